@@ -0,0 +1,93 @@
+/*
+ * Data cache maintenance by address and by set/way - see cache.h.
+ */
+
+#include "cache.h"
+
+// Smallest data cache line, from CTR.DminLine (log2 of words)
+static uint32_t dcache_line_size(void) {
+    uint32_t ctr;
+    __asm volatile ("mrc p15, 0, %0, c0, c0, 1" : "=r" (ctr));
+    return 4UL << ((ctr >> 16) & 0xF);
+}
+
+void cache_clean_range(const volatile void *addr, size_t len) {
+    uint32_t line = dcache_line_size();
+    uintptr_t p = (uintptr_t)addr & ~(line - 1);
+    uintptr_t end = (uintptr_t)addr + len;
+
+    for (; p < end; p += line) {
+        __asm volatile ("mcr p15, 0, %0, c7, c10, 1" :: "r" (p) : "memory");  // DCCMVAC
+    }
+    __asm volatile ("dsb" ::: "memory");
+}
+
+void cache_clean_invalidate_range(const volatile void *addr, size_t len) {
+    uint32_t line = dcache_line_size();
+    uintptr_t p = (uintptr_t)addr & ~(line - 1);
+    uintptr_t end = (uintptr_t)addr + len;
+
+    for (; p < end; p += line) {
+        __asm volatile ("mcr p15, 0, %0, c7, c14, 1" :: "r" (p) : "memory");  // DCCIMVAC
+    }
+    __asm volatile ("dsb" ::: "memory");
+}
+
+void cache_invalidate_range(volatile void *addr, size_t len) {
+    uint32_t line = dcache_line_size();
+    uintptr_t start = (uintptr_t)addr;
+    uintptr_t end = start + len;
+    uintptr_t p;
+
+    if (len == 0) {
+        return;
+    }
+
+    // Partial lines at the ends hold data outside the buffer; keep it.
+    if (start & (line - 1)) {
+        __asm volatile ("mcr p15, 0, %0, c7, c14, 1" :: "r" (start) : "memory");
+    }
+    if (end & (line - 1)) {
+        __asm volatile ("mcr p15, 0, %0, c7, c14, 1" :: "r" (end) : "memory");
+    }
+
+    for (p = (start + line - 1) & ~(line - 1); p + line <= end; p += line) {
+        __asm volatile ("mcr p15, 0, %0, c7, c6, 1" :: "r" (p) : "memory");   // DCIMVAC
+    }
+    __asm volatile ("dsb" ::: "memory");
+}
+
+void cache_invalidate_dcache_all(void) {
+    uint32_t clidr;
+    uint32_t loc;
+
+    __asm volatile ("mrc p15, 1, %0, c0, c0, 1" : "=r" (clidr));
+    loc = (clidr >> 24) & 0x7;
+
+    for (uint32_t level = 0; level < loc; level++) {
+        uint32_t ctype = (clidr >> (3 * level)) & 0x7;
+        uint32_t ccsidr, line_shift, ways, sets, way_shift;
+
+        if (ctype < 2) {
+            continue;  // No cache or instruction cache only
+        }
+
+        __asm volatile ("mcr p15, 2, %0, c0, c0, 0\n"  // CSSELR
+                        "isb" :: "r" (level << 1) : "memory");
+        __asm volatile ("mrc p15, 1, %0, c0, c0, 0" : "=r" (ccsidr));
+
+        line_shift = (ccsidr & 0x7) + 4;
+        ways = ((ccsidr >> 3) & 0x3FF) + 1;
+        sets = ((ccsidr >> 13) & 0x7FFF) + 1;
+        way_shift = ways > 1 ? (uint32_t)__builtin_clz(ways - 1) : 0;
+
+        for (uint32_t way = 0; way < ways; way++) {
+            for (uint32_t set = 0; set < sets; set++) {
+                uint32_t sw = (way << way_shift) | (set << line_shift) | (level << 1);
+                __asm volatile ("mcr p15, 0, %0, c7, c6, 2" :: "r" (sw) : "memory");  // DCISW
+            }
+        }
+    }
+    __asm volatile ("dsb\n"
+                    "isb" ::: "memory");
+}
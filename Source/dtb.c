@@ -0,0 +1,142 @@
+/*
+ * Flattened device tree reader - see dtb.h.
+ *
+ * Only walks the structure block; nothing is cached, callers run once at boot.
+ */
+
+#include <stddef.h>
+#include "dtb.h"
+
+#define FDT_MAGIC           0xD00DFEEDUL
+#define FDT_BEGIN_NODE      1
+#define FDT_END_NODE        2
+#define FDT_PROP            3
+#define FDT_NOP             4
+#define FDT_END             9
+
+// Header fields, as 32-bit big-endian word offsets
+#define FDT_HDR_MAGIC       0
+#define FDT_HDR_TOTALSIZE   1
+#define FDT_HDR_OFF_STRUCT  2
+#define FDT_HDR_OFF_STRINGS 3
+#define FDT_HDR_SIZE_STRUCT 9
+
+uintptr_t dtb_boot_address;
+
+static uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Read a 1 or 2 cell big-endian number.
+static uint64_t read_cells(const uint8_t *p, uint32_t cells) {
+    uint64_t val = 0;
+
+    for (uint32_t i = 0; i < cells; i++) {
+        val = (val << 32) | be32(p + 4 * i);
+    }
+    return val;
+}
+
+static int str_eq(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// "memory" or "memory@<unit address>"
+static int is_memory_node(const char *name) {
+    const char *m = "memory";
+
+    while (*m && *name == *m) {
+        m++;
+        name++;
+    }
+    return *m == '\0' && (*name == '\0' || *name == '@');
+}
+
+static const uint8_t *dtb_get(void) {
+    const uint8_t *fdt = (const uint8_t *)dtb_boot_address;
+
+    if (dtb_boot_address < DTB_GUEST_RAM_BASE || (dtb_boot_address & 7)) {
+        return NULL;
+    }
+    if (be32(fdt + 4 * FDT_HDR_MAGIC) != FDT_MAGIC) {
+        return NULL;
+    }
+    return fdt;
+}
+
+int dtb_memory_range(uint64_t *base, uint64_t *size) {
+    const uint8_t *fdt = dtb_get();
+    const uint8_t *p, *end;
+    const char *strings;
+    uint32_t addr_cells = 2, size_cells = 1;  // Defaults from the DT spec
+    int depth = 0;
+    int in_memory = 0;
+
+    if (fdt == NULL) {
+        return -1;
+    }
+
+    p = fdt + be32(fdt + 4 * FDT_HDR_OFF_STRUCT);
+    end = p + be32(fdt + 4 * FDT_HDR_SIZE_STRUCT);
+    strings = (const char *)fdt + be32(fdt + 4 * FDT_HDR_OFF_STRINGS);
+    if (end > fdt + be32(fdt + 4 * FDT_HDR_TOTALSIZE)) {
+        return -1;
+    }
+
+    while (p + 4 <= end) {
+        uint32_t token = be32(p);
+        p += 4;
+
+        switch (token) {
+            case FDT_BEGIN_NODE: {
+                const char *name = (const char *)p;
+                size_t len = 0;
+
+                while (p + len < end && name[len]) {
+                    len++;
+                }
+                p += (len + 4) & ~3UL;  // Name, NUL and padding
+                depth++;
+                in_memory = depth == 2 && is_memory_node(name);
+                break;
+            }
+            case FDT_END_NODE:
+                depth--;
+                in_memory = 0;
+                break;
+            case FDT_PROP: {
+                uint32_t len = be32(p);
+                const char *name = strings + be32(p + 4);
+                const uint8_t *val = p + 8;
+
+                p += 8 + ((len + 3) & ~3UL);
+                if (p > end) {
+                    return -1;
+                }
+                if (depth == 1 && str_eq(name, "#address-cells") && len == 4) {
+                    addr_cells = be32(val);
+                } else if (depth == 1 && str_eq(name, "#size-cells") && len == 4) {
+                    size_cells = be32(val);
+                } else if (in_memory && str_eq(name, "reg")) {
+                    if (addr_cells < 1 || addr_cells > 2 || size_cells < 1 || size_cells > 2 ||
+                        len < 4 * (addr_cells + size_cells)) {
+                        return -1;
+                    }
+                    *base = read_cells(val, addr_cells);
+                    *size = read_cells(val + 4 * addr_cells, size_cells);
+                    return 0;
+                }
+                break;
+            }
+            case FDT_NOP:
+                break;
+            default:  // FDT_END or garbage
+                return -1;
+        }
+    }
+    return -1;
+}
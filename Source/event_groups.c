@@ -54,7 +54,15 @@
     typedef struct EventGroupDef_t
     {
         EventBits_t uxEventBits;
-        List_t xTasksWaitingForBits; /**< List of tasks waiting for a bit to be set. */
+
+        #if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+            List_t xTasksWaitingForBits[ configEVENT_GROUP_WAIT_CLASSES ]; /**< Tasks waiting for bits to be set, one list per wait condition.  The last list holds the tasks whose condition did not get a list of its own. */
+            EventBits_t uxClassCondition[ configEVENT_GROUP_WAIT_CLASSES ]; /**< The wait condition, bits and control bits, of every task on the list of the same index.  Not used for the last list. */
+            EventBits_t uxPendingBits;                                     /**< Bits set from an interrupt while the event group was locked. */
+            uint8_t ucLocked;                                              /**< Non-zero while a task is using the lists - interrupts must then leave them alone.  A count, as xEventGroupSync() sets bits with the event group locked. */
+        #else
+            List_t xTasksWaitingForBits; /**< List of tasks waiting for a bit to be set. */
+        #endif
 
         #if ( configUSE_TRACE_FACILITY == 1 )
             UBaseType_t uxEventGroupNumber;
@@ -79,6 +87,65 @@
                                             const EventBits_t uxBitsToWaitFor,
                                             const BaseType_t xWaitForAllBits ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+
+/* The list for tasks whose wait condition has no list of its own. */
+    #define eventSHARED_WAIT_LIST    ( configEVENT_GROUP_WAIT_CLASSES - 1 )
+
+/*
+ * Initialise the wait lists of a new event group.
+ */
+    static void prvInitialiseWaitLists( EventGroup_t * pxEventBits ) PRIVILEGED_FUNCTION;
+
+/*
+ * Place the calling task on the list for uxWaitCondition, taking a free list
+ * if no other task is waiting on the same condition, or else the shared list.
+ * Must be called with the scheduler suspended and the event group locked.
+ */
+    static void prvPlaceOnWaitList( EventGroup_t * pxEventBits,
+                                    const EventBits_t uxWaitCondition,
+                                    const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Set bits and unblock every task whose wait condition is then met.  Each
+ * list but the shared one is tested once and released as a whole.  A task
+ * calls this with the scheduler suspended and the event group locked, and
+ * xFromISR set to pdFALSE.  An ISR calls it from a critical section, with the
+ * event group not locked.  Returns pdTRUE if an ISR unblocked a task of a
+ * higher priority than the interrupted task.
+ */
+    static BaseType_t prvSetBitsAndUnblock( EventGroup_t * pxEventBits,
+                                            const EventBits_t uxBitsToSet,
+                                            const BaseType_t xFromISR ) PRIVILEGED_FUNCTION;
+
+/*
+ * Unblock every task on pxList, with xTaskRemoveAllFromUnorderedEventList()
+ * from an ISR or vTaskRemoveAllFromUnorderedEventList() from a task.
+ */
+    static BaseType_t prvReleaseWaitList( List_t * pxList,
+                                          const EventBits_t uxUnblockValue,
+                                          const BaseType_t xFromISR ) PRIVILEGED_FUNCTION;
+
+/*
+ * A task locks the event group while it walks or adds itself to the wait
+ * lists outside a critical section.  xEventGroupSetBitsFromISR() then only
+ * records the bits, and the unlock sets them - like the locking in queue.c.
+ * Interrupts are therefore only ever masked for one pass over the lists, by
+ * an ISR that sets bits directly.
+ */
+    static void prvLockEventGroup( EventGroup_t * pxEventBits ) PRIVILEGED_FUNCTION;
+    static void prvUnlockEventGroup( EventGroup_t * pxEventBits ) PRIVILEGED_FUNCTION;
+
+#else /* configUSE_EVENT_GROUP_WAITER_INDEX */
+
+    #define prvInitialiseWaitLists( pxEventBits )    vListInitialise( &( ( pxEventBits )->xTasksWaitingForBits ) )
+    #define prvPlaceOnWaitList( pxEventBits, uxWaitCondition, xTicksToWait ) \
+    vTaskPlaceOnUnorderedEventList( &( ( pxEventBits )->xTasksWaitingForBits ), ( uxWaitCondition ), ( xTicksToWait ) )
+    #define prvLockEventGroup( pxEventBits )
+    #define prvUnlockEventGroup( pxEventBits )
+
+#endif /* configUSE_EVENT_GROUP_WAITER_INDEX */
+
 /*-----------------------------------------------------------*/
 
     #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
@@ -111,7 +178,7 @@
             if( pxEventBits != NULL )
             {
                 pxEventBits->uxEventBits = 0;
-                vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
+                prvInitialiseWaitLists( pxEventBits );
 
                 #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
                 {
@@ -156,7 +223,7 @@
             if( pxEventBits != NULL )
             {
                 pxEventBits->uxEventBits = 0;
-                vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
+                prvInitialiseWaitLists( pxEventBits );
 
                 #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
                 {
@@ -203,6 +270,7 @@
         #endif
 
         vTaskSuspendAll();
+        prvLockEventGroup( pxEventBits );
         {
             uxOriginalBitValue = pxEventBits->uxEventBits;
 
@@ -228,7 +296,7 @@
                     /* Store the bits that the calling task is waiting for in the
                      * task's event list item so the kernel knows when a match is
                      * found.  Then enter the blocked state. */
-                    vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits ), ( uxBitsToWaitFor | eventCLEAR_EVENTS_ON_EXIT_BIT | eventWAIT_FOR_ALL_BITS ), xTicksToWait );
+                    prvPlaceOnWaitList( pxEventBits, ( uxBitsToWaitFor | eventCLEAR_EVENTS_ON_EXIT_BIT | eventWAIT_FOR_ALL_BITS ), xTicksToWait );
 
                     /* This assignment is obsolete as uxReturn will get set after
                      * the task unblocks, but some compilers mistakenly generate a
@@ -245,6 +313,7 @@
                 }
             }
         }
+        prvUnlockEventGroup( pxEventBits );
         xAlreadyYielded = xTaskResumeAll();
 
         if( xTicksToWait != ( TickType_t ) 0 )
@@ -334,6 +403,7 @@
         #endif
 
         vTaskSuspendAll();
+        prvLockEventGroup( pxEventBits );
         {
             const EventBits_t uxCurrentEventBits = pxEventBits->uxEventBits;
 
@@ -391,7 +461,7 @@
                 /* Store the bits that the calling task is waiting for in the
                  * task's event list item so the kernel knows when a match is
                  * found.  Then enter the blocked state. */
-                vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits ), ( uxBitsToWaitFor | uxControlBits ), xTicksToWait );
+                prvPlaceOnWaitList( pxEventBits, ( uxBitsToWaitFor | uxControlBits ), xTicksToWait );
 
                 /* This is obsolete as it will get set after the task unblocks, but
                  * some compilers mistakenly generate a warning about the variable
@@ -401,6 +471,7 @@
                 traceEVENT_GROUP_WAIT_BITS_BLOCK( xEventGroup, uxBitsToWaitFor );
             }
         }
+        prvUnlockEventGroup( pxEventBits );
         xAlreadyYielded = xTaskResumeAll();
 
         if( xTicksToWait != ( TickType_t ) 0 )
@@ -544,6 +615,46 @@
     }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+
+    EventBits_t xEventGroupSetBits( EventGroupHandle_t xEventGroup,
+                                    const EventBits_t uxBitsToSet )
+    {
+        EventBits_t uxReturnBits;
+        EventGroup_t * pxEventBits = xEventGroup;
+
+        traceENTER_xEventGroupSetBits( xEventGroup, uxBitsToSet );
+
+        /* Check the user is not attempting to set the bits used by the kernel
+         * itself. */
+        configASSERT( xEventGroup );
+        configASSERT( ( uxBitsToSet & eventEVENT_BITS_CONTROL_BYTES ) == 0 );
+
+        /* The lists are walked with the scheduler suspended, as without the
+         * index, and with the event group locked, so interrupts stay enabled
+         * however many tasks are waiting.  xTaskResumeAll() yields to the
+         * unblocked tasks if required.  xEventGroupSync() calls this with the
+         * event group already locked by the calling task itself. */
+        vTaskSuspendAll();
+        prvLockEventGroup( pxEventBits );
+        {
+            traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet );
+
+            ( void ) prvSetBitsAndUnblock( pxEventBits, uxBitsToSet, pdFALSE );
+
+            /* Snapshot resulting bits. */
+            uxReturnBits = pxEventBits->uxEventBits;
+        }
+        prvUnlockEventGroup( pxEventBits );
+        ( void ) xTaskResumeAll();
+
+        traceRETURN_xEventGroupSetBits( uxReturnBits );
+
+        return uxReturnBits;
+    }
+
+#else /* configUSE_EVENT_GROUP_WAITER_INDEX */
+
     EventBits_t xEventGroupSetBits( EventGroupHandle_t xEventGroup,
                                     const EventBits_t uxBitsToSet )
     {
@@ -645,17 +756,44 @@
 
         return uxReturnBits;
     }
+
+#endif /* configUSE_EVENT_GROUP_WAITER_INDEX */
 /*-----------------------------------------------------------*/
 
     void vEventGroupDelete( EventGroupHandle_t xEventGroup )
     {
         EventGroup_t * pxEventBits = xEventGroup;
-        const List_t * pxTasksWaitingForBits;
+
+        #if ( configUSE_EVENT_GROUP_WAITER_INDEX == 0 )
+            const List_t * pxTasksWaitingForBits;
+        #endif
 
         traceENTER_vEventGroupDelete( xEventGroup );
 
         configASSERT( pxEventBits );
 
+        #if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+        {
+            UBaseType_t x;
+
+            vTaskSuspendAll();
+            {
+                traceEVENT_GROUP_DELETE( xEventGroup );
+
+                /* Unblock every task, returning 0 as the event list is being
+                 * deleted and cannot therefore have any bits set.  The event
+                 * group is not unlocked again, so bits an ISR sets from now on
+                 * are dropped. */
+                prvLockEventGroup( pxEventBits );
+
+                for( x = 0; x < ( UBaseType_t ) configEVENT_GROUP_WAIT_CLASSES; x++ )
+                {
+                    vTaskRemoveAllFromUnorderedEventList( &( pxEventBits->xTasksWaitingForBits[ x ] ), eventUNBLOCKED_DUE_TO_BIT_SET );
+                }
+            }
+            ( void ) xTaskResumeAll();
+        }
+        #else /* configUSE_EVENT_GROUP_WAITER_INDEX */
         pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 
         vTaskSuspendAll();
@@ -671,6 +809,7 @@
             }
         }
         ( void ) xTaskResumeAll();
+        #endif /* configUSE_EVENT_GROUP_WAITER_INDEX */
 
         #if ( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
         {
@@ -812,7 +951,261 @@
     }
 /*-----------------------------------------------------------*/
 
-    #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 ) && ( configUSE_TIMERS == 1 ) )
+    #if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+
+        static void prvInitialiseWaitLists( EventGroup_t * pxEventBits )
+        {
+            UBaseType_t x;
+
+            for( x = 0; x < ( UBaseType_t ) configEVENT_GROUP_WAIT_CLASSES; x++ )
+            {
+                vListInitialise( &( pxEventBits->xTasksWaitingForBits[ x ] ) );
+                pxEventBits->uxClassCondition[ x ] = 0;
+            }
+
+            pxEventBits->uxPendingBits = 0;
+            pxEventBits->ucLocked = ( uint8_t ) 0U;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvPlaceOnWaitList( EventGroup_t * pxEventBits,
+                                        const EventBits_t uxWaitCondition,
+                                        const TickType_t xTicksToWait )
+        {
+            UBaseType_t x, uxList = ( UBaseType_t ) eventSHARED_WAIT_LIST;
+
+            /* A list that has emptied, as its tasks were unblocked or timed
+             * out, is free to take a new condition. */
+            for( x = 0; x < ( UBaseType_t ) eventSHARED_WAIT_LIST; x++ )
+            {
+                if( listLIST_IS_EMPTY( &( pxEventBits->xTasksWaitingForBits[ x ] ) ) != pdFALSE )
+                {
+                    if( uxList == ( UBaseType_t ) eventSHARED_WAIT_LIST )
+                    {
+                        uxList = x;
+                    }
+                }
+                else if( pxEventBits->uxClassCondition[ x ] == uxWaitCondition )
+                {
+                    uxList = x;
+                    break;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+
+            if( uxList != ( UBaseType_t ) eventSHARED_WAIT_LIST )
+            {
+                pxEventBits->uxClassCondition[ uxList ] = uxWaitCondition;
+            }
+
+            vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits[ uxList ] ), uxWaitCondition, xTicksToWait );
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvSetBitsAndUnblock( EventGroup_t * pxEventBits,
+                                                const EventBits_t uxBitsToSet,
+                                                const BaseType_t xFromISR )
+        {
+            List_t xMatched;
+            List_t * pxList;
+            ListItem_t * pxListItem;
+            ListItem_t * pxNext;
+            ListItem_t const * pxListEnd;
+            EventBits_t uxBitsToClear = 0, uxBitsWaitedFor, uxControlBits, uxUnblockValue;
+            BaseType_t xReturn = pdFALSE;
+            UBaseType_t x;
+
+            /* Set the bits.  The tasks are given the value before any are
+             * cleared, as in the lists' walk without the index. */
+            pxEventBits->uxEventBits |= uxBitsToSet;
+            uxUnblockValue = pxEventBits->uxEventBits | eventUNBLOCKED_DUE_TO_BIT_SET;
+
+            for( x = 0; x < ( UBaseType_t ) configEVENT_GROUP_WAIT_CLASSES; x++ )
+            {
+                pxList = &( pxEventBits->xTasksWaitingForBits[ x ] );
+
+                if( listLIST_IS_EMPTY( pxList ) != pdFALSE )
+                {
+                    continue;
+                }
+
+                if( x != ( UBaseType_t ) eventSHARED_WAIT_LIST )
+                {
+                    /* Every task on the list waits on the same condition. */
+                    uxControlBits = pxEventBits->uxClassCondition[ x ] & eventEVENT_BITS_CONTROL_BYTES;
+                    uxBitsWaitedFor = pxEventBits->uxClassCondition[ x ] & ~eventEVENT_BITS_CONTROL_BYTES;
+
+                    if( prvTestWaitCondition( pxEventBits->uxEventBits, uxBitsWaitedFor, ( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) != 0 ) ? pdTRUE : pdFALSE ) != pdFALSE )
+                    {
+                        if( ( uxControlBits & eventCLEAR_EVENTS_ON_EXIT_BIT ) != ( EventBits_t ) 0 )
+                        {
+                            uxBitsToClear |= uxBitsWaitedFor;
+                        }
+
+                        if( prvReleaseWaitList( pxList, uxUnblockValue, xFromISR ) != pdFALSE )
+                        {
+                            xReturn = pdTRUE;
+                        }
+                    }
+                }
+                else
+                {
+                    /* The shared list is tested task by task.  The matches are
+                     * gathered on a list of their own to be released together. */
+                    vListInitialise( &xMatched );
+                    pxListEnd = listGET_END_MARKER( pxList );
+                    pxListItem = listGET_HEAD_ENTRY( pxList );
+
+                    while( pxListItem != pxListEnd )
+                    {
+                        pxNext = listGET_NEXT( pxListItem );
+                        uxControlBits = listGET_LIST_ITEM_VALUE( pxListItem ) & eventEVENT_BITS_CONTROL_BYTES;
+                        uxBitsWaitedFor = listGET_LIST_ITEM_VALUE( pxListItem ) & ~eventEVENT_BITS_CONTROL_BYTES;
+
+                        if( prvTestWaitCondition( pxEventBits->uxEventBits, uxBitsWaitedFor, ( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) != 0 ) ? pdTRUE : pdFALSE ) != pdFALSE )
+                        {
+                            if( ( uxControlBits & eventCLEAR_EVENTS_ON_EXIT_BIT ) != ( EventBits_t ) 0 )
+                            {
+                                uxBitsToClear |= uxBitsWaitedFor;
+                            }
+
+                            listREMOVE_ITEM( pxListItem );
+                            listINSERT_END( &xMatched, pxListItem );
+                        }
+
+                        pxListItem = pxNext;
+                    }
+
+                    if( prvReleaseWaitList( &xMatched, uxUnblockValue, xFromISR ) != pdFALSE )
+                    {
+                        xReturn = pdTRUE;
+                    }
+                }
+            }
+
+            /* Clear any bits that matched when the eventCLEAR_EVENTS_ON_EXIT_BIT
+             * bit was set in the control word. */
+            pxEventBits->uxEventBits &= ~uxBitsToClear;
+
+            return xReturn;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvReleaseWaitList( List_t * pxList,
+                                              const EventBits_t uxUnblockValue,
+                                              const BaseType_t xFromISR )
+        {
+            BaseType_t xReturn = pdFALSE;
+
+            if( xFromISR != pdFALSE )
+            {
+                xReturn = xTaskRemoveAllFromUnorderedEventList( pxList, uxUnblockValue );
+            }
+            else
+            {
+                vTaskRemoveAllFromUnorderedEventList( pxList, uxUnblockValue );
+            }
+
+            return xReturn;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvLockEventGroup( EventGroup_t * pxEventBits )
+        {
+            taskENTER_CRITICAL();
+            {
+                configASSERT( pxEventBits->ucLocked < ( uint8_t ) UINT8_MAX );
+                pxEventBits->ucLocked++;
+            }
+            taskEXIT_CRITICAL();
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvUnlockEventGroup( EventGroup_t * pxEventBits )
+        {
+            EventBits_t uxPendingBits;
+
+            /* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED, so the
+             * tasks unblocked here are held pending until xTaskResumeAll().
+             * Bits set from ISRs while the event group was locked are set
+             * here, still locked and outside the critical section, until an
+             * ISR has left none behind. */
+            for( ; ; )
+            {
+                taskENTER_CRITICAL();
+                {
+                    uxPendingBits = pxEventBits->uxPendingBits;
+                    pxEventBits->uxPendingBits = 0;
+
+                    if( uxPendingBits == ( EventBits_t ) 0 )
+                    {
+                        pxEventBits->ucLocked--;
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                if( uxPendingBits == ( EventBits_t ) 0 )
+                {
+                    break;
+                }
+
+                ( void ) prvSetBitsAndUnblock( pxEventBits, uxPendingBits, pdFALSE );
+            }
+        }
+
+    #endif /* configUSE_EVENT_GROUP_WAITER_INDEX */
+/*-----------------------------------------------------------*/
+
+    #if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+
+        BaseType_t xEventGroupSetBitsFromISR( EventGroupHandle_t xEventGroup,
+                                              const EventBits_t uxBitsToSet,
+                                              BaseType_t * pxHigherPriorityTaskWoken )
+        {
+            EventGroup_t * pxEventBits = xEventGroup;
+            UBaseType_t uxSavedInterruptStatus;
+            BaseType_t xWoken = pdFALSE;
+
+            traceENTER_xEventGroupSetBitsFromISR( xEventGroup, uxBitsToSet, pxHigherPriorityTaskWoken );
+
+            configASSERT( xEventGroup );
+            configASSERT( ( uxBitsToSet & eventEVENT_BITS_CONTROL_BYTES ) == 0 );
+            portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+            /* MISRA Ref 4.7.1 [Return value shall be checked] */
+            /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#dir-47 */
+            /* coverity[misra_c_2012_directive_4_7_violation] */
+            uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+            {
+                traceEVENT_GROUP_SET_BITS_FROM_ISR( xEventGroup, uxBitsToSet );
+
+                if( pxEventBits->ucLocked == ( uint8_t ) 0U )
+                {
+                    xWoken = prvSetBitsAndUnblock( pxEventBits, uxBitsToSet, pdTRUE );
+                }
+                else
+                {
+                    /* A task is adding itself to the wait lists.  It sets
+                     * these bits when it unlocks the event group. */
+                    pxEventBits->uxPendingBits |= uxBitsToSet;
+                }
+            }
+            taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+            if( ( xWoken != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+            {
+                *pxHigherPriorityTaskWoken = pdTRUE;
+            }
+
+            traceRETURN_xEventGroupSetBitsFromISR( pdPASS );
+
+            return pdPASS;
+        }
+
+    #elif ( ( configUSE_TRACE_FACILITY == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 ) && ( configUSE_TIMERS == 1 ) )
 
         BaseType_t xEventGroupSetBitsFromISR( EventGroupHandle_t xEventGroup,
                                               const EventBits_t uxBitsToSet,
@@ -0,0 +1,47 @@
+/*
+ * Minimal GICv2 helpers - see gic.h.
+ */
+
+#include "FreeRTOS.h"
+#include "gic.h"
+
+#define GICD_REG(off)   (*(volatile uint32_t *)(configINTERRUPT_CONTROLLER_DISTRIBUTOR_ADDRESS + (off)))
+#define GICD_REG8(off)  (*(volatile uint8_t *)(configINTERRUPT_CONTROLLER_DISTRIBUTOR_ADDRESS + (off)))
+#define GICC_REG(off)   (*(volatile uint32_t *)(portINTERRUPT_CONTROLLER_CPU_INTERFACE_ADDRESS + (off)))
+
+void gic_init(void) {
+    // Enable forwarding from the distributor, then signalling on this CPU.
+    GICD_REG(GICD_CTLR) = 1;
+    gic_init_cpu();
+}
+
+void gic_init_cpu(void) {
+    // Binary point 0 keeps every priority bit a pre-emption bit, which is
+    // what vPortValidateInterruptPriority() expects.
+    GICC_REG(GICC_BPR) = 0;
+    GICC_REG(GICC_CTLR) = 1;
+}
+
+void gic_set_priority(uint32_t id, uint32_t priority) {
+    GICD_REG8(GICD_IPRIORITYR + id) = (uint8_t)(priority << portPRIORITY_SHIFT);
+}
+
+void gic_set_target(uint32_t id, uint32_t cpu_mask) {
+    // Target registers are read-only for SGIs and PPIs.
+    if (id >= GIC_SPI_BASE) {
+        GICD_REG8(GICD_ITARGETSR + id) = (uint8_t)cpu_mask;
+    }
+}
+
+void gic_enable_irq(uint32_t id) {
+    GICD_REG(GICD_ISENABLER + ((id / 32) * 4)) = 1UL << (id % 32);
+}
+
+void gic_disable_irq(uint32_t id) {
+    GICD_REG(GICD_ICENABLER + ((id / 32) * 4)) = 1UL << (id % 32);
+}
+
+void gic_send_sgi(uint32_t id) {
+    // Target list filter 0b10: forward only to the requesting CPU
+    GICD_REG(GICD_SGIR) = (2UL << 24) | (id & 0xF);
+}
@@ -0,0 +1,42 @@
+/*
+ * Heap region for configHEAP_FROM_LINKER_REGION.
+ *
+ * The heap is the last thing in link.ld.  It starts at __heap_start__ and runs
+ * to the end of guest RAM as given by the device tree, but no further than
+ * __heap_limit__, where the trace rings and then the fixed memory debug
+ * regions begin.  Without a usable device tree it is just the
+ * __heap_start__ .. __heap_end__ reservation, configTOTAL_HEAP_SIZE bytes.
+ *
+ * The region is outside .bss, so startup.S never clears it; heap_4 only
+ * writes its block headers.
+ */
+
+#include "FreeRTOS.h"
+#include "dtb.h"
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+
+extern uint8_t __heap_start__[];
+extern uint8_t __heap_end__[];
+extern uint8_t __heap_limit__[];
+
+void vApplicationGetHeapRegion(uint8_t **ppucHeapStart, size_t *pxHeapSize) {
+    uintptr_t end = (uintptr_t)__heap_end__;
+    uint64_t ram_base, ram_size;
+
+    if (dtb_memory_range(&ram_base, &ram_size) == 0) {
+        uint64_t ram_end = ram_base + ram_size;
+
+        if (ram_end > (uintptr_t)__heap_limit__) {
+            ram_end = (uintptr_t)__heap_limit__;
+        }
+        if (ram_end > end) {
+            end = (uintptr_t)ram_end;
+        }
+    }
+
+    *ppucHeapStart = __heap_start__;
+    *pxHeapSize = end - (uintptr_t)__heap_start__;
+}
+
+#endif // configSUPPORT_DYNAMIC_ALLOCATION
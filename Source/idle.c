@@ -0,0 +1,95 @@
+/*
+ * Background work and WFI from the idle task - see idle.h.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "tick_timer.h"
+#include "idle.h"
+#if ( configUSE_SEL4_PARAVIRT == 1 )
+#include "sel4_pv.h"
+#endif
+
+// Written only by the core's own idle task.  'seq' is odd while the totals
+// are being updated, for readers on other cores.
+typedef struct {
+    uint64_t asleep;
+    uint64_t sleep_start;
+    uint32_t wakeups;
+    uint32_t seq;
+} idle_core_t;
+
+static idle_work_t idle_work[IDLE_WORK_MAX];
+static uint32_t idle_work_count;
+
+static volatile idle_core_t idle_cores[configNUMBER_OF_CORES];
+
+int idle_add_work(idle_work_t work) {
+    if (idle_work_count >= IDLE_WORK_MAX) {
+        return -1;
+    }
+    idle_work[idle_work_count++] = work;
+    return 0;
+}
+
+void idle_sleep_enter(void) {
+    idle_cores[portGET_CORE_ID()].sleep_start = tick_timer_read_counter();
+}
+
+void idle_sleep_exit(void) {
+    volatile idle_core_t *c = &idle_cores[portGET_CORE_ID()];
+    uint64_t now = tick_timer_read_counter();
+
+    c->seq++;
+    __asm volatile ("dmb ish" ::: "memory");
+    c->asleep += now - c->sleep_start;
+    c->wakeups++;
+    __asm volatile ("dmb ish" ::: "memory");
+    c->seq++;
+}
+
+void idle_wait(void) {
+    for (uint32_t i = 0; i < idle_work_count; i++) {
+        idle_work[i]();
+    }
+
+#if ( configUSE_TICKLESS_IDLE == 0 )
+    // Masked, so that the wakeup is counted before its interrupt is taken;
+    // WFI still wakes on a pending interrupt.  Anything that readied a task
+    // before this point has already switched away from the idle task.
+    __asm volatile ("cpsid i" ::: "memory");
+    idle_sleep_enter();
+#if ( configUSE_SEL4_PARAVIRT == 1 )
+    // The next tick is the deadline; a core with no tick armed (SMP: all but
+    // core 0) waits for its other interrupts only.
+    sel4_pv_wait((tick_timer_read_ctl() & CNTV_CTL_ENABLE) ? tick_timer_read_compare()
+                                                           : SEL4_PV_NO_DEADLINE);
+#else
+    __asm volatile ("dsb\n"
+                    "wfi\n"
+                    "isb" ::: "memory");
+#endif
+    idle_sleep_exit();
+    __asm volatile ("cpsie i" ::: "memory");
+#endif
+}
+
+int idle_stats_get(uint32_t core, idle_stats_t *stats) {
+    const volatile idle_core_t *c;
+    uint32_t seq;
+
+    if (core >= configNUMBER_OF_CORES) {
+        return -1;
+    }
+    c = &idle_cores[core];
+
+    // The 64-bit total is not written atomically
+    do {
+        seq = c->seq;
+        __asm volatile ("dmb ish" ::: "memory");
+        stats->asleep = c->asleep;
+        stats->wakeups = c->wakeups;
+        __asm volatile ("dmb ish" ::: "memory");
+    } while ((seq & 1) || seq != c->seq);
+    return 0;
+}
@@ -518,10 +518,56 @@
     #endif
 #endif
 
+#ifndef configUSE_PARTITIONED_SCHEDULING
+    #define configUSE_PARTITIONED_SCHEDULING    0
+#endif /* configUSE_PARTITIONED_SCHEDULING */
+
 #ifndef configUSE_PASSIVE_IDLE_HOOK
     #define configUSE_PASSIVE_IDLE_HOOK    0
 #endif /* configUSE_PASSIVE_IDLE_HOOK */
 
+#ifndef configUSE_DELAY_WHEEL
+    #define configUSE_DELAY_WHEEL    0
+#endif /* configUSE_DELAY_WHEEL */
+
+#ifndef configUSE_TCB_CACHE_LAYOUT
+    #define configUSE_TCB_CACHE_LAYOUT    0
+#endif /* configUSE_TCB_CACHE_LAYOUT */
+
+#ifndef configTCB_CACHE_LINE_SIZE
+    #define configTCB_CACHE_LINE_SIZE    32
+#endif /* configTCB_CACHE_LINE_SIZE */
+
+#ifndef configDELAY_WHEEL_SLOTS
+    #define configDELAY_WHEEL_SLOTS    64
+#endif /* configDELAY_WHEEL_SLOTS */
+
+#ifndef configUSE_EVENT_GROUP_WAITER_INDEX
+    #define configUSE_EVENT_GROUP_WAITER_INDEX    0
+#endif /* configUSE_EVENT_GROUP_WAITER_INDEX */
+
+#ifndef configEVENT_GROUP_WAIT_CLASSES
+    #define configEVENT_GROUP_WAIT_CLASSES    4
+#endif /* configEVENT_GROUP_WAIT_CLASSES */
+
+#if ( ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 ) && ( configEVENT_GROUP_WAIT_CLASSES < 2 ) )
+    #error configEVENT_GROUP_WAIT_CLASSES must be at least 2 - one class plus the shared list
+#endif
+
+#ifndef configUSE_MUTEX_FAST_PATH
+    #define configUSE_MUTEX_FAST_PATH    0
+#endif /* configUSE_MUTEX_FAST_PATH */
+
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+    #if ( configUSE_MUTEXES != 1 )
+        #error configUSE_MUTEX_FAST_PATH requires configUSE_MUTEXES
+    #endif
+
+    #ifndef portCOMPARE_AND_SWAP
+        #error configUSE_MUTEX_FAST_PATH requires the port to define portCOMPARE_AND_SWAP
+    #endif
+#endif
+
 /* The timers module relies on xTaskGetSchedulerState(). */
 #if configUSE_TIMERS == 1
 
@@ -541,6 +587,14 @@
         #define portTIMER_CALLBACK_ATTRIBUTE
     #endif /* portTIMER_CALLBACK_ATTRIBUTE */
 
+    #ifndef configUSE_TIMER_WHEEL
+        #define configUSE_TIMER_WHEEL    0
+    #endif /* configUSE_TIMER_WHEEL */
+
+    #if ( ( configUSE_TIMER_WHEEL == 1 ) && ( INCLUDE_xTaskAbortDelay != 1 ) )
+        #error configUSE_TIMER_WHEEL wakes the timer service task with xTaskAbortDelay(), so INCLUDE_xTaskAbortDelay must be set to 1.
+    #endif
+
 #endif /* configUSE_TIMERS */
 
 #ifndef portHAS_NESTED_INTERRUPTS
@@ -1326,6 +1380,38 @@
     #define traceRETURN_xQueueReceiveFromISR( xReturn )
 #endif
 
+#ifndef traceENTER_xQueueSendMultiple
+    #define traceENTER_xQueueSendMultiple( xQueue, pvItems, uxItemCount, xTicksToWait )
+#endif
+
+#ifndef traceRETURN_xQueueSendMultiple
+    #define traceRETURN_xQueueSendMultiple( uxReturn )
+#endif
+
+#ifndef traceENTER_xQueueSendMultipleFromISR
+    #define traceENTER_xQueueSendMultipleFromISR( xQueue, pvItems, uxItemCount, pxHigherPriorityTaskWoken )
+#endif
+
+#ifndef traceRETURN_xQueueSendMultipleFromISR
+    #define traceRETURN_xQueueSendMultipleFromISR( uxReturn )
+#endif
+
+#ifndef traceENTER_xQueueReceiveMultiple
+    #define traceENTER_xQueueReceiveMultiple( xQueue, pvBuffer, uxMaxItems, xTicksToWait )
+#endif
+
+#ifndef traceRETURN_xQueueReceiveMultiple
+    #define traceRETURN_xQueueReceiveMultiple( uxReturn )
+#endif
+
+#ifndef traceENTER_xQueueReceiveMultipleFromISR
+    #define traceENTER_xQueueReceiveMultipleFromISR( xQueue, pvBuffer, uxMaxItems, pxHigherPriorityTaskWoken )
+#endif
+
+#ifndef traceRETURN_xQueueReceiveMultipleFromISR
+    #define traceRETURN_xQueueReceiveMultipleFromISR( uxReturn )
+#endif
+
 #ifndef traceENTER_xQueuePeekFromISR
     #define traceENTER_xQueuePeekFromISR( xQueue, pvBuffer )
 #endif
@@ -2330,6 +2416,14 @@
     #define traceRETURN_pvTaskIncrementMutexHeldCount( pxTCB )
 #endif
 
+#ifndef traceENTER_xTaskDecrementMutexHeldCount
+    #define traceENTER_xTaskDecrementMutexHeldCount()
+#endif
+
+#ifndef traceRETURN_xTaskDecrementMutexHeldCount
+    #define traceRETURN_xTaskDecrementMutexHeldCount( xReturn )
+#endif
+
 #ifndef traceENTER_ulTaskGenericNotifyTake
     #define traceENTER_ulTaskGenericNotifyTake( uxIndexToWaitOn, xClearCountOnExit, xTicksToWait )
 #endif
@@ -2514,6 +2608,22 @@
     #define traceRETURN_xStreamBufferSendFromISR( xReturn )
 #endif
 
+#ifndef traceENTER_xStreamBufferSendFragments
+    #define traceENTER_xStreamBufferSendFragments( xStreamBuffer, pxFragments, xFragmentCount, xTicksToWait )
+#endif
+
+#ifndef traceRETURN_xStreamBufferSendFragments
+    #define traceRETURN_xStreamBufferSendFragments( xReturn )
+#endif
+
+#ifndef traceENTER_xStreamBufferSendFragmentsFromISR
+    #define traceENTER_xStreamBufferSendFragmentsFromISR( xStreamBuffer, pxFragments, xFragmentCount, pxHigherPriorityTaskWoken )
+#endif
+
+#ifndef traceRETURN_xStreamBufferSendFragmentsFromISR
+    #define traceRETURN_xStreamBufferSendFragmentsFromISR( xReturn )
+#endif
+
 #ifndef traceENTER_xStreamBufferReceive
     #define traceENTER_xStreamBufferReceive( xStreamBuffer, pvRxData, xBufferLengthBytes, xTicksToWait )
 #endif
@@ -2538,6 +2648,14 @@
     #define traceRETURN_xStreamBufferReceiveFromISR( xReceivedLength )
 #endif
 
+#ifndef traceENTER_xStreamBufferReceiveMessages
+    #define traceENTER_xStreamBufferReceiveMessages( xStreamBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, xMaxMessages, xTicksToWait )
+#endif
+
+#ifndef traceRETURN_xStreamBufferReceiveMessages
+    #define traceRETURN_xStreamBufferReceiveMessages( xMessages )
+#endif
+
 #ifndef traceENTER_xStreamBufferIsEmpty
     #define traceENTER_xStreamBufferIsEmpty( xStreamBuffer )
 #endif
@@ -2756,6 +2874,10 @@
     #define portDONT_DISCARD
 #endif
 
+#ifndef portNOINIT
+    #define portNOINIT
+#endif
+
 #ifndef configUSE_TIME_SLICING
     #define configUSE_TIME_SLICING    1
 #endif
@@ -2796,6 +2918,14 @@
     #define configAPPLICATION_ALLOCATED_HEAP    0
 #endif
 
+#ifndef configHEAP_FROM_LINKER_REGION
+    #define configHEAP_FROM_LINKER_REGION    0
+#endif
+
+#if ( ( configHEAP_FROM_LINKER_REGION == 1 ) && ( configAPPLICATION_ALLOCATED_HEAP == 1 ) )
+    #error configHEAP_FROM_LINKER_REGION and configAPPLICATION_ALLOCATED_HEAP cannot both be set to 1
+#endif
+
 #ifndef configENABLE_HEAP_PROTECTOR
     #define configENABLE_HEAP_PROTECTOR    0
 #endif
@@ -2906,6 +3036,14 @@
     #error configUSE_PORT_OPTIMISED_TASK_SELECTION is not supported in SMP FreeRTOS
 #endif
 
+#if ( ( configUSE_PARTITIONED_SCHEDULING == 1 ) && ( ( configNUMBER_OF_CORES == 1 ) || ( configUSE_CORE_AFFINITY == 0 ) ) )
+    #error configUSE_PARTITIONED_SCHEDULING needs SMP FreeRTOS with configUSE_CORE_AFFINITY set to 1
+#endif
+
+#if ( ( configUSE_PARTITIONED_SCHEDULING == 1 ) && ( configRUN_MULTIPLE_PRIORITIES == 0 ) )
+    #error configRUN_MULTIPLE_PRIORITIES must be set to 1 to use partitioned scheduling
+#endif
+
 #ifndef configINITIAL_TICK_COUNT
     #define configINITIAL_TICK_COUNT    0
 #endif
@@ -3161,6 +3299,70 @@ typedef struct xSTATIC_LIST
  * are set.  Its contents are somewhat obfuscated in the hope users will
  * recognise that it would be unwise to make direct use of the structure members.
  */
+#if ( configUSE_TCB_CACHE_LAYOUT == 1 )
+typedef struct xSTATIC_TCB
+{
+    void * pxDummy1;
+    #if ( portUSING_MPU_WRAPPERS == 1 )
+        xMPU_SETTINGS xDummy2;
+    #endif
+    StaticListItem_t xDummy3;
+    UBaseType_t uxDummy5;
+    void * pxDummy6;
+    StaticListItem_t xDummy4;
+    #if ( configNUMBER_OF_CORES > 1 )
+        BaseType_t xDummy23;
+        UBaseType_t uxDummy24;
+    #endif
+    #if ( configUSE_CORE_AFFINITY == 1 ) && ( configNUMBER_OF_CORES > 1 )
+        UBaseType_t uxDummy26;
+    #endif
+    #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+        BaseType_t xDummy27;
+    #endif
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        configRUN_TIME_COUNTER_TYPE ulDummy16;
+    #endif
+    #if ( configUSE_TASK_PREEMPTION_DISABLE == 1 )
+        BaseType_t xDummy25;
+    #endif
+    #if ( portCRITICAL_NESTING_IN_TCB == 1 )
+        UBaseType_t uxDummy9;
+    #endif
+    #if ( configUSE_MUTEXES == 1 )
+        UBaseType_t uxDummy12[ 2 ];
+    #endif
+    #if ( configUSE_TASK_NOTIFICATIONS == 1 )
+        uint32_t ulDummy18[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+        uint8_t ucDummy19[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+    #endif
+    #if ( INCLUDE_xTaskAbortDelay == 1 )
+        uint8_t ucDummy21;
+    #endif
+    #if ( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 )
+        uint8_t uxDummy20;
+    #endif
+    uint8_t ucDummy7[ configMAX_TASK_NAME_LEN ];
+    #if ( ( portSTACK_GROWTH > 0 ) || ( configRECORD_STACK_HIGH_ADDRESS == 1 ) )
+        void * pxDummy8;
+    #endif
+    #if ( configUSE_TRACE_FACILITY == 1 )
+        UBaseType_t uxDummy10[ 2 ];
+    #endif
+    #if ( configUSE_APPLICATION_TASK_TAG == 1 )
+        void * pxDummy14;
+    #endif
+    #if ( configNUM_THREAD_LOCAL_STORAGE_POINTERS > 0 )
+        void * pvDummy15[ configNUM_THREAD_LOCAL_STORAGE_POINTERS ];
+    #endif
+    #if ( configUSE_C_RUNTIME_TLS_SUPPORT == 1 )
+        configTLS_BLOCK_TYPE xDummy17;
+    #endif
+    #if ( configUSE_POSIX_ERRNO == 1 )
+        int iDummy22;
+    #endif
+} __attribute__( ( aligned( configTCB_CACHE_LINE_SIZE ) ) ) StaticTask_t;
+#else /* configUSE_TCB_CACHE_LAYOUT */
 typedef struct xSTATIC_TCB
 {
     void * pxDummy1;
@@ -3170,6 +3372,9 @@ typedef struct xSTATIC_TCB
     #if ( configUSE_CORE_AFFINITY == 1 ) && ( configNUMBER_OF_CORES > 1 )
         UBaseType_t uxDummy26;
     #endif
+    #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+        BaseType_t xDummy27;
+    #endif
     StaticListItem_t xDummy3[ 2 ];
     UBaseType_t uxDummy5;
     void * pxDummy6;
@@ -3220,6 +3425,7 @@ typedef struct xSTATIC_TCB
         int iDummy22;
     #endif
 } StaticTask_t;
+#endif /* configUSE_TCB_CACHE_LAYOUT */
 
 /*
  * In line with software engineering best practice, especially when supplying a
@@ -3261,6 +3467,10 @@ typedef struct xSTATIC_QUEUE
         UBaseType_t uxDummy8;
         uint8_t ucDummy9;
     #endif
+
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+        uint32_t ulDummy10;
+    #endif
 } StaticQueue_t;
 typedef StaticQueue_t StaticSemaphore_t;
 
@@ -3281,7 +3491,14 @@ typedef StaticQueue_t StaticSemaphore_t;
 typedef struct xSTATIC_EVENT_GROUP
 {
     TickType_t xDummy1;
-    StaticList_t xDummy2;
+    #if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+        StaticList_t xDummy2[ configEVENT_GROUP_WAIT_CLASSES ];
+        TickType_t xDummy5[ configEVENT_GROUP_WAIT_CLASSES ];
+        TickType_t xDummy6;
+        uint8_t ucDummy7;
+    #else
+        StaticList_t xDummy2;
+    #endif
 
     #if ( configUSE_TRACE_FACILITY == 1 )
         UBaseType_t uxDummy3;
@@ -1,23 +1,112 @@
 #ifndef FREERTOS_CONFIG_H
 #define FREERTOS_CONFIG_H
 
-#define configUSE_PREEMPTION			0
+/* The kernel and port options this tree adds - the timer and delay wheels,
+ * event group index, mutex fast path, heap pools, TCB layout, trace ring, CPSR
+ * critical sections, IRQ stats, lazy FPU switching and tickless idle - are off
+ * here, so make PROFILE=release builds the stock kernel.  The Makefile turns
+ * them on together (TUNED) for the other profiles. */
+
+#define configUSE_PREEMPTION			1
+
+/* Cores.  make PROFILE=smp builds for two; the VMM must then give the guest
+ * as many vCPUs.  Core 0 boots and runs main(), the others are started by
+ * xPortStartScheduler() (PSCI CPU_ON, or configSMP_SPIN_TABLE_ADDRESS if
+ * defined) and only run tasks.  Tasks may run on any core unless pinned with
+ * vTaskCoreAffinitySet(). */
+#ifndef configNUMBER_OF_CORES
+#define configNUMBER_OF_CORES			1
+#endif
+#if ( configNUMBER_OF_CORES > 1 )
+#define configRUN_MULTIPLE_PRIORITIES	1
+#define configUSE_CORE_AFFINITY			1
+#define configUSE_PASSIVE_IDLE_HOOK		1	/* The other cores sleep too - see idle.h */
+#define configYIELD_CORE_SGI_ID			15	/* Reserved for portYIELD_CORE() */
+#define configSETUP_CORE_INTERRUPTS( xCoreID )	vSetupCoreInterrupts( xCoreID )
+/* Partitioned (make PROFILE=smp_part): each core schedules only the tasks
+ * pinned to it, from its own ready lists, so a wakeup on one core never
+ * reorders or rescans the other's.  Affinities must name one core; tasks
+ * created without one go to core 0. */
+#ifndef configUSE_PARTITIONED_SCHEDULING
+#define configUSE_PARTITIONED_SCHEDULING	0
+#endif
+#endif
 #define configUSE_IDLE_HOOK				1
 #define configUSE_TICK_HOOK				0
 #define configCPU_CLOCK_HZ				( ( unsigned long ) 1000000000 )
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES			( 10 )
-#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 128 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 128 * 1024 ) )
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 192 )
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 128 * 1024 ) )	/* Minimum - see heap_region.c */
+#define configHEAP_FROM_LINKER_REGION	1
+
+/* TCB fields ordered so a switch or wakeup touches one 32 byte cache line on a
+ * single core, and TCBs and pool blocks aligned to cache lines - see tasks.c.
+ * make PROFILE=bench_legacy_tcb benchmarks the original layout. */
+#ifndef configUSE_TCB_CACHE_LAYOUT
+#define configUSE_TCB_CACHE_LAYOUT		0
+#endif
+#define configTCB_CACHE_LINE_SIZE		32
+#if configUSE_TCB_CACHE_LAYOUT
+#define configHEAP_POOL_ALIGNMENT		configTCB_CACHE_LINE_SIZE
+#endif
+
+/* Static profile (make PROFILE=static): every kernel object comes from
+ * statically allocated memory and no heap_*.c is linked.  Other profiles
+ * allow both, but create the demo tasks and the kernel's own tasks from
+ * static memory as well - see static_alloc.h. */
+#ifndef configSTATIC_PROFILE
+#define configSTATIC_PROFILE			0
+#endif
+#define configSUPPORT_STATIC_ALLOCATION	1
+#if configSTATIC_PROFILE
+#define configSUPPORT_DYNAMIC_ALLOCATION	0
+#else
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+#endif
+
+/* heap_pool.c size classes in bytes, ascending: small kernel objects (timers,
+ * event groups, queues, TCBs) and task stacks of 1, 2 and 4 times
+ * configMINIMAL_STACK_SIZE.  Larger requests go straight to heap_4.  The
+ * Makefile links heap_pool.c when this is on, and heap_4.c alone when not. */
+#ifndef configUSE_HEAP_POOLS
+#define configUSE_HEAP_POOLS			0
+#endif
+#define configHEAP_POOL_CLASS_COUNT		6
+#define configHEAP_POOL_SIZES			{ 64, 128, 256,										\
+										  configMINIMAL_STACK_SIZE * sizeof( StackType_t ),		\
+										  configMINIMAL_STACK_SIZE * sizeof( StackType_t ) * 2,	\
+										  configMINIMAL_STACK_SIZE * sizeof( StackType_t ) * 4 }
+
+/* Allocation profiler (make PROFILE=debug): heap_4 records the caller, count
+ * and bytes in use of every allocation site, request sizes, malloc and free
+ * times, and on vPortHeapProfileSnapshot() a map of the free list by block
+ * size, in xHeapProfile at 0x40FE0000 for the host to read - see portable.h.
+ * Adds 8 bytes to every heap_4 block header. */
+#ifndef configUSE_HEAP_PROFILER
+#define configUSE_HEAP_PROFILER			0
+#endif
+#define configHEAP_PROFILER_SITES		64
+
 #define configMAX_TASK_NAME_LEN			( 10 )
 #define configUSE_TRACE_FACILITY		1
+/* Kernel events are recorded as binary records in a RAM ring per core, for the
+ * host to read out of guest memory - see trace_ring.h. */
+#ifndef configUSE_TRACE_RING
+#define configUSE_TRACE_RING			0
+#endif
+#define configGENERATE_RUN_TIME_STATS	1
+#define configRUN_TIME_COUNTER_TYPE		uint64_t
+#define configUSE_STATS_FORMATTING_FUNCTIONS	0	/* No snprintf - see task_stats.c */
 #define configUSE_16_BIT_TICKS			0
 #define configIDLE_SHOULD_YIELD			1
 #define configUSE_MUTEXES				1
 #define configUSE_RECURSIVE_MUTEXES		1
 #define configUSE_COUNTING_SEMAPHORES	1
 #define configUSE_ALTERNATIVE_API		0
-#define configCHECK_FOR_STACK_OVERFLOW	0
+/* 2: compare the 16 byte canary at the bottom of the outgoing task's stack at
+ * every switch.  Guard pages and high-water tracking - see stack_guard.h. */
+#define configCHECK_FOR_STACK_OVERFLOW	2
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configQUEUE_REGISTRY_SIZE		8
 
@@ -29,6 +118,44 @@
 #define configTIMER_QUEUE_LENGTH		5
 #define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
 
+/* Active timers are kept in a hierarchical timer wheel rather than sorted lists,
+ * and tasks start, reset, stop and change timers without going through the timer
+ * queue - see timers.c.  Periods are limited to half the tick range. */
+#ifndef configUSE_TIMER_WHEEL
+#define configUSE_TIMER_WHEEL			0
+#endif
+
+/* Tasks delayed by less than configDELAY_WHEEL_SLOTS ticks are kept in a wheel
+ * of unsorted per-tick slots instead of the sorted delayed list, so a periodic
+ * task blocks and wakes in constant time - see tasks.c.  Longer delays still
+ * use the list. */
+#ifndef configUSE_DELAY_WHEEL
+#define configUSE_DELAY_WHEEL			0
+#endif
+#define configDELAY_WHEEL_SLOTS			64
+
+/* Tasks waiting on an event group are kept on one list per distinct wait
+ * condition, so setting bits tests each condition once and releases all its
+ * tasks together, and xEventGroupSetBitsFromISR() does so without the timer
+ * task - see event_groups.h.  Waiters beyond configEVENT_GROUP_WAIT_CLASSES - 1
+ * conditions share a list that is tested task by task.  Tasks set bits with
+ * the scheduler suspended; only xEventGroupSetBitsFromISR() masks interrupts
+ * for the pass, for one test per list plus one per task on the shared list and
+ * one list move per task released. */
+#ifndef configUSE_EVENT_GROUP_WAITER_INDEX
+#define configUSE_EVENT_GROUP_WAITER_INDEX	0
+#endif
+#define configEVENT_GROUP_WAIT_CLASSES	4
+
+/* An uncontended xSemaphoreTake()/xSemaphoreGive() on a mutex is one LDREX/STREX
+ * compare and swap, with no critical section; the first task to contend moves
+ * the mutex back to the queue code and priority inheritance until it is free
+ * again.  Recursive mutexes, and mutexes in queue sets, always use the queue
+ * code. */
+#ifndef configUSE_MUTEX_FAST_PATH
+#define configUSE_MUTEX_FAST_PATH		0
+#endif
+
 #define INCLUDE_vTaskPrioritySet		1
 #define INCLUDE_uxTaskPriorityGet		1
 #define INCLUDE_vTaskDelete				1
@@ -36,29 +163,124 @@
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetSchedulerState	1
+#define INCLUDE_xTaskAbortDelay			1
 
 #define configASSERT( x ) if( ( x ) == 0 ) vAssertCalled( __LINE__, __FILE__ )
 
+/* Port diagnostics on the UART while the scheduler starts: 0 none, 1 the GIC
+ * and CPU mode checks, 2 also every initial task stack and the first task's
+ * context.  The debug build (make PROFILE=debug) uses 2.  The same checks are
+ * recorded in the boot report either way - see portmacro.h. */
+#ifndef configPORT_DEBUG_LEVEL
+#define configPORT_DEBUG_LEVEL			0
+#endif
+
 /* Port specific definitions. */
 #define configUNIQUE_INTERRUPT_PRIORITIES		256
+#if ( configNUMBER_OF_CORES > 1 )
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	0	/* Not supported by the SMP scheduler */
+#else
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+#endif
+/* Tickless idle on the virtual timer - see tick_timer.c.  Single core only, as
+ * the tick timer is core 0's alone. */
+#ifndef configUSE_TICKLESS_IDLE
 #define configUSE_TICKLESS_IDLE					0
+#endif
 #define portTICK_TYPE_IS_ATOMIC					1
+/* The tickless sleep is counted in the idle residency - see idle.h. */
+#define configPRE_SLEEP_PROCESSING( x )			idle_sleep_enter()
+#define configPOST_SLEEP_PROCESSING( x )		idle_sleep_exit()
 
 /* seL4 VM Virtual GIC CPU Interface address */
 #define configINTERRUPT_CONTROLLER_BASE_ADDRESS	0x08040000
 #define configINTERRUPT_CONTROLLER_CPU_INTERFACE_OFFSET	0x0
 #define configMAX_API_CALL_INTERRUPT_PRIORITY	200
 
-/* Minimal FPU support */
-#define configUSE_TASK_FPU_SUPPORT	1
+/* vGIC distributor emulated by the VMM (intc@8000000 in virt_custom.dtb) */
+#define configINTERRUPT_CONTROLLER_DISTRIBUTOR_ADDRESS	0x08000000
+
+/* Critical sections mask with the CPSR I bit: the vGIC priority mask register is
+ * emulated, so each write is a VM exit.  No interrupt here is above
+ * configMAX_API_CALL_INTERRUPT_PRIORITY, so nothing loses by it; a build with
+ * one leaves this off.  With configUSE_NESTED_INTERRUPTS the FromISR masks and
+ * the tick handler keep the priority mask - see portmacro.h.  Also used from
+ * portASM.S. */
+#ifndef configUSE_CPSR_CRITICAL_SECTIONS
+#define configUSE_CPSR_CRITICAL_SECTIONS	0
+#endif
+
+/* Paravirtual interface to the seL4 VMM: HVC calls that take the GIC priority
+ * bits, the idle vCPU yield with its wake deadline, and seL4 notifications, in
+ * place of the emulated vGIC probe and the trapped WFI - see sel4_pv.h.  Off
+ * by default, as the VMM must implement the calls; with it on, a VMM that does
+ * not answers the probe as not supported and the emulated paths are kept. */
+#ifndef configUSE_SEL4_PARAVIRT
+#define configUSE_SEL4_PARAVIRT			0
+#endif
+
+/* Interrupt handlers re-enable IRQs in the CPU, so an interrupt of higher GIC
+ * priority can preempt a running handler.  Off by default: handlers then run
+ * to completion one at a time. */
+#ifndef configUSE_NESTED_INTERRUPTS
+#define configUSE_NESTED_INTERRUPTS		0
+#endif
 
-/* vexpress-a9 timer */
+/* Per interrupt ID nesting depth, handler time and ICCIAR-to-EOI time, in run
+ * time counter units - see irq_dispatch.h. */
+#ifndef configUSE_IRQ_STATS
+#define configUSE_IRQ_STATS				0
+#endif
+
+/* Snapshot boot (make SNAPSHOT=1): the image carries the zeroed BSS and the
+ * painted boot stacks, so startup.S goes from mmu_init() straight to main()
+ * without writing either.  Only for a VMM that loads the whole image into RAM
+ * again for every boot, restarts included. */
+#ifndef configBOOT_SNAPSHOT
+#define configBOOT_SNAPSHOT				0
+#endif
+
+/* Interrupt handlers run on their core's SVC mode stack, which main() also
+ * uses before the scheduler starts: ( 1 << configISR_STACK_SHIFT ) bytes per
+ * core.  IRQ mode itself only keeps 8 bytes per nesting level.  irq_stack_unused()
+ * reports the measured worst case.  Also used from startup.S. */
+#ifndef configISR_STACK_SHIFT
+#define configISR_STACK_SHIFT			13
+#endif
+
+/* Every task has an FPU context.  With configUSE_LAZY_FPU_CONTEXT it is
+ * switched lazily on first use - see the undefined instruction handler in
+ * portASM.S - and the save area is kept at the top of each task's stack, hence
+ * the larger minimal stack.  Single core only: with more than one core a task's
+ * registers could be left behind in another core's FPU, so the SMP build saves
+ * them on every switch. */
+#define configUSE_TASK_FPU_SUPPORT		2
+#ifndef configUSE_LAZY_FPU_CONTEXT
+#define configUSE_LAZY_FPU_CONTEXT		0
+#endif
+#define configRECORD_STACK_HIGH_ADDRESS	1
+
+/* Tick from the ARMv7 virtual generic timer, see tick_timer.c */
 #define configSETUP_TICK_INTERRUPT()	vSetupTickInterrupt()
-#define configCLEAR_TICK_INTERRUPT()	/* Not needed */
+#define configCLEAR_TICK_INTERRUPT()	vClearTickInterrupt()
 
+/* This file is also included from assembly (rt_string.S). */
+#ifndef __ASSEMBLER__
 void vSetupTickInterrupt(void);
+void vClearTickInterrupt(void);
+void idle_sleep_enter(void);
+void idle_sleep_exit(void);
+#if ( configNUMBER_OF_CORES > 1 )
+void vSetupCoreInterrupts(long xCoreID);	/* BaseType_t is not defined yet */
+#endif
 
 extern void vAssertCalled( unsigned long ulLine, const char * const pcFileName );
 
+/* Defines the kernel's trace macros, so must come last. */
+#if ( configUSE_TRACE_RING == 1 )
+#include "trace_ring.h"
+#endif
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
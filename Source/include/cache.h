@@ -0,0 +1,30 @@
+/*
+ * Data cache maintenance for memory shared with other bus masters (DMA
+ * engines, the VMM or a host-side memory analyzer).
+ *
+ * The RAM window is write-back cached (see mmu.h).  Before another master
+ * reads a buffer the CPU wrote, clean it; before the CPU reads a buffer another
+ * master wrote, invalidate it.  All ranges are rounded out to cache lines, so
+ * buffers used for DMA into the CPU should be line aligned and padded: the
+ * partial lines at either end of an invalidate are cleaned first instead of
+ * being discarded.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest data cache line on ARMv7 cores we run on; use for aligning buffers.
+#define CACHE_LINE_MAX  64
+
+void cache_clean_range(const volatile void *addr, size_t len);
+void cache_invalidate_range(volatile void *addr, size_t len);
+void cache_clean_invalidate_range(const volatile void *addr, size_t len);
+
+// Invalidate every data/unified cache level up to the point of coherency by
+// set/way, discarding their contents.  Boot only, with the caches off.
+void cache_invalidate_dcache_all(void);
+
+#endif // CACHE_H
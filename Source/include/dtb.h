@@ -0,0 +1,23 @@
+/*
+ * Minimal reader for the flattened device tree the VMM hands the guest.
+ *
+ * The VMM boots the guest like a Linux kernel, with the DTB address in r2;
+ * startup.S saves it in dtb_boot_address before anything else can clobber it.
+ * virt_custom.dtb in Build/ is the tree used with the seL4 VM.
+ */
+
+#ifndef DTB_H
+#define DTB_H
+
+#include <stdint.h>
+
+// Start of guest RAM; a DTB pointer below it is not trusted.
+#define DTB_GUEST_RAM_BASE  0x40000000UL
+
+extern uintptr_t dtb_boot_address;
+
+// Base and size of the first /memory node's first reg entry.  Returns 0 on
+// success, -1 if there is no valid DTB or no usable memory node.
+int dtb_memory_range(uint64_t *base, uint64_t *size);
+
+#endif // DTB_H
@@ -551,6 +551,14 @@ EventBits_t xEventGroupSetBits( EventGroupHandle_t xEventGroup,
  * context of the timer task - where a scheduler lock is used in place of a
  * critical section.
  *
+ * With configUSE_EVENT_GROUP_WAITER_INDEX set to 1 the bits are set, and the
+ * waiting tasks unblocked, directly from the interrupt instead, without the
+ * timer task.  Tasks waiting on the event group are grouped by their wait
+ * condition, so each distinct condition is tested once and the tasks waiting
+ * on it are moved to the ready lists in one batch.  If a task is
+ * part way through an event group call the bits are held in the event group
+ * and set by that task when it finishes.  pdPASS is always returned.
+ *
  * @param xEventGroup The event group in which the bits are to be set.
  *
  * @param uxBitsToSet A bitwise value that indicates the bit or bits to set.
@@ -607,7 +615,7 @@ EventBits_t xEventGroupSetBits( EventGroupHandle_t xEventGroup,
  * \defgroup xEventGroupSetBitsFromISR xEventGroupSetBitsFromISR
  * \ingroup EventGroup
  */
-#if ( configUSE_TRACE_FACILITY == 1 )
+#if ( ( configUSE_TRACE_FACILITY == 1 ) || ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 ) )
     BaseType_t xEventGroupSetBitsFromISR( EventGroupHandle_t xEventGroup,
                                           const EventBits_t uxBitsToSet,
                                           BaseType_t * pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
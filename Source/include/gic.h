@@ -0,0 +1,51 @@
+/*
+ * Minimal GICv2 distributor / CPU interface helpers for the seL4 vGIC.
+ *
+ * The CPU interface is the one the port already uses for ICCIAR/ICCEOIR/ICCPMR
+ * (configINTERRUPT_CONTROLLER_BASE_ADDRESS); the distributor is emulated by the
+ * VMM at configINTERRUPT_CONTROLLER_DISTRIBUTOR_ADDRESS.
+ */
+
+#ifndef GIC_H
+#define GIC_H
+
+#include <stdint.h>
+
+// Distributor register offsets
+#define GICD_CTLR           0x000
+#define GICD_ISENABLER      0x100
+#define GICD_ICENABLER      0x180
+#define GICD_ICPENDR        0x280
+#define GICD_IPRIORITYR     0x400
+#define GICD_ITARGETSR      0x800
+#define GICD_ICFGR          0xC00
+#define GICD_SGIR           0xF00
+
+// CPU interface register offsets
+#define GICC_CTLR           0x00
+#define GICC_BPR            0x08
+
+// Interrupt ID ranges
+#define GIC_SGI_COUNT       16
+#define GIC_PPI_BASE        16
+#define GIC_SPI_BASE        32
+#define GIC_SPURIOUS_ID     1023
+#define GIC_INTID_MASK      0x3FF
+
+void gic_init(void);
+
+// Per-CPU half of gic_init(), for each secondary core in an SMP build.
+void gic_init_cpu(void);
+
+void gic_set_priority(uint32_t id, uint32_t priority);
+void gic_set_target(uint32_t id, uint32_t cpu_mask);
+void gic_enable_irq(uint32_t id);
+void gic_disable_irq(uint32_t id);
+
+// Raise software generated interrupt 'id' (0-15) on this CPU.
+void gic_send_sgi(uint32_t id);
+
+// Called by the IRQ dispatcher for SGIs.  Weak no-op by default.
+void vApplicationSGIHandler(uint32_t id);
+
+#endif // GIC_H
@@ -0,0 +1,62 @@
+/*
+ * Idle strategy: background work, then WFI.
+ *
+ * The idle hook of every core - vApplicationIdleHook(), and with more than
+ * one core vApplicationPassiveIdleHook() on the others - calls idle_wait(),
+ * which runs the registered background work (cheap, bounded steps such as
+ * stack_watch_step()) and then waits for an interrupt with WFI.  The seL4 VMM traps WFI and blocks the vCPU until an
+ * interrupt is due for it, so an idle guest costs the host next to nothing
+ * instead of a spinning vCPU.  Anything that readies a task interrupts the
+ * WFI: a device or tick interrupt on this core, or with more than one core
+ * the yield SGI from the core that readied it.
+ *
+ * With configUSE_TICKLESS_IDLE idle_wait() only runs the background work.
+ * The idle task sleeps next in vPortSuppressTicksAndSleep() (tick_timer.c),
+ * which brackets its own WFI with configPRE_SLEEP_PROCESSING /
+ * configPOST_SLEEP_PROCESSING, i.e. idle_sleep_enter() / idle_sleep_exit().
+ * A WFI in the hook would wake on the next tick and keep that tick from ever
+ * being suppressed.  Idle periods shorter than
+ * configEXPECTED_IDLE_TIME_BEFORE_SLEEP are not slept through.
+ *
+ * With configUSE_SEL4_PARAVIRT both sleeps go through sel4_pv_wait() instead,
+ * which yields the vCPU with a hypercall that carries the wake deadline - the
+ * next tick here, the end of the tickless period there - rather than leaving
+ * the VMM to decode a trapped WFI.
+ *
+ * Every sleep is timed with the generic timer's virtual counter, which keeps
+ * counting while the core sleeps (the PMU cycle counter run time stats are
+ * based on does not), for each core's idle residency.
+ */
+
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <stdint.h>
+
+typedef void (*idle_work_t)(void);
+
+// Background work functions, run in order on every idle_wait()
+#define IDLE_WORK_MAX   4
+
+// Run 'work' from the idle task of every core before it sleeps.  It must not
+// block, and should return within a few microseconds: a task readied meanwhile
+// waits for it.  Returns -1 if the table is full.  Before the scheduler starts.
+int idle_add_work(idle_work_t work);
+
+// Run the background work, then sleep until an interrupt unless the kernel
+// sleeps instead (configUSE_TICKLESS_IDLE).  Idle hooks.
+void idle_wait(void);
+
+// Bracket a WFI with interrupts masked: the counter is sampled on both sides.
+void idle_sleep_enter(void);
+void idle_sleep_exit(void);
+
+typedef struct {
+    uint64_t asleep;    // Virtual counter ticks spent in WFI
+    uint32_t wakeups;
+} idle_stats_t;
+
+// Idle residency of core 'core' since boot.  Returns -1 if out of range.
+int idle_stats_get(uint32_t core, idle_stats_t *stats);
+
+#endif // IDLE_H
@@ -0,0 +1,93 @@
+/*
+ * Device interrupt dispatch, by the interrupt ID read from ICCIAR.
+ *
+ * irq_register() installs a handler for an interrupt, sets its priority and
+ * enables it.  By default the handler runs after portASM.S has saved the
+ * caller-saved VFP registers (d0-d7, d16-d31 and FPSCR), like any handler
+ * called from vApplicationFPUSafeIRQHandler().  With IRQ_FLAG_NO_FPU it is
+ * called straight from vApplicationIRQHandler() instead, which saves about 50
+ * words of stores and loads per interrupt; the handler, and everything it
+ * calls, must then leave the VFP registers alone - no floating point, and no
+ * memcpy/memset (rt_string.S may use NEON).  The kernel's FromISR functions
+ * are fine.
+ *
+ * irq_bind_notify() is the shortest path from a device to its driver task:
+ * the interrupt is forwarded with vTaskNotifyGiveFromISR() to the bound task,
+ * which waits with ulTaskNotifyTake(), without the VFP save.  A level
+ * triggered device keeps its line asserted until the driver has serviced it,
+ * so bind it with IRQ_FLAG_ONESHOT: the interrupt is then disabled in the
+ * distributor when it fires, and the task calls irq_unmask() when done.
+ *
+ * The tick, the UART and (SMP) the yield SGI are built in.  Interrupts with no
+ * entry go to spsc_ring.c's doorbells, then vApplicationSGIHandler() for SGIs;
+ * anything else left is disabled.
+ *
+ * With configUSE_NESTED_INTERRUPTS a handler runs with IRQs enabled in the
+ * CPU, so interrupts of a higher GIC priority preempt it; the GIC holds off
+ * those of the same or lower priority until the EOI.  All levels share the
+ * core's SVC stack, so it must hold one handler frame per preemption level in
+ * use, plus main()'s frames from before the scheduler started.
+ * irq_stack_unused() reports how much of it was never touched.
+ *
+ * With configUSE_IRQ_STATS each core keeps, per interrupt ID, the number of
+ * runs, the deepest nesting level it ran at (1 = not nested), the longest
+ * handler call and the longest time from the ICCIAR read to the EOI.  Both
+ * times are in run time counter units, ulPortGetRunTimeCounterFrequency() per
+ * second, and include any interrupts that preempted the handler.  They are
+ * taken in vApplicationIRQHandler(), a few instructions after the ICCIAR read
+ * and before the EOI write in portASM.S.
+ */
+
+#ifndef IRQ_DISPATCH_H
+#define IRQ_DISPATCH_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Interrupt IDs 0 .. IRQ_TABLE_SIZE - 1 can have an entry: the SGIs, PPIs
+// and the first 96 SPIs.
+#define IRQ_TABLE_SIZE      128
+
+// irq_register() / irq_bind_notify() flags
+#define IRQ_FLAG_NO_FPU     (1UL << 0)  // Call without saving the VFP registers
+#define IRQ_FLAG_ONESHOT    (1UL << 1)  // irq_bind_notify(): disable until irq_unmask()
+
+typedef void (*irq_handler_t)(uint32_t id, void *arg);
+
+// Call 'handler' with 'arg' whenever interrupt 'id' fires.  'priority' is a
+// GIC priority value; handlers that use the FreeRTOS API need one numerically
+// at or above configMAX_API_CALL_INTERRUPT_PRIORITY, as do all handlers with
+// configUSE_CPSR_CRITICAL_SECTIONS (asserted).  SPIs are routed to core 0.
+// Returns -1 if 'id' is out of range or already registered.
+int irq_register(uint32_t id, irq_handler_t handler, void *arg, uint32_t priority, uint32_t flags);
+
+// Register interrupt 'id' to give 'task' a notification.  'flags' may add
+// IRQ_FLAG_ONESHOT; IRQ_FLAG_NO_FPU is implied.
+int irq_bind_notify(uint32_t id, TaskHandle_t task, uint32_t priority, uint32_t flags);
+
+// Disable interrupt 'id' and remove its entry.
+void irq_unregister(uint32_t id);
+
+// Re-enable an IRQ_FLAG_ONESHOT interrupt, from its driver task.
+void irq_unmask(uint32_t id);
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_nesting;
+    uint32_t max_handler;       // Run time counter units
+    uint32_t max_ack_to_eoi;
+} irq_stats_t;
+
+// Statistics of interrupt 'id', combined over all cores.  Returns -1 if 'id'
+// is out of range or configUSE_IRQ_STATS is 0.
+int irq_stats_get(uint32_t id, irq_stats_t *stats);
+
+// Start the statistics over.  Task context.
+void irq_stats_reset(void);
+
+// Bytes at the bottom of core 'core's SVC stack that have never been written.
+uint32_t irq_stack_unused(uint32_t core);
+
+#endif // IRQ_DISPATCH_H
@@ -0,0 +1,92 @@
+/*
+ * Deferred, non-blocking logging.
+ *
+ * LOG_ERROR() .. LOG_DEBUG() take a printf-style format and up to
+ * LOG_MAX_ARGS arguments, but do no formatting: the call site only stores
+ * the format pointer, the raw argument words and the tick count in a
+ * lock-free queue entry, which takes a few hundred cycles from any task or
+ * ISR on any core.  A low-priority logger task formats the entries and
+ * writes them to the UART later, one line each, prefixed with the tick and
+ * the level.  When the queue is full the message is dropped and counted;
+ * the logger reports the count.
+ *
+ * Because formatting is deferred:
+ *  - every argument must fit in 32 bits (integers, chars, pointers - no
+ *    64-bit integers or doubles), and
+ *  - %s strings must stay valid until the logger gets to them, so pass
+ *    string literals or other static strings only.
+ *
+ * The formatter handles %d %i %u %x %X %p %s %c and %%, with optional '-'
+ * and '0' flags, a field width and an ignored 'l' modifier.
+ *
+ * Levels above LOG_COMPILE_LEVEL compile out entirely, arguments included.
+ * log_set_level() filters further at run time.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOG_LEVEL_ERROR     0
+#define LOG_LEVEL_WARN      1
+#define LOG_LEVEL_INFO      2
+#define LOG_LEVEL_DEBUG     3
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL   LOG_LEVEL_INFO
+#endif
+
+#define LOG_MAX_ARGS        6
+#define LOG_QUEUE_ENTRIES   64      // A power of two
+#define LOG_LINE_MAX        128     // Formatted line, longer lines are cut
+
+// Logger task.  It drains the queue every LOG_FLUSH_MS.
+#define LOG_TASK_PRIORITY   ( tskIDLE_PRIORITY + 1 )
+#define LOG_TASK_STACK_DEPTH    ( configMINIMAL_STACK_SIZE * 2 )
+#define LOG_FLUSH_MS        20
+
+// Argument count of a call site, 0 to 8; more than LOG_MAX_ARGS is a
+// compile error.
+#define LOG_NARGS(...)      LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...)  n
+
+#define LOG_AT(level, fmt, ...)                                                     \
+    do {                                                                            \
+        if ((level) <= LOG_COMPILE_LEVEL) {                                         \
+            (void)sizeof(char[(LOG_NARGS(__VA_ARGS__) <= LOG_MAX_ARGS) ? 1 : -1]);  \
+            log_write((level), (fmt), LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__);       \
+        }                                                                           \
+    } while (0)
+
+#define LOG_ERROR(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+// Create the logger task.  Call once from main() before the scheduler
+// starts; messages logged before then are kept until it runs.
+void log_init(void);
+
+// Queue one message; 'nargs' 32-bit arguments follow.  Any context.  Use the
+// LOG_* macros rather than calling this directly.
+void log_write(uint32_t level, const char *fmt, uint32_t nargs, ...);
+
+// Drop messages above 'level' at run time.
+void log_set_level(uint32_t level);
+
+// Messages dropped because the queue was full, since boot.
+uint32_t log_dropped(void);
+
+// Format everything still queued and write it out from the calling context.
+// For fatal paths, after uart_enter_polled_mode().
+void log_flush(void);
+
+// Format into 'buf' (always terminated), taking the arguments from an array
+// or a va_list.  Missing array arguments print as 0.  Return the length.
+size_t log_format(char *buf, size_t size, const char *fmt, const uint32_t *args, uint32_t nargs);
+size_t log_vformat(char *buf, size_t size, const char *fmt, va_list ap);
+
+#endif // LOG_H
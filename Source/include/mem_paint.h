@@ -0,0 +1,83 @@
+/*
+ * Memory pattern painting and verification engine, for memory forensics of
+ * the guest (QEMU monitor / host-side memory analyzer dumps).
+ *
+ * A job paints, verifies, or paints and verifies in one fused pass, a word
+ * range with one of a few patterns.  Work is done in small blocks with no
+ * per-word bookkeeping; the fixed pattern goes through rt_memset32 (8-register
+ * STM bursts, or NEON with RT_STRING_USE_NEON).  A job can be advanced a slice
+ * at a time with mem_paint_step(), or run to completion with progress reported
+ * every MEM_PAINT_PROGRESS_WORDS by mem_paint_run().
+ *
+ * In the fused mode each block is read back right after it is written, while
+ * it is still in the data cache: this checks the address mapping, not the
+ * DRAM cells.  Use MEM_PAINT_WRITE followed by MEM_PAINT_VERIFY for that.
+ */
+
+#ifndef MEM_PAINT_H
+#define MEM_PAINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Words per inner block; a fused block is read back from L1.
+#define MEM_PAINT_BLOCK_WORDS       64
+
+// mem_paint_run() progress callback interval (256 KB)
+#define MEM_PAINT_PROGRESS_WORDS    (64 * 1024)
+
+// Mismatches recorded in detail per job; all of them are counted.
+#define MEM_PAINT_MAX_MISMATCHES    8
+
+typedef enum {
+    MEM_PATTERN_FIXED,          // seed in every word
+    MEM_PATTERN_ADDRESS,        // each word's own address XOR seed
+    MEM_PATTERN_WALKING_ONES,   // one set bit, moving up a bit per word, seed = start bit
+    MEM_PATTERN_LFSR,           // 32-bit Galois LFSR sequence from seed (0 is replaced)
+} mem_pattern_kind_t;
+
+typedef enum {
+    MEM_PAINT_WRITE,
+    MEM_PAINT_VERIFY,
+    MEM_PAINT_WRITE_VERIFY,
+} mem_paint_mode_t;
+
+typedef struct {
+    uint32_t *addr;
+    uint32_t expected;
+    uint32_t actual;
+} mem_paint_mismatch_t;
+
+typedef struct {
+    uint32_t *base;
+    size_t words;
+    size_t done;                // Words processed so far
+    mem_pattern_kind_t kind;
+    mem_paint_mode_t mode;
+    uint32_t seed;
+    uint32_t state;             // Generator state at 'done'
+    uint32_t mismatch_count;
+    mem_paint_mismatch_t mismatches[MEM_PAINT_MAX_MISMATCHES];
+} mem_paint_job_t;
+
+typedef void (*mem_paint_progress_fn)(const mem_paint_job_t *job, void *arg);
+
+// Set up a job over 'words' words at 'base' (word aligned).
+void mem_paint_begin(mem_paint_job_t *job, uint32_t *base, size_t words,
+                     mem_pattern_kind_t kind, uint32_t seed, mem_paint_mode_t mode);
+
+// Process up to 'max_words' more words.  Returns the number processed, 0 once
+// the job is complete.
+size_t mem_paint_step(mem_paint_job_t *job, size_t max_words);
+
+// Run the job to completion.  'progress' (may be NULL) is called every
+// MEM_PAINT_PROGRESS_WORDS and at the end.  Returns the mismatch count.
+uint32_t mem_paint_run(mem_paint_job_t *job, mem_paint_progress_fn progress, void *arg);
+
+// The value the pattern puts at word 'index' of the job - for spot checks of
+// a dump.  O(index) for MEM_PATTERN_LFSR.
+uint32_t mem_paint_expected(const mem_paint_job_t *job, size_t index);
+
+const char *mem_pattern_name(mem_pattern_kind_t kind);
+
+#endif // MEM_PAINT_H
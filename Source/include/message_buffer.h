@@ -85,6 +85,11 @@
  */
 typedef StreamBufferHandle_t MessageBufferHandle_t;
 
+/**
+ * One piece of a message passed to xMessageBufferSendFragments().
+ */
+typedef StreamBufferFragment_t MessageBufferFragment_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -692,6 +697,199 @@ typedef StreamBufferHandle_t MessageBufferHandle_t;
 #define xMessageBufferReceiveFromISR( xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken ) \
     xStreamBufferReceiveFromISR( ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( pxHigherPriorityTaskWoken ) )
 
+/**
+ * message_buffer.h
+ *
+ * @code{c}
+ * size_t xMessageBufferSendFragments( MessageBufferHandle_t xMessageBuffer,
+ *                                     const MessageBufferFragment_t *pxFragments,
+ *                                     size_t xFragmentCount,
+ *                                     TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Sends one message gathered from several fragments - a scatter/gather
+ * xMessageBufferSend().  The fragments are copied back to back into the
+ * message buffer after a single length, so the receiver sees one message of
+ * their total length, and is notified once.  The message is sent whole or not
+ * at all, blocking for space as xMessageBufferSend() does.
+ *
+ * The same single writer rules as xMessageBufferSend() apply.
+ *
+ * configUSE_STREAM_BUFFERS must be set to 1 in for FreeRTOSConfig.h for
+ * xMessageBufferSendFragments() to be available.
+ *
+ * @param xMessageBuffer The handle of the message buffer to which a message is
+ * being sent.
+ *
+ * @param pxFragments The fragments of the message, in order.  A fragment with
+ * an xLength of 0 is skipped.
+ *
+ * @param xFragmentCount The number of entries in pxFragments.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should
+ * remain in the Blocked state to wait for enough space to become available in
+ * the message buffer.
+ *
+ * @return The number of bytes of the message written, which is the total
+ * length of the fragments, or 0 if the message could not be sent.
+ *
+ * Example use:
+ * @code{c}
+ * void vSendRecord( MessageBufferHandle_t xMessageBuffer,
+ *                   const RecordHeader_t *pxHeader,
+ *                   const uint8_t *pucPayload,
+ *                   size_t xPayloadLength )
+ * {
+ * MessageBufferFragment_t xFragments[ 2 ];
+ *
+ *  xFragments[ 0 ].pvData = pxHeader;
+ *  xFragments[ 0 ].xLength = sizeof( *pxHeader );
+ *  xFragments[ 1 ].pvData = pucPayload;
+ *  xFragments[ 1 ].xLength = xPayloadLength;
+ *
+ *  ( void ) xMessageBufferSendFragments( xMessageBuffer, xFragments, 2, 0 );
+ * }
+ * @endcode
+ * \defgroup xMessageBufferSendFragments xMessageBufferSendFragments
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSendFragments( xMessageBuffer, pxFragments, xFragmentCount, xTicksToWait ) \
+    xStreamBufferSendFragments( ( xMessageBuffer ), ( pxFragments ), ( xFragmentCount ), ( xTicksToWait ) )
+
+/**
+ * message_buffer.h
+ *
+ * @code{c}
+ * size_t xMessageBufferSendFragmentsFromISR( MessageBufferHandle_t xMessageBuffer,
+ *                                            const MessageBufferFragment_t *pxFragments,
+ *                                            size_t xFragmentCount,
+ *                                            BaseType_t *pxHigherPriorityTaskWoken );
+ * @endcode
+ *
+ * The interrupt safe version of xMessageBufferSendFragments().  The message is
+ * sent only if there is space for all of it now.
+ *
+ * @param pxHigherPriorityTaskWoken As for xMessageBufferSendFromISR().
+ *
+ * @return The number of bytes of the message written, or 0 if there was not
+ * enough space.
+ *
+ * \defgroup xMessageBufferSendFragmentsFromISR xMessageBufferSendFragmentsFromISR
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSendFragmentsFromISR( xMessageBuffer, pxFragments, xFragmentCount, pxHigherPriorityTaskWoken ) \
+    xStreamBufferSendFragmentsFromISR( ( xMessageBuffer ), ( pxFragments ), ( xFragmentCount ), ( pxHigherPriorityTaskWoken ) )
+
+/**
+ * message_buffer.h
+ *
+ * @code{c}
+ * size_t xMessageBufferReceiveMany( MessageBufferHandle_t xMessageBuffer,
+ *                                   void *pvRxData,
+ *                                   size_t xBufferLengthBytes,
+ *                                   size_t *pxMessageLengths,
+ *                                   size_t xMaxMessages,
+ *                                   TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Drains several messages from a message buffer in one call.  The messages
+ * are copied into pvRxData back to back, without their length headers, and
+ * their lengths are written to pxMessageLengths in the same order.  Messages
+ * are taken in order for as long as the next one fits in what is left of
+ * pvRxData, up to xMaxMessages; a sender waiting for space is notified once
+ * for all of them.
+ *
+ * If the message buffer holds fewer bytes than its wake threshold (see
+ * xMessageBufferSetWakeThreshold()) the calling task blocks until a sender
+ * brings it up to the threshold or xTicksToWait expires, and then takes
+ * whatever is there.  With the default threshold that is the same as waiting
+ * for the first message.
+ *
+ * The same single reader rules as xMessageBufferReceive() apply.
+ *
+ * configUSE_STREAM_BUFFERS must be set to 1 in for FreeRTOSConfig.h for
+ * xMessageBufferReceiveMany() to be available.
+ *
+ * @param xMessageBuffer The handle of the message buffer from which the
+ * messages are being received.
+ *
+ * @param pvRxData A pointer to the buffer into which the messages are copied.
+ *
+ * @param xBufferLengthBytes The length of the buffer pointed to by pvRxData.
+ * If the next message is longer than this nothing is received.
+ *
+ * @param pxMessageLengths A pointer to an array of xMaxMessages entries, which
+ * receives the length of each message copied.
+ *
+ * @param xMaxMessages The most messages to receive.  Must not be zero.
+ *
+ * @param xTicksToWait The maximum amount of time the task should remain in the
+ * Blocked state to wait for a batch of messages.
+ *
+ * @return The number of messages received, or 0 if there was none (or the
+ * next one did not fit in pvRxData) when the block time expired.
+ *
+ * Example use:
+ * @code{c}
+ * void vTelemetryTask( void *pvParameters )
+ * {
+ * uint8_t ucRecords[ 512 ];
+ * size_t xLengths[ 32 ], xMessages, xMessage, xOffset;
+ *
+ *  // Wake once there are at least 256 bytes of records, or every 100ms.
+ *  xMessageBufferSetWakeThreshold( xMessageBuffer, 256 );
+ *
+ *  for( ;; )
+ *  {
+ *      xMessages = xMessageBufferReceiveMany( xMessageBuffer, ucRecords,
+ *                                             sizeof( ucRecords ), xLengths,
+ *                                             32, pdMS_TO_TICKS( 100 ) );
+ *
+ *      for( xMessage = 0, xOffset = 0; xMessage < xMessages; xMessage++ )
+ *      {
+ *          vProcessRecord( &( ucRecords[ xOffset ] ), xLengths[ xMessage ] );
+ *          xOffset += xLengths[ xMessage ];
+ *      }
+ *  }
+ * }
+ * @endcode
+ * \defgroup xMessageBufferReceiveMany xMessageBufferReceiveMany
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferReceiveMany( xMessageBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, xMaxMessages, xTicksToWait ) \
+    xStreamBufferReceiveMessages( ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( pxMessageLengths ), ( xMaxMessages ), ( xTicksToWait ) )
+
+/**
+ * message_buffer.h
+ *
+ * @code{c}
+ * BaseType_t xMessageBufferSetWakeThreshold( MessageBufferHandle_t xMessageBuffer,
+ *                                            size_t xThresholdBytes );
+ * @endcode
+ *
+ * Sets how many bytes, length headers included, a message buffer must hold
+ * before a send notifies the task blocked receiving from it.  Below the
+ * threshold senders append without waking the receiver, so a burst of small
+ * messages costs one wake-up rather than one per message; a receiver blocked
+ * in xMessageBufferReceive() or xMessageBufferReceiveMany() that times out
+ * takes what is there.  The default, 1, wakes the receiver on every message.
+ *
+ * The threshold is the message buffer's trigger level, so it must be less
+ * than the buffer size; a threshold of 0 is taken as 1.
+ *
+ * @param xMessageBuffer The handle of the message buffer being updated.
+ *
+ * @param xThresholdBytes The number of bytes that wakes the receiver.
+ *
+ * @return pdPASS if the threshold was set, pdFALSE if it was not less than the
+ * size of the message buffer.
+ *
+ * \defgroup xMessageBufferSetWakeThreshold xMessageBufferSetWakeThreshold
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSetWakeThreshold( xMessageBuffer, xThresholdBytes ) \
+    xStreamBufferSetTriggerLevel( ( xMessageBuffer ), ( xThresholdBytes ) )
+
 /**
  * message_buffer.h
  *
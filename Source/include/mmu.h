@@ -0,0 +1,77 @@
+/*
+ * Stage 1 MMU setup: a flat, section-mapped (1 MB) identity table.
+ *
+ *   0x00000000 - 0x3FFFFFFF   Device, execute never (UART, vGIC, ...)
+ *   0x40000000 - 0xBFFFFFFF   Normal, write-back write-allocate (guest RAM)
+ *   0xC0000000 - 0xFFFFFFFF   Fault
+ *
+ * The RAM window covers the /memory node of virt_custom.dtb (0x40000000,
+ * 0x7FF00000 bytes) rounded up to 1 MB.  The seL4 VMM's stage 2 translation
+ * decides what is actually backed.  With configNUMBER_OF_CORES > 1 RAM is
+ * also Shareable, so that the cores' caches are kept coherent.
+ */
+
+#ifndef MMU_H
+#define MMU_H
+
+#include <stdint.h>
+
+#define MMU_SECTION_SHIFT   20
+#define MMU_SECTION_SIZE    (1UL << MMU_SECTION_SHIFT)
+#define MMU_L1_ENTRIES      4096
+
+// 4 KB pages, for sections split by mmu_unmap_pages()
+#define MMU_PAGE_SHIFT      12
+#define MMU_PAGE_SIZE       (1UL << MMU_PAGE_SHIFT)
+#define MMU_L2_ENTRIES      256
+#define MMU_L2_TABLES       4       // Sections that can be split
+
+#define MMU_DEVICE_BASE     0x00000000UL
+#define MMU_DEVICE_SIZE     0x40000000UL
+#define MMU_RAM_BASE        0x40000000UL
+#define MMU_RAM_SIZE        0x80000000UL
+
+// Short-descriptor section attributes (TEX remap off)
+#define MMU_SECT            (2UL << 0)
+#define MMU_SECT_B          (1UL << 2)
+#define MMU_SECT_C          (1UL << 3)
+#define MMU_SECT_XN         (1UL << 4)
+#define MMU_SECT_AP_RW      (3UL << 10)             // Full access at PL0 and PL1
+#define MMU_SECT_TEX(x)     ((uint32_t)(x) << 12)
+#define MMU_SECT_S          (1UL << 16)             // Shareable
+
+#define MMU_SECT_DEVICE     (MMU_SECT | MMU_SECT_AP_RW | MMU_SECT_B | MMU_SECT_XN)
+#define MMU_SECT_NORMAL_WB  (MMU_SECT | MMU_SECT_AP_RW | MMU_SECT_TEX(1) | MMU_SECT_C | MMU_SECT_B)
+
+// For memory shared with another VM or core (e.g. a CAmkES dataport), which is
+// only kept coherent with the Shareable attribute.
+#define MMU_SECT_NORMAL_WB_SHARED   (MMU_SECT_NORMAL_WB | MMU_SECT_S)
+
+// Build the table and enable the MMU, caches and branch prediction.  Called
+// from startup.S before BSS is cleared, so it must not rely on zeroed data.
+void mmu_init(void);
+
+// With configNUMBER_OF_CORES > 1: the translation and control registers as
+// core 0 left them, for the secondary cores to load in _secondary_start
+// (startup.S) with their MMU off.  That code depends on the field order.
+typedef struct {
+    uint32_t ttbcr;
+    uint32_t ttbr0;
+    uint32_t dacr;
+    uint32_t actlr;
+    uint32_t sctlr;
+} mmu_boot_regs_t;
+
+extern mmu_boot_regs_t mmu_boot_regs;
+
+// Change the attributes of the 1 MB sections covering [base, base + size),
+// with the MMU on.  The range must not be in use meanwhile.
+void mmu_set_attributes(uint32_t base, uint32_t size, uint32_t attr);
+
+// Make the 4 KB pages covering [base, base + size) fault on any access, with
+// the MMU on, e.g. as stack guard pages.  The sections they are in are split
+// into page tables, keeping the attributes of the rest.  Returns -1, changing
+// nothing, if 'base' is not page aligned or the page tables have run out.
+int mmu_unmap_pages(uint32_t base, uint32_t size);
+
+#endif // MMU_H
@@ -0,0 +1,80 @@
+/*
+ * Zero-copy messages: fixed-size buffer pools and channels that pass buffer
+ * ownership instead of payload bytes.
+ *
+ * A pool splits caller-provided storage into equal buffers.  A producer
+ * acquires one, fills it in place and sends it down a channel; the receiver
+ * gets the same buffer back and releases it to the pool when done.  Only a
+ * one-word descriptor (buffer index and length) goes through the underlying
+ * queues, which queue.c copies with a single load and store, so the cost of
+ * a hop does not depend on the payload size.
+ *
+ * Each buffer has exactly one owner at a time - the pool, a task, or a
+ * channel - and the pool checks every hand-over with configASSERT, so a
+ * double release or a send of a buffer that is not held is caught at once.
+ * The pool's free list is itself a queue, so msg_acquire() can block until
+ * a buffer comes back.
+ */
+
+#ifndef MSG_POOL_H
+#define MSG_POOL_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+
+// Buffers per pool and messages per channel.
+#define MSG_POOL_MAX_BUFFERS    32
+#define MSG_CHANNEL_DEPTH       16
+
+// Descriptor: buffer index in the low half, length in the high half.
+#define MSG_MAX_LENGTH          0xFFFF
+
+typedef struct {
+    uint8_t *storage;
+    uint32_t buf_size;
+    uint32_t count;
+    QueueHandle_t free;
+    StaticQueue_t free_struct;
+    uint32_t free_storage[MSG_POOL_MAX_BUFFERS];
+    volatile uint8_t state[MSG_POOL_MAX_BUFFERS];   // MSG_BUF_*, for the ownership checks
+} msg_pool_t;
+
+typedef struct {
+    msg_pool_t *pool;
+    QueueHandle_t queue;
+    StaticQueue_t queue_struct;
+    uint32_t queue_storage[MSG_CHANNEL_DEPTH];
+} msg_channel_t;
+
+// Split the 'storage_size' bytes at 'storage' into 'count' buffers of
+// 'buf_size' bytes.  buf_size is rounded up to a multiple of 8, so storage_size
+// must cover 'count' rounded buffers.  Returns 0, or -1 if the geometry is
+// invalid or does not fit.
+int msg_pool_init(msg_pool_t *p, void *storage, uint32_t storage_size,
+                  uint32_t buf_size, uint32_t count);
+
+// Take a free buffer, waiting up to 'timeout' ticks.  NULL if none came back.
+void *msg_acquire(msg_pool_t *p, TickType_t timeout);
+void *msg_acquire_from_isr(msg_pool_t *p);
+
+// Give back a buffer the caller owns.
+void msg_release(msg_pool_t *p, void *buf);
+void msg_release_from_isr(msg_pool_t *p, void *buf, BaseType_t *woken);
+
+// Buffers currently free.
+uint32_t msg_pool_free_count(const msg_pool_t *p);
+
+// Create a channel carrying buffers of pool 'p'.
+void msg_channel_init(msg_channel_t *c, msg_pool_t *p);
+
+// Hand 'buf', holding 'len' valid bytes, to the receiver.  On success the
+// caller no longer owns it; on timeout (pdFAIL) it still does.
+BaseType_t msg_send(msg_channel_t *c, void *buf, uint32_t len, TickType_t timeout);
+BaseType_t msg_send_from_isr(msg_channel_t *c, void *buf, uint32_t len, BaseType_t *woken);
+
+// Take ownership of the next buffer, waiting up to 'timeout' ticks, and
+// store its length in '*len'.  NULL on timeout.
+void *msg_receive(msg_channel_t *c, uint32_t *len, TickType_t timeout);
+
+#endif // MSG_POOL_H
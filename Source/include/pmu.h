@@ -0,0 +1,38 @@
+/*
+ * ARMv7 PMU cycle counter (PMCCNTR), for measurements.
+ *
+ * The counter is 32 bits wide and wraps every few seconds at GHz clock rates,
+ * so it is meant for timing short intervals: take the difference of two
+ * unsigned reads.
+ */
+
+#ifndef PMU_H
+#define PMU_H
+
+#include <stdint.h>
+
+// PMCR bits
+#define PMCR_E      (1UL << 0)  // Enable all counters
+#define PMCR_C      (1UL << 2)  // Reset cycle counter
+#define PMCR_D      (1UL << 3)  // Count every 64th cycle
+
+// PMCNTENSET bit for the cycle counter
+#define PMCNTEN_C   (1UL << 31)
+
+static inline void pmu_enable_cycle_counter(void) {
+    uint32_t pmcr;
+    __asm volatile ("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+    pmcr = (pmcr | PMCR_E | PMCR_C) & ~PMCR_D;
+    __asm volatile ("mcr p15, 0, %0, c9, c12, 0\n"
+                    "mcr p15, 0, %1, c9, c12, 1\n"
+                    "isb" :: "r" (pmcr), "r" (PMCNTEN_C) : "memory");
+}
+
+static inline uint32_t pmu_read_cycles(void) {
+    uint32_t val;
+    __asm volatile ("isb\n"
+                    "mrc p15, 0, %0, c9, c13, 0" : "=r" (val) :: "memory");
+    return val;
+}
+
+#endif // PMU_H
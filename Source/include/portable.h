@@ -152,6 +152,25 @@ typedef struct HeapRegion
     size_t xSizeInBytes;
 } HeapRegion_t;
 
+#ifndef configUSE_HEAP_POOLS
+    #define configUSE_HEAP_POOLS    0
+#endif
+
+#if ( configUSE_HEAP_POOLS == 1 )
+
+/* Per size class figures for the heap_pool.c front end. */
+    typedef struct xHeapPoolStats
+    {
+        size_t xBlockSize;           /* The usable size, in bytes, of each block in the class. */
+        size_t xBlocksTotal;         /* The number of blocks the class has carved from the general heap so far. */
+        size_t xBlocksInUse;         /* The number of blocks currently allocated. */
+        size_t xMaxBlocksInUse;      /* The high-water mark of xBlocksInUse since the system booted. */
+        size_t xNumberOfAllocations; /* The number of calls to pvPortMalloc() served from the class. */
+        size_t xNumberOfFallbacks;   /* The number of requests for the class passed to the general heap because the pool could not grow. */
+        size_t xSlabs;               /* The number of slabs allocated from the general heap for the class. */
+    } HeapPoolStats_t;
+#endif
+
 /* Used to pass information about the heap out of vPortGetHeapStats(). */
 typedef struct xHeapStats
 {
@@ -162,8 +181,84 @@ typedef struct xHeapStats
     size_t xMinimumEverFreeBytesRemaining;  /* The minimum amount of total free memory (sum of all free blocks) there has been in the heap since the system booted. */
     size_t xNumberOfSuccessfulAllocations;  /* The number of calls to pvPortMalloc() that have returned a valid memory block. */
     size_t xNumberOfSuccessfulFrees;        /* The number of calls to vPortFree() that has successfully freed a block of memory. */
+    #if ( configUSE_HEAP_POOLS == 1 )
+        HeapPoolStats_t xPoolStats[ configHEAP_POOL_CLASS_COUNT ]; /* One entry per configHEAP_POOL_SIZES class. */
+    #endif
 } HeapStats_t;
 
+#ifndef configUSE_HEAP_PROFILER
+    #define configUSE_HEAP_PROFILER    0
+#endif
+
+#if ( configUSE_HEAP_PROFILER == 1 )
+
+    #ifndef configHEAP_PROFILER_SITES
+        #define configHEAP_PROFILER_SITES    64
+    #endif
+
+    #define heapPROFILE_MAGIC           0x50414548UL /* "HEAP" */
+    #define heapPROFILE_VERSION         1UL
+
+/* Request and free block size buckets: bucket 0 is below 16 bytes, bucket n
+ * ( 8 << n ) to ( 16 << n ) - 1 bytes, and the last one 256KB and over. */
+    #define heapPROFILE_SIZE_BUCKETS    16
+
+/* The heap_4.c figures for the code at one pvPortMalloc() return address.
+ * Sizes are heap_4 block sizes, header and alignment padding included. */
+    typedef struct xHeapProfileSite
+    {
+        uint32_t ulCaller;        /* The return address of the pvPortMalloc() call, 0 for an unused entry. */
+        uint32_t ulAllocations;   /* The number of blocks allocated from the call. */
+        uint32_t ulFrees;         /* The number of those blocks freed again. */
+        uint32_t ulBytesInUse;    /* The heap held by the call's blocks not yet freed. */
+        uint32_t ulMaxBytesInUse; /* The high-water mark of ulBytesInUse. */
+    } HeapProfileSite_t;
+
+/* xHeapProfile, at a fixed address in RAM so that the host can read it out of
+ * the guest without a console.  The counters are kept up to date by every
+ * pvPortMalloc() and vPortFree(); the fragmentation map from ulSnapshotTick on
+ * only by vPortHeapProfileSnapshot().  Times are in run time counter ticks, at
+ * ulCounterFrequency Hz. */
+    typedef struct xHeapProfile
+    {
+        volatile uint32_t ulMagic;                               /* heapPROFILE_MAGIC once the heap is initialised. */
+        uint32_t ulVersion;                                      /* heapPROFILE_VERSION. */
+        uint32_t ulSiteCount;                                    /* configHEAP_PROFILER_SITES. */
+        uint32_t ulBucketCount;                                  /* heapPROFILE_SIZE_BUCKETS. */
+        uint32_t ulHeapStart;                                    /* The first byte heap_4 manages. */
+        uint32_t ulHeapSize;                                     /* The number of bytes heap_4 manages. */
+        uint32_t ulHeaderSize;                                   /* The heap_4 header in front of every block. */
+        uint32_t ulCounterFrequency;                             /* The run time counter rate, 0 before the first snapshot. */
+        uint32_t ulMallocCalls;                                  /* Calls to pvPortMalloc() that reached heap_4, failed ones included. */
+        uint32_t ulMallocFailures;                               /* The number of those that returned NULL. */
+        uint64_t ullMallocTime;                                  /* Total time spent in them. */
+        uint32_t ulMallocMaxTime;                                /* The longest of them. */
+        uint32_t ulFreeCalls;                                    /* Calls to vPortFree() that freed a heap_4 block. */
+        uint64_t ullFreeTime;                                    /* Total time spent in them. */
+        uint32_t ulFreeMaxTime;                                  /* The longest of them. */
+        uint32_t ulSitesFull;                                    /* Allocations not counted against a site because every entry was taken. */
+        uint32_t ulRequestHistogram[ heapPROFILE_SIZE_BUCKETS ]; /* Requested sizes, before the header and alignment are added. */
+        volatile uint32_t ulSnapshotSequence;                    /* Odd while a snapshot is being written. */
+        uint32_t ulSnapshotTick;                                 /* The tick count of the last snapshot. */
+        uint32_t ulFreeBytes;                                    /* The sum of the free blocks. */
+        uint32_t ulFreeBlocks;                                   /* The number of free blocks. */
+        uint32_t ulLargestFreeBlock;                             /* The largest free block. */
+        uint32_t ulMapBlocks[ heapPROFILE_SIZE_BUCKETS ];        /* The number of free blocks in each size bucket. */
+        uint32_t ulMapBytes[ heapPROFILE_SIZE_BUCKETS ];         /* The bytes in the free blocks of each size bucket. */
+        HeapProfileSite_t xSites[ configHEAP_PROFILER_SITES ];   /* Hashed on ulCaller. */
+    } HeapProfile_t;
+
+    extern HeapProfile_t xHeapProfile;
+
+/*
+ * Walk the heap_4 free list into the fragmentation map of xHeapProfile and
+ * clean it out of the data cache.  The scheduler is suspended for the walk,
+ * which is as long as the free list.
+ */
+    void vPortHeapProfileSnapshot( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_HEAP_PROFILER */
+
 /*
  * Used to define multiple heap regions for use by heap_5.c.  This function
  * must be called before any calls to pvPortMalloc() - not creating a task,
@@ -177,6 +272,14 @@ typedef struct xHeapStats
  */
 void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEGED_FUNCTION;
 
+/*
+ * Called once, when the heap is first used, by heap_1.c, heap_4.c and
+ * heap_simple.c if configHEAP_FROM_LINKER_REGION is set to 1.  The
+ * application returns the start and size of the memory to use for the heap.
+ */
+void vApplicationGetHeapRegion( uint8_t ** ppucHeapStart,
+                                size_t * pxHeapSize ) PRIVILEGED_FUNCTION;
+
 /*
  * Returns a HeapStats_t structure filled with information about the current
  * heap state.
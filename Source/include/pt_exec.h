@@ -0,0 +1,220 @@
+/*
+ * Stackless workers: many protothread style state machines run by one task.
+ *
+ * A worker is a function and a pt_worker_t of a few words.  The function is
+ * written as straight line code between PT_BEGIN() and PT_END(), and every
+ * wait in it - PT_YIELD(), PT_DELAY(), PT_WAIT_UNTIL(), PT_WAIT_EVENT() and
+ * the queue waits - returns to the executor and records where to resume, in
+ * the switch/case manner of protothreads.  Locals therefore do not survive a
+ * wait; state that must is kept in the structure 'arg' points to.  A worker
+ * costs sizeof (pt_worker_t) in memory the caller provides, against a TCB and
+ * at least configMINIMAL_STACK_SIZE words of heap for a task.
+ *
+ * pt_exec_run() is the body of the task that runs an executor, created as any
+ * other task with the executor as its parameter; that task's stack is the one
+ * every worker runs on.  Each executor has its own run queue, so executors
+ * at different task priorities (or, with partitioned scheduling, on different
+ * cores) run their workers independently.  Ready workers run in FIFO order,
+ * each once per pass; an executor with nothing ready blocks on its task
+ * notification until a worker is readied or its next timer expires.  With
+ * workers always ready it yields between passes to tasks of its priority.
+ *
+ * Timed waits are kept per executor in a wheel of PT_WHEEL_SLOTS one tick
+ * slots, with longer waits in an unsorted list that is looked through once per
+ * revolution, so starting a wait costs the same whatever the number of
+ * workers.  Delays are limited to portMAX_DELAY / 2 ticks, portMAX_DELAY
+ * itself meaning no timeout.
+ *
+ * A pt_event_t counts signals, up to a limit: a give wakes the worker that has
+ * waited longest, or is kept for the next wait.  Tasks and ISRs give events,
+ * so they wake workers in any executor; workers wait on them.  A pt_queue_t
+ * puts two wake up flags beside a FreeRTOS queue, so items flow both ways
+ * between tasks and workers: tasks use pt_queue_send() and pt_queue_receive(),
+ * which block as the queue functions do, and workers PT_QUEUE_SEND() and
+ * PT_QUEUE_RECEIVE(), which try the queue and wait for the flag when it is
+ * empty or full.  Every send and receive must go through the pt_queue_t, or
+ * a waiting worker is not woken and only retries at its timeout.
+ *
+ * The event, queue and spawn functions take a critical section, and are safe
+ * from any task; only the _from_isr ones may be called from an interrupt.
+ */
+
+#ifndef PT_EXEC_H
+#define PT_EXEC_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+// One tick each; must be 64, the width of the slot map.
+#define PT_WHEEL_SLOTS      64
+
+// Worker function return values
+#define PT_WAITING          0   // At a wait, or yielded: run again when due
+#define PT_DONE             1   // Past PT_END(): the worker is finished
+
+// pt_worker_t result of the last wait
+#define PT_RESULT_OK        0
+#define PT_RESULT_TIMEOUT   1
+
+// Intrusive doubly linked list: a list head, or a link in one.
+typedef struct pt_link {
+    struct pt_link *next;
+    struct pt_link *prev;
+} pt_link_t;
+
+typedef struct pt_exec pt_exec_t;
+typedef struct pt_worker pt_worker_t;
+typedef struct pt_event pt_event_t;
+
+typedef int (*pt_worker_fn)(pt_worker_t *w);
+
+struct pt_worker {
+    pt_link_t link;         // Run queue, or the wait list of 'event'
+    pt_link_t timer;        // Wheel slot or long wait list, executor only
+    pt_exec_t *exec;
+    pt_worker_fn fn;
+    void *arg;
+    pt_event_t *event;      // Being waited on, or NULL
+    TickType_t wake;        // Timer expiry tick
+    uint16_t pc;            // Resume point, 0 at PT_BEGIN()
+    uint8_t state;
+    uint8_t result;         // PT_RESULT_*
+};
+
+struct pt_event {
+    pt_link_t waiters;
+    uint32_t count;
+    uint32_t max;
+};
+
+struct pt_exec {
+    pt_link_t ready;        // Protected by a critical section
+    uint32_t ready_count;
+    uint32_t workers;       // Spawned and not yet done
+    TaskHandle_t task;      // Running pt_exec_run(), NULL before it starts
+    // Timers, touched by the executor's task only
+    TickType_t now;         // Last tick the wheel was advanced to
+    uint64_t wheel_map;     // Slots that may be occupied
+    pt_link_t far;          // Waits of PT_WHEEL_SLOTS ticks or more
+    pt_link_t wheel[PT_WHEEL_SLOTS];
+    // Statistics
+    uint32_t passes;
+    uint32_t runs;
+};
+
+typedef struct {
+    QueueHandle_t queue;
+    pt_event_t items;       // Wake up flag, given on every send
+    pt_event_t space;       // Wake up flag, given on every receive
+} pt_queue_t;
+
+// Set up an executor for a task created with pt_exec_run() and 'exec' as its
+// parameter.  Workers may be spawned before the task runs.
+void pt_exec_init(pt_exec_t *exec);
+
+// Task body: run the executor passed as the parameter, forever.
+void pt_exec_run(void *exec);
+
+// Start 'fn' as a worker in 'exec', with 'w' (kept until it is done) and
+// 'arg' for its use.  Its first run is on the executor's next pass.
+void pt_spawn(pt_exec_t *exec, pt_worker_t *w, pt_worker_fn fn, void *arg);
+
+// An event with 'count' signals pending, holding no more than 'max'.
+// max 1 makes it a wake up flag.
+void pt_event_init(pt_event_t *ev, uint32_t count, uint32_t max);
+void pt_event_give(pt_event_t *ev);
+void pt_event_give_from_isr(pt_event_t *ev, BaseType_t *woken);
+
+// Workers and tasks exchange items through 'queue', created by the caller
+// (statically or not) and used only through 'q' from now on.
+void pt_queue_init(pt_queue_t *q, QueueHandle_t queue);
+
+// Task side: as xQueueSend() / xQueueSendFromISR() / xQueueReceive().
+// Return 0, or -1 if the queue stayed full or empty for 'ticks'.
+int pt_queue_send(pt_queue_t *q, const void *item, TickType_t ticks);
+int pt_queue_send_from_isr(pt_queue_t *q, const void *item, BaseType_t *woken);
+int pt_queue_receive(pt_queue_t *q, void *buf, TickType_t ticks);
+
+// Used by the macros below.  pt_event_wait() takes a signal and returns 0,
+// sets PT_RESULT_TIMEOUT and returns 0 if there is none and 'timeout' is 0,
+// or parks the worker and returns 1.
+int pt_event_wait(pt_worker_t *w, pt_event_t *ev, TickType_t timeout);
+void pt_sleep(pt_worker_t *w, TickType_t ticks);
+int pt_queue_try_send(pt_queue_t *q, const void *item);
+int pt_queue_try_receive(pt_queue_t *q, void *buf);
+
+// Worker body.  Each wait must be on a line of its own, and not inside a
+// switch statement of the worker's own.
+#define PT_BEGIN(w)         switch ((w)->pc) { case 0:
+#define PT_END(w)           } (w)->pc = 0; return PT_DONE
+
+// True if the last PT_WAIT_EVENT() or queue operation timed out.
+#define PT_TIMED_OUT(w)     ((w)->result == PT_RESULT_TIMEOUT)
+
+// Let the other ready workers run first.
+#define PT_YIELD(w)                                                         \
+    do {                                                                    \
+        (w)->pc = __LINE__;                                                 \
+        pt_sleep((w), 0);                                                   \
+        return PT_WAITING;                                                  \
+    case __LINE__:;                                                         \
+    } while (0)
+
+#define PT_DELAY(w, ticks)                                                  \
+    do {                                                                    \
+        (w)->pc = __LINE__;                                                 \
+        pt_sleep((w), (ticks));                                             \
+        return PT_WAITING;                                                  \
+    case __LINE__:;                                                         \
+    } while (0)
+
+// Poll 'cond' once a tick until it holds, for conditions nothing signals.
+#define PT_WAIT_UNTIL(w, cond)                                              \
+    do {                                                                    \
+        (w)->pc = __LINE__;                                                 \
+    case __LINE__:                                                          \
+        if (!(cond)) {                                                      \
+            pt_sleep((w), 1);                                               \
+            return PT_WAITING;                                              \
+        }                                                                   \
+    } while (0)
+
+// Take a signal from 'ev', waiting up to 'timeout' ticks for one.
+#define PT_WAIT_EVENT(w, ev, timeout)                                       \
+    do {                                                                    \
+        (w)->pc = __LINE__;                                                 \
+        if (pt_event_wait((w), (ev), (timeout)) != 0) {                     \
+            return PT_WAITING;                                              \
+        }                                                                   \
+    case __LINE__:;                                                         \
+    } while (0)
+
+// Retry 'attempt' (0 once done) each time 'ev' is given, for the queue waits.
+#define PT_RETRY_ON_EVENT(w, attempt, ev, timeout)                          \
+    do {                                                                    \
+        (w)->result = PT_RESULT_OK;                                         \
+        (w)->pc = __LINE__;                                                 \
+    case __LINE__:                                                          \
+        if (!PT_TIMED_OUT(w) && (attempt) != 0) {                           \
+            if (pt_event_wait((w), (ev), (timeout)) == 0 &&                 \
+                !PT_TIMED_OUT(w)) {                                         \
+                pt_sleep((w), 0);                                           \
+            }                                                               \
+            if (!PT_TIMED_OUT(w)) {                                         \
+                return PT_WAITING;                                          \
+            }                                                               \
+        }                                                                   \
+    } while (0)
+
+// Receive an item into 'buf', or send the one at 'item', waiting up to
+// 'timeout' ticks at a time for one or for room.  'buf' and 'item' must still
+// be valid when the worker resumes: not locals.
+#define PT_QUEUE_RECEIVE(w, q, buf, timeout)                                \
+    PT_RETRY_ON_EVENT((w), pt_queue_try_receive((q), (buf)), &(q)->items, (timeout))
+#define PT_QUEUE_SEND(w, q, item, timeout)                                  \
+    PT_RETRY_ON_EVENT((w), pt_queue_try_send((q), (item)), &(q)->space, (timeout))
+
+#endif // PT_EXEC_H
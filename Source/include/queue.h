@@ -1456,6 +1456,154 @@ BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue,
                                  void * const pvBuffer,
                                  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * @code{c}
+ * UBaseType_t xQueueSendMultiple(
+ *                                   QueueHandle_t xQueue,
+ *                                   const void * pvItems,
+ *                                   UBaseType_t uxItemCount,
+ *                                   TickType_t xTicksToWait
+ *                               );
+ * @endcode
+ *
+ * Post a batch of items to the back of a queue.  Equivalent to calling
+ * xQueueSend() once per item, but the items are copied under a single
+ * critical section for as many as there is room for, and the waiting
+ * receivers are unblocked once per batch rather than once per item.  If the
+ * queue fills part way the calling task blocks until there is room for the
+ * rest or xTicksToWait expires.
+ *
+ * Must not be used on a semaphore or mutex.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItems A pointer to uxItemCount items, each of the size the queue
+ * was created with, stored consecutively.
+ *
+ * @param uxItemCount The number of items to post.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue, for the whole batch.
+ *
+ * @return The number of items posted, from the start of pvItems.  Less than
+ * uxItemCount only if the block time expired.
+ *
+ * Example usage:
+ * @code{c}
+ * uint16_t usSamples[ 8 ];
+ *
+ *  // Fill usSamples[] from the ADC FIFO, then hand them all on at once.
+ *  if( xQueueSendMultiple( xSampleQueue, usSamples, 8, pdMS_TO_TICKS( 10 ) ) != 8 )
+ *  {
+ *      // The consumer is falling behind.
+ *  }
+ * @endcode
+ * \defgroup xQueueSendMultiple xQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueSendMultiple( QueueHandle_t xQueue,
+                                const void * const pvItems,
+                                const UBaseType_t uxItemCount,
+                                TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * UBaseType_t xQueueSendMultipleFromISR(
+ *                                          QueueHandle_t xQueue,
+ *                                          const void * pvItems,
+ *                                          UBaseType_t uxItemCount,
+ *                                          BaseType_t *pxHigherPriorityTaskWoken
+ *                                      );
+ * @endcode
+ *
+ * The interrupt safe version of xQueueSendMultiple().  Posts as many of the
+ * items as there is room for, without blocking.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if posting the items
+ * unblocked a task with a priority higher than that of the interrupted task,
+ * otherwise left unchanged.  A context switch should then be requested
+ * before the interrupt is exited.
+ *
+ * @return The number of items posted.
+ *
+ * \defgroup xQueueSendMultipleFromISR xQueueSendMultipleFromISR
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue,
+                                       const void * const pvItems,
+                                       const UBaseType_t uxItemCount,
+                                       BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * UBaseType_t xQueueReceiveMultiple(
+ *                                      QueueHandle_t xQueue,
+ *                                      void * pvBuffer,
+ *                                      UBaseType_t uxMaxItems,
+ *                                      TickType_t xTicksToWait
+ *                                  );
+ * @endcode
+ *
+ * Receive a batch of items from a queue.  Blocks, for up to xTicksToWait,
+ * only while the queue is empty; as soon as there is data, all of it up to
+ * uxMaxItems is copied out under a single critical section and a waiting
+ * sender is unblocked for each slot freed.
+ *
+ * Must not be used on a semaphore or mutex.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to room for uxMaxItems items, into which the items
+ * are copied in queue order.
+ *
+ * @param uxMaxItems The most items to receive.  Must not be zero.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for the first item.
+ *
+ * @return The number of items received, or 0 if the block time expired with
+ * the queue still empty.
+ *
+ * \defgroup xQueueReceiveMultiple xQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue,
+                                   void * const pvBuffer,
+                                   const UBaseType_t uxMaxItems,
+                                   TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * @code{c}
+ * UBaseType_t xQueueReceiveMultipleFromISR(
+ *                                             QueueHandle_t xQueue,
+ *                                             void * pvBuffer,
+ *                                             UBaseType_t uxMaxItems,
+ *                                             BaseType_t *pxHigherPriorityTaskWoken
+ *                                         );
+ * @endcode
+ *
+ * The interrupt safe version of xQueueReceiveMultiple().  Receives whatever
+ * is in the queue, up to uxMaxItems, without blocking.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if freeing the slots
+ * unblocked a task with a priority higher than that of the interrupted task,
+ * otherwise left unchanged.
+ *
+ * @return The number of items received.
+ *
+ * \defgroup xQueueReceiveMultipleFromISR xQueueReceiveMultipleFromISR
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue,
+                                          void * const pvBuffer,
+                                          const UBaseType_t uxMaxItems,
+                                          BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /*
  * Utilities to query queues that are safe to use from an ISR.  These utilities
  * should be used only from within an ISR, or within a critical section.
@@ -0,0 +1,48 @@
+/*
+ * Freestanding runtime: memcpy/memset, implemented in rt_string.S.
+ *
+ * Mutually word-aligned buffers are copied with 8-register LDM/STM bursts,
+ * everything else byte by byte (LDM/STM need word-aligned addresses even
+ * with the MMU on).  Blocks of RT_STRING_NEON_THRESHOLD bytes or more can go through
+ * NEON instead, see below.
+ *
+ * Included from rt_string.S, so keep C-only parts under !__ASSEMBLER__.
+ */
+
+#ifndef RT_STRING_H
+#define RT_STRING_H
+
+// The NEON path clobbers d0-d7, which are only saved across a context switch
+// for tasks that have an FPU context.  Enable it only when every task has one
+// (configUSE_TASK_FPU_SUPPORT 2); ISRs are covered by vApplicationIRQHandler,
+// except IRQ_FLAG_NO_FPU ones, which must not call it (irq_dispatch.h).
+#ifndef RT_STRING_USE_NEON
+#define RT_STRING_USE_NEON          0
+#endif
+
+// Below this the NEON setup does not pay for itself.
+#define RT_STRING_NEON_THRESHOLD    128
+
+// Build the memcpy/memset benchmark task (rt_string_bench.c) into main.c.
+#ifndef RT_STRING_BENCH
+#define RT_STRING_BENCH             0
+#endif
+
+#ifndef __ASSEMBLER__
+
+#include <stddef.h>
+#include <stdint.h>
+
+void *memcpy(void *dest, const void *src, size_t n);
+void *memset(void *s, int c, size_t n);
+
+// Fill 'words' words at word-aligned 's' with 'v', through the memset bursts.
+void rt_memset32(uint32_t *s, uint32_t v, size_t words);
+
+// Measure both functions across size classes and print cycles per byte,
+// then delete itself.
+void vRtStringBenchTask(void *pvParameters);
+
+#endif // __ASSEMBLER__
+
+#endif // RT_STRING_H
@@ -0,0 +1,102 @@
+/*
+ * Paravirtual interface to the seL4 VMM (configUSE_SEL4_PARAVIRT).
+ *
+ * Without it the guest learns about its environment by trial and waits on
+ * emulated devices: xPortStartScheduler() finds the vGIC priority bits by
+ * writing a priority register and reading it back, and the idle task's WFI
+ * traps into the VMM, which has to decode it and then guess when the vCPU is
+ * next due - the virtual timer compare value is part of the vCPU state, not
+ * something the VMM is told about.
+ *
+ * The calls below go straight to the VMM with HVC #0, in the SMC calling
+ * convention: the function ID in r0, arguments in r1-r3, results in r0-r2.
+ * The IDs are in the vendor specific hypervisor service range.  A 64-bit
+ * virtual counter value is passed low word first.
+ *
+ *   SEL4_PV_FN_VERSION       -> r0 version, r1 feature bits, r2 notification IRQ ID
+ *   SEL4_PV_FN_GIC_INFO      -> r0 vGIC priority bits implemented
+ *   SEL4_PV_FN_SET_DEADLINE  r1:r2 wake the vCPU no later than this counter
+ *                            value; all ones for no deadline
+ *   SEL4_PV_FN_YIELD         r1:r2 as SET_DEADLINE, then block until an
+ *                            interrupt is pending for the vCPU
+ *   SEL4_PV_FN_NOTIFY        r1 channel: signal the seL4 notification the VMM
+ *                            bound to it -> r0 0, or SEL4_PV_NOT_SUPPORTED
+ *   SEL4_PV_FN_NOTIFY_POLL   -> r0 channels signalled since the last poll
+ *
+ * A VMM without the interface answers SEL4_PV_FN_VERSION with
+ * SEL4_PV_NOT_SUPPORTED, as it does for any unknown function ID.
+ * sel4_pv_init() then leaves the feature bits at 0 and every user keeps its
+ * emulated path: the priority probe, and WFI.
+ *
+ * Notifications from other VMs arrive as one virtual interrupt, the ID the
+ * VMM reports with its version; the handler installed by sel4_pv_notify_bind()
+ * polls the signalled channels and calls each one's callback.
+ */
+
+#ifndef SEL4_PV_H
+#define SEL4_PV_H
+
+#include <stdint.h>
+
+#define SEL4_PV_FN(n)               (0x86000000UL | (n))
+#define SEL4_PV_FN_VERSION          SEL4_PV_FN(0)
+#define SEL4_PV_FN_GIC_INFO         SEL4_PV_FN(1)
+#define SEL4_PV_FN_SET_DEADLINE     SEL4_PV_FN(2)
+#define SEL4_PV_FN_YIELD            SEL4_PV_FN(3)
+#define SEL4_PV_FN_NOTIFY           SEL4_PV_FN(4)
+#define SEL4_PV_FN_NOTIFY_POLL      SEL4_PV_FN(5)
+
+#define SEL4_PV_NOT_SUPPORTED       0xFFFFFFFFUL
+
+// Oldest VMM interface version this guest can use
+#define SEL4_PV_VERSION             1
+
+// Feature bits, from SEL4_PV_FN_VERSION
+#define SEL4_PV_FEAT_GIC_INFO       (1UL << 0)
+#define SEL4_PV_FEAT_DEADLINE       (1UL << 1)
+#define SEL4_PV_FEAT_YIELD          (1UL << 2)
+#define SEL4_PV_FEAT_NOTIFY         (1UL << 3)
+
+#define SEL4_PV_NOTIFY_CHANNELS     32
+
+#define SEL4_PV_NO_DEADLINE         UINT64_MAX
+
+// Callback for a signalled channel, from the notification interrupt.  As an
+// IRQ_FLAG_NO_FPU handler it must leave the VFP registers alone.
+typedef void (*sel4_pv_notify_fn)(uint32_t channel, void *arg);
+
+// Probe the VMM, once, before the scheduler starts; xPortStartScheduler()
+// calls it.  Returns the feature bits, 0 if the VMM has no interface.
+uint32_t sel4_pv_init(void);
+
+// Features from sel4_pv_init(), 0 before it.
+uint32_t sel4_pv_features(void);
+
+// vGIC priority bits reported by the VMM, 0 if it does not report them.
+uint32_t sel4_pv_gic_priority_bits(void);
+
+// Tell the VMM that the vCPU must run again by virtual counter value
+// 'deadline', or SEL4_PV_NO_DEADLINE.  Nothing without SEL4_PV_FEAT_DEADLINE.
+void sel4_pv_set_deadline(uint64_t deadline);
+
+// Sleep until an interrupt is pending, which the timer guarantees no later
+// than 'deadline': one SEL4_PV_FN_YIELD, or WFI (preceded by the deadline if
+// the VMM takes one) when the VMM cannot yield.  Call with IRQs masked in the
+// CPU; a pending interrupt still ends the wait.
+void sel4_pv_wait(uint64_t deadline);
+
+// Signal the notification bound to 'channel'.  Returns -1 without
+// SEL4_PV_FEAT_NOTIFY or if the VMM has no notification on the channel; the
+// caller then rings its emulated doorbell instead.
+int sel4_pv_notify(uint32_t channel);
+
+// spsc_doorbell_fn for a ring whose consumer is in another VM: 'arg' is the
+// channel, cast to a pointer.
+void sel4_pv_doorbell(void *arg);
+
+// Call 'fn' with 'arg' from the notification interrupt whenever 'channel' is
+// signalled.  The first binding registers the interrupt.  Returns -1 without
+// SEL4_PV_FEAT_NOTIFY, or if the channel is out of range or already bound.
+int sel4_pv_notify_bind(uint32_t channel, sel4_pv_notify_fn fn, void *arg);
+
+#endif // SEL4_PV_H
@@ -700,6 +700,10 @@ typedef QueueHandle_t SemaphoreHandle_t;
  * 'taking' a semaphore MUST ALWAYS 'give' the semaphore back once the
  * semaphore it is no longer required.
  *
+ * If configUSE_MUTEX_FAST_PATH is set to 1 an uncontended take or give is a
+ * single atomic compare and swap, without a critical section.  Priority
+ * inheritance and blocking are as usual once a second task wants the mutex.
+ *
  * Mutex type semaphores cannot be used from within interrupt service routines.
  *
  * See xSemaphoreCreateBinary() for an alternative implementation that can be
@@ -761,6 +765,10 @@ typedef QueueHandle_t SemaphoreHandle_t;
  * 'taking' a semaphore MUST ALWAYS 'give' the semaphore back once the
  * semaphore it is no longer required.
  *
+ * If configUSE_MUTEX_FAST_PATH is set to 1 an uncontended take or give is a
+ * single atomic compare and swap, without a critical section.  Priority
+ * inheritance and blocking are as usual once a second task wants the mutex.
+ *
  * Mutex type semaphores cannot be used from within interrupt service routines.
  *
  * See xSemaphoreCreateBinary() for an alternative implementation that can be
@@ -0,0 +1,104 @@
+/*
+ * Lock-free single-producer single-consumer ring for shared-memory channels
+ * between VMs (CAmkES dataports) or between this guest's tasks and ISRs.
+ *
+ * The ring lives entirely in the shared page and holds no pointers, so each
+ * side can map it at a different address.  The producer owns 'head' and the
+ * consumer owns 'tail', each in its own cache line; both are free-running
+ * slot counts, so head - tail is the fill level and slot_count must be a
+ * power of two.  Slots are copied in batches and an index is published once
+ * per batch, after a DMB, so a burst of messages costs one barrier pair
+ * rather than one queue operation each.
+ *
+ * A consumer with nothing to read may block in spsc_ring_pop_wait().  It
+ * raises 'consumer_waiting' first; a producer that sees the flag after
+ * publishing claims it with LDREX/STREX and rings the doorbell, so the
+ * doorbell (a VMM trap when it crosses VMs) is only paid when the consumer
+ * is really asleep.  On the consumer side the doorbell arrives as an
+ * interrupt bound with spsc_ring_bind_irq().  Without a doorbell a waiting
+ * consumer just polls at its timeout.
+ *
+ * Both VMs must map the page Normal, Shareable and with the same
+ * cacheability - see MMU_SECT_NORMAL_WB_SHARED and mmu_set_attributes().
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cache.h"
+
+#define SPSC_RING_MAGIC     0x53505343UL    // "SPSC", written last by format
+
+// Rings that can have a doorbell interrupt bound at once.
+#define SPSC_RING_MAX_IRQS  4
+
+// Shared layout.  Every field is a word so that no access is torn.
+typedef struct {
+    volatile uint32_t head;                 // Written by the producer only
+    uint8_t pad0[CACHE_LINE_MAX - 4];
+    volatile uint32_t tail;                 // Written by the consumer only
+    volatile uint32_t consumer_waiting;     // Set by the consumer, claimed by the producer
+    uint8_t pad1[CACHE_LINE_MAX - 8];
+    volatile uint32_t magic;                // Constant once formatted
+    uint32_t slot_size;
+    uint32_t slot_count;
+    uint8_t pad2[CACHE_LINE_MAX - 12];
+    uint8_t data[];
+} __attribute__((aligned(CACHE_LINE_MAX))) spsc_ring_shared_t;
+
+typedef void (*spsc_doorbell_fn)(void *arg);
+
+// Per-side handle, in local memory.  Each side needs its own.
+typedef struct {
+    spsc_ring_shared_t *shm;
+    uint32_t mask;
+    uint32_t slot_size;
+    uint32_t cached;        // Last seen opposite index, to skip shared reads
+    TaskHandle_t consumer;  // Task blocked in spsc_ring_pop_wait(), if any
+    spsc_doorbell_fn doorbell;
+    void *doorbell_arg;
+} spsc_ring_t;
+
+// Bytes of shared memory a ring of this geometry needs.
+size_t spsc_ring_shm_size(uint32_t slot_size, uint32_t slot_count);
+
+// Initialise a ring in 'shm' (one side only, before the other attaches).
+// Returns 0, or -1 if the geometry is invalid or does not fit in 'size'.
+int spsc_ring_format(spsc_ring_t *r, void *shm, size_t size, uint32_t slot_size, uint32_t slot_count);
+
+// Attach to a ring formatted by the other side, or re-attach to one already
+// in use: the handle resumes from the shared indices.  Returns 0, or -1 if
+// 'shm' does not hold a valid ring that fits in 'size'.
+int spsc_ring_attach(spsc_ring_t *r, void *shm, size_t size);
+
+// Producer: the doorbell to ring when the consumer is waiting, or NULL.
+// For a consumer in this guest, a gic_send_sgi() wrapper will do.
+void spsc_ring_set_doorbell(spsc_ring_t *r, spsc_doorbell_fn fn, void *arg);
+
+// Producer: copy up to 'count' slots from 'items'.  Returns the number
+// pushed, which is less than 'count' when the ring fills.  Never blocks.
+uint32_t spsc_ring_push(spsc_ring_t *r, const void *items, uint32_t count);
+
+// Consumer: copy up to 'max' slots into 'items'.  Returns the number popped.
+uint32_t spsc_ring_pop(spsc_ring_t *r, void *items, uint32_t max);
+
+// Consumer, from a task: as spsc_ring_pop(), but block for up to 'timeout'
+// ticks while the ring is empty.  Returns 0 on timeout.
+uint32_t spsc_ring_pop_wait(spsc_ring_t *r, void *items, uint32_t max, TickType_t timeout);
+
+// Slots currently readable (consumer) or, from the producer, in flight.
+uint32_t spsc_ring_count(const spsc_ring_t *r);
+
+// Consumer: wake the waiting task when interrupt 'irq_id' fires, and enable
+// it.  Returns 0, or -1 if SPSC_RING_MAX_IRQS rings are already bound.
+int spsc_ring_bind_irq(spsc_ring_t *r, uint32_t irq_id);
+
+// Called by the IRQ dispatcher for unclaimed interrupts.  Returns 1 if 'id'
+// is a bound doorbell.
+int spsc_ring_irq_handler(uint32_t id);
+
+#endif // SPSC_RING_H
@@ -0,0 +1,68 @@
+/*
+ * Task stack overflow detection and high-water tracking.
+ *
+ * Two overflow checks, from cheapest to most thorough:
+ *
+ *   - configCHECK_FOR_STACK_OVERFLOW 2: the kernel compares the lowest 16
+ *     bytes of the outgoing task's stack with the fill pattern at every
+ *     context switch and calls vApplicationStackOverflowHook() (here) if they
+ *     changed.  Costs four loads per switch; catches an overflow late, and not
+ *     at all if a frame skips over the canary.
+ *   - Guard pages: stack_guard_protect() unmaps the 4 KB page below a task's
+ *     stack, so the first store past the end takes a data abort naming the
+ *     task.  Costs a page of RAM per stack; the buffer is declared with
+ *     STACK_GUARDED_SECTION and STACK_GUARD_WORDS more words than the task
+ *     gets, and the task is given buffer + STACK_GUARD_WORDS.
+ *
+ * The kernel's uxTaskGetStackHighWaterMark() scans a whole stack at once.
+ * stack_watch_step(), called from the idle hook, instead checks
+ * STACK_WATCH_SLICE words of one watched stack per call, so the lowest free
+ * figures are kept up to date in the background at a bounded cost per idle
+ * iteration.  stack_watch_get() then returns the figure without a scan.
+ */
+
+#ifndef STACK_GUARD_H
+#define STACK_GUARD_H
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mmu.h"
+
+// Guard page in front of a stack buffer, see above.
+#define STACK_GUARD_WORDS       (MMU_PAGE_SIZE / sizeof(StackType_t))
+#define STACK_GUARDED_SECTION   __attribute__((section(".task_stacks"), aligned(MMU_PAGE_SIZE)))
+
+// Stacks that can have a guard page, and tasks that can be watched
+#define STACK_GUARD_MAX         4
+#define STACK_WATCH_MAX         16
+
+// Words of a stack checked per stack_watch_step()
+#define STACK_WATCH_SLICE       64
+
+// Unmap the guard page at the start of 'buffer' (STACK_GUARDED_SECTION, with
+// STACK_GUARD_WORDS spare words).  The MMU must be on.  Returns -1 if the
+// buffer is not page aligned or no more guard pages or page tables are left.
+int stack_guard_protect(StackType_t *buffer);
+
+// Data abort handler, called from startup.S in Abort mode with the fault
+// address and status registers and the aborting instruction.  Reports a hit
+// on a guard page as an overflow of the running task, then halts.
+void stack_guard_data_abort(uint32_t dfar, uint32_t dfsr, uint32_t pc);
+
+// Start tracking the stack of 'task'.  Returns -1 if the table is full.
+int stack_watch_add(TaskHandle_t task);
+
+// Check the next slice of the watched stacks.  Idle hook.
+void stack_watch_step(void);
+
+// Lowest number of free words seen on the stack of 'task', from the last
+// complete pass or better; the stack depth until one has been made.  Returns
+// 0 if the task is not watched.
+uint32_t stack_watch_get(TaskHandle_t task);
+
+// Completed passes over all watched stacks.
+uint32_t stack_watch_passes(void);
+
+#endif // STACK_GUARD_H
@@ -0,0 +1,16 @@
+/*
+ * Statically allocated kernel memory.
+ *
+ * Task stacks and kernel object buffers (StaticTask_t, StaticQueue_t, ...)
+ * tagged with these attributes are collected into their own output sections
+ * by link.ld, so their total shows up in the link map and running out of RAM
+ * is a link error rather than a failed create at run time.
+ */
+
+#ifndef STATIC_ALLOC_H
+#define STATIC_ALLOC_H
+
+#define TASK_STACK_SECTION      __attribute__((section(".task_stacks"), aligned(8)))
+#define KERNEL_OBJECT_SECTION   __attribute__((section(".kernel_objects"), aligned(8)))
+
+#endif // STATIC_ALLOC_H
@@ -85,6 +85,15 @@ typedef void (* StreamBufferCallbackFunction_t)( StreamBufferHandle_t xStreamBuf
                                                  BaseType_t xIsInsideISR,
                                                  BaseType_t * const pxHigherPriorityTaskWoken );
 
+/**
+ * One piece of the data passed to xStreamBufferSendFragments().
+ */
+typedef struct xSTREAM_BUFFER_FRAGMENT
+{
+    const void * pvData; /* The fragment's bytes.  May be NULL only if xLength is 0. */
+    size_t xLength;      /* The number of bytes at pvData. */
+} StreamBufferFragment_t;
+
 /**
  * stream_buffer.h
  *
@@ -879,6 +888,96 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
                                     size_t xBufferLengthBytes,
                                     BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferSendFragments( StreamBufferHandle_t xStreamBuffer,
+ *                                    const StreamBufferFragment_t *pxFragments,
+ *                                    size_t xFragmentCount,
+ *                                    TickType_t xTicksToWait );
+ * @endcode
+ *
+ * As xStreamBufferSend(), but the data is gathered from xFragmentCount
+ * fragments, so a record made of a header and a payload held in different
+ * places is sent without first being copied into one buffer.  On a message
+ * buffer the fragments become a single message with a single length, and the
+ * send is all or nothing; on a stream buffer as many of the bytes are written
+ * as there is space for, in fragment order.  Either way the data is published
+ * with one update of the buffer and the reader is told at most once.
+ *
+ * Used through xMessageBufferSendFragments() on message buffers.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to which the data is
+ * being sent.
+ *
+ * @param pxFragments The fragments, in the order they are to be written.
+ *
+ * @param xFragmentCount The number of entries in pxFragments.
+ *
+ * @param xTicksToWait As for xStreamBufferSend().
+ *
+ * @return The number of bytes written, not counting the message length.
+ *
+ * \defgroup xStreamBufferSendFragments xStreamBufferSendFragments
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendFragments( StreamBufferHandle_t xStreamBuffer,
+                                   const StreamBufferFragment_t * const pxFragments,
+                                   size_t xFragmentCount,
+                                   TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferSendFragmentsFromISR( StreamBufferHandle_t xStreamBuffer,
+ *                                           const StreamBufferFragment_t *pxFragments,
+ *                                           size_t xFragmentCount,
+ *                                           BaseType_t *pxHigherPriorityTaskWoken );
+ * @endcode
+ *
+ * The interrupt safe version of xStreamBufferSendFragments().
+ *
+ * @param pxHigherPriorityTaskWoken As for xStreamBufferSendFromISR().
+ *
+ * @return The number of bytes written, not counting the message length.
+ *
+ * \defgroup xStreamBufferSendFragmentsFromISR xStreamBufferSendFragmentsFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendFragmentsFromISR( StreamBufferHandle_t xStreamBuffer,
+                                          const StreamBufferFragment_t * const pxFragments,
+                                          size_t xFragmentCount,
+                                          BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * @code{c}
+ * size_t xStreamBufferReceiveMessages( StreamBufferHandle_t xStreamBuffer,
+ *                                      void *pvRxData,
+ *                                      size_t xBufferLengthBytes,
+ *                                      size_t *pxMessageLengths,
+ *                                      size_t xMaxMessages,
+ *                                      TickType_t xTicksToWait );
+ * @endcode
+ *
+ * Receives several messages from a message buffer in one call.  Only valid
+ * on a message buffer; used through xMessageBufferReceiveMany().
+ *
+ * @return The number of messages received.
+ *
+ * \defgroup xStreamBufferReceiveMessages xStreamBufferReceiveMessages
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveMessages( StreamBufferHandle_t xStreamBuffer,
+                                     void * pvRxData,
+                                     size_t xBufferLengthBytes,
+                                     size_t * const pxMessageLengths,
+                                     size_t xMaxMessages,
+                                     TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /**
  * stream_buffer.h
  *
@@ -3580,6 +3580,42 @@ BaseType_t xTaskRemoveFromEventList( const List_t * const pxEventList ) PRIVILEG
 void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem,
                                         const TickType_t xItemValue ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * THIS FUNCTION MUST BE CALLED WITH INTERRUPTS DISABLED.
+ *
+ * Unblocks every task on an unordered event list, setting each event list
+ * item value to xItemValue, like vTaskRemoveFromUnorderedEventList() called on
+ * each in turn.  Unlike it, this can be called from an ISR and with the
+ * scheduler running.  Used by the indexed event groups
+ * (configUSE_EVENT_GROUP_WAITER_INDEX).
+ *
+ * @return pdTRUE if a task was unblocked that has a higher priority than the
+ * task making the call, otherwise pdFALSE.
+ */
+#if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+    BaseType_t xTaskRemoveAllFromUnorderedEventList( List_t * const pxEventList,
+                                                     const TickType_t xItemValue ) PRIVILEGED_FUNCTION;
+#endif
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED.
+ *
+ * As xTaskRemoveAllFromUnorderedEventList(), but for tasks: interrupts stay
+ * enabled, and the caller must make sure no interrupt accesses pxEventList.
+ * The indexed event groups lock the event group for that.  A yield needed for
+ * an unblocked task is left pending until the scheduler is resumed.
+ */
+#if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+    void vTaskRemoveAllFromUnorderedEventList( List_t * const pxEventList,
+                                               const TickType_t xItemValue ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
  * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
@@ -3697,6 +3733,17 @@ void vTaskPriorityDisinheritAfterTimeout( TaskHandle_t const pxMutexHolder,
  */
 TaskHandle_t pvTaskIncrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * For internal use only.  Decrement the mutex held count when a mutex taken
+ * on the fast path (configUSE_MUTEX_FAST_PATH) is given back uncontended.  If
+ * it was the last mutex held, any priority inherited through a mutex given
+ * back before it is disinherited, and pdTRUE is returned if the caller should
+ * yield.
+ */
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+    BaseType_t xTaskDecrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * For internal use only.  Same as vTaskSetTimeOutState(), but without a critical
  * section.
@@ -0,0 +1,38 @@
+/*
+ * Per-task CPU usage report from the kernel's run-time stats.
+ *
+ * vTaskGetRunTimeStatistics() needs snprintf, which the freestanding build
+ * does not have, so this prints the same information straight to the UART.
+ * The heap report goes alongside it.
+ */
+
+#ifndef TASK_STATS_H
+#define TASK_STATS_H
+
+// Maximum number of tasks listed; any beyond this are left out.
+#define TASK_STATS_MAX_TASKS    16
+
+// Print name, state, priority, stack high-water mark, run time and CPU share
+// of every task.  Task context only.
+void task_stats_print(void);
+
+// Print the general heap figures and, with heap_pool.c, the per size class
+// block counts and high-water marks.  Prints nothing in the static profile.
+// Task context only.
+void heap_stats_print(void);
+
+// Print how many vGIC priority mask writes the CPSR critical sections have
+// saved, in total and per second since the previous call.  Prints nothing
+// unless configUSE_CPSR_CRITICAL_SECTIONS is 1.  Task context only.
+void critical_stats_print(void);
+
+// Print count, deepest nesting, longest handler and longest ICCIAR-to-EOI
+// time in ns of every interrupt that has run, and the unused SVC stack of each
+// core.  Prints nothing unless configUSE_IRQ_STATS is 1.  Task context only.
+void irq_stats_print(void);
+
+// Print each core's share of time asleep in the idle task and its number of
+// wakeups, since the previous call.  Task context only.
+void idle_stats_print(void);
+
+#endif // TASK_STATS_H
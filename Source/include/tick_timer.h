@@ -0,0 +1,61 @@
+/*
+ * RTOS tick source: ARMv7 generic timer (virtual timer) as exposed to the
+ * guest by the seL4 VMM.  The virtual timer is not trapped by the VMM, so
+ * programming the compare value does not cause a VM exit.
+ */
+
+#ifndef TICK_TIMER_H
+#define TICK_TIMER_H
+
+#include <stdint.h>
+
+// Virtual timer PPI (armv7-timer node in virt_custom.dtb: PPI 11 -> ID 27)
+#define TICK_TIMER_IRQ_ID           27
+
+// CNTFRQ is normally set up by the VMM; QEMU virt runs the counter at 62.5 MHz.
+#define TICK_TIMER_FALLBACK_HZ      62500000UL
+
+// CNTV_CTL bits
+#define CNTV_CTL_ENABLE             (1UL << 0)
+#define CNTV_CTL_IMASK              (1UL << 1)
+#define CNTV_CTL_ISTATUS            (1UL << 2)
+
+static inline uint32_t tick_timer_read_cntfrq(void) {
+    uint32_t val;
+    __asm volatile ("mrc p15, 0, %0, c14, c0, 0" : "=r" (val));
+    return val;
+}
+
+static inline uint64_t tick_timer_read_counter(void) {
+    uint32_t lo, hi;
+    __asm volatile ("isb\n"
+                    "mrrc p15, 1, %0, %1, c14" : "=r" (lo), "=r" (hi) :: "memory");
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void tick_timer_write_compare(uint64_t cval) {
+    __asm volatile ("mcrr p15, 3, %0, %1, c14\n"
+                    "isb" :: "r" ((uint32_t)cval), "r" ((uint32_t)(cval >> 32)) : "memory");
+}
+
+static inline uint64_t tick_timer_read_compare(void) {
+    uint32_t lo, hi;
+    __asm volatile ("mrrc p15, 3, %0, %1, c14" : "=r" (lo), "=r" (hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline uint32_t tick_timer_read_ctl(void) {
+    uint32_t val;
+    __asm volatile ("mrc p15, 0, %0, c14, c3, 1" : "=r" (val));
+    return val;
+}
+
+static inline void tick_timer_write_ctl(uint32_t ctl) {
+    __asm volatile ("mcr p15, 0, %0, c14, c3, 1\n"
+                    "isb" :: "r" (ctl) : "memory");
+}
+
+// Counter ticks per RTOS tick, valid after vSetupTickInterrupt().
+uint32_t tick_timer_counts_per_tick(void);
+
+#endif // TICK_TIMER_H
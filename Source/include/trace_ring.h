@@ -0,0 +1,209 @@
+/*
+ * Binary trace of kernel events into a RAM ring per core.
+ *
+ * With configUSE_TRACE_RING set, FreeRTOSConfig.h includes this header and
+ * the kernel's trace macros (task switches, ticks, queue traffic, blocking,
+ * notifications, timer expiry) each append one 16-byte record: a timestamp,
+ * an event ID, an object handle and one event-specific value.  Recording an
+ * event masks IRQs with the CPSR I bit for a handful of stores, so it costs a
+ * few dozen cycles and never reaches the UART or the VMM.
+ *
+ * The rings are linked at TRACE_RING_BASE, so a host-side tool (the QEMU
+ * monitor, qemu_memory_analyzer.py) can pull them out of guest RAM without
+ * the guest's help: read the header, then each core's 'head' and the last
+ * min(head, record_count) records before it.  A ring is a flight recorder:
+ * once full, the oldest records are overwritten.  trace_ring_freeze() stops
+ * recording, so the events leading up to a failure survive; vAssertCalled()
+ * calls it.
+ *
+ * Timestamps are the low 32 bits of the PMU cycle counter, or of the virtual
+ * counter if the hypervisor does not expose the PMU or there is more than one
+ * core (each core's PMU counts separately).  The header says which, and at
+ * what rate.  The port resets the cycle counter when the scheduler starts,
+ * which the TRACE_EV_SCHEDULER_START record marks.
+ *
+ * Nothing is recorded until trace_ring_init() runs, so builds whose main()
+ * does not call it (the latency benchmark) only pay a test and a branch.
+ */
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <stdint.h>
+
+// Fixed address of trace_ring_area_t, and the RAM link.ld reserves for it.
+#define TRACE_RING_BASE         0x40F00000UL
+#define TRACE_RING_REGION_SIZE  0x00100000UL
+
+// Records per core; a power of two.
+#define TRACE_RING_RECORDS      2048
+
+#define TRACE_RING_MAGIC        0x54524345UL    // "TRCE", written last by init
+#define TRACE_RING_VERSION      1
+
+// trace_ring_header_t.clock_source
+#define TRACE_CLOCK_PMU         0               // PMCCNTR, one per core
+#define TRACE_CLOCK_VIRTUAL     1               // CNTVCT, common to all cores
+
+// Event IDs.  The object is the handle named, 0 if none; the value is
+// described where it is not 0.
+enum {
+    TRACE_EV_NONE = 0,
+    TRACE_EV_SCHEDULER_START,       // Idle task of core 0
+    TRACE_EV_TASK_SWITCHED_IN,      // Task; priority
+    TRACE_EV_TASK_SWITCHED_OUT,     // Task
+    TRACE_EV_TASK_INCREMENT_TICK,   // -; tick count before the increment
+    TRACE_EV_TASK_READY,            // Task
+    TRACE_EV_TASK_CREATE,           // Task; priority
+    TRACE_EV_TASK_DELETE,           // Task
+    TRACE_EV_TASK_DELAY,            // Current task; ticks to delay
+    TRACE_EV_TASK_DELAY_UNTIL,      // Current task; tick to wake at
+    TRACE_EV_TASK_PRIORITY_SET,     // Task; new priority
+    TRACE_EV_TASK_PRIORITY_INHERIT, // Mutex holder; inherited priority
+    TRACE_EV_TASK_PRIORITY_DISINHERIT, // Mutex holder; restored priority
+    TRACE_EV_TASK_SUSPEND,          // Task
+    TRACE_EV_TASK_RESUME,           // Task
+    TRACE_EV_TASK_RESUME_FROM_ISR,  // Task
+    TRACE_EV_QUEUE_SEND,            // Queue; items waiting before the send
+    TRACE_EV_QUEUE_SEND_FAILED,     // Queue
+    TRACE_EV_QUEUE_SEND_FROM_ISR,   // Queue; items waiting before the send
+    TRACE_EV_QUEUE_SEND_FROM_ISR_FAILED, // Queue
+    TRACE_EV_QUEUE_RECEIVE,         // Queue; items waiting before the receive
+    TRACE_EV_QUEUE_RECEIVE_FAILED,  // Queue
+    TRACE_EV_QUEUE_RECEIVE_FROM_ISR, // Queue; items waiting before the receive
+    TRACE_EV_QUEUE_RECEIVE_FROM_ISR_FAILED, // Queue
+    TRACE_EV_BLOCKING_ON_QUEUE_SEND, // Queue
+    TRACE_EV_BLOCKING_ON_QUEUE_RECEIVE, // Queue
+    TRACE_EV_BLOCKING_ON_QUEUE_PEEK, // Queue
+    TRACE_EV_TASK_NOTIFY,           // Task notified; index
+    TRACE_EV_TASK_NOTIFY_FROM_ISR,  // Task notified; index
+    TRACE_EV_TASK_NOTIFY_GIVE_FROM_ISR, // Task notified; index
+    TRACE_EV_TASK_NOTIFY_TAKE_BLOCK, // Current task; index
+    TRACE_EV_TASK_NOTIFY_WAIT_BLOCK, // Current task; index
+    TRACE_EV_TIMER_EXPIRED,         // Timer
+    TRACE_EV_LOW_POWER_IDLE_BEGIN,  // -; expected idle ticks
+    TRACE_EV_LOW_POWER_IDLE_END,
+    TRACE_EV_IRQ,                   // -; interrupt ID (irq_dispatch.c)
+    TRACE_EV_COUNT
+};
+
+typedef struct {
+    uint32_t timestamp;
+    uint32_t event;
+    uint32_t object;
+    uint32_t value;
+} trace_record_t;
+
+typedef struct {
+    volatile uint32_t magic;
+    uint32_t version;
+    uint32_t core_count;
+    uint32_t record_count;      // Per core
+    uint32_t record_size;
+    uint32_t clock_source;      // TRACE_CLOCK_*
+    uint32_t clock_hz;
+    volatile uint32_t frozen;   // Non-zero once trace_ring_freeze() has run
+    uint8_t pad[32];
+} trace_ring_header_t;
+
+typedef struct {
+    volatile uint32_t head;     // Records written, free-running
+    uint8_t pad[60];
+    trace_record_t records[TRACE_RING_RECORDS];
+} trace_ring_core_t;
+
+typedef struct {
+    trace_ring_header_t header;
+    trace_ring_core_t core[configNUMBER_OF_CORES];
+} trace_ring_area_t;
+
+// Format the rings and start recording.  Boot only, on core 0, before the
+// scheduler starts.
+void trace_ring_init(void);
+
+// Append one record to this core's ring.  Any context.
+void trace_ring_record(uint32_t event, uint32_t object, uint32_t value);
+
+// Stop recording on every core and clean the rings to RAM.  Any context.
+void trace_ring_freeze(void);
+
+// Kernel trace macros.  These expand inside tasks.c, queue.c and timers.c,
+// where the TCB and queue types are visible.
+#define TRACE_RING_HANDLE( x )  ( ( uint32_t ) ( uintptr_t ) ( x ) )
+
+#if ( configNUMBER_OF_CORES > 1 )
+    #define TRACE_RING_CURRENT_TCB    pxCurrentTCBs[ portGET_CORE_ID() ]
+#else
+    #define TRACE_RING_CURRENT_TCB    pxCurrentTCB
+#endif
+
+#define traceSTARTING_SCHEDULER( xIdleTaskHandles ) \
+    trace_ring_record( TRACE_EV_SCHEDULER_START, TRACE_RING_HANDLE( ( xIdleTaskHandles )[ 0 ] ), 0 )
+#define traceTASK_SWITCHED_IN() \
+    trace_ring_record( TRACE_EV_TASK_SWITCHED_IN, TRACE_RING_HANDLE( TRACE_RING_CURRENT_TCB ), TRACE_RING_CURRENT_TCB->uxPriority )
+#define traceTASK_SWITCHED_OUT() \
+    trace_ring_record( TRACE_EV_TASK_SWITCHED_OUT, TRACE_RING_HANDLE( TRACE_RING_CURRENT_TCB ), 0 )
+#define traceTASK_INCREMENT_TICK( xTickCount ) \
+    trace_ring_record( TRACE_EV_TASK_INCREMENT_TICK, 0, ( uint32_t ) ( xTickCount ) )
+#define traceMOVED_TASK_TO_READY_STATE( pxTCB ) \
+    trace_ring_record( TRACE_EV_TASK_READY, TRACE_RING_HANDLE( pxTCB ), 0 )
+#define traceTASK_CREATE( pxNewTCB ) \
+    trace_ring_record( TRACE_EV_TASK_CREATE, TRACE_RING_HANDLE( pxNewTCB ), ( pxNewTCB )->uxPriority )
+#define traceTASK_DELETE( pxTaskToDelete ) \
+    trace_ring_record( TRACE_EV_TASK_DELETE, TRACE_RING_HANDLE( pxTaskToDelete ), 0 )
+#define traceTASK_DELAY() \
+    trace_ring_record( TRACE_EV_TASK_DELAY, TRACE_RING_HANDLE( TRACE_RING_CURRENT_TCB ), ( uint32_t ) xTicksToDelay )
+#define traceTASK_DELAY_UNTIL( xTimeToWake ) \
+    trace_ring_record( TRACE_EV_TASK_DELAY_UNTIL, TRACE_RING_HANDLE( TRACE_RING_CURRENT_TCB ), ( uint32_t ) ( xTimeToWake ) )
+#define traceTASK_PRIORITY_SET( pxTask, uxNewPriority ) \
+    trace_ring_record( TRACE_EV_TASK_PRIORITY_SET, TRACE_RING_HANDLE( pxTask ), ( uint32_t ) ( uxNewPriority ) )
+#define traceTASK_PRIORITY_INHERIT( pxTCBOfMutexHolder, uxInheritedPriority ) \
+    trace_ring_record( TRACE_EV_TASK_PRIORITY_INHERIT, TRACE_RING_HANDLE( pxTCBOfMutexHolder ), ( uint32_t ) ( uxInheritedPriority ) )
+#define traceTASK_PRIORITY_DISINHERIT( pxTCBOfMutexHolder, uxOriginalPriority ) \
+    trace_ring_record( TRACE_EV_TASK_PRIORITY_DISINHERIT, TRACE_RING_HANDLE( pxTCBOfMutexHolder ), ( uint32_t ) ( uxOriginalPriority ) )
+#define traceTASK_SUSPEND( pxTaskToSuspend ) \
+    trace_ring_record( TRACE_EV_TASK_SUSPEND, TRACE_RING_HANDLE( pxTaskToSuspend ), 0 )
+#define traceTASK_RESUME( pxTaskToResume ) \
+    trace_ring_record( TRACE_EV_TASK_RESUME, TRACE_RING_HANDLE( pxTaskToResume ), 0 )
+#define traceTASK_RESUME_FROM_ISR( pxTaskToResume ) \
+    trace_ring_record( TRACE_EV_TASK_RESUME_FROM_ISR, TRACE_RING_HANDLE( pxTaskToResume ), 0 )
+#define traceQUEUE_SEND( pxQueue ) \
+    trace_ring_record( TRACE_EV_QUEUE_SEND, TRACE_RING_HANDLE( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_SEND_FAILED( pxQueue ) \
+    trace_ring_record( TRACE_EV_QUEUE_SEND_FAILED, TRACE_RING_HANDLE( pxQueue ), 0 )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue ) \
+    trace_ring_record( TRACE_EV_QUEUE_SEND_FROM_ISR, TRACE_RING_HANDLE( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue ) \
+    trace_ring_record( TRACE_EV_QUEUE_SEND_FROM_ISR_FAILED, TRACE_RING_HANDLE( pxQueue ), 0 )
+#define traceQUEUE_RECEIVE( pxQueue ) \
+    trace_ring_record( TRACE_EV_QUEUE_RECEIVE, TRACE_RING_HANDLE( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue ) \
+    trace_ring_record( TRACE_EV_QUEUE_RECEIVE_FAILED, TRACE_RING_HANDLE( pxQueue ), 0 )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue ) \
+    trace_ring_record( TRACE_EV_QUEUE_RECEIVE_FROM_ISR, TRACE_RING_HANDLE( pxQueue ), ( pxQueue )->uxMessagesWaiting )
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue ) \
+    trace_ring_record( TRACE_EV_QUEUE_RECEIVE_FROM_ISR_FAILED, TRACE_RING_HANDLE( pxQueue ), 0 )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue ) \
+    trace_ring_record( TRACE_EV_BLOCKING_ON_QUEUE_SEND, TRACE_RING_HANDLE( pxQueue ), 0 )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue ) \
+    trace_ring_record( TRACE_EV_BLOCKING_ON_QUEUE_RECEIVE, TRACE_RING_HANDLE( pxQueue ), 0 )
+#define traceBLOCKING_ON_QUEUE_PEEK( pxQueue ) \
+    trace_ring_record( TRACE_EV_BLOCKING_ON_QUEUE_PEEK, TRACE_RING_HANDLE( pxQueue ), 0 )
+#define traceTASK_NOTIFY( uxIndexToNotify ) \
+    trace_ring_record( TRACE_EV_TASK_NOTIFY, TRACE_RING_HANDLE( pxTCB ), ( uint32_t ) ( uxIndexToNotify ) )
+#define traceTASK_NOTIFY_FROM_ISR( uxIndexToNotify ) \
+    trace_ring_record( TRACE_EV_TASK_NOTIFY_FROM_ISR, TRACE_RING_HANDLE( pxTCB ), ( uint32_t ) ( uxIndexToNotify ) )
+#define traceTASK_NOTIFY_GIVE_FROM_ISR( uxIndexToNotify ) \
+    trace_ring_record( TRACE_EV_TASK_NOTIFY_GIVE_FROM_ISR, TRACE_RING_HANDLE( pxTCB ), ( uint32_t ) ( uxIndexToNotify ) )
+#define traceTASK_NOTIFY_TAKE_BLOCK( uxIndexToWait ) \
+    trace_ring_record( TRACE_EV_TASK_NOTIFY_TAKE_BLOCK, TRACE_RING_HANDLE( TRACE_RING_CURRENT_TCB ), ( uint32_t ) ( uxIndexToWait ) )
+#define traceTASK_NOTIFY_WAIT_BLOCK( uxIndexToWait ) \
+    trace_ring_record( TRACE_EV_TASK_NOTIFY_WAIT_BLOCK, TRACE_RING_HANDLE( TRACE_RING_CURRENT_TCB ), ( uint32_t ) ( uxIndexToWait ) )
+#define traceTIMER_EXPIRED( pxTimer ) \
+    trace_ring_record( TRACE_EV_TIMER_EXPIRED, TRACE_RING_HANDLE( pxTimer ), 0 )
+#define traceLOW_POWER_IDLE_BEGIN() \
+    trace_ring_record( TRACE_EV_LOW_POWER_IDLE_BEGIN, 0, ( uint32_t ) xExpectedIdleTime )
+#define traceLOW_POWER_IDLE_END() \
+    trace_ring_record( TRACE_EV_LOW_POWER_IDLE_END, 0, 0 )
+
+#endif // TRACE_RING_H
@@ -0,0 +1,45 @@
+/*
+ * Buffered, interrupt-driven PL011 UART driver.
+ *
+ * Output is queued in a stream buffer and drained by the PL011 TX interrupt.
+ * Before the scheduler runs, and after uart_enter_polled_mode(), output is
+ * written synchronously by polling the TX FIFO flag instead.
+ */
+
+#ifndef UART_H
+#define UART_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// PL011 UART0 on the virt platform (pl011@9000000, SPI 1)
+#define UART0_BASE          0x9000000
+#define UART0_IRQ_ID        33
+
+// Size of the TX ring; one full boot banner fits without back-pressure.
+#define UART_TX_BUFFER_SIZE 2048
+
+// Set up the PL011 and TX ring.  Call once from main() before any output
+// is expected to be buffered; writes before this are simply polled.
+void uart_init(void);
+
+// Task/critical-section context.  Never drops data: if the ring is full the
+// caller waits for the FIFO to drain.
+void uart_putc(char c);
+size_t uart_write(const char *buf, size_t len);
+
+// ISR context (interrupts at or below configMAX_API_CALL_INTERRUPT_PRIORITY).
+// Never waits; returns the number of bytes queued, the rest is dropped and
+// counted in uart_tx_dropped().
+size_t uart_write_from_isr(const char *buf, size_t len);
+
+// Flush what is queued and write everything synchronously from now on.
+// Used by fatal paths (asserts) that may run with interrupts masked.
+void uart_enter_polled_mode(void);
+
+// PL011 interrupt handler, called from the application IRQ dispatcher.
+void uart_irq_handler(void);
+
+uint32_t uart_tx_dropped(void);
+
+#endif // UART_H
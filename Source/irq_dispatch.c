@@ -0,0 +1,314 @@
+/*
+ * Application IRQ handlers called by FreeRTOS_IRQ_Handler with the value read
+ * from ICCIAR - see irq_dispatch.h.
+ *
+ * vApplicationIRQHandler() replaces portASM.S's default, which always saves
+ * the FPU registers: IRQ_FLAG_NO_FPU entries run from here, everything else
+ * goes through vPortCallFPUSafeIRQHandler() to vApplicationFPUSafeIRQHandler().
+ * Neither may touch the VFP registers themselves.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "gic.h"
+#include "tick_timer.h"
+#include "uart.h"
+#include "spsc_ring.h"
+#include "irq_dispatch.h"
+
+typedef struct {
+    irq_handler_t handler;     // NULL if the interrupt has no entry
+    void *arg;
+    uint32_t flags;
+} irq_entry_t;
+
+static void irq_tick(uint32_t id, void *arg) {
+    (void)id;
+    (void)arg;
+    FreeRTOS_Tick_Handler();
+}
+
+static void irq_uart(uint32_t id, void *arg) {
+    (void)id;
+    (void)arg;
+    uart_irq_handler();
+}
+
+#if ( configNUMBER_OF_CORES > 1 )
+static void irq_yield_core(uint32_t id, void *arg) {
+    (void)id;
+    (void)arg;
+    FreeRTOS_Yield_Core_Handler();
+}
+#endif
+
+static irq_entry_t irq_table[IRQ_TABLE_SIZE] = {
+    [TICK_TIMER_IRQ_ID] = { irq_tick, NULL, 0 },
+    [UART0_IRQ_ID] = { irq_uart, NULL, 0 },
+#if ( configNUMBER_OF_CORES > 1 )
+    [configYIELD_CORE_SGI_ID] = { irq_yield_core, NULL, IRQ_FLAG_NO_FPU },
+#endif
+};
+
+__attribute__((weak)) void vApplicationSGIHandler(uint32_t id) {
+    (void)id;
+}
+
+#if ( configUSE_IRQ_STATS == 1 )
+static irq_stats_t irq_stats[configNUMBER_OF_CORES][IRQ_TABLE_SIZE];
+
+#if ( configNUMBER_OF_CORES == 1 )
+extern volatile uint32_t ulPortInterruptNesting;
+#define IRQ_NESTING()       ulPortInterruptNesting
+#else
+extern volatile uint32_t ulPortInterruptNesting[configNUMBER_OF_CORES];
+#define IRQ_NESTING()       ulPortInterruptNesting[portGET_CORE_ID()]
+#endif
+
+static inline uint32_t irq_now(void) {
+    return (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+}
+#endif
+
+static void irq_notify(uint32_t id, void *arg) {
+    BaseType_t woken = pdFALSE;
+
+    if (irq_table[id].flags & IRQ_FLAG_ONESHOT) {
+        gic_disable_irq(id);
+    }
+    vTaskNotifyGiveFromISR((TaskHandle_t)arg, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Run the handler of a table entry, timing it.
+static inline void irq_call(uint32_t id, irq_handler_t handler, void *arg) {
+#if ( configUSE_IRQ_STATS == 1 )
+    uint32_t start = irq_now();
+    irq_stats_t *st;
+    uint32_t elapsed;
+
+    handler(id, arg);
+
+    // The same ID cannot preempt itself, and each core has its own stats
+    elapsed = irq_now() - start;
+    st = &irq_stats[portGET_CORE_ID()][id];
+    if (elapsed > st->max_handler) {
+        st->max_handler = elapsed;
+    }
+#else
+    handler(id, arg);
+#endif
+}
+
+void vApplicationIRQHandler(uint32_t ulICCIAR) {
+    uint32_t id = ulICCIAR & GIC_INTID_MASK;
+    irq_handler_t handler = NULL;
+    void *arg = NULL;
+#if ( configUSE_IRQ_STATS == 1 )
+    uint32_t start = irq_now();
+    uint32_t nesting = IRQ_NESTING();
+#endif
+
+#if ( configUSE_TRACE_RING == 1 )
+    trace_ring_record(TRACE_EV_IRQ, 0, id);
+#endif
+
+    if (id < IRQ_TABLE_SIZE) {
+        const irq_entry_t *e = &irq_table[id];
+
+        if (e->flags & IRQ_FLAG_NO_FPU) {
+            handler = e->handler;
+            arg = e->arg;
+        }
+    }
+
+#if ( configUSE_NESTED_INTERRUPTS == 1 )
+    // The GIC's running priority is now this interrupt's, so only higher
+    // priority ones get through.
+    __asm volatile ("cpsie i" ::: "memory");
+#endif
+    if (handler != NULL) {
+        irq_call(id, handler, arg);
+    } else {
+        vPortCallFPUSafeIRQHandler(ulICCIAR);
+    }
+#if ( configUSE_NESTED_INTERRUPTS == 1 )
+    __asm volatile ("cpsid i" ::: "memory");
+#endif
+
+#if ( configUSE_IRQ_STATS == 1 )
+    if (id < IRQ_TABLE_SIZE) {
+        irq_stats_t *st = &irq_stats[portGET_CORE_ID()][id];
+        uint32_t elapsed = irq_now() - start;
+
+        st->count++;
+        if (nesting > st->max_nesting) {
+            st->max_nesting = nesting;
+        }
+        if (elapsed > st->max_ack_to_eoi) {
+            st->max_ack_to_eoi = elapsed;
+        }
+    }
+#endif
+}
+
+void vApplicationFPUSafeIRQHandler(uint32_t ulICCIAR) {
+    uint32_t id = ulICCIAR & GIC_INTID_MASK;
+
+    if (id < IRQ_TABLE_SIZE) {
+        const irq_entry_t *e = &irq_table[id];
+        irq_handler_t handler = e->handler;
+
+        if (handler != NULL) {
+            irq_call(id, handler, e->arg);
+            return;
+        }
+    }
+
+    if (id == GIC_SPURIOUS_ID || spsc_ring_irq_handler(id)) {
+        return;
+    }
+    if (id < GIC_SGI_COUNT) {
+        vApplicationSGIHandler(id);
+        return;
+    }
+    // Nobody owns this interrupt - stop it from firing again.
+    gic_disable_irq(id);
+}
+
+int irq_register(uint32_t id, irq_handler_t handler, void *arg, uint32_t priority, uint32_t flags) {
+    irq_entry_t *e;
+    int ret = -1;
+
+    if (id >= IRQ_TABLE_SIZE || handler == NULL) {
+        return -1;
+    }
+#if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 )
+    // Critical sections mask every interrupt with the CPSR I bit, so one above
+    // configMAX_API_CALL_INTERRUPT_PRIORITY would not preempt the kernel.  Such
+    // a build has to keep the priority mask scheme.
+    configASSERT(priority >= configMAX_API_CALL_INTERRUPT_PRIORITY);
+#endif
+    e = &irq_table[id];
+
+    taskENTER_CRITICAL();
+    if (e->handler == NULL) {
+        e->arg = arg;
+        e->flags = flags;
+        __asm volatile ("dmb ish" ::: "memory");
+        e->handler = handler;
+        ret = 0;
+    }
+    taskEXIT_CRITICAL();
+    if (ret < 0) {
+        return -1;
+    }
+
+    gic_set_priority(id, priority);
+    if (id >= GIC_SPI_BASE) {
+        gic_set_target(id, 1);
+    }
+    gic_enable_irq(id);
+    return 0;
+}
+
+int irq_bind_notify(uint32_t id, TaskHandle_t task, uint32_t priority, uint32_t flags) {
+    configASSERT(task != NULL);
+    configASSERT(priority >= configMAX_API_CALL_INTERRUPT_PRIORITY);
+
+    return irq_register(id, irq_notify, task, priority, (flags & IRQ_FLAG_ONESHOT) | IRQ_FLAG_NO_FPU);
+}
+
+void irq_unregister(uint32_t id) {
+    irq_entry_t *e;
+
+    if (id >= IRQ_TABLE_SIZE) {
+        return;
+    }
+    e = &irq_table[id];
+
+    gic_disable_irq(id);
+    taskENTER_CRITICAL();
+    e->handler = NULL;
+    e->arg = NULL;
+    e->flags = 0;
+    taskEXIT_CRITICAL();
+}
+
+void irq_unmask(uint32_t id) {
+    gic_enable_irq(id);
+}
+
+int irq_stats_get(uint32_t id, irq_stats_t *stats) {
+#if ( configUSE_IRQ_STATS == 1 )
+    if (id >= IRQ_TABLE_SIZE) {
+        return -1;
+    }
+
+    stats->count = 0;
+    stats->max_nesting = 0;
+    stats->max_handler = 0;
+    stats->max_ack_to_eoi = 0;
+    for (uint32_t c = 0; c < configNUMBER_OF_CORES; c++) {
+        const irq_stats_t *st = &irq_stats[c][id];
+
+        stats->count += st->count;
+        if (st->max_nesting > stats->max_nesting) {
+            stats->max_nesting = st->max_nesting;
+        }
+        if (st->max_handler > stats->max_handler) {
+            stats->max_handler = st->max_handler;
+        }
+        if (st->max_ack_to_eoi > stats->max_ack_to_eoi) {
+            stats->max_ack_to_eoi = st->max_ack_to_eoi;
+        }
+    }
+    return 0;
+#else
+    (void)id;
+    (void)stats;
+    return -1;
+#endif
+}
+
+void irq_stats_reset(void) {
+#if ( configUSE_IRQ_STATS == 1 )
+    taskENTER_CRITICAL();
+    for (uint32_t c = 0; c < configNUMBER_OF_CORES; c++) {
+        for (uint32_t id = 0; id < IRQ_TABLE_SIZE; id++) {
+            irq_stats[c][id] = (irq_stats_t){ 0 };
+        }
+    }
+    taskEXIT_CRITICAL();
+#endif
+}
+
+uint32_t irq_stack_unused(uint32_t core) {
+    // startup.S: core 0's stack is the top one, and all are painted at boot
+    extern const uint32_t stack_base[];
+    const uint32_t words = (1UL << configISR_STACK_SHIFT) / sizeof(uint32_t);
+    const uint32_t *p;
+    uint32_t n = 0;
+
+    if (core >= configNUMBER_OF_CORES) {
+        return 0;
+    }
+    p = stack_base + (configNUMBER_OF_CORES - 1 - core) * words;
+    while (n < words && p[n] == 0xA5A5A5A5UL) {
+        n++;
+    }
+    return n * sizeof(uint32_t);
+}
+
+#if ( configNUMBER_OF_CORES > 1 )
+// configSETUP_CORE_INTERRUPTS: called on each core before it starts its
+// first task.  The CPU interface and SGI/PPI enables are banked per core;
+// core 0's were set up with the tick interrupt.
+void vSetupCoreInterrupts(long xCoreID) {
+    if (xCoreID != 0) {
+        gic_init_cpu();
+    }
+    gic_set_priority(configYIELD_CORE_SGI_ID, portLOWEST_USABLE_INTERRUPT_PRIORITY);
+    gic_enable_irq(configYIELD_CORE_SGI_ID);
+}
+#endif
@@ -0,0 +1,358 @@
+/*
+ * Deferred logging - see log.h.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "uart.h"
+#include "static_alloc.h"
+#include "log.h"
+
+// A queue entry.  'seq' is the producer's reservation number plus one once
+// the entry is complete, so the logger can tell a filled slot from one that
+// a preempted producer is still writing.
+typedef struct {
+    volatile uint32_t seq;
+    const char *fmt;
+    uint32_t tick;
+    uint16_t level;
+    uint16_t nargs;
+    uint32_t args[LOG_MAX_ARGS];
+} log_entry_t;
+
+static log_entry_t log_queue[LOG_QUEUE_ENTRIES];
+static volatile uint32_t log_head;      // Reserved by producers
+static volatile uint32_t log_tail;      // Released by the logger
+static volatile uint32_t log_drop_count;
+static volatile uint32_t log_level = LOG_COMPILE_LEVEL;
+
+static StackType_t log_stack[LOG_TASK_STACK_DEPTH] TASK_STACK_SECTION;
+static StaticTask_t log_tcb KERNEL_OBJECT_SECTION;
+
+static const char log_level_chars[] = { 'E', 'W', 'I', 'D' };
+
+static inline void log_dmb(void) {
+    __asm volatile ("dmb ish" ::: "memory");
+}
+
+static void log_atomic_inc(volatile uint32_t *p) {
+    uint32_t val, failed;
+
+    do {
+        __asm volatile ("ldrex %0, [%2]\n"
+                        "add %0, %0, #1\n"
+                        "strex %1, %0, [%2]"
+                        : "=&r" (val), "=&r" (failed)
+                        : "r" (p)
+                        : "memory");
+    } while (failed);
+}
+
+// Claim the next entry, or return 0 if the queue is full.
+static int log_reserve(uint32_t *slot) {
+    uint32_t head, failed;
+
+    do {
+        __asm volatile ("ldrex %0, [%1]" : "=&r" (head) : "r" (&log_head) : "memory");
+        if (head - log_tail >= LOG_QUEUE_ENTRIES) {
+            __asm volatile ("clrex" ::: "memory");
+            return 0;
+        }
+        __asm volatile ("strex %0, %2, [%1]" : "=&r" (failed) : "r" (&log_head), "r" (head + 1) : "memory");
+    } while (failed);
+
+    *slot = head;
+    return 1;
+}
+
+void log_write(uint32_t level, const char *fmt, uint32_t nargs, ...) {
+    log_entry_t *e;
+    uint32_t slot;
+    va_list ap;
+
+    if (level > log_level) {
+        return;
+    }
+    if (!log_reserve(&slot)) {
+        log_atomic_inc(&log_drop_count);
+        return;
+    }
+
+    e = &log_queue[slot & (LOG_QUEUE_ENTRIES - 1)];
+    e->fmt = fmt;
+    e->tick = xTaskGetTickCountFromISR();
+    e->level = (uint16_t)level;
+    e->nargs = (uint16_t)nargs;
+    va_start(ap, nargs);
+    for (uint32_t i = 0; i < nargs; i++) {
+        e->args[i] = va_arg(ap, uint32_t);
+    }
+    va_end(ap);
+
+    log_dmb();
+    e->seq = slot + 1;
+}
+
+void log_set_level(uint32_t level) {
+    log_level = level;
+}
+
+uint32_t log_dropped(void) {
+    return log_drop_count;
+}
+
+/*-----------------------------------------------------------*/
+/* Formatter */
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    const uint32_t *args;   // Array source, or
+    uint32_t nargs;
+    va_list *ap;            // va_list source
+} log_out_t;
+
+static void out_char(log_out_t *o, char c) {
+    if (o->len + 1 < o->size) {
+        o->buf[o->len++] = c;
+    }
+}
+
+static void out_pad(log_out_t *o, char c, int count) {
+    while (count-- > 0) {
+        out_char(o, c);
+    }
+}
+
+static uint32_t next_word(log_out_t *o) {
+    if (o->ap) {
+        return va_arg(*o->ap, uint32_t);
+    }
+    if (o->nargs > 0) {
+        o->nargs--;
+        return *o->args++;
+    }
+    return 0;
+}
+
+static const char *next_string(log_out_t *o) {
+    if (o->ap) {
+        return va_arg(*o->ap, const char *);
+    }
+    return (const char *)(uintptr_t)next_word(o);
+}
+
+static size_t format(log_out_t *o, const char *fmt) {
+    static const char digits_lower[] = "0123456789abcdef";
+    static const char digits_upper[] = "0123456789ABCDEF";
+
+    if (o->size == 0) {
+        return 0;
+    }
+
+    while (*fmt) {
+        char tmp[11];
+        const char *digits = digits_lower;
+        int left = 0, width = 0, n = 0, negative = 0;
+        char pad = ' ';
+        uint32_t val, base = 10;
+
+        if (*fmt != '%') {
+            out_char(o, *fmt++);
+            continue;
+        }
+        fmt++;
+        for (;; fmt++) {
+            if (*fmt == '-') {
+                left = 1;
+            } else if (*fmt == '0') {
+                pad = '0';
+            } else {
+                break;
+            }
+        }
+        while (*fmt >= '0' && *fmt <= '9') {
+            width = width * 10 + (*fmt++ - '0');
+        }
+        while (*fmt == 'l') {
+            fmt++;
+        }
+
+        switch (*fmt) {
+            case '\0':
+                continue;
+
+            case '%':
+                out_char(o, '%');
+                fmt++;
+                continue;
+
+            case 'c':
+                tmp[n++] = (char)next_word(o);
+                break;
+
+            case 's': {
+                const char *s = next_string(o);
+                int len = 0;
+
+                if (s == NULL) {
+                    s = "(null)";
+                }
+                while (s[len]) {
+                    len++;
+                }
+                if (!left) {
+                    out_pad(o, ' ', width - len);
+                }
+                for (int i = 0; i < len; i++) {
+                    out_char(o, s[i]);
+                }
+                if (left) {
+                    out_pad(o, ' ', width - len);
+                }
+                fmt++;
+                continue;
+            }
+
+            case 'd':
+            case 'i':
+                val = next_word(o);
+                if ((int32_t)val < 0) {
+                    negative = 1;
+                    val = 0U - val;
+                }
+                goto number;
+
+            case 'p':
+                out_char(o, '0');
+                out_char(o, 'x');
+                pad = '0';
+                width = 8;
+                /* fall through */
+            case 'x':
+            case 'X':
+                digits = (*fmt == 'X') ? digits_upper : digits_lower;
+                base = 16;
+                /* fall through */
+            case 'u':
+                val = next_word(o);
+number:
+                do {
+                    tmp[n++] = digits[val % base];
+                    val /= base;
+                } while (val > 0);
+                break;
+
+            default:
+                // Unknown conversion: print it as it stands
+                out_char(o, '%');
+                out_char(o, *fmt++);
+                continue;
+        }
+
+        // tmp holds the digits (or the char) in reverse
+        width -= n + negative;
+        if (negative && pad == '0') {
+            out_char(o, '-');
+        }
+        if (!left) {
+            out_pad(o, pad, width);
+        }
+        if (negative && pad != '0') {
+            out_char(o, '-');
+        }
+        while (n > 0) {
+            out_char(o, tmp[--n]);
+        }
+        if (left) {
+            out_pad(o, ' ', width);
+        }
+        fmt++;
+    }
+
+    o->buf[o->len] = '\0';
+    return o->len;
+}
+
+size_t log_format(char *buf, size_t size, const char *fmt, const uint32_t *args, uint32_t nargs) {
+    log_out_t o = { buf, size, 0, args, nargs, NULL };
+
+    return format(&o, fmt);
+}
+
+size_t log_vformat(char *buf, size_t size, const char *fmt, va_list ap) {
+    log_out_t o = { buf, size, 0, NULL, 0, NULL };
+    va_list copy;
+    size_t len;
+
+    va_copy(copy, ap);
+    o.ap = &copy;
+    len = format(&o, fmt);
+    va_end(copy);
+    return len;
+}
+
+/*-----------------------------------------------------------*/
+/* Logger */
+
+// Format and write out the oldest complete entry.  Returns 0 if there is
+// none.  Only one context may drain at a time.
+static int log_drain_one(void) {
+    uint32_t tail = log_tail;
+    log_entry_t *e = &log_queue[tail & (LOG_QUEUE_ENTRIES - 1)];
+    log_entry_t copy;
+    char line[LOG_LINE_MAX];
+    size_t len;
+
+    if (tail == log_head || e->seq != tail + 1) {
+        return 0;   // Empty, or the producer has not finished the entry
+    }
+    log_dmb();
+    copy = *e;
+    log_dmb();
+    log_tail = tail + 1;    // The slot may be reused from here
+
+    len = log_format(line, sizeof(line), "[%8u] %c: ", (const uint32_t[]){ copy.tick, (uint32_t)log_level_chars[copy.level & 3] }, 2);
+    len += log_format(line + len, sizeof(line) - len, copy.fmt, copy.args, copy.nargs);
+    uart_write(line, len);
+    uart_write("\r\n", 2);
+    return 1;
+}
+
+static void log_report_drops(uint32_t *reported) {
+    uint32_t dropped = log_drop_count;
+    char line[48];
+
+    if (dropped != *reported) {
+        size_t len = log_format(line, sizeof(line), "[log] %u messages dropped\r\n", (const uint32_t[]){ dropped - *reported }, 1);
+
+        uart_write(line, len);
+        *reported = dropped;
+    }
+}
+
+static void vLogTask(void *pvParameters) {
+    uint32_t reported = 0;
+
+    (void)pvParameters;
+
+    for (;;) {
+        while (log_drain_one()) {
+        }
+        log_report_drops(&reported);
+        vTaskDelay(pdMS_TO_TICKS(LOG_FLUSH_MS));
+    }
+}
+
+void log_init(void) {
+    xTaskCreateStatic(vLogTask, "Log", LOG_TASK_STACK_DEPTH, NULL, LOG_TASK_PRIORITY, log_stack, &log_tcb);
+}
+
+void log_flush(void) {
+    uint32_t reported = 0;
+
+    while (log_drain_one()) {
+    }
+    log_report_drops(&reported);
+}
@@ -0,0 +1,456 @@
+/*
+ * Kernel and port latency benchmarks ("bench" profile in the Makefile)
+ *
+ * Measures, with the PMU cycle counter, the costs that dominate our IPC path
+ * inside the seL4 VM: portYIELD (SWI) round trips, task-to-task handoff through
+ * a semaphore, queue send/receive at several item sizes, and the latency from
+ * raising an interrupt to the woken task running.  Every case collects
+ * BENCH_SAMPLES samples; the summary (min/avg/max, percentiles and a log2
+ * histogram) is printed once everything has run, so UART output does not
+ * disturb the measurements.
+ *
+ * The task switch is also timed with both TCBs evicted from the cache first,
+ * which is what configUSE_TCB_CACHE_LAYOUT is about: compare a "bench" build
+ * with a "bench_legacy_tcb" one.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "gic.h"
+#include "pmu.h"
+#include "tick_timer.h"
+#include "uart.h"
+#include "cache.h"
+#include "rt_string.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define BENCH_SAMPLES       1000
+#define BENCH_MAX_RESULTS   12
+#define BENCH_HIST_BUCKETS  33      // log2 buckets, 0 to 2^32
+#define BENCH_BAR_WIDTH     40
+
+// The controller runs below the helpers it hands off to
+#define BENCH_PRIO_LOW      3
+#define BENCH_PRIO_HIGH     4
+#define BENCH_STACK         (configMINIMAL_STACK_SIZE * 2)
+
+#define BENCH_SGI_ID        1
+
+typedef struct {
+    const char *name;
+    uint32_t min;
+    uint32_t max;
+    uint32_t avg;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint16_t hist[BENCH_HIST_BUCKETS];
+} bench_result_t;
+
+static bench_result_t results[BENCH_MAX_RESULTS];
+static int result_count;
+
+static uint32_t samples[BENCH_SAMPLES];
+static uint32_t samples_isr[BENCH_SAMPLES];
+static volatile uint32_t sample_count;
+static volatile uint32_t sample_isr_count;
+
+static int use_pmu;
+static uint32_t timer_overhead;
+
+static volatile uint32_t stamp;
+static volatile int stamp_valid;
+
+static TaskHandle_t pingpong_tasks[2];
+static volatile int pingpong_cold;
+
+static SemaphoreHandle_t done_sem;
+static SemaphoreHandle_t handoff_sem;
+
+static uint8_t queue_buf[256] __attribute__((aligned(8)));
+static const uint32_t queue_sizes[] = { 4, 16, 64, 256 };
+
+//----------------------------------------------------------------------------
+// Output
+//----------------------------------------------------------------------------
+
+void uart_puts(const char *s) {
+    size_t len = 0;
+    while (s[len]) {
+        len++;
+    }
+    uart_write(s, len);
+}
+
+static void uart_dec_width(uint32_t val, int width) {
+    char buf[10];
+    int i = 0;
+
+    do {
+        buf[i++] = '0' + (val % 10);
+        val /= 10;
+    } while (val > 0);
+    while (width-- > i) {
+        uart_putc(' ');
+    }
+    while (i > 0) {
+        uart_putc(buf[--i]);
+    }
+}
+
+void uart_decimal(unsigned long val) {
+    uart_dec_width(val, 0);
+}
+
+//----------------------------------------------------------------------------
+// Sampling
+//----------------------------------------------------------------------------
+
+static inline uint32_t bench_now(void) {
+    return use_pmu ? pmu_read_cycles() : (uint32_t)tick_timer_read_counter();
+}
+
+static inline void record(uint32_t *buf, volatile uint32_t *count, uint32_t val) {
+    if (*count < BENCH_SAMPLES) {
+        buf[(*count)++] = val;
+    }
+}
+
+static void reset_samples(void) {
+    sample_count = 0;
+    sample_isr_count = 0;
+    stamp_valid = 0;
+}
+
+static void sort_samples(uint32_t *buf, uint32_t n) {
+    // Shell sort: no recursion, no allocation, fast enough for 1000 samples
+    for (uint32_t gap = n / 2; gap > 0; gap /= 2) {
+        for (uint32_t i = gap; i < n; i++) {
+            uint32_t v = buf[i];
+            uint32_t j = i;
+            while (j >= gap && buf[j - gap] > v) {
+                buf[j] = buf[j - gap];
+                j -= gap;
+            }
+            buf[j] = v;
+        }
+    }
+}
+
+static uint32_t log2_bucket(uint32_t v) {
+    return v ? 32 - __builtin_clz(v) : 0;
+}
+
+// Reduce a sample buffer to a result; overhead is the cost of one timestamp.
+static void summarise(const char *name, uint32_t *buf, uint32_t n) {
+    bench_result_t *r;
+    uint64_t sum = 0;
+
+    if (result_count >= BENCH_MAX_RESULTS || n == 0) {
+        return;
+    }
+    r = &results[result_count++];
+
+    for (uint32_t i = 0; i < n; i++) {
+        buf[i] = buf[i] > timer_overhead ? buf[i] - timer_overhead : 0;
+        sum += buf[i];
+    }
+    sort_samples(buf, n);
+
+    r->name = name;
+    r->min = buf[0];
+    r->max = buf[n - 1];
+    r->avg = (uint32_t)(sum / n);
+    r->p50 = buf[(n * 50) / 100];
+    r->p90 = buf[(n * 90) / 100];
+    r->p99 = buf[(n * 99) / 100];
+    for (int b = 0; b < BENCH_HIST_BUCKETS; b++) {
+        r->hist[b] = 0;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        r->hist[log2_bucket(buf[i])]++;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Cases
+//----------------------------------------------------------------------------
+
+static void bench_yield_self(void) {
+    reset_samples();
+    // Nothing else is ready at this priority, so the SWI comes straight back
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t t0 = bench_now();
+        taskYIELD();
+        record(samples, &sample_count, bench_now() - t0);
+    }
+    summarise("yield (no switch)", samples, sample_count);
+}
+
+// Both tasks time the switch from the other one: stamp, yield, and the task
+// switched to takes the difference.
+static void pingpong_loop(void) {
+    while (sample_count < BENCH_SAMPLES) {
+        uint32_t now = bench_now();
+        if (stamp_valid) {
+            record(samples, &sample_count, now - stamp);
+        }
+        if (pingpong_cold) {
+            // The switch then has to fetch every TCB line it touches
+            cache_clean_invalidate_range(pingpong_tasks[0], sizeof(StaticTask_t));
+            cache_clean_invalidate_range(pingpong_tasks[1], sizeof(StaticTask_t));
+        }
+        stamp = bench_now();
+        stamp_valid = 1;
+        taskYIELD();
+    }
+}
+
+static void vPingPongTask(void *pvParameters) {
+    (void)pvParameters;
+    pingpong_loop();
+    xSemaphoreGive(done_sem);
+    vTaskDelete(NULL);
+}
+
+static void bench_yield_switch(int cold) {
+    reset_samples();
+    pingpong_cold = cold;
+    pingpong_tasks[0] = xTaskGetCurrentTaskHandle();
+    xTaskCreate(vPingPongTask, "Pong", BENCH_STACK, NULL, BENCH_PRIO_LOW, &pingpong_tasks[1]);
+    pingpong_loop();
+    xSemaphoreTake(done_sem, portMAX_DELAY);
+    pingpong_cold = 0;
+    summarise(cold ? "yield task->task, cold TCBs" : "yield task->task", samples, sample_count);
+}
+
+// Higher priority waiter: every give from the controller preempts into it.
+static void vHandoffTask(void *pvParameters) {
+    (void)pvParameters;
+    while (sample_count < BENCH_SAMPLES) {
+        xSemaphoreTake(handoff_sem, portMAX_DELAY);
+        record(samples, &sample_count, bench_now() - stamp);
+    }
+    xSemaphoreGive(done_sem);
+    vTaskDelete(NULL);
+}
+
+static void bench_semaphore_handoff(void) {
+    reset_samples();
+    xTaskCreate(vHandoffTask, "Handoff", BENCH_STACK, NULL, BENCH_PRIO_HIGH, NULL);
+    while (sample_count < BENCH_SAMPLES) {
+        stamp = bench_now();
+        xSemaphoreGive(handoff_sem);
+    }
+    xSemaphoreTake(done_sem, portMAX_DELAY);
+    summarise("sem give->take", samples, sample_count);
+}
+
+static void bench_queue(uint32_t item_size, const char *name) {
+    QueueHandle_t q = xQueueCreate(1, item_size);
+
+    if (q == NULL) {
+        uart_puts("queue benchmark: out of heap\r\n");
+        return;
+    }
+    reset_samples();
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        uint32_t t0 = bench_now();
+        xQueueSend(q, queue_buf, 0);
+        xQueueReceive(q, queue_buf, 0);
+        record(samples, &sample_count, bench_now() - t0);
+    }
+    vQueueDelete(q);
+    summarise(name, samples, sample_count);
+}
+
+void vApplicationSGIHandler(uint32_t id) {
+    BaseType_t woken = pdFALSE;
+
+    if (id == BENCH_SGI_ID) {
+        record(samples_isr, &sample_isr_count, bench_now() - stamp);
+        xSemaphoreGiveFromISR(handoff_sem, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static void bench_irq_wake(void) {
+    reset_samples();
+    xTaskCreate(vHandoffTask, "IrqWait", BENCH_STACK, NULL, BENCH_PRIO_HIGH, NULL);
+    while (sample_count < BENCH_SAMPLES) {
+        uint32_t before = sample_count;
+        TickType_t start = xTaskGetTickCount();
+
+        stamp = bench_now();
+        gic_send_sgi(BENCH_SGI_ID);
+
+        // Delivery goes through the VMM, so the SGI can arrive a little after
+        // the write.  Do not re-stamp until the woken task has taken its sample.
+        while (sample_count == before) {
+            if (xTaskGetTickCount() - start > pdMS_TO_TICKS(100)) {
+                uart_puts("SGI benchmark: interrupt not delivered, skipped\r\n");
+                return;
+            }
+        }
+    }
+    xSemaphoreTake(done_sem, portMAX_DELAY);
+    summarise("SGI -> ISR entry", samples_isr, sample_isr_count);
+    summarise("SGI -> task wake", samples, sample_count);
+}
+
+//----------------------------------------------------------------------------
+// Report
+//----------------------------------------------------------------------------
+
+static void print_result(const bench_result_t *r) {
+    int first = BENCH_HIST_BUCKETS, last = 0;
+
+    uart_puts("\r\n--- ");
+    uart_puts(r->name);
+    uart_puts(" ---\r\n");
+    uart_puts("  min ");
+    uart_dec_width(r->min, 0);
+    uart_puts("  avg ");
+    uart_dec_width(r->avg, 0);
+    uart_puts("  max ");
+    uart_dec_width(r->max, 0);
+    uart_puts("  p50 ");
+    uart_dec_width(r->p50, 0);
+    uart_puts("  p90 ");
+    uart_dec_width(r->p90, 0);
+    uart_puts("  p99 ");
+    uart_dec_width(r->p99, 0);
+    uart_puts("\r\n");
+
+    for (int b = 0; b < BENCH_HIST_BUCKETS; b++) {
+        if (r->hist[b]) {
+            if (b < first) {
+                first = b;
+            }
+            last = b;
+        }
+    }
+    for (int b = first; b <= last; b++) {
+        uint32_t lo = b ? 1UL << (b - 1) : 0;
+        uint32_t hi = b ? (b == 32 ? UINT32_MAX : (1UL << b) - 1) : 0;
+        uint32_t bar = (uint32_t)r->hist[b] * BENCH_BAR_WIDTH / BENCH_SAMPLES;
+
+        uart_puts("  [");
+        uart_dec_width(lo, 10);
+        uart_puts(" - ");
+        uart_dec_width(hi, 10);
+        uart_puts("] ");
+        uart_dec_width(r->hist[b], 5);
+        uart_puts(" ");
+        if (bar == 0 && r->hist[b]) {
+            bar = 1;
+        }
+        while (bar--) {
+            uart_putc('#');
+        }
+        uart_puts("\r\n");
+    }
+}
+
+static void vBenchTask(void *pvParameters) {
+    static const char *const queue_names[] = {
+        "queue send+recv 4B",
+        "queue send+recv 16B",
+        "queue send+recv 64B",
+        "queue send+recv 256B",
+    };
+    (void)pvParameters;
+
+    // Under some hypervisors the PMU is not exposed and reads as a constant.
+    pmu_enable_cycle_counter();
+    uint32_t c0 = pmu_read_cycles();
+    for (volatile int i = 0; i < 1000; i++) {}
+    use_pmu = pmu_read_cycles() != c0;
+
+    timer_overhead = UINT32_MAX;
+    for (int i = 0; i < 64; i++) {
+        uint32_t t0 = bench_now();
+        uint32_t d = bench_now() - t0;
+        if (d < timer_overhead) {
+            timer_overhead = d;
+        }
+    }
+
+    bench_yield_self();
+    bench_yield_switch(0);
+    bench_yield_switch(1);
+    bench_semaphore_handoff();
+    for (size_t i = 0; i < sizeof(queue_sizes) / sizeof(queue_sizes[0]); i++) {
+        bench_queue(queue_sizes[i], queue_names[i]);
+    }
+    bench_irq_wake();
+
+    uart_puts("\r\n========================================\r\n");
+    uart_puts("  KERNEL / PORT BENCHMARK RESULTS\r\n");
+    uart_puts("========================================\r\n");
+    uart_puts(use_pmu ? "Units: CPU cycles (PMCCNTR)" : "Units: generic timer counts (PMU unavailable)");
+    uart_puts(", timestamp overhead ");
+    uart_decimal(timer_overhead);
+    uart_puts(" subtracted\r\n");
+    uart_puts("Samples per case: ");
+    uart_decimal(BENCH_SAMPLES);
+    uart_puts("\r\n");
+    uart_puts("TCB: ");
+    uart_decimal(sizeof(StaticTask_t));
+    uart_puts(configUSE_TCB_CACHE_LAYOUT ? " bytes, cache line layout\r\n" : " bytes, legacy layout\r\n");
+    for (int i = 0; i < result_count; i++) {
+        print_result(&results[i]);
+    }
+#if (configUSE_LAZY_FPU_CONTEXT == 1)
+    extern volatile uint32_t ulPortFPUContextSwitches;
+    uart_puts("\r\nLazy FPU context switches: ");
+    uart_decimal(ulPortFPUContextSwitches);
+    uart_puts("\r\n");
+#endif
+    uart_puts("\r\n=== BENCHMARK COMPLETE ===\r\n");
+
+#if RT_STRING_BENCH
+    xTaskCreate(vRtStringBenchTask, "MemBench", BENCH_STACK, NULL, BENCH_PRIO_LOW, NULL);
+#endif
+    vTaskDelete(NULL);
+}
+
+//----------------------------------------------------------------------------
+// Runtime hooks
+//----------------------------------------------------------------------------
+
+void vAssertCalled(unsigned long ulLine, const char * const pcFileName) {
+    uart_enter_polled_mode();
+    uart_puts("\r\nASSERT FAILED at line ");
+    uart_decimal(ulLine);
+    uart_puts(" in ");
+    uart_puts(pcFileName);
+    uart_puts("\r\n");
+    for (;;);
+}
+
+void vApplicationIdleHook(void) {
+}
+
+int main(void) {
+    uart_init();
+    uart_puts("\r\n=== FREERTOS KERNEL/PORT BENCHMARK ===\r\n");
+
+    done_sem = xSemaphoreCreateBinary();
+    handoff_sem = xSemaphoreCreateBinary();
+    configASSERT(done_sem != NULL && handoff_sem != NULL);
+
+    gic_set_priority(BENCH_SGI_ID, portLOWEST_USABLE_INTERRUPT_PRIORITY - 1);
+    gic_enable_irq(BENCH_SGI_ID);
+
+    xTaskCreate(vBenchTask, "Bench", BENCH_STACK, NULL, BENCH_PRIO_LOW, NULL);
+
+    uart_puts("Starting scheduler...\r\n");
+    vTaskStartScheduler();
+
+    uart_puts("CRITICAL ERROR: Scheduler returned unexpectedly!\r\n");
+    for (;;);
+}
@@ -12,9 +12,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
-// PL011 UART registers - matching seL4 VM configuration
-#define UART0_DR (*(volatile unsigned int *)0x9000000)   // Data register
-#define UART0_FR (*(volatile unsigned int *)0x9000018)   // Flag register
+#include "uart.h"
+#include "idle.h"
+#include "cache.h"
+#include "mem_paint.h"
 
 // Memory pattern constants for systematic debugging
 #define PATTERN_STACK   0xDEADBEEF  // Stack region pattern
@@ -34,19 +35,27 @@
 #define PATTERN_SIZE       0x400000   // 4MB for pattern painting
 
 // Enhanced UART functions
-void uart_putc(char c) {
-    UART0_DR = c;
-    for (volatile int i = 0; i < 10000; i++) {}  // Delay for stability
-}
-
 void uart_puts(const char *s) {
+    const char *seg = s;
+
+    // Hand whole lines to the driver, inserting '\r' before each '\n'
     while (*s) {
         if (*s == '\n') {
-            uart_putc('\r');  // Ensure proper line endings
+            uart_write(seg, s - seg);
+            uart_write("\r", 1);  // Ensure proper line endings
+            seg = s;
         }
-        uart_putc(*s);
         s++;
     }
+    uart_write(seg, s - seg);
+}
+
+void uart_hex(unsigned int val) {
+    uart_puts("0x");
+    for (int i = 28; i >= 0; i -= 4) {
+        int digit = (val >> i) & 0xF;
+        uart_putc(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    }
 }
 
 void uart_decimal(unsigned long val) {
@@ -60,16 +69,19 @@ void uart_decimal(unsigned long val) {
     uart_hex((unsigned int)val);
 }
 
-void uart_hex(unsigned int val) {
-    uart_puts("0x");
-    for (int i = 28; i >= 0; i -= 4) {
-        int digit = (val >> i) & 0xF;
-        uart_putc(digit < 10 ? '0' + digit : 'A' + digit - 10);
+static void paint_progress(const mem_paint_job_t *job, void *arg) {
+    (void)arg;
+    if (job->done < job->words) {
+        uart_puts("Progress: ");
+        uart_decimal(job->done >> 14);  // 64KB chunks
+        uart_puts(" chunks\n");
     }
 }
 
 // Memory pattern painting with verification
 int paint_memory_region(volatile uint32_t *start, size_t word_count, uint32_t pattern, const char *region_name) {
+    static mem_paint_job_t job;
+
     uart_puts("\n=== Painting Memory Region: ");
     uart_puts(region_name);
     uart_puts(" ===\n");
@@ -81,39 +93,25 @@ int paint_memory_region(volatile uint32_t *start, size_t word_count, uint32_t pa
     uart_hex(pattern);
     uart_puts("\n");
     
-    // Paint memory with progress tracking
-    for (size_t i = 0; i < word_count; i++) {
-        start[i] = pattern;
-        
-        // Progress indicator every 16K words (64KB) - avoid division
-        if ((i & 0x3FFF) == 0 && i > 0) {  // i % 16384 == 0, using bitwise AND
-            uart_puts("Progress: ");
-            // Simple progress without division - just show chunks
-            uart_decimal(i >> 14);  // i / 16384 using bit shift
-            uart_puts(" chunks\n");
-        }
-    }
-    
-    uart_puts("Painting complete. Verifying...\n");
+    // Paint and verify in one pass, progress between 256KB slices
+    mem_paint_begin(&job, (uint32_t *)start, word_count, MEM_PATTERN_FIXED, pattern, MEM_PAINT_WRITE_VERIFY);
+    int errors = (int)mem_paint_run(&job, paint_progress, NULL);
     
-    // Verification pass
-    int errors = 0;
-    for (size_t i = 0; i < word_count && errors < 10; i++) {
-        uint32_t actual = start[i];
-        if (actual != pattern) {
-            uart_puts("MISMATCH at offset ");
-            uart_decimal(i);
-            uart_puts(" (address ");
-            uart_hex((uint32_t)&start[i]);
-            uart_puts("): expected ");
-            uart_hex(pattern);
-            uart_puts(", got ");
-            uart_hex(actual);
-            uart_puts("\n");
-            errors++;
-        }
+    for (int i = 0; i < errors && i < MEM_PAINT_MAX_MISMATCHES; i++) {
+        uart_puts("MISMATCH at offset ");
+        uart_decimal(job.mismatches[i].addr - (uint32_t *)start);
+        uart_puts(" (address ");
+        uart_hex((uint32_t)job.mismatches[i].addr);
+        uart_puts("): expected ");
+        uart_hex(job.mismatches[i].expected);
+        uart_puts(", got ");
+        uart_hex(job.mismatches[i].actual);
+        uart_puts("\n");
     }
     
+    // Let the host-side dump see what was painted
+    cache_clean_range(start, word_count * sizeof(uint32_t));
+    
     if (errors == 0) {
         uart_puts("[OK] All ");
         uart_decimal(word_count);
@@ -221,7 +219,9 @@ void vMemoryPatternDebugTask(void *pvParameters) {
         (volatile uint32_t *)PATTERN_REGION_BASE
     };
     uint32_t patterns[] = {PATTERN_STACK, PATTERN_DATA, PATTERN_HEAP, PATTERN_TEST};
-    
+
+    (void)pvParameters;
+
     uart_puts("\n========================================\n");
     uart_puts("  ENHANCED MEMORY PATTERN DEBUG TASK\n");
     uart_puts("  FreeRTOS-seL4 Memory Mapping Analysis\n");
@@ -307,30 +307,13 @@ void vMemoryPatternDebugTask(void *pvParameters) {
     }
 }
 
-// Standard library functions
-void *memcpy(void *dest, const void *src, size_t n) {
-    char *d = (char *)dest;
-    const char *s = (const char *)src;
-    for (size_t i = 0; i < n; i++) {
-        d[i] = s[i];
-    }
-    return dest;
-}
-
-void *memset(void *s, int c, size_t n) {
-    char *p = (char *)s;
-    for (size_t i = 0; i < n; i++) {
-        p[i] = c;
-    }
-    return s;
-}
-
 int printf(const char *format, ...) {
     uart_puts(format);
     return 0;
 }
 
 void vAssertCalled(unsigned long ulLine, const char * const pcFileName) {
+    uart_enter_polled_mode();
     uart_puts("\n=== DETAILED ASSERT FAILURE DEBUG ===\n");
     uart_puts("ASSERT FAILED at line: ");
     uart_decimal(ulLine);
@@ -338,70 +321,35 @@ void vAssertCalled(unsigned long ulLine, const char * const pcFileName) {
     uart_puts(pcFileName);
     uart_puts("\n");
     
-    // Enhanced assertion analysis
-    const char *p = pcFileName;
-    int isPortC = 0;
-    while (*p) {
-        if (*p == 'p' && *(p+1) == 'o' && *(p+2) == 'r' && *(p+3) == 't' && *(p+4) == '.') {
-            isPortC = 1;
-            break;
-        }
-        p++;
-    }
-    
-    if (isPortC) {
-        uart_puts("\n--- PORT.C ASSERTION ANALYSIS ---\n");
-        if (ulLine >= 410 && ulLine <= 420) {
-            uart_puts("CPU Mode assertion - checking APSR register\n");
-        } else if (ulLine >= 430 && ulLine <= 450) {
-            uart_puts("GIC Binary Point Register assertion\n");
-        } else if (ulLine >= 470 && ulLine <= 480) {
-            uart_puts("Critical nesting assertion\n");
-        } else {
-            uart_puts("Other port.c assertion at line ");
-            uart_decimal(ulLine);
-            uart_puts("\n");
-        }
-        
-        // Dump current execution context for debugging
-        analyze_execution_context();
-    }
+    // The location also goes in the boot report, for the host
+    vPortRecordAssert(ulLine, pcFileName);
+
+    // Dump current execution context for debugging
+    analyze_execution_context();
     
     uart_puts("\nSystem will halt here for debugging.\n");
     uart_puts("=====================================\n");
     for (;;);
 }
 
-// ARM Generic Timer registers for Cortex-A15
-#define GENERIC_TIMER_CNTFRQ    0x00000000  // Counter Frequency Register
-#define GENERIC_TIMER_CNTKCTL   0x00000008  // Counter-timer Kernel Control Register
-#define GENERIC_TIMER_CNTP_TVAL 0x00000010  // Counter-timer Physical Timer TimerValue Register
-#define GENERIC_TIMER_CNTP_CTL  0x00000014  // Counter-timer Physical Timer Control Register
-
-// Timer interrupt configuration for QEMU virt machine
-void vSetupTickInterrupt(void) {
-    uart_puts("Setting up ARM Generic Timer interrupt...\n");
-    
-    // For QEMU virt machine, we'll use a simpler polling approach
-    // since configuring the generic timer requires EL1 privileges
-    uart_puts("Timer setup complete - using task delays for scheduling\n");
+// Sleep until an interrupt rather than spin - see idle.h
+void vApplicationIdleHook(void) {
+    idle_wait();
 }
 
-// Add a FreeRTOS idle hook to ensure the system doesn't hang
-void vApplicationIdleHook(void) {
-    static uint32_t idle_counter = 0;
-    
-    // Simple heartbeat every ~1 million idle cycles
-    if ((idle_counter & 0xFFFFF) == 0) {
-        uart_puts(".");  // Minimal heartbeat
-    }
-    idle_counter++;
+#if ( configNUMBER_OF_CORES > 1 )
+// The idle tasks of the other cores
+void vApplicationPassiveIdleHook(void) {
+    idle_wait();
 }
+#endif
 
 // Simple monitoring task
 void vMonitorTask(void *pvParameters) {
     uint32_t counter = 0;
-    
+
+    (void)pvParameters;
+
     for (;;) {
         uart_puts("Monitor: System running, cycle ");
         uart_decimal(counter);
@@ -419,6 +367,7 @@ void vMonitorTask(void *pvParameters) {
 }
 
 int main(void) {
+    uart_init();
     uart_puts("\n========================================\n");
     uart_puts("  FREERTOS MEMORY PATTERN DEBUGGING\n");
     uart_puts("  PhD Research - Secure Virtualization\n");
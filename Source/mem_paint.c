@@ -0,0 +1,182 @@
+/*
+ * Memory pattern painting and verification engine - see mem_paint.h.
+ */
+
+#include "mem_paint.h"
+#include "rt_string.h"
+
+// x^32 + x^22 + x^2 + x + 1, maximal length
+#define LFSR_TAPS           0x80200003UL
+#define LFSR_DEFAULT_SEED   0xACE1ACE1UL
+
+static inline uint32_t lfsr_next(uint32_t s) {
+    return (s >> 1) ^ (-(s & 1) & LFSR_TAPS);
+}
+
+static inline uint32_t rotl1(uint32_t v) {
+    return (v << 1) | (v >> 31);
+}
+
+static uint32_t initial_state(mem_pattern_kind_t kind, uint32_t seed) {
+    switch (kind) {
+        case MEM_PATTERN_WALKING_ONES:
+            return 1UL << (seed & 31);
+        case MEM_PATTERN_LFSR:
+            return seed ? seed : LFSR_DEFAULT_SEED;
+        default:
+            return seed;
+    }
+}
+
+// Write n words from generator state 'state'; returns the state after them.
+static uint32_t paint_block(const mem_paint_job_t *job, uint32_t *dst, size_t n, uint32_t state) {
+    switch (job->kind) {
+        case MEM_PATTERN_FIXED:
+            rt_memset32(dst, job->seed, n);
+            break;
+        case MEM_PATTERN_ADDRESS:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = (uint32_t)(uintptr_t)&dst[i] ^ job->seed;
+            }
+            break;
+        case MEM_PATTERN_WALKING_ONES:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = state;
+                state = rotl1(state);
+            }
+            break;
+        case MEM_PATTERN_LFSR:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = state;
+                state = lfsr_next(state);
+            }
+            break;
+    }
+    return state;
+}
+
+static void record_mismatch(mem_paint_job_t *job, uint32_t *addr, uint32_t expected, uint32_t actual) {
+    if (job->mismatch_count < MEM_PAINT_MAX_MISMATCHES) {
+        mem_paint_mismatch_t *m = &job->mismatches[job->mismatch_count];
+        m->addr = addr;
+        m->expected = expected;
+        m->actual = actual;
+    }
+    job->mismatch_count++;
+}
+
+// Check n words against the generator from 'state'; returns the state after
+// them.  Reads go through 'src' after the barrier in mem_paint_step, so they
+// are real loads even right after paint_block wrote the same words.
+static uint32_t verify_block(mem_paint_job_t *job, uint32_t *src, size_t n, uint32_t state) {
+    uint32_t expected;
+
+    for (size_t i = 0; i < n; i++) {
+        switch (job->kind) {
+            case MEM_PATTERN_FIXED:
+                expected = job->seed;
+                break;
+            case MEM_PATTERN_ADDRESS:
+                expected = (uint32_t)(uintptr_t)&src[i] ^ job->seed;
+                break;
+            case MEM_PATTERN_WALKING_ONES:
+                expected = state;
+                state = rotl1(state);
+                break;
+            default:
+                expected = state;
+                state = lfsr_next(state);
+                break;
+        }
+        if (src[i] != expected) {
+            record_mismatch(job, &src[i], expected, src[i]);
+        }
+    }
+    return state;
+}
+
+void mem_paint_begin(mem_paint_job_t *job, uint32_t *base, size_t words,
+                     mem_pattern_kind_t kind, uint32_t seed, mem_paint_mode_t mode) {
+    job->base = base;
+    job->words = words;
+    job->done = 0;
+    job->kind = kind;
+    job->mode = mode;
+    job->seed = seed;
+    job->state = initial_state(kind, seed);
+    job->mismatch_count = 0;
+}
+
+size_t mem_paint_step(mem_paint_job_t *job, size_t max_words) {
+    size_t todo = job->words - job->done;
+    uint32_t *p = job->base + job->done;
+    uint32_t state = job->state;
+
+    if (todo > max_words) {
+        todo = max_words;
+    }
+
+    for (size_t left = todo; left > 0; ) {
+        size_t n = left < MEM_PAINT_BLOCK_WORDS ? left : MEM_PAINT_BLOCK_WORDS;
+        uint32_t next;
+
+        switch (job->mode) {
+            case MEM_PAINT_WRITE:
+                state = paint_block(job, p, n, state);
+                break;
+            case MEM_PAINT_VERIFY:
+                state = verify_block(job, p, n, state);
+                break;
+            case MEM_PAINT_WRITE_VERIFY:
+                next = paint_block(job, p, n, state);
+                __asm volatile ("" ::: "memory");
+                verify_block(job, p, n, state);
+                state = next;
+                break;
+        }
+        p += n;
+        left -= n;
+    }
+
+    job->state = state;
+    job->done += todo;
+    return todo;
+}
+
+uint32_t mem_paint_run(mem_paint_job_t *job, mem_paint_progress_fn progress, void *arg) {
+    while (mem_paint_step(job, MEM_PAINT_PROGRESS_WORDS) > 0) {
+        if (progress) {
+            progress(job, arg);
+        }
+    }
+    return job->mismatch_count;
+}
+
+uint32_t mem_paint_expected(const mem_paint_job_t *job, size_t index) {
+    uint32_t state = initial_state(job->kind, job->seed);
+
+    switch (job->kind) {
+        case MEM_PATTERN_FIXED:
+            return job->seed;
+        case MEM_PATTERN_ADDRESS:
+            return (uint32_t)(uintptr_t)&job->base[index] ^ job->seed;
+        case MEM_PATTERN_WALKING_ONES:
+            index &= 31;
+            return index ? (state << index) | (state >> (32 - index)) : state;
+        default:
+            while (index--) {
+                state = lfsr_next(state);
+            }
+            return state;
+    }
+}
+
+const char *mem_pattern_name(mem_pattern_kind_t kind) {
+    switch (kind) {
+        case MEM_PATTERN_FIXED:        return "fixed";
+        case MEM_PATTERN_ADDRESS:      return "address";
+        case MEM_PATTERN_WALKING_ONES: return "walking ones";
+        case MEM_PATTERN_LFSR:         return "LFSR";
+        default:                       return "?";
+    }
+}
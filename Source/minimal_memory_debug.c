@@ -27,8 +27,8 @@
 #define PATTERN_SIZE       0x400000   // 4MB for pattern painting
 
 void uart_putc(char c) {
+    while (UART0_FR & (1 << 5)) {}  // Wait until TX FIFO not full
     UART0_DR = c;
-    for (volatile int i = 0; i < 1000; i++) {}
 }
 
 void uart_puts(const char *s) {
@@ -0,0 +1,222 @@
+/*
+ * Identity map and cache enable - see mmu.h.
+ */
+
+#include "FreeRTOSConfig.h"
+#include "mmu.h"
+#include "cache.h"
+
+// SCTLR bits
+#define SCTLR_M     (1UL << 0)
+#define SCTLR_A     (1UL << 1)
+#define SCTLR_C     (1UL << 2)
+#define SCTLR_Z     (1UL << 11)
+#define SCTLR_I     (1UL << 12)
+#define SCTLR_TRE   (1UL << 28)
+#define SCTLR_AFE   (1UL << 29)
+
+// ACTLR: take part in coherency (Cortex-A9 and A15 alike)
+#define ACTLR_SMP   (1UL << 6)
+
+// TTBR0 walk attributes: inner and outer write-back write-allocate
+// (multiprocessing extensions IRGN encoding)
+#define TTBR_IRGN_WBWA  (1UL << 6)
+#define TTBR_RGN_WBWA   (1UL << 3)
+#define TTBR_S          (1UL << 1)
+
+// With more than one core RAM, and the table walks, have to be Shareable to
+// be coherent between them, and TLB maintenance is broadcast.
+#if (configNUMBER_OF_CORES > 1)
+#define MMU_RAM_ATTR    MMU_SECT_NORMAL_WB_SHARED
+#define TTBR_WALK       (TTBR_IRGN_WBWA | TTBR_RGN_WBWA | TTBR_S)
+#define TLBIMVA(va)     __asm volatile ("mcr p15, 0, %0, c8, c3, 1" :: "r" (va) : "memory")  // TLBIMVAIS
+#else
+#define MMU_RAM_ATTR    MMU_SECT_NORMAL_WB
+#define TTBR_WALK       (TTBR_IRGN_WBWA | TTBR_RGN_WBWA)
+#define TLBIMVA(va)     __asm volatile ("mcr p15, 0, %0, c8, c7, 1" :: "r" (va) : "memory")
+#endif
+
+// All domains "client": accesses are checked against the AP bits
+#define DACR_ALL_CLIENT 0x55555555UL
+
+// In its own NOLOAD section (link.ld): every entry is written below, so it
+// needs neither space in the image nor the BSS clear.
+static uint32_t mmu_l1_table[MMU_L1_ENTRIES]
+    __attribute__((section(".mmu_table"), aligned(16384)));
+
+// Page tables for split sections, allocated by mmu_unmap_pages()
+static uint32_t mmu_l2_tables[MMU_L2_TABLES][MMU_L2_ENTRIES] __attribute__((aligned(1024)));
+static uint32_t mmu_l2_used;
+
+// Short-descriptor first level: a page table pointer, domain 0
+#define MMU_L1_TYPE_MASK    3UL
+#define MMU_L1_PAGE_TABLE   1UL
+
+#if (configNUMBER_OF_CORES > 1)
+// Written before the BSS clear, so kept out of BSS.
+mmu_boot_regs_t mmu_boot_regs __attribute__((section(".data")));
+#endif
+
+static void map_sections(uint32_t base, uint32_t size, uint32_t attr) {
+    for (uint32_t i = base >> MMU_SECTION_SHIFT; i < ((base + size - 1) >> MMU_SECTION_SHIFT) + 1; i++) {
+        mmu_l1_table[i] = (i << MMU_SECTION_SHIFT) | attr;
+    }
+}
+
+void mmu_init(void) {
+    uint32_t sctlr;
+
+    for (uint32_t i = 0; i < MMU_L1_ENTRIES; i++) {
+        mmu_l1_table[i] = 0;  // Fault
+    }
+    map_sections(MMU_DEVICE_BASE, MMU_DEVICE_SIZE, MMU_SECT_DEVICE);
+    map_sections(MMU_RAM_BASE, MMU_RAM_SIZE, MMU_RAM_ATTR);
+
+    // The table walk may not snoop the cache; the caches are still off, but
+    // make sure the table is in memory before it is used.
+    __asm volatile ("dsb" ::: "memory");
+
+    // Stale cache, TLB and predictor contents from before the guest started
+    // must not become visible when the caches come on.
+    cache_invalidate_dcache_all();
+    __asm volatile ("mcr p15, 0, %0, c8, c7, 0\n"   // TLBIALL
+                    "mcr p15, 0, %0, c7, c5, 0\n"   // ICIALLU
+                    "mcr p15, 0, %0, c7, c5, 6\n"   // BPIALL
+                    "dsb\n"
+                    "isb" :: "r" (0) : "memory");
+
+    __asm volatile ("mcr p15, 0, %0, c2, c0, 2\n"   // TTBCR: TTBR0 only, short descriptors
+                    "mcr p15, 0, %1, c2, c0, 0\n"   // TTBR0
+                    "mcr p15, 0, %2, c3, c0, 0\n"   // DACR
+                    "isb"
+                    :: "r" (0),
+                       "r" ((uint32_t)mmu_l1_table | TTBR_WALK),
+                       "r" (DACR_ALL_CLIENT)
+                    : "memory");
+
+#if (configNUMBER_OF_CORES > 1)
+    // Only written if clear: a hypervisor that keeps ACTLR to itself will
+    // have set SMP already.
+    uint32_t actlr;
+    __asm volatile ("mrc p15, 0, %0, c1, c0, 1" : "=r" (actlr));
+    if (!(actlr & ACTLR_SMP)) {
+        actlr |= ACTLR_SMP;
+        __asm volatile ("mcr p15, 0, %0, c1, c0, 1\n"
+                        "isb" :: "r" (actlr) : "memory");
+    }
+#endif
+
+    __asm volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (sctlr));
+    sctlr &= ~(SCTLR_A | SCTLR_TRE | SCTLR_AFE);
+    sctlr |= SCTLR_M | SCTLR_C | SCTLR_I | SCTLR_Z;
+    __asm volatile ("mcr p15, 0, %0, c1, c0, 0\n"
+                    "isb" :: "r" (sctlr) : "memory");
+
+#if (configNUMBER_OF_CORES > 1)
+    // The secondary cores load the same state in _secondary_start, before
+    // their caches are on.
+    mmu_boot_regs.ttbcr = 0;
+    mmu_boot_regs.ttbr0 = (uint32_t)mmu_l1_table | TTBR_WALK;
+    mmu_boot_regs.dacr = DACR_ALL_CLIENT;
+    mmu_boot_regs.actlr = actlr;
+    mmu_boot_regs.sctlr = sctlr;
+    cache_clean_range(&mmu_boot_regs, sizeof(mmu_boot_regs));
+#endif
+}
+
+void mmu_set_attributes(uint32_t base, uint32_t size, uint32_t attr) {
+    // No stale lines may survive with the old attributes.
+    cache_clean_invalidate_range((const void *)base, size);
+    map_sections(base, size, attr);
+    __asm volatile ("dsb" ::: "memory");
+
+    for (uint32_t i = base >> MMU_SECTION_SHIFT; i < ((base + size - 1) >> MMU_SECTION_SHIFT) + 1; i++) {
+        TLBIMVA(i << MMU_SECTION_SHIFT);
+    }
+    __asm volatile ("mcr p15, 0, %0, c7, c5, 6\n"   // BPIALL
+                    "dsb\n"
+                    "isb" :: "r" (0) : "memory");
+}
+
+
+// The small page descriptor with the same attributes as a section descriptor.
+static uint32_t section_to_page_attr(uint32_t sect) {
+    uint32_t page = 2UL;                    // Small page
+
+    page |= sect & (MMU_SECT_B | MMU_SECT_C);
+    page |= (sect >> 4) & 1UL;              // XN
+    page |= ((sect >> 10) & 3UL) << 4;      // AP[1:0]
+    page |= ((sect >> 12) & 7UL) << 6;      // TEX
+    page |= ((sect >> 15) & 1UL) << 9;      // AP[2]
+    page |= ((sect >> 16) & 3UL) << 10;     // S, nG
+    return page;
+}
+
+// The page table of the section at 'va', splitting the section if need be.
+static uint32_t *page_table_for(uint32_t va) {
+    uint32_t i = va >> MMU_SECTION_SHIFT;
+    uint32_t entry = mmu_l1_table[i];
+    uint32_t *table;
+    uint32_t attr;
+
+    if ((entry & MMU_L1_TYPE_MASK) == MMU_L1_PAGE_TABLE) {
+        return (uint32_t *)(entry & ~0x3FFUL);
+    }
+    if (mmu_l2_used == MMU_L2_TABLES) {
+        return NULL;
+    }
+
+    // Same mapping with 4 KB granularity; a faulting section stays faulting.
+    table = mmu_l2_tables[mmu_l2_used++];
+    attr = (entry & MMU_L1_TYPE_MASK) ? section_to_page_attr(entry) : 0;
+    for (uint32_t p = 0; p < MMU_L2_ENTRIES; p++) {
+        table[p] = attr ? ((i << MMU_SECTION_SHIFT) | (p << MMU_PAGE_SHIFT) | attr) : 0;
+    }
+    cache_clean_range(table, sizeof(mmu_l2_tables[0]));
+
+    // VMSAv7 allows replacing a section with an equivalent page table in
+    // place, which matters because this code may well run from the section.
+    mmu_l1_table[i] = (uint32_t)table | MMU_L1_PAGE_TABLE;
+    cache_clean_range(&mmu_l1_table[i], sizeof(mmu_l1_table[i]));
+    __asm volatile ("dsb" ::: "memory");
+    TLBIMVA(i << MMU_SECTION_SHIFT);
+    __asm volatile ("dsb\n"
+                    "isb" ::: "memory");
+    return table;
+}
+
+int mmu_unmap_pages(uint32_t base, uint32_t size) {
+    uint32_t end = base + size;
+    uint32_t sections = ((end - 1) >> MMU_SECTION_SHIFT) - (base >> MMU_SECTION_SHIFT) + 1;
+    uint32_t splits = 0;
+
+    if ((base & (MMU_PAGE_SIZE - 1)) || size == 0) {
+        return -1;
+    }
+    for (uint32_t s = 0; s < sections; s++) {
+        uint32_t entry = mmu_l1_table[(base >> MMU_SECTION_SHIFT) + s];
+
+        if ((entry & MMU_L1_TYPE_MASK) != MMU_L1_PAGE_TABLE) {
+            splits++;
+        }
+    }
+    if (mmu_l2_used + splits > MMU_L2_TABLES) {
+        return -1;
+    }
+
+    // Write back anything cached from the pages before they go.
+    cache_clean_invalidate_range((const void *)base, size);
+    for (uint32_t va = base; va < end; va += MMU_PAGE_SIZE) {
+        uint32_t *table = page_table_for(va);
+        uint32_t *pte = &table[(va >> MMU_PAGE_SHIFT) & (MMU_L2_ENTRIES - 1)];
+
+        *pte = 0;   // Fault
+        cache_clean_range(pte, sizeof(*pte));
+        __asm volatile ("dsb" ::: "memory");
+        TLBIMVA(va);
+    }
+    __asm volatile ("mcr p15, 0, %0, c7, c5, 6\n"   // BPIALL
+                    "dsb\n"
+                    "isb" :: "r" (0) : "memory");
+    return 0;
+}
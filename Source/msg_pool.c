@@ -0,0 +1,157 @@
+/*
+ * Zero-copy buffer pools and channels - see msg_pool.h.
+ */
+
+#include "msg_pool.h"
+
+// Buffer states, for the ownership checks.
+#define MSG_BUF_FREE    0
+#define MSG_BUF_HELD    1   // Acquired or received by a task or ISR
+#define MSG_BUF_QUEUED  2   // In a channel
+
+#define DESC(index, len)    ((uint32_t)(index) | ((uint32_t)(len) << 16))
+#define DESC_INDEX(d)       ((d) & 0xFFFF)
+#define DESC_LENGTH(d)      ((d) >> 16)
+
+static uint32_t buf_index(const msg_pool_t *p, const void *buf) {
+    uint32_t offset = (uint32_t)((const uint8_t *)buf - p->storage);
+
+    configASSERT((const uint8_t *)buf >= p->storage);
+    configASSERT(offset % p->buf_size == 0 && offset / p->buf_size < p->count);
+    return offset / p->buf_size;
+}
+
+static inline void *buf_at(const msg_pool_t *p, uint32_t index) {
+    return p->storage + index * p->buf_size;
+}
+
+int msg_pool_init(msg_pool_t *p, void *storage, uint32_t storage_size,
+                  uint32_t buf_size, uint32_t count) {
+    if (storage == NULL || buf_size == 0 || buf_size > MSG_MAX_LENGTH + 1 ||
+        count == 0 || count > MSG_POOL_MAX_BUFFERS) {
+        return -1;
+    }
+    // After the range check, so the rounding cannot wrap.  The product fits in
+    // 32 bits: at most 32 buffers of 64 KB.
+    buf_size = (buf_size + 7) & ~7UL;
+    if (buf_size * count > storage_size) {
+        return -1;
+    }
+
+    p->storage = storage;
+    p->buf_size = buf_size;
+    p->count = count;
+    p->free = xQueueCreateStatic(MSG_POOL_MAX_BUFFERS, sizeof(uint32_t),
+                                 (uint8_t *)p->free_storage, &p->free_struct);
+    for (uint32_t i = 0; i < count; i++) {
+        p->state[i] = MSG_BUF_FREE;
+        (void)xQueueSend(p->free, &i, 0);
+    }
+    return 0;
+}
+
+static void *take_free(msg_pool_t *p, uint32_t index) {
+    configASSERT(p->state[index] == MSG_BUF_FREE);
+    p->state[index] = MSG_BUF_HELD;
+    return buf_at(p, index);
+}
+
+void *msg_acquire(msg_pool_t *p, TickType_t timeout) {
+    uint32_t index;
+
+    if (xQueueReceive(p->free, &index, timeout) != pdPASS) {
+        return NULL;
+    }
+    return take_free(p, index);
+}
+
+void *msg_acquire_from_isr(msg_pool_t *p) {
+    uint32_t index;
+
+    // Nothing can be waiting to send to the free list, so no wake-up.
+    if (xQueueReceiveFromISR(p->free, &index, NULL) != pdPASS) {
+        return NULL;
+    }
+    return take_free(p, index);
+}
+
+static uint32_t give_back(msg_pool_t *p, void *buf) {
+    uint32_t index = buf_index(p, buf);
+
+    configASSERT(p->state[index] == MSG_BUF_HELD);
+    p->state[index] = MSG_BUF_FREE;
+    return index;
+}
+
+void msg_release(msg_pool_t *p, void *buf) {
+    uint32_t index = give_back(p, buf);
+
+    // Cannot fail: the free list has a slot for every buffer.
+    (void)xQueueSend(p->free, &index, 0);
+}
+
+void msg_release_from_isr(msg_pool_t *p, void *buf, BaseType_t *woken) {
+    uint32_t index = give_back(p, buf);
+
+    (void)xQueueSendFromISR(p->free, &index, woken);
+}
+
+uint32_t msg_pool_free_count(const msg_pool_t *p) {
+    return (uint32_t)uxQueueMessagesWaiting(p->free);
+}
+
+void msg_channel_init(msg_channel_t *c, msg_pool_t *p) {
+    c->pool = p;
+    c->queue = xQueueCreateStatic(MSG_CHANNEL_DEPTH, sizeof(uint32_t),
+                                  (uint8_t *)c->queue_storage, &c->queue_struct);
+}
+
+// The buffer is marked queued before it is visible to the receiver, and put
+// back to held if the send fails, so the state always has a single writer.
+static uint32_t start_send(msg_channel_t *c, void *buf, uint32_t len) {
+    uint32_t index = buf_index(c->pool, buf);
+
+    configASSERT(c->pool->state[index] == MSG_BUF_HELD);
+    configASSERT(len <= c->pool->buf_size && len <= MSG_MAX_LENGTH);
+    c->pool->state[index] = MSG_BUF_QUEUED;
+    return index;
+}
+
+BaseType_t msg_send(msg_channel_t *c, void *buf, uint32_t len, TickType_t timeout) {
+    uint32_t index = start_send(c, buf, len);
+    uint32_t desc = DESC(index, len);
+
+    if (xQueueSend(c->queue, &desc, timeout) != pdPASS) {
+        c->pool->state[index] = MSG_BUF_HELD;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+BaseType_t msg_send_from_isr(msg_channel_t *c, void *buf, uint32_t len, BaseType_t *woken) {
+    uint32_t index = start_send(c, buf, len);
+    uint32_t desc = DESC(index, len);
+
+    if (xQueueSendFromISR(c->queue, &desc, woken) != pdPASS) {
+        c->pool->state[index] = MSG_BUF_HELD;
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+void *msg_receive(msg_channel_t *c, uint32_t *len, TickType_t timeout) {
+    uint32_t desc;
+    uint32_t index;
+
+    if (xQueueReceive(c->queue, &desc, timeout) != pdPASS) {
+        return NULL;
+    }
+
+    index = DESC_INDEX(desc);
+    configASSERT(index < c->pool->count && c->pool->state[index] == MSG_BUF_QUEUED);
+    c->pool->state[index] = MSG_BUF_HELD;
+    if (len != NULL) {
+        *len = DESC_LENGTH(desc);
+    }
+    return buf_at(c->pool, index);
+}
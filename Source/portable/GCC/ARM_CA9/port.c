@@ -34,44 +34,33 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
-/* Debug UART functions */
-#define UART0_DR (*(volatile unsigned int *)0x9000000)
-#define UART0_FR (*(volatile unsigned int *)0x9000018)
-
-static void uart_putc(char c) {
-    while (UART0_FR & (1 << 5));  // Wait until TX FIFO not full
-    UART0_DR = c;
-}
-
-static void uart_puts(const char *s) {
-    while (*s) {
-        uart_putc(*s++);
-    }
-}
-
-static void uart_hex(unsigned int val) {
-    int i;
-    for (i = 28; i >= 0; i -= 4) {
-        int digit = (val >> i) & 0xF;
-        uart_putc(digit < 10 ? '0' + digit : 'A' + digit - 10);
-    }
-}
+/* Paravirtual VMM calls - see sel4_pv.h. */
+#if ( configUSE_SEL4_PARAVIRT == 1 )
+    #include "sel4_pv.h"
+#endif
 
-static void uart_dec(unsigned int val) {
-    char buffer[10];
-    int i = 0;
-    if (val == 0) {
-        uart_putc('0');
-        return;
-    }
-    while (val > 0) {
-        buffer[i++] = '0' + (val % 10);
-        val /= 10;
-    }
-    while (i > 0) {
-        uart_putc(buffer[--i]);
-    }
-}
+/* Boot diagnostics.  portDEBUG_LOG( uxLevel, ... ) formats with log.h's
+ * formatter and writes to the UART synchronously, as the scheduler is not
+ * running yet.  Messages above configPORT_DEBUG_LEVEL compile out, arguments
+ * included, so a release build prints nothing. */
+#if ( configPORT_DEBUG_LEVEL > 0 )
+    #include <stdarg.h>
+    #include "log.h"
+    #include "uart.h"
+
+    static void prvDebugLog( const char * pcFormat,
+                             ... ) __attribute__( ( format( printf, 1, 2 ) ) );
+
+    #define portDEBUG_LOG( uxLevel, ... )           \
+    do {                                            \
+        if( ( uxLevel ) <= configPORT_DEBUG_LEVEL ) \
+        {                                           \
+            prvDebugLog( __VA_ARGS__ );             \
+        }                                           \
+    } while( 0 )
+#else
+    #define portDEBUG_LOG( uxLevel, ... )
+#endif
 
 #ifndef configINTERRUPT_CONTROLLER_BASE_ADDRESS
     #error "configINTERRUPT_CONTROLLER_BASE_ADDRESS must be defined.  See www.FreeRTOS.org/Using-FreeRTOS-on-Cortex-A-Embedded-Processors.html"
@@ -93,6 +82,30 @@ static void uart_dec(unsigned int val) {
     #error "configMAX_API_CALL_INTERRUPT_PRIORITY must be defined.  See www.FreeRTOS.org/Using-FreeRTOS-on-Cortex-A-Embedded-Processors.html"
 #endif
 
+#if ( configUSE_LAZY_FPU_CONTEXT == 1 )
+    #if ( configUSE_TASK_FPU_SUPPORT != 2 )
+        #error "configUSE_LAZY_FPU_CONTEXT requires configUSE_TASK_FPU_SUPPORT to be set to 2"
+    #endif
+    #if ( configRECORD_STACK_HIGH_ADDRESS != 1 )
+        #error "configUSE_LAZY_FPU_CONTEXT requires configRECORD_STACK_HIGH_ADDRESS to be set to 1"
+    #endif
+#endif
+
+#if ( configNUMBER_OF_CORES > 1 )
+    #if ( configUSE_LAZY_FPU_CONTEXT == 1 )
+        #error "configUSE_LAZY_FPU_CONTEXT is not supported with more than one core"
+    #endif
+    #if ( configUSE_TICKLESS_IDLE != 0 )
+        #error "configUSE_TICKLESS_IDLE is not supported with more than one core"
+    #endif
+    #ifndef configYIELD_CORE_SGI_ID
+        #error "configYIELD_CORE_SGI_ID must name the SGI used by portYIELD_CORE()"
+    #endif
+    #ifndef configSETUP_CORE_INTERRUPTS
+        #error "configSETUP_CORE_INTERRUPTS( xCoreID ) must be defined to set up each core's interrupt controller interface"
+    #endif
+#endif
+
 #if configMAX_API_CALL_INTERRUPT_PRIORITY == 0
     #error "configMAX_API_CALL_INTERRUPT_PRIORITY must not be set to 0"
 #endif
@@ -166,14 +179,26 @@ static void uart_dec(unsigned int val) {
 
 
 /* Macro to unmask all interrupt priorities. */
-#define portCLEAR_INTERRUPT_MASK()                            \
-    {                                                         \
-        portCPU_IRQ_DISABLE();                                \
-        portICCPMR_PRIORITY_MASK_REGISTER = portUNMASK_VALUE; \
-        __asm volatile ( "DSB        \n"                      \
-                         "ISB        \n" );                   \
-        portCPU_IRQ_ENABLE();                                 \
+#if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 )
+
+/* The priority mask register is left at portUNMASK_VALUE and only the I bit
+ * masks interrupts, so unmasking is a CPSIE.  The priority mask write it
+ * replaces is counted. */
+    #define portUNMASK_ALL_INTERRUPTS()                      \
+    {                                                        \
+        portCORE_LOCAL( ulPortMaskWritesAvoided )++;         \
+        __asm volatile ( "CPSIE i" ::: "memory" );           \
     }
+#else
+    #define portUNMASK_ALL_INTERRUPTS()                           \
+    {                                                             \
+        portCPU_IRQ_DISABLE();                                    \
+        portICCPMR_PRIORITY_MASK_REGISTER = portUNMASK_VALUE;     \
+        __asm volatile ( "DSB        \n"                          \
+                         "ISB        \n" );                       \
+        portCPU_IRQ_ENABLE();                                     \
+    }
+#endif
 
 #define portINTERRUPT_PRIORITY_REGISTER_OFFSET    0x400UL
 #define portMAX_8_BIT_VALUE                       ( ( uint8_t ) 0xff )
@@ -192,6 +217,42 @@ static void uart_dec(unsigned int val) {
  * registers, plus a 32-bit status register. */
 #define portFPU_REGISTER_WORDS    ( ( 32 * 2 ) + 1 )
 
+/* Offset of the PC in a new task's context from its saved stack pointer, past
+ * the FPU word (and registers), the critical nesting count and R0-R12, R14.  The
+ * CPSR follows it. */
+#if ( ( configUSE_TASK_FPU_SUPPORT == 2 ) && ( configUSE_LAZY_FPU_CONTEXT != 1 ) )
+    #define portINITIAL_PC_OFFSET    ( 1 + portFPU_REGISTER_WORDS + 1 + 14 )
+#else
+    #define portINITIAL_PC_OFFSET    ( 1 + 1 + 14 )
+#endif
+
+/* The port's per-core state is a single variable on one core and an array
+ * indexed by core number on several.  portASM.S indexes the arrays the same
+ * way. */
+#if ( configNUMBER_OF_CORES == 1 )
+    #define portCORE_ARRAY
+    #define portCORE_LOCAL( xVariable )    ( xVariable )
+#else
+    #define portCORE_ARRAY                 [ configNUMBER_OF_CORES ]
+    #define portCORE_LOCAL( xVariable )    ( ( xVariable )[ portGET_CORE_ID() ] )
+#endif
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+/* GIC distributor software generated interrupt register. */
+    #define portGICD_SGIR                  ( *( ( volatile uint32_t * ) ( configINTERRUPT_CONTROLLER_DISTRIBUTOR_ADDRESS + 0xF00UL ) ) )
+    #define portGICD_SGIR_TARGET_SHIFT     ( 16UL )
+
+/* PSCI CPU_ON (32-bit calling convention), called through SMC as the DTB's
+ * psci node specifies. */
+    #define portPSCI_CPU_ON                ( 0x84000003UL )
+    #define portPSCI_SUCCESS               ( 0L )
+    #define portPSCI_ALREADY_ON            ( -4L )
+
+/* Value of a lock's owner field while nobody holds it. */
+    #define portLOCK_NO_OWNER              ( 0xFFFFFFFFUL )
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -205,6 +266,12 @@ extern void vPortRestoreTaskContext( void );
  */
 static void prvTaskExitError( void );
 
+/*
+ * Complete the boot report with the first task's context, just before it
+ * starts.
+ */
+static void prvRecordFirstTask( void );
+
 /*
  * If the application provides an implementation of vApplicationIRQHandler(),
  * then it will get called directly without saving the FPU registers on
@@ -226,6 +293,25 @@ static void prvTaskExitError( void );
  */
 void vApplicationFPUSafeIRQHandler( uint32_t ulICCIAR ) __attribute__( ( weak ) );
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+/*
+ * Entry point of the secondary cores, in startup.S.  It sets up the core's
+ * stacks, vector base, FPU and MMU and then calls vPortSecondaryCoreEntry().
+ */
+    extern void _secondary_start( void );
+
+/*
+ * Start cores 1 to configNUMBER_OF_CORES - 1 running their first task.
+ */
+    static void prvStartSecondaryCores( void );
+
+/*
+ * Called from startup.S on each secondary core, with interrupts off.
+ */
+    void vPortSecondaryCoreEntry( void );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* A variable is used to keep track of the critical section nesting.  This
@@ -233,18 +319,70 @@ void vApplicationFPUSafeIRQHandler( uint32_t ulICCIAR ) __attribute__( ( weak )
  * a non zero value to ensure interrupts don't inadvertently become unmasked before
  * the scheduler starts.  As it is stored as part of the task context it will
  * automatically be set to 0 when the first task is started. */
-volatile uint32_t ulCriticalNesting = 9999UL;
+#if ( configNUMBER_OF_CORES == 1 )
+    volatile uint32_t ulCriticalNesting = 9999UL;
+#else
+    volatile uint32_t ulCriticalNesting[ configNUMBER_OF_CORES ] = { [ 0 ... ( configNUMBER_OF_CORES - 1 ) ] = 9999UL };
+#endif
 
 /* Saved as part of the task context.  If ulPortTaskHasFPUContext is non-zero then
  * a floating point context must be saved and restored for the task. */
-volatile uint32_t ulPortTaskHasFPUContext = pdFALSE;
+volatile uint32_t ulPortTaskHasFPUContext portCORE_ARRAY = { pdFALSE };
+
+#if ( configUSE_LAZY_FPU_CONTEXT == 1 )
+
+/* The save area of the task whose registers are currently loaded in the FPU, or
+ * NULL if the FPU contents belong to no task.  Only changed by
+ * FreeRTOS_Undefined_Handler and vPortReleaseFPUContext(). */
+    volatile uint32_t * volatile pulPortFPUOwnerContext = NULL;
+
+/* Number of times the FPU registers have changed hands. */
+    volatile uint32_t ulPortFPUContextSwitches = 0UL;
+#endif
 
 /* Set to 1 to pend a context switch from an ISR. */
-volatile uint32_t ulPortYieldRequired = pdFALSE;
+volatile uint32_t ulPortYieldRequired portCORE_ARRAY = { pdFALSE };
+
+#if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 )
+
+/* Writes to the priority mask register, which the VMM emulates, that masking
+ * with the I bit has saved.  Only changed with interrupts disabled, on the
+ * owning core.  Also incremented in portASM.S. */
+    volatile uint32_t ulPortMaskWritesAvoided portCORE_ARRAY = { 0UL };
+#endif
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/* Upper 32 bits of the run time counter, in bits 63:32. */
+    static uint64_t ullRunTimeCounterHigh = 0ULL;
+
+/* pdFALSE if the PMU cycle counter did not advance, in which case the virtual
+ * counter is used instead. */
+    static uint32_t ulRunTimeCounterUsesPMU = pdFALSE;
+#endif
 
 /* Counts the interrupt nesting depth.  A context switch is only performed if
  * if the nesting depth is 0. */
-volatile uint32_t ulPortInterruptNesting = 0UL;
+volatile uint32_t ulPortInterruptNesting portCORE_ARRAY = { 0UL };
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+/* The kernel's task and ISR locks.  ulOwner and ulCount are only written by
+ * the core holding the lock, so a core can tell it already holds a lock
+ * without an exclusive access.  Each lock has a cache line to itself. */
+    typedef struct PortLock
+    {
+        volatile uint32_t ulLock;
+        volatile uint32_t ulOwner;
+        uint32_t ulCount;
+    } __attribute__( ( aligned( 64 ) ) ) PortLock_t;
+
+    static PortLock_t xPortLocks[ 2 ] =
+    {
+        { 0UL, portLOCK_NO_OWNER, 0UL },
+        { 0UL, portLOCK_NO_OWNER, 0UL }
+    };
+#endif
 
 /* Used in the asm file. */
 __attribute__( ( used ) ) const uint32_t ulICCIARAddress = portICCIAR_INTERRUPT_ACKNOWLEDGE_REGISTER_ADDRESS;
@@ -252,6 +390,11 @@ __attribute__( ( used ) ) const uint32_t ulICCEOIRAddress = portICCEOIR_END_OF_I
 __attribute__( ( used ) ) const uint32_t ulICCPMRAddress = portICCPMR_PRIORITY_MASK_REGISTER_ADDRESS;
 __attribute__( ( used ) ) const uint32_t ulMaxAPIPriorityMask = ( configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT );
 
+/* Linked at portBOOT_REPORT_ADDRESS (link.ld), outside the BSS clear, so a
+ * report from an earlier boot is not mistaken for a complete one until
+ * xPortStartScheduler() clears ulMagic.  Only the host reads it. */
+PortBootReport_t xPortBootReport __attribute__( ( section( ".boot_report" ), used ) );
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -261,13 +404,16 @@ StackType_t * pxPortInitialiseStack( StackType_t * pxTopOfStack,
                                      TaskFunction_t pxCode,
                                      void * pvParameters )
 {
-    uart_puts("=== pxPortInitialiseStack called ===\n");
-    uart_puts("pxTopOfStack = 0x");
-    uart_hex((unsigned int)pxTopOfStack);
-    uart_puts("\n");
-    uart_puts("pxCode = 0x");
-    uart_hex((unsigned int)pxCode);
-    uart_puts("\n");
+    #if ( configUSE_LAZY_FPU_CONTEXT == 1 )
+        /* Reserve the FPU save area (all registers start as 0) above the
+         * initial context.  An extra word keeps the context 8 byte aligned. */
+        StackType_t * pxFPUContext;
+
+        pxTopOfStack -= ( portFPU_REGISTER_WORDS + 1 );
+        pxFPUContext = pxTopOfStack + 1;
+        memset( pxFPUContext, 0x00, portFPU_REGISTER_WORDS * sizeof( StackType_t ) );
+    #endif
+
     /* Setup the initial stack of the task.  The stack is set exactly as
      * expected by the portRESTORE_CONTEXT() macro.
      *
@@ -335,6 +481,15 @@ StackType_t * pxPortInitialiseStack( StackType_t * pxTopOfStack,
         pxTopOfStack--;
         *pxTopOfStack = portNO_FLOATING_POINT_CONTEXT;
     }
+    #elif ( ( configUSE_TASK_FPU_SUPPORT == 2 ) && ( configUSE_LAZY_FPU_CONTEXT == 1 ) )
+    {
+        /* The task's FPU registers live in a save area at the top of its
+         * stack, which was reserved above.  The context only holds a pointer to
+         * it, and the registers are only moved when another task needs the
+         * FPU. */
+        pxTopOfStack--;
+        *pxTopOfStack = ( StackType_t ) pxFPUContext;
+    }
     #elif ( configUSE_TASK_FPU_SUPPORT == 2 )
     {
         /* The task will start with a floating point context.  Leave enough
@@ -344,7 +499,7 @@ StackType_t * pxPortInitialiseStack( StackType_t * pxTopOfStack,
 
         pxTopOfStack--;
         *pxTopOfStack = pdTRUE;
-        ulPortTaskHasFPUContext = pdTRUE;
+        portCORE_LOCAL( ulPortTaskHasFPUContext ) = pdTRUE;
     }
     #else /* if ( configUSE_TASK_FPU_SUPPORT == 1 ) */
     {
@@ -352,32 +507,11 @@ StackType_t * pxPortInitialiseStack( StackType_t * pxTopOfStack,
     }
     #endif /* if ( configUSE_TASK_FPU_SUPPORT == 1 ) */
 
-    uart_puts("=== Stack initialization complete ===\n");
-    uart_puts("Returning pxTopOfStack = 0x");
-    uart_hex((unsigned int)pxTopOfStack);
-    uart_puts("\n");
-    
-    /* The stack layout for RFEIA (from low to high address):
-     * pxTopOfStack + many_offsets: PC value  (what RFEIA loads into PC)
-     * pxTopOfStack + many_offsets + 1: SPSR value (what RFEIA loads into CPSR)
-     * Let's find where they actually are by looking near the end of the stack area */
-    StackType_t *stack_end = pxTopOfStack;
-    while (stack_end < (StackType_t*)0x50000000) {  /* Search within reasonable bounds */
-        if (*stack_end == (StackType_t)pxCode) {  /* Found our PC value */
-            uart_puts("Found PC on stack at offset ");
-            uart_dec((int)(stack_end - pxTopOfStack));
-            uart_puts(": PC = 0x");
-            uart_hex(*stack_end);
-            uart_puts("\n");
-            uart_puts("SPSR at next location = 0x");
-            uart_hex(*(stack_end + 1));
-            uart_puts("\n");
-            break;
-        }
-        stack_end++;
-        if ((stack_end - pxTopOfStack) > 50) break; /* Limit search */
-    }
-    
+    portDEBUG_LOG( 2, "port: task %p stack %p, PC 0x%08x CPSR 0x%08x\n",
+                   ( void * ) pxCode, ( void * ) pxTopOfStack,
+                   ( unsigned ) pxTopOfStack[ portINITIAL_PC_OFFSET ],
+                   ( unsigned ) pxTopOfStack[ portINITIAL_PC_OFFSET + 1 ] );
+
     return pxTopOfStack;
 }
 /*-----------------------------------------------------------*/
@@ -390,7 +524,7 @@ static void prvTaskExitError( void )
      *
      * Artificially force an assert() to be triggered if configASSERT() is
      * defined, then stop here so application writers can catch the error. */
-    configASSERT( ulPortInterruptNesting == ~0UL );
+    configASSERT( portCORE_LOCAL( ulPortInterruptNesting ) == ~0UL );
     portDISABLE_INTERRUPTS();
 
     for( ; ; )
@@ -399,9 +533,104 @@ static void prvTaskExitError( void )
 }
 /*-----------------------------------------------------------*/
 
+static inline uint32_t prvReadVirtualCounterLow( void )
+{
+    uint32_t ulLow, ulHigh;
+
+    __asm volatile ( "ISB \n"
+                     "MRRC p15, 1, %0, %1, c14" : "=r" ( ulLow ), "=r" ( ulHigh ) :: "memory" );
+    ( void ) ulHigh;
+    return ulLow;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configPORT_DEBUG_LEVEL > 0 )
+
+    static void prvDebugLog( const char * pcFormat,
+                             ... )
+    {
+        char cLine[ LOG_LINE_MAX ];
+        size_t xLength;
+        va_list xArgs;
+
+        va_start( xArgs, pcFormat );
+        xLength = log_vformat( cLine, sizeof( cLine ), pcFormat, xArgs );
+        va_end( xArgs );
+        uart_write( cLine, xLength );
+    }
+
+#endif /* configPORT_DEBUG_LEVEL */
+/*-----------------------------------------------------------*/
+
+static void prvRecordFirstTask( void )
+{
+    /* pxTopOfStack is the first member of a TCB. */
+    #if ( configNUMBER_OF_CORES == 1 )
+        extern void * volatile pxCurrentTCB;
+        StackType_t * const * ppxTCB = ( StackType_t * const * ) pxCurrentTCB;
+    #else
+        extern void * volatile pxCurrentTCBs[ configNUMBER_OF_CORES ];
+        StackType_t * const * ppxTCB = ( StackType_t * const * ) pxCurrentTCBs[ 0 ];
+    #endif
+    const StackType_t * pxStack = *ppxTCB;
+
+    xPortBootReport.ulFirstTCB = ( uint32_t ) ppxTCB;
+    xPortBootReport.ulFirstStackPointer = ( uint32_t ) pxStack;
+    xPortBootReport.ulFirstPC = pxStack[ portINITIAL_PC_OFFSET ];
+    xPortBootReport.ulFirstCPSR = pxStack[ portINITIAL_PC_OFFSET + 1 ];
+    xPortBootReport.ulFirstTaskCount = prvReadVirtualCounterLow();
+
+    portDEBUG_LOG( 2, "port: first task TCB %p stack %p, PC 0x%08x CPSR 0x%08x\n",
+                   ( void * ) ppxTCB, ( void * ) pxStack,
+                   ( unsigned ) xPortBootReport.ulFirstPC,
+                   ( unsigned ) xPortBootReport.ulFirstCPSR );
+
+    __asm volatile ( "DMB" ::: "memory" );
+    xPortBootReport.ulMagic = portBOOT_REPORT_MAGIC;
+
+    /* QEMU keeps no caches, but a debugger reading RAM on hardware would see
+     * stale lines.  The report is one cache line. */
+    __asm volatile ( "MCR p15, 0, %0, c7, c10, 1 \n" /* DCCMVAC */
+                     "DSB" :: "r" ( &xPortBootReport ) : "memory" );
+}
+/*-----------------------------------------------------------*/
+
+void vPortRecordAssert( uint32_t ulLine,
+                        const char * pcFileName )
+{
+    xPortBootReport.pcAssertFile = pcFileName;
+    xPortBootReport.ulAssertLine = ulLine;
+    __asm volatile ( "DSB                        \n"
+                     "MCR p15, 0, %0, c7, c10, 1 \n"
+                     "DSB" :: "r" ( &xPortBootReport ) : "memory" );
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xPortStartScheduler( void )
 {
-    uint32_t ulAPSR;
+    uint32_t ulAPSR, ulBinaryPoint;
+
+    xPortBootReport.ulMagic = 0UL;
+    xPortBootReport.ulSchedulerStartCount = prvReadVirtualCounterLow();
+    xPortBootReport.ulVersion = portBOOT_REPORT_VERSION;
+    xPortBootReport.ulFlags = 0UL;
+    xPortBootReport.ulCoreCount = configNUMBER_OF_CORES;
+    xPortBootReport.ulAssertLine = 0UL;
+    xPortBootReport.pcAssertFile = NULL;
+    __asm volatile ( "MRC p15, 0, %0, c14, c0, 0" : "=r" ( xPortBootReport.ulCounterFrequency ) );
+
+    #if ( configUSE_SEL4_PARAVIRT == 1 )
+    {
+        /* Before the tick is set up: the tick and the idle task use the
+         * features found here. */
+        if( sel4_pv_init() != 0UL )
+        {
+            xPortBootReport.ulFlags |= portBOOT_REPORT_PARAVIRT;
+        }
+
+        portDEBUG_LOG( 1, "port: paravirtual features 0x%x\n", ( unsigned ) sel4_pv_features() );
+    }
+    #endif /* configUSE_SEL4_PARAVIRT */
 
     #if ( configASSERT_DEFINED == 1 )
     {
@@ -409,298 +638,122 @@ BaseType_t xPortStartScheduler( void )
         volatile uint8_t * const pucFirstUserPriorityRegister = ( volatile uint8_t * const ) ( configINTERRUPT_CONTROLLER_BASE_ADDRESS + portINTERRUPT_PRIORITY_REGISTER_OFFSET );
         volatile uint8_t ucMaxPriorityValue;
 
-        /* Determine how many priority bits are implemented in the GIC.
-         *
-         * Save the interrupt priority value that is about to be clobbered. */
-        ucOriginalPriority = *pucFirstUserPriorityRegister;
-
-        /* Determine the number of priority bits available.  First write to
-         * all possible bits. */
-        uart_puts("Writing 0xFF to GIC priority register\n");
-        *pucFirstUserPriorityRegister = portMAX_8_BIT_VALUE;
-
-        /* Read the value back to see how many bits stuck. */
-        ucMaxPriorityValue = *pucFirstUserPriorityRegister;
-        uart_puts("Raw value read back from GIC: 0x");
-        uart_hex(ucMaxPriorityValue);
-        uart_puts("\n");
-
-        /* Shift to the least significant bits. */
-        while( ( ucMaxPriorityValue & portBIT_0_SET ) != portBIT_0_SET )
+        #if ( configUSE_SEL4_PARAVIRT == 1 )
+            uint32_t ulPriorityBits = sel4_pv_gic_priority_bits();
+        #else
+            const uint32_t ulPriorityBits = 0UL;
+        #endif
+
+        if( ulPriorityBits != 0UL )
         {
-            ucMaxPriorityValue >>= ( uint8_t ) 0x01;
+            /* The VMM said how many priority bits its vGIC implements, so
+             * there is no need to find out by writing to an emulated
+             * register.  Those are the most significant bits, so this is the
+             * value the probe below ends up with. */
+            ucMaxPriorityValue = ( uint8_t ) ( ( 1UL << ulPriorityBits ) - 1UL );
         }
+        else
+        {
+            /* Determine how many priority bits are implemented in the GIC.
+             *
+             * Save the interrupt priority value that is about to be clobbered. */
+            ucOriginalPriority = *pucFirstUserPriorityRegister;
+
+            /* Determine the number of priority bits available.  First write to
+             * all possible bits. */
+            *pucFirstUserPriorityRegister = portMAX_8_BIT_VALUE;
+
+            /* Read the value back to see how many bits stuck. */
+            ucMaxPriorityValue = *pucFirstUserPriorityRegister;
+            portDEBUG_LOG( 1, "port: GIC priority register reads back 0x%02x\n", ( unsigned ) ucMaxPriorityValue );
+
+            /* Shift to the least significant bits. */
+            while( ( ucMaxPriorityValue & portBIT_0_SET ) != portBIT_0_SET )
+            {
+                ucMaxPriorityValue >>= ( uint8_t ) 0x01;
+            }
+
+            /* Restore the clobbered interrupt priority register to its
+             * original value. */
+            *pucFirstUserPriorityRegister = ucOriginalPriority;
+        }
+
+        xPortBootReport.ulMaxPriorityValue = ucMaxPriorityValue;
+
+        if( ucMaxPriorityValue == portLOWEST_INTERRUPT_PRIORITY )
+        {
+            xPortBootReport.ulFlags |= portBOOT_REPORT_PRIORITY_BITS_OK;
+        }
+
+        portDEBUG_LOG( 1, "port: max priority value %u, expected %u\n",
+                       ( unsigned ) ucMaxPriorityValue, ( unsigned ) portLOWEST_INTERRUPT_PRIORITY );
 
         /* Sanity check configUNIQUE_INTERRUPT_PRIORITIES matches the read
          * value. */
-        uart_puts("GIC Priority Discovery Debug:\n");
-        uart_puts("ucMaxPriorityValue = ");
-        uart_dec(ucMaxPriorityValue);
-        uart_puts("\n");
-        uart_puts("portLOWEST_INTERRUPT_PRIORITY = ");
-        uart_dec(portLOWEST_INTERRUPT_PRIORITY);
-        uart_puts("\n");
-        
         configASSERT( ucMaxPriorityValue == portLOWEST_INTERRUPT_PRIORITY );
-
-        /* Restore the clobbered interrupt priority register to its original
-         * value. */
-        *pucFirstUserPriorityRegister = ucOriginalPriority;
     }
     #endif /* configASSERT_DEFINED */
 
-
     /* Only continue if the CPU is not in User mode.  The CPU must be in a
      * Privileged mode for the scheduler to start. */
     __asm volatile ( "MRS %0, APSR" : "=r" ( ulAPSR )::"memory" );
     ulAPSR &= portAPSR_MODE_BITS_MASK;
-    // Debug: Print CPU mode and GIC register values for all modes
-    uart_puts("CPU Debug: APSR = 0x");
-    uart_hex(ulAPSR);
-    uart_puts(", USER_MODE = 0x");
-    uart_hex(portAPSR_USER_MODE);
-    uart_puts("\n");
-    
-    // Re-enable CPU mode assertion with debug info
-    uart_puts("About to check CPU mode assertion\n");
-    configASSERT( ulAPSR != portAPSR_USER_MODE );
+    xPortBootReport.ulCPUMode = ulAPSR;
 
-    // Always print GIC debug info regardless of CPU mode
-    uart_puts("GIC Debug: Binary Point Register = 0x");
-    uart_hex(portICCBPR_BINARY_POINT_REGISTER);
-    uart_puts("\n");
-    uart_puts("GIC Debug: Binary Point Bits = 0x");
-    uart_hex(portICCBPR_BINARY_POINT_REGISTER & portBINARY_POINT_BITS);
-    uart_puts("\n");
-    uart_puts("GIC Debug: Max Binary Point Value = ");
-    uart_dec(portMAX_BINARY_POINT_VALUE);
-    uart_puts("\n");
+    /* Only continue if the binary point value is set to its lowest possible
+     * setting.  See the comments in vPortValidateInterruptPriority() below for
+     * more information. */
+    ulBinaryPoint = portICCBPR_BINARY_POINT_REGISTER;
+    xPortBootReport.ulBinaryPoint = ulBinaryPoint;
 
     if( ulAPSR != portAPSR_USER_MODE )
     {
-        uart_puts("Running in privileged mode\n");
-        /* Only continue if the binary point value is set to its lowest possible
-         * setting.  See the comments in vPortValidateInterruptPriority() below for
-         * more information. */
-        
-        // Temporarily disable strict GIC assertion for virtualized environment
-        // configASSERT( ( portICCBPR_BINARY_POINT_REGISTER & portBINARY_POINT_BITS ) <= portMAX_BINARY_POINT_VALUE );
+        xPortBootReport.ulFlags |= portBOOT_REPORT_PRIVILEGED;
+    }
 
-        if( ( portICCBPR_BINARY_POINT_REGISTER & portBINARY_POINT_BITS ) <= portMAX_BINARY_POINT_VALUE )
-        {
-            /* Interrupts are turned off in the CPU itself to ensure tick does
-             * not execute while the scheduler is being started.  Interrupts are
-             * automatically turned back on in the CPU when the first task starts
-             * executing. */
-            portCPU_IRQ_DISABLE();
-
-            /* Start the timer that generates the tick ISR. */
-            configSETUP_TICK_INTERRUPT();
-
-            /* Start the first task executing. */
-            uart_puts("About to call vPortRestoreTaskContext()\n");
-            
-            /* Debug: Check pxCurrentTCB before context switch */
-            extern void *pxCurrentTCB;
-            uart_puts("pxCurrentTCB = 0x");
-            uart_hex((unsigned int)pxCurrentTCB);
-            uart_puts("\n");
-            
-            if (pxCurrentTCB != NULL) {
-                uart_puts("pxCurrentTCB points to valid memory\n");
-                /* Check the stack pointer stored in the TCB */
-                void **tcb_ptr = (void **)pxCurrentTCB;
-                unsigned int *stack_ptr = (unsigned int *)*tcb_ptr;
-                uart_puts("Stack pointer in TCB = 0x");
-                uart_hex((unsigned int)stack_ptr);
-                uart_puts("\n");
-                
-                /* Debug: Check stack contents - scan for our PC value */
-                uart_puts("Stack inspection - searching for PC value:\n");
-                uart_puts("TCB Stack pointer = 0x");
-                uart_hex((unsigned int)stack_ptr);
-                uart_puts("\n");
-                
-                /* Look for our PC value in the stack */
-                for (int i = 0; i < 20; i++) {
-                    uart_puts("stack[");
-                    uart_dec(i);
-                    uart_puts("] = 0x");
-                    uart_hex(stack_ptr[i]);
-                    if (stack_ptr[i] == 0x40000CC8 || stack_ptr[i] == 0x4000001C) {
-                        uart_puts(" <-- FOUND PC!");
-                    }
-                    if (stack_ptr[i] == 0x1F) {
-                        uart_puts(" <-- FOUND SPSR!");
-                    }
-                    uart_puts("\n");
-                }
-            } else {
-                uart_puts("ERROR: pxCurrentTCB is NULL!\n");
-            }
-            
-            /* Debug: Create a custom context restore to see what RFEIA would load */
-            uart_puts("About to manually check what RFEIA will load...\n");
-            
-            /* Simulate the start of portRESTORE_CONTEXT */
-            extern void *pxCurrentTCB;
-            unsigned int *stack_ptr = (unsigned int *)(*(unsigned int **)pxCurrentTCB);
-            
-            uart_puts("Initial stack pointer from TCB: 0x");
-            uart_hex((unsigned int)stack_ptr);
-            uart_puts("\n");
-            
-            /* Simulate FPU context pop */
-            unsigned int fpu_context = *stack_ptr++;
-            uart_puts("FPU context flag: 0x");
-            uart_hex(fpu_context);
-            uart_puts("\n");
-            
-            /* Skip FPU registers if needed (they're not popped since fpu_context == 0) */
-            
-            /* Simulate critical nesting pop */
-            unsigned int critical_nesting = *stack_ptr++;
-            uart_puts("Critical nesting: 0x");
-            uart_hex(critical_nesting);
-            uart_puts("\n");
-            
-            /* Skip priority mask setup... */
-            
-            /* Simulate register pops: POP {R0-R12, R14} = 14 values */
-            uart_puts("Simulating POP {R0-R12, R14} - advancing by 14 values...\n");
-            stack_ptr += 14;
-            
-            uart_puts("Stack pointer after all POPs: 0x");
-            uart_hex((unsigned int)stack_ptr);
-            uart_puts("\n");
-            
-            uart_puts("Values RFEIA would load:\n");
-            uart_puts("PC (from stack[0]): 0x");
-            uart_hex(stack_ptr[0]);
-            uart_puts("\n");
-            uart_puts("CPSR (from stack[1]): 0x");
-            uart_hex(stack_ptr[1]);
-            uart_puts("\n");
-            
-            /* CRITICAL: Check if seL4 VM is translating addresses correctly */
-            uart_puts("=== seL4 ADDRESS TRANSLATION CHECK ===\n");
-            uart_puts("Current function address: 0x");
-            uart_hex((unsigned int)&uart_puts);  /* Check if our own function address makes sense */
-            uart_puts("\n");
-            uart_puts("Stack address range: TCB=0x");
-            uart_hex((unsigned int)pxCurrentTCB);
-            uart_puts(" to stack=0x");
-            uart_hex((unsigned int)stack_ptr + 64);  /* Check stack address range */
-            uart_puts("\n");
-            
-            /* Test if we can read/write from the addresses we think contain PC */
-            unsigned int test_value = 0xDEADBEEF;
-            unsigned int *test_addr = &stack_ptr[16];  /* Where we think PC is stored */
-            uart_puts("Test write/read to PC location: ");
-            *test_addr = test_value;
-            if (*test_addr == test_value) {
-                uart_puts("PASS - Memory is accessible\n");
-                *test_addr = 0x4000532C;  /* Restore correct value */
-            } else {
-                uart_puts("FAIL - Memory translation issue! Read: 0x");
-                uart_hex(*test_addr);
-                uart_puts("\n");
-            }
-            
-            /* Instead of complex assembly, try direct function call */
-            uart_puts("=== ATTEMPTING DIRECT TASK CALL ===\n");
-            uart_puts("Calling vPLCMain directly as a test...\n");
-            
-            /* Get the first task function address */
-            if (stack_ptr[16] == 0x40000CC8) {
-                uart_puts("About to call vPLCMain(NULL)...\n");
-                extern void vPLCMain(void *pvParameters);
-                
-                /* Call it in a way that won't hang if it has infinite loops */
-                uart_puts("Calling vPLCMain - expecting it to print messages...\n");
-                
-                /* Simple test - call the function but catch any immediate return */
-                void (*task_func)(void*) = (void (*)(void*))0x40000CC8;
-                uart_puts("About to jump to task function at 0x40000CC8\n");
-                
-                /* Instead of calling the infinite loop version, let's check what's at that address */
-                uart_puts("Checking memory at task address:\n");
-                unsigned int *code = (unsigned int *)0x40000CC8;
-                for (int i = 0; i < 4; i++) {
-                    uart_puts("code[");
-                    uart_dec(i);
-                    uart_puts("] = 0x");
-                    uart_hex(code[i]);
-                    uart_puts("\n");
-                }
-                
-                uart_puts("Now actually calling the task function...\n");
-                task_func(NULL);
-            }
-            
-            uart_puts("Direct call completed, now trying vPortRestoreTaskContext...\n");
-            /* Now call the real function to see what happens */
-            vPortRestoreTaskContext();
-        }
+    if( ( ulBinaryPoint & portBINARY_POINT_BITS ) <= portMAX_BINARY_POINT_VALUE )
+    {
+        xPortBootReport.ulFlags |= portBOOT_REPORT_BINARY_POINT_OK;
     }
-    else
+
+    portDEBUG_LOG( 1, "port: mode 0x%02x, binary point 0x%x (max %u)\n",
+                   ( unsigned ) ulAPSR, ( unsigned ) ulBinaryPoint, ( unsigned ) portMAX_BINARY_POINT_VALUE );
+
+    configASSERT( ulAPSR != portAPSR_USER_MODE );
+
+    /* Without configASSERT() a VMM that runs the guest in User mode gets the
+     * scheduler started anyway, with the binary point left unchecked; the mode
+     * is in the boot report. */
+    if( ( ulAPSR == portAPSR_USER_MODE ) ||
+        ( ( ulBinaryPoint & portBINARY_POINT_BITS ) <= portMAX_BINARY_POINT_VALUE ) )
     {
-        uart_puts("Running in USER mode - bypassing GIC checks for virtualized environment\n");
-        
-        /* In virtualized environments, we may be running in USER mode
-         * but still need to proceed with scheduler initialization */
-        
         /* Interrupts are turned off in the CPU itself to ensure tick does
-         * not execute while the scheduler is being started. */
+         * not execute while the scheduler is being started.  Interrupts are
+         * automatically turned back on in the CPU when the first task starts
+         * executing. */
         portCPU_IRQ_DISABLE();
 
         /* Start the timer that generates the tick ISR. */
         configSETUP_TICK_INTERRUPT();
 
-        /* Start the first task executing. */
-        uart_puts("About to call vPortRestoreTaskContext() from USER mode path\n");
-        
-        /* Debug: Check pxCurrentTCB before context switch */
-        extern void *pxCurrentTCB;
-        uart_puts("pxCurrentTCB = 0x");
-        uart_hex((unsigned int)pxCurrentTCB);
-        uart_puts("\n");
-        
-        if (pxCurrentTCB != NULL) {
-            uart_puts("pxCurrentTCB points to valid memory\n");
-            /* Check the stack pointer stored in the TCB */
-            void **tcb_ptr = (void **)pxCurrentTCB;
-            unsigned int *stack_ptr = (unsigned int *)*tcb_ptr;
-            uart_puts("Stack pointer in TCB = 0x");
-            uart_hex((unsigned int)stack_ptr);
-            uart_puts("\n");
-            
-            /* Debug: Check stack contents that RFEIA will load */
-            uart_puts("Stack inspection (RFEIA will load these):\n");
-            uart_puts("stack[0] (should be SPSR) = 0x");
-            uart_hex(stack_ptr[0]);
-            uart_puts("\n");
-            uart_puts("stack[1] (should be PC/LR) = 0x");
-            uart_hex(stack_ptr[1]);
-            uart_puts("\n");
-            uart_puts("stack[2] = 0x");
-            uart_hex(stack_ptr[2]);
-            uart_puts("\n");
-            uart_puts("stack[3] = 0x");
-            uart_hex(stack_ptr[3]);
-            uart_puts("\n");
-        } else {
-            uart_puts("ERROR: pxCurrentTCB is NULL!\n");
+        #if ( configNUMBER_OF_CORES > 1 )
+        {
+            /* Core 0 takes the tick; every core takes yield requests. */
+            configSETUP_CORE_INTERRUPTS( 0 );
+            prvStartSecondaryCores();
         }
-        
+        #endif
+
+        prvRecordFirstTask();
+
+        /* Start the first task executing. */
         vPortRestoreTaskContext();
     }
 
-    /* Will only get here if vTaskStartScheduler() was called with the CPU in
-     * a non-privileged mode or the binary point register was not set to its lowest
-     * possible value.  prvTaskExitError() is referenced to prevent a compiler
-     * warning about it being defined but not referenced in the case that the user
-     * defines their own exit address. */
+    /* Will only get here if vTaskStartScheduler() was called with the binary
+     * point register not set to its lowest possible value.  prvTaskExitError()
+     * is referenced to prevent a compiler warning about it being defined but not
+     * referenced in the case that the user defines their own exit address. */
     ( void ) prvTaskExitError;
     return 0;
 }
@@ -710,13 +763,140 @@ void vPortEndScheduler( void )
 {
     /* Not implemented in ports where there is nothing to return to.
      * Artificially force an assert. */
-    configASSERT( ulCriticalNesting == 1000UL );
+    configASSERT( portCORE_LOCAL( ulCriticalNesting ) == 1000UL );
 }
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+    static void prvStartSecondaryCores( void )
+    {
+        BaseType_t xCoreID;
+
+        for( xCoreID = 1; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+        {
+            #ifdef configSMP_SPIN_TABLE_ADDRESS
+            {
+                /* The VMM holds each secondary core in a loop that waits for a
+                 * non-zero entry point in its word of the table.  The core
+                 * reads it with its caches off, so write it back to memory
+                 * before waking it. */
+                volatile uint32_t * pulReleaseAddress = ( ( volatile uint32_t * ) configSMP_SPIN_TABLE_ADDRESS ) + xCoreID;
+
+                *pulReleaseAddress = ( uint32_t ) _secondary_start;
+                __asm volatile ( "MCR p15, 0, %0, c7, c10, 1 \n" /* DCCMVAC */
+                                 "DSB                        \n"
+                                 "SEV                        \n"
+                                 ::"r" ( pulReleaseAddress ) : "memory" );
+            }
+            #else
+            {
+                register uint32_t r0 __asm( "r0" ) = portPSCI_CPU_ON;
+                register uint32_t r1 __asm( "r1" ) = ( uint32_t ) xCoreID; /* Target MPIDR. */
+                register uint32_t r2 __asm( "r2" ) = ( uint32_t ) _secondary_start;
+                register uint32_t r3 __asm( "r3" ) = 0UL;                  /* Context ID, unused. */
+
+                /* The new core starts with its caches off and reads nothing
+                 * before it has joined coherency - see _secondary_start. */
+                __asm volatile ( ".arch_extension sec \n"
+                                 "DSB                 \n"
+                                 "SMC #0              \n"
+                                 : "+r" ( r0 ) : "r" ( r1 ), "r" ( r2 ), "r" ( r3 ) : "memory" );
+
+                configASSERT( ( ( int32_t ) r0 == portPSCI_SUCCESS ) || ( ( int32_t ) r0 == portPSCI_ALREADY_ON ) );
+            }
+            #endif /* configSMP_SPIN_TABLE_ADDRESS */
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortSecondaryCoreEntry( void )
+    {
+        /* The scheduler is already running on core 0, which gave this core its
+         * own idle task in pxCurrentTCBs[] before starting it. */
+        configSETUP_CORE_INTERRUPTS( portGET_CORE_ID() );
+        vPortRestoreTaskContext();
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortYieldCore( BaseType_t xCoreID )
+    {
+        /* The kernel state the other core is to act on must be visible before
+         * the interrupt arrives. */
+        __asm volatile ( "DSB" ::: "memory" );
+        portGICD_SGIR = ( ( 1UL << ( uint32_t ) xCoreID ) << portGICD_SGIR_TARGET_SHIFT ) | ( uint32_t ) configYIELD_CORE_SGI_ID;
+    }
+/*-----------------------------------------------------------*/
+
+    void FreeRTOS_Yield_Core_Handler( void )
+    {
+        /* The switch itself happens on the way out of FreeRTOS_IRQ_Handler. */
+        portCORE_LOCAL( ulPortYieldRequired ) = pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortGetLock( BaseType_t xLock,
+                       BaseType_t xCoreID )
+    {
+        PortLock_t * pxLock = &( xPortLocks[ xLock ] );
+        uint32_t ulStatus;
+
+        if( pxLock->ulOwner == ( uint32_t ) xCoreID )
+        {
+            pxLock->ulCount++;
+            return;
+        }
+
+        /* Wait with WFE while the lock is held; vPortReleaseLock() sends an
+         * event. */
+        __asm volatile ( "1:                  \n"
+                         "LDREX   %0, [%1]    \n"
+                         "CMP     %0, #0      \n"
+                         "WFENE               \n"
+                         "BNE     1b          \n"
+                         "STREX   %0, %2, [%1]\n"
+                         "CMP     %0, #0      \n"
+                         "BNE     1b          \n"
+                         "DMB                 \n"
+                         : "=&r" ( ulStatus )
+                         : "r" ( &( pxLock->ulLock ) ), "r" ( 1UL )
+                         : "cc", "memory" );
+
+        pxLock->ulOwner = ( uint32_t ) xCoreID;
+        pxLock->ulCount = 1UL;
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortReleaseLock( BaseType_t xLock,
+                           BaseType_t xCoreID )
+    {
+        PortLock_t * pxLock = &( xPortLocks[ xLock ] );
+
+        configASSERT( pxLock->ulOwner == ( uint32_t ) xCoreID );
+        configASSERT( pxLock->ulCount > 0UL );
+        ( void ) xCoreID;
+
+        pxLock->ulCount--;
+
+        if( pxLock->ulCount == 0UL )
+        {
+            pxLock->ulOwner = portLOCK_NO_OWNER;
+            __asm volatile ( "DMB" ::: "memory" );
+            pxLock->ulLock = 0UL;
+            __asm volatile ( "DSB \n"
+                             "SEV \n" ::: "memory" );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* configNUMBER_OF_CORES > 1 */
+
+#if ( configNUMBER_OF_CORES == 1 )
+
 void vPortEnterCritical( void )
 {
-    /* Mask interrupts up to the max syscall interrupt priority. */
+    /* Mask interrupts up to the max syscall interrupt priority, or all of them
+     * if configUSE_CPSR_CRITICAL_SECTIONS is 1. */
     ulPortSetInterruptMask();
 
     /* Now that interrupts are disabled, ulCriticalNesting can be accessed
@@ -750,12 +930,14 @@ void vPortExitCritical( void )
         {
             /* Critical nesting has reached zero so all interrupt priorities
              * should be unmasked. */
-            portCLEAR_INTERRUPT_MASK();
+            portUNMASK_ALL_INTERRUPTS();
         }
     }
 }
 /*-----------------------------------------------------------*/
 
+#endif /* configNUMBER_OF_CORES == 1 */
+
 void FreeRTOS_Tick_Handler( void )
 {
     /* Set interrupt mask before altering scheduler structures.   The tick
@@ -763,20 +945,49 @@ void FreeRTOS_Tick_Handler( void )
      * so there is no need to save and restore the current mask value.  It is
      * necessary to turn off interrupts in the CPU itself while the ICCPMR is being
      * updated. */
-    portCPU_IRQ_DISABLE();
-    portICCPMR_PRIORITY_MASK_REGISTER = ( uint32_t ) ( configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT );
-    __asm volatile ( "dsb        \n"
-                     "isb        \n" ::: "memory" );
-    portCPU_IRQ_ENABLE();
+    #if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 ) && ( configUSE_NESTED_INTERRUPTS == 1 )
+    {
+        /* Higher priority handlers can preempt this one, so mask with the
+         * priority mask until the end of the handler. */
+        ( void ) ulPortSetInterruptMaskFromISR();
+    }
+    #elif ( configUSE_CPSR_CRITICAL_SECTIONS == 1 )
+    {
+        /* Keep IRQs off in the CPU instead, until portUNMASK_ALL_INTERRUPTS()
+         * below. */
+        __asm volatile ( "CPSID i" ::: "memory" );
+        portCORE_LOCAL( ulPortMaskWritesAvoided )++;
+    }
+    #else
+    {
+        portCPU_IRQ_DISABLE();
+        portICCPMR_PRIORITY_MASK_REGISTER = ( uint32_t ) ( configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT );
+        __asm volatile ( "dsb        \n"
+                         "isb        \n" ::: "memory" );
+        portCPU_IRQ_ENABLE();
+    }
+    #endif /* configUSE_CPSR_CRITICAL_SECTIONS */
+
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+    {
+        /* Keep the software extension of the 32-bit cycle counter current,
+         * even if no context switch happens for a long time. */
+        ( void ) ullPortGetRunTimeCounterValue();
+    }
+    #endif
 
     /* Increment the RTOS tick. */
     if( xTaskIncrementTick() != pdFALSE )
     {
-        ulPortYieldRequired = pdTRUE;
+        portCORE_LOCAL( ulPortYieldRequired ) = pdTRUE;
     }
 
     /* Ensure all interrupt priorities are active again. */
-    portCLEAR_INTERRUPT_MASK();
+    #if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 ) && ( configUSE_NESTED_INTERRUPTS == 1 )
+        vPortClearInterruptMaskFromISR( pdFALSE );
+    #else
+        portUNMASK_ALL_INTERRUPTS();
+    #endif
     configCLEAR_TICK_INTERRUPT();
 }
 /*-----------------------------------------------------------*/
@@ -789,7 +1000,7 @@ void FreeRTOS_Tick_Handler( void )
 
         /* A task is registering the fact that it needs an FPU context.  Set the
          * FPU flag (which is saved as part of the task context). */
-        ulPortTaskHasFPUContext = pdTRUE;
+        portCORE_LOCAL( ulPortTaskHasFPUContext ) = pdTRUE;
 
         /* Initialise the floating point status register. */
         __asm volatile ( "FMXR  FPSCR, %0" ::"r" ( ulInitialFPSCR ) : "memory" );
@@ -798,15 +1009,247 @@ void FreeRTOS_Tick_Handler( void )
 #endif /* configUSE_TASK_FPU_SUPPORT */
 /*-----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+/* PMU and generic timer register access. */
+    #define portPMCR_ENABLE            ( 1UL << 0 )
+    #define portPMCR_CYCLE_RESET       ( 1UL << 2 )
+    #define portPMCR_CYCLE_DIV64       ( 1UL << 3 )
+    #define portPMU_CYCLE_COUNTER_BIT  ( 1UL << 31 )
+
+    static portINLINE uint32_t prvReadCycleCounter( void )
+    {
+        uint32_t ulValue;
+
+        __asm volatile ( "MRC p15, 0, %0, c9, c13, 0" : "=r" ( ulValue ) :: "memory" );
+        return ulValue;
+    }
+
+    void vPortConfigureTimerForRunTimeStats( void )
+    {
+        #if ( configNUMBER_OF_CORES > 1 )
+        {
+            /* Each core has its own PMU, and the kernel compares run time
+             * counter values taken on different cores.  The virtual counter is
+             * common to all of them. */
+            ulRunTimeCounterUsesPMU = pdFALSE;
+        }
+        #else
+        {
+            uint32_t ulPMCR, ulStart;
+
+            __asm volatile ( "MRC p15, 0, %0, c9, c12, 0" : "=r" ( ulPMCR ) );
+            ulPMCR |= portPMCR_ENABLE | portPMCR_CYCLE_RESET;
+            ulPMCR &= ~portPMCR_CYCLE_DIV64;
+            __asm volatile ( "MCR p15, 0, %0, c9, c12, 0 \n" /* PMCR */
+                             "MCR p15, 0, %1, c9, c12, 3 \n" /* PMOVSR - clear overflow */
+                             "MCR p15, 0, %1, c9, c12, 1 \n" /* PMCNTENSET */
+                             "ISB                        \n"
+                             ::"r" ( ulPMCR ), "r" ( portPMU_CYCLE_COUNTER_BIT ) : "memory" );
+
+            /* A hypervisor that does not expose the PMU leaves the counter stuck. */
+            ulStart = prvReadCycleCounter();
+
+            for( volatile uint32_t ulDelay = 0; ulDelay < 1000UL; ulDelay++ )
+            {
+            }
+
+            ulRunTimeCounterUsesPMU = ( prvReadCycleCounter() != ulStart ) ? pdTRUE : pdFALSE;
+        }
+        #endif /* configNUMBER_OF_CORES */
+    }
+/*-----------------------------------------------------------*/
+
+    uint64_t ullPortGetRunTimeCounterValue( void )
+    {
+        uint32_t ulCPSR, ulLow, ulOverflow, ulHigh;
+        uint64_t ullValue;
+
+        if( ulRunTimeCounterUsesPMU == pdFALSE )
+        {
+            __asm volatile ( "ISB \n"
+                             "MRRC p15, 1, %0, %1, c14" : "=r" ( ulLow ), "=r" ( ulHigh ) :: "memory" );
+            return ( ( uint64_t ) ulHigh << 32 ) | ulLow;
+        }
+
+        /* Called from tasks, the tick and the context switch, so the counter
+         * and its extension have to be sampled atomically. */
+        __asm volatile ( "MRS %0, CPSR \n"
+                         "CPSID i      \n" : "=r" ( ulCPSR ) :: "memory" );
+
+        ulLow = prvReadCycleCounter();
+        __asm volatile ( "MRC p15, 0, %0, c9, c12, 3" : "=r" ( ulOverflow ) :: "memory" );
+
+        if( ( ulOverflow & portPMU_CYCLE_COUNTER_BIT ) != 0UL )
+        {
+            /* The counter wrapped since the last call.  It may have wrapped
+             * after ulLow was read, so read it again now that the wrap has been
+             * accounted for. */
+            __asm volatile ( "MCR p15, 0, %0, c9, c12, 3" ::"r" ( portPMU_CYCLE_COUNTER_BIT ) : "memory" );
+            ullRunTimeCounterHigh += ( 1ULL << 32 );
+            ulLow = prvReadCycleCounter();
+        }
+
+        ullValue = ullRunTimeCounterHigh | ulLow;
+
+        __asm volatile ( "MSR CPSR_c, %0" ::"r" ( ulCPSR ) : "memory" );
+
+        return ullValue;
+    }
+/*-----------------------------------------------------------*/
+
+    uint32_t ulPortGetRunTimeCounterFrequency( void )
+    {
+        uint32_t ulFrequency;
+
+        if( ulRunTimeCounterUsesPMU != pdFALSE )
+        {
+            return configCPU_CLOCK_HZ;
+        }
+
+        __asm volatile ( "MRC p15, 0, %0, c14, c0, 0" : "=r" ( ulFrequency ) );
+        return ulFrequency;
+    }
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_LAZY_FPU_CONTEXT == 1 )
+
+    void vPortReleaseFPUContext( StackType_t * pxStackBase,
+                                 StackType_t * pxStackTop )
+    {
+        volatile uint32_t * pulOwner = pulPortFPUOwnerContext;
+
+        /* Called via portCLEAN_UP_TCB() before a deleted task's stack is freed.
+         * If the task owns the FPU its registers are simply dropped, so the
+         * next owner does not save them into freed memory. */
+        if( ( pulOwner >= ( volatile uint32_t * ) pxStackBase ) &&
+            ( pulOwner <= ( volatile uint32_t * ) pxStackTop ) )
+        {
+            pulPortFPUOwnerContext = NULL;
+        }
+    }
+
+#endif /* configUSE_LAZY_FPU_CONTEXT */
+/*-----------------------------------------------------------*/
+
 void vPortClearInterruptMask( uint32_t ulNewMaskValue )
 {
     if( ulNewMaskValue == pdFALSE )
     {
-        portCLEAR_INTERRUPT_MASK();
+        portUNMASK_ALL_INTERRUPTS();
     }
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 )
+
+uint32_t ulPortSetInterruptMask( void )
+{
+    uint32_t ulCPSR;
+
+    /* CPSID takes effect before the next instruction, so no barrier is
+     * needed. */
+    __asm volatile ( "MRS %0, CPSR \n"
+                     "CPSID i      \n" : "=r" ( ulCPSR ) :: "memory" );
+
+    if( ( ulCPSR & portINTERRUPT_ENABLE_BIT ) != 0UL )
+    {
+        /* Interrupts were already masked. */
+        return pdTRUE;
+    }
+
+    portCORE_LOCAL( ulPortMaskWritesAvoided )++;
+
+    return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulPortGetMaskWritesAvoided( void )
+{
+    #if ( configNUMBER_OF_CORES > 1 )
+    {
+        uint32_t ulTotal = 0UL;
+        BaseType_t xCoreID;
+
+        for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+        {
+            ulTotal += ulPortMaskWritesAvoided[ xCoreID ];
+        }
+
+        return ulTotal;
+    }
+    #else
+    {
+        return ulPortMaskWritesAvoided;
+    }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_NESTED_INTERRUPTS == 1 )
+
+/* A handler runs with IRQs enabled in the CPU once it has been acknowledged, so
+ * it masks with the priority mask, as without configUSE_CPSR_CRITICAL_SECTIONS,
+ * and interrupts above configMAX_API_CALL_INTERRUPT_PRIORITY still preempt it.
+ * The I bit is put back as it was rather than cleared, as the tick handler and
+ * the FromISR functions can also run with IRQs off. */
+uint32_t ulPortSetInterruptMaskFromISR( void )
+{
+    uint32_t ulCPSR;
+    uint32_t ulReturn;
+
+    __asm volatile ( "MRS %0, CPSR \n"
+                     "CPSID i      \n" : "=r" ( ulCPSR ) :: "memory" );
+
+    if( portICCPMR_PRIORITY_MASK_REGISTER == ( uint32_t ) ( configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT ) )
+    {
+        /* Interrupts were already masked. */
+        ulReturn = pdTRUE;
+    }
+    else
+    {
+        ulReturn = pdFALSE;
+        portICCPMR_PRIORITY_MASK_REGISTER = ( uint32_t ) ( configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT );
+        __asm volatile ( "dsb        \n"
+                         "isb        \n" ::: "memory" );
+    }
+
+    if( ( ulCPSR & portINTERRUPT_ENABLE_BIT ) == 0UL )
+    {
+        __asm volatile ( "CPSIE i" ::: "memory" );
+    }
+
+    return ulReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMaskFromISR( uint32_t ulNewMaskValue )
+{
+    uint32_t ulCPSR;
+
+    if( ulNewMaskValue == pdFALSE )
+    {
+        __asm volatile ( "MRS %0, CPSR \n"
+                         "CPSID i      \n" : "=r" ( ulCPSR ) :: "memory" );
+
+        portICCPMR_PRIORITY_MASK_REGISTER = portUNMASK_VALUE;
+        __asm volatile ( "dsb        \n"
+                         "isb        \n" ::: "memory" );
+
+        if( ( ulCPSR & portINTERRUPT_ENABLE_BIT ) == 0UL )
+        {
+            __asm volatile ( "CPSIE i" ::: "memory" );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_NESTED_INTERRUPTS */
+
+#else /* configUSE_CPSR_CRITICAL_SECTIONS */
+
 uint32_t ulPortSetInterruptMask( void )
 {
     uint32_t ulReturn;
@@ -834,6 +1277,8 @@ uint32_t ulPortSetInterruptMask( void )
 }
 /*-----------------------------------------------------------*/
 
+#endif /* configUSE_CPSR_CRITICAL_SECTIONS */
+
 #if ( configASSERT_DEFINED == 1 )
 
     void vPortValidateInterruptPriority( void )
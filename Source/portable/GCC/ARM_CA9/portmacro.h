@@ -77,15 +77,27 @@ typedef uint32_t         TickType_t;
 /* Task utilities. */
 
 /* Called at the end of an ISR that can cause a context switch. */
-#define portEND_SWITCHING_ISR( xSwitchRequired ) \
-    {                                            \
-        extern uint32_t ulPortYieldRequired;     \
-                                                 \
-        if( xSwitchRequired != pdFALSE )         \
-        {                                        \
-            ulPortYieldRequired = pdTRUE;        \
-        }                                        \
+#if ( configNUMBER_OF_CORES == 1 )
+    #define portEND_SWITCHING_ISR( xSwitchRequired ) \
+    {                                                \
+        extern uint32_t ulPortYieldRequired;         \
+                                                     \
+        if( xSwitchRequired != pdFALSE )             \
+        {                                            \
+            ulPortYieldRequired = pdTRUE;            \
+        }                                            \
     }
+#else
+    #define portEND_SWITCHING_ISR( xSwitchRequired )                  \
+    {                                                                 \
+        extern uint32_t ulPortYieldRequired[ configNUMBER_OF_CORES ]; \
+                                                                      \
+        if( xSwitchRequired != pdFALSE )                              \
+        {                                                             \
+            ulPortYieldRequired[ portGET_CORE_ID() ] = pdTRUE;        \
+        }                                                             \
+    }
+#endif
 
 #define portYIELD_FROM_ISR( x )    portEND_SWITCHING_ISR( x )
 #define portYIELD()                __asm volatile ( "SWI 0" ::: "memory" );
@@ -101,14 +113,73 @@ extern uint32_t ulPortSetInterruptMask( void );
 extern void vPortClearInterruptMask( uint32_t ulNewMaskValue );
 extern void vPortInstallFreeRTOSVectorTable( void );
 
+/* If configUSE_CPSR_CRITICAL_SECTIONS is set to 1 the critical sections and
+ * interrupt masks below clear and set the CPSR I bit instead of writing the GIC
+ * priority mask register, which costs a trap to the VMM when the GIC is
+ * emulated.  Interrupt nesting is still ordered by the GIC's running priority.
+ * Where that order matters - the FromISR masks and the tick handler when
+ * configUSE_NESTED_INTERRUPTS lets handlers be preempted - the priority mask is
+ * kept, so higher priority handlers still preempt them.  Task level critical
+ * sections always use the I bit, so interrupts above
+ * configMAX_API_CALL_INTERRUPT_PRIORITY are held off by them too; builds that
+ * rely on such interrupts preempting the kernel keep the priority mask scheme,
+ * and irq_register() asserts that none is registered.
+ * ulPortGetMaskWritesAvoided() returns the number of priority mask writes saved
+ * so far, on all cores. */
+#ifndef configUSE_CPSR_CRITICAL_SECTIONS
+    #define configUSE_CPSR_CRITICAL_SECTIONS    0
+#endif
+
+#ifndef configUSE_NESTED_INTERRUPTS
+    #define configUSE_NESTED_INTERRUPTS    0
+#endif
+
+/* configUSE_SEL4_PARAVIRT: xPortStartScheduler() probes the VMM's paravirtual
+ * interface and takes the GIC priority bits from it - see sel4_pv.h. */
+#ifndef configUSE_SEL4_PARAVIRT
+    #define configUSE_SEL4_PARAVIRT    0
+#endif
+
+#if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 )
+    extern uint32_t ulPortGetMaskWritesAvoided( void );
+#endif
+
+/* The priority mask forms of ulPortSetInterruptMask() and
+ * vPortClearInterruptMask(), for handlers that can be preempted. */
+#if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 ) && ( configUSE_NESTED_INTERRUPTS == 1 )
+    extern uint32_t ulPortSetInterruptMaskFromISR( void );
+    extern void vPortClearInterruptMaskFromISR( uint32_t ulNewMaskValue );
+#endif
+
 /* These macros do not globally disable/enable interrupts.  They do mask off
- * interrupts that have a priority below configMAX_API_CALL_INTERRUPT_PRIORITY. */
-#define portENTER_CRITICAL()                      vPortEnterCritical();
-#define portEXIT_CRITICAL()                       vPortExitCritical();
+ * interrupts that have a priority below configMAX_API_CALL_INTERRUPT_PRIORITY.
+ * With more than one core the kernel implements the critical sections itself,
+ * on top of the interrupt mask and the spinlocks below. */
+#if ( configNUMBER_OF_CORES == 1 )
+    #define portENTER_CRITICAL()                  vPortEnterCritical();
+    #define portEXIT_CRITICAL()                   vPortExitCritical();
+#else
+    extern void vTaskEnterCritical( void );
+    extern void vTaskExitCritical( void );
+    extern UBaseType_t vTaskEnterCriticalFromISR( void );
+    extern void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus );
+
+    #define portENTER_CRITICAL()                  vTaskEnterCritical()
+    #define portEXIT_CRITICAL()                   vTaskExitCritical()
+    #define portENTER_CRITICAL_FROM_ISR()         vTaskEnterCriticalFromISR()
+    #define portEXIT_CRITICAL_FROM_ISR( x )       vTaskExitCriticalFromISR( x )
+    #define portSET_INTERRUPT_MASK()              ulPortSetInterruptMask()
+    #define portCLEAR_INTERRUPT_MASK( x )         vPortClearInterruptMask( x )
+#endif
 #define portDISABLE_INTERRUPTS()                  ulPortSetInterruptMask()
 #define portENABLE_INTERRUPTS()                   vPortClearInterruptMask( 0 )
-#define portSET_INTERRUPT_MASK_FROM_ISR()         ulPortSetInterruptMask()
-#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    vPortClearInterruptMask( x )
+#if ( configUSE_CPSR_CRITICAL_SECTIONS == 1 ) && ( configUSE_NESTED_INTERRUPTS == 1 )
+    #define portSET_INTERRUPT_MASK_FROM_ISR()         ulPortSetInterruptMaskFromISR()
+    #define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    vPortClearInterruptMaskFromISR( x )
+#else
+    #define portSET_INTERRUPT_MASK_FROM_ISR()         ulPortSetInterruptMask()
+    #define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    vPortClearInterruptMask( x )
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -122,6 +193,11 @@ extern void vPortInstallFreeRTOSVectorTable( void );
  * handler for whichever peripheral is used to generate the RTOS tick. */
 void FreeRTOS_Tick_Handler( void );
 
+/* Save the caller-saved FPU registers and call vApplicationFPUSafeIRQHandler(),
+ * like the default vApplicationIRQHandler() - for an application
+ * vApplicationIRQHandler() that only handles some interrupts without them. */
+void vPortCallFPUSafeIRQHandler( uint32_t ulICCIAR );
+
 /* If configUSE_TASK_FPU_SUPPORT is set to 1 (or left undefined) then tasks are
  * created without an FPU context and must call vPortTaskUsesFPU() to give
  * themselves an FPU context before using any FPU instructions.  If
@@ -137,6 +213,93 @@ void FreeRTOS_Tick_Handler( void );
 #endif
 #define portTASK_USES_FLOATING_POINT()    vPortTaskUsesFPU()
 
+/* If configUSE_LAZY_FPU_CONTEXT is set to 1 (requires configUSE_TASK_FPU_SUPPORT
+ * 2) the FPU registers are not saved and restored on every context switch.  The
+ * FPU is disabled for any task whose registers are not currently loaded, and the
+ * first FPU instruction such a task executes traps to
+ * FreeRTOS_Undefined_Handler, which swaps the register banks.  A deleted task
+ * has to give up ownership before its stack, which holds the save area, is
+ * freed. */
+#ifndef configUSE_LAZY_FPU_CONTEXT
+    #define configUSE_LAZY_FPU_CONTEXT    0
+#endif
+
+#if ( configUSE_LAZY_FPU_CONTEXT == 1 )
+    void vPortReleaseFPUContext( StackType_t * pxStackBase,
+                                 StackType_t * pxStackTop );
+    #define portCLEAN_UP_TCB( pxTCB )    vPortReleaseFPUContext( ( pxTCB )->pxStack, ( pxTCB )->pxEndOfStack )
+#endif
+
+/* Run time stats.  The port counts CPU cycles with the PMU cycle counter,
+ * extended to 64 bits in software, or uses the 64-bit virtual counter if the
+ * hypervisor does not expose the PMU.  The 32-bit cycle counter must be read at
+ * least once per wrap (about 4 s at 1 GHz) for the extension to stay correct;
+ * the tick handler does this, and tickless idle limits sleeps accordingly. */
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+    void vPortConfigureTimerForRunTimeStats( void );
+    uint64_t ullPortGetRunTimeCounterValue( void );
+    uint32_t ulPortGetRunTimeCounterFrequency( void ); /* Counts per second, once the scheduler has started. */
+    #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vPortConfigureTimerForRunTimeStats()
+    #define portGET_RUN_TIME_COUNTER_VALUE()            ullPortGetRunTimeCounterValue()
+
+/* Longest tickless sleep that cannot miss a cycle counter wrap, with margin. */
+    #define portMAX_RUN_TIME_STATS_IDLE_TICKS           ( ( TickType_t ) ( ( 0xFFFFFFFFULL / ( configCPU_CLOCK_HZ / configTICK_RATE_HZ ) ) / 2ULL ) )
+#endif
+
+/* Tickless idle.  The tick peripheral is owned by the application (see
+ * configSETUP_TICK_INTERRUPT()), so the application's tick driver also provides
+ * the function that stops the tick and sleeps. */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+    void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+    #define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )    vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
+/* Kernel data that is always initialised before its first use, such as the
+ * ready lists and the wheels, is linked in .noinit, which startup.S does not
+ * clear - see link.ld. */
+#define portNOINIT    __attribute__( ( section( ".noinit" ) ) )
+
+/* Boot report.  xPortStartScheduler() records what it checked and the first
+ * task's initial context here, at a fixed address below the memory debug
+ * regions, instead of printing it, so the host can read it out of guest memory
+ * (x/20wx 0x40FFF000 in the QEMU monitor).  ulMagic is written last, so a
+ * report with portBOOT_REPORT_MAGIC is complete.  The assertion fields are set
+ * by vPortRecordAssert(), from the application's assertion handler.  See also
+ * configPORT_DEBUG_LEVEL. */
+#define portBOOT_REPORT_ADDRESS              ( 0x40FFF000UL )
+#define portBOOT_REPORT_MAGIC                ( 0x544F4F42UL ) /* "BOOT" */
+#define portBOOT_REPORT_VERSION              ( 1UL )
+
+/* ulFlags bits. */
+#define portBOOT_REPORT_PRIORITY_BITS_OK     ( 1UL << 0 ) /* GIC priority bits match configUNIQUE_INTERRUPT_PRIORITIES. */
+#define portBOOT_REPORT_PRIVILEGED           ( 1UL << 1 ) /* Not started in User mode. */
+#define portBOOT_REPORT_BINARY_POINT_OK      ( 1UL << 2 ) /* Binary point at or below portMAX_BINARY_POINT_VALUE. */
+#define portBOOT_REPORT_PARAVIRT             ( 1UL << 3 ) /* The VMM answered the paravirtual probe - see sel4_pv.h. */
+
+typedef struct PortBootReport
+{
+    volatile uint32_t ulMagic;
+    uint32_t ulVersion;
+    uint32_t ulFlags;
+    uint32_t ulCoreCount;
+    uint32_t ulMaxPriorityValue;      /* GIC priority register read back after writing 0xFF, shifted down, or from the VMM. */
+    uint32_t ulCPUMode;               /* APSR mode bits. */
+    uint32_t ulBinaryPoint;           /* ICCBPR. */
+    uint32_t ulFirstTCB;              /* Task started on core 0. */
+    uint32_t ulFirstStackPointer;     /* Saved in its TCB. */
+    uint32_t ulFirstPC;               /* What RFEIA will load. */
+    uint32_t ulFirstCPSR;
+    uint32_t ulCounterFrequency;      /* CNTFRQ, for the two counts below. */
+    uint32_t ulSchedulerStartCount;   /* Low word of the virtual counter on entry to xPortStartScheduler(). */
+    uint32_t ulFirstTaskCount;        /* ... just before the first task starts. */
+    volatile uint32_t ulAssertLine;   /* 0 if no assertion failed. */
+    const char * volatile pcAssertFile;
+} PortBootReport_t;
+
+extern PortBootReport_t xPortBootReport;
+void vPortRecordAssert( uint32_t ulLine,
+                        const char * pcFileName );
+
 #define portLOWEST_INTERRUPT_PRIORITY           ( ( ( uint32_t ) configUNIQUE_INTERRUPT_PRIORITIES ) - 1UL )
 #define portLOWEST_USABLE_INTERRUPT_PRIORITY    ( portLOWEST_INTERRUPT_PRIORITY - 1UL )
 
@@ -165,6 +328,56 @@ void FreeRTOS_Tick_Handler( void );
 #define portNOP()                                         __asm volatile ( "NOP" )
 #define portINLINE    __inline
 
+/*-----------------------------------------------------------*/
+
+/* Multi-core support. */
+#if ( configNUMBER_OF_CORES > 1 )
+
+/* A core's number is the affinity level 0 field of its MPIDR, which the VMM
+ * numbers from 0 like the DTB's cpu@N nodes. */
+    #define portMPIDR_AFF0_MASK    ( 0xFFUL )
+
+    static portINLINE BaseType_t xPortGetCoreID( void )
+    {
+        uint32_t ulMPIDR;
+
+        __asm volatile ( "MRC p15, 0, %0, c0, c0, 5" : "=r" ( ulMPIDR ) );
+        return ( BaseType_t ) ( ulMPIDR & portMPIDR_AFF0_MASK );
+    }
+
+    #define portGET_CORE_ID()    xPortGetCoreID()
+
+/* Another core is asked to yield with SGI configYIELD_CORE_SGI_ID, whose
+ * handler is FreeRTOS_Yield_Core_Handler(). */
+    void vPortYieldCore( BaseType_t xCoreID );
+    void FreeRTOS_Yield_Core_Handler( void );
+    #define portYIELD_CORE( xCoreID )    vPortYieldCore( xCoreID )
+
+/* The critical nesting count is kept per core by the port, and saved as part
+ * of the task context as on a single core. */
+    extern volatile uint32_t ulCriticalNesting[ configNUMBER_OF_CORES ];
+    #define portGET_CRITICAL_NESTING_COUNT( xCoreID )          ( ulCriticalNesting[ ( xCoreID ) ] )
+    #define portSET_CRITICAL_NESTING_COUNT( xCoreID, x )       ( ulCriticalNesting[ ( xCoreID ) ] = ( x ) )
+    #define portINCREMENT_CRITICAL_NESTING_COUNT( xCoreID )    ( ulCriticalNesting[ ( xCoreID ) ]++ )
+    #define portDECREMENT_CRITICAL_NESTING_COUNT( xCoreID )    ( ulCriticalNesting[ ( xCoreID ) ]-- )
+
+/* The kernel's two locks, recursive spinlocks built on LDREX/STREX.  Both are
+ * only taken with interrupts masked. */
+    #define portRTOS_TASK_LOCK    ( 0 )
+    #define portRTOS_ISR_LOCK     ( 1 )
+
+    void vPortGetLock( BaseType_t xLock,
+                       BaseType_t xCoreID );
+    void vPortReleaseLock( BaseType_t xLock,
+                           BaseType_t xCoreID );
+
+    #define portGET_TASK_LOCK( xCoreID )        vPortGetLock( portRTOS_TASK_LOCK, ( xCoreID ) )
+    #define portRELEASE_TASK_LOCK( xCoreID )    vPortReleaseLock( portRTOS_TASK_LOCK, ( xCoreID ) )
+    #define portGET_ISR_LOCK( xCoreID )         vPortGetLock( portRTOS_ISR_LOCK, ( xCoreID ) )
+    #define portRELEASE_ISR_LOCK( xCoreID )     vPortReleaseLock( portRTOS_ISR_LOCK, ( xCoreID ) )
+
+#endif /* configNUMBER_OF_CORES > 1 */
+
 /* The number of bits to shift for an interrupt priority is dependent on the
  * number of bits implemented by the interrupt controller. */
 #if configUNIQUE_INTERRUPT_PRIORITIES == 16
@@ -203,6 +416,42 @@ void FreeRTOS_Tick_Handler( void );
 
 #define portMEMORY_BARRIER()    __asm volatile ( "" ::: "memory" )
 
+/* Compare and swap a word with LDREX/STREX, outside any critical section:
+ * *pulTarget is set to ulNew if it holds ulExpected.  Returns the value it held,
+ * so the swap happened if that is ulExpected.  With more than one core the
+ * swap is bracketed by barriers, so it orders memory as a lock acquire or
+ * release would.  Used by the mutex fast path (configUSE_MUTEX_FAST_PATH). */
+#if ( configNUMBER_OF_CORES > 1 )
+    #define portCAS_BARRIER    "DMB                 \n"
+#else
+    #define portCAS_BARRIER
+#endif
+
+static portINLINE uint32_t ulPortCompareAndSwap( volatile uint32_t * pulTarget,
+                                                 uint32_t ulExpected,
+                                                 uint32_t ulNew )
+{
+    uint32_t ulOld, ulFailed;
+
+    __asm volatile ( portCAS_BARRIER
+                     "1:                  \n"
+                     "LDREX   %0, [%2]    \n"
+                     "CMP     %0, %3      \n"
+                     "BNE     2f          \n"
+                     "STREX   %1, %4, [%2]\n"
+                     "CMP     %1, #0      \n"
+                     "BNE     1b          \n"
+                     "2:                  \n"
+                     portCAS_BARRIER
+                     : "=&r" ( ulOld ), "=&r" ( ulFailed )
+                     : "r" ( pulTarget ), "r" ( ulExpected ), "r" ( ulNew )
+                     : "cc", "memory" );
+
+    return ulOld;
+}
+
+#define portCOMPARE_AND_SWAP( pulTarget, ulExpected, ulNew )    ulPortCompareAndSwap( ( pulTarget ), ( ulExpected ), ( ulNew ) )
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
     }
@@ -47,21 +47,35 @@
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
-/* A few bytes might be lost to byte aligning the heap start address. */
-#define configADJUSTED_HEAP_SIZE    ( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT )
-
 /* Allocate the memory for the heap. */
-#if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
+#if ( configHEAP_FROM_LINKER_REGION == 1 )
+
+    /* The application supplies the heap region, and its size, at run time
+     * through vApplicationGetHeapRegion() - typically so the heap can be a
+     * linker defined region sized to the RAM actually present. */
+    PRIVILEGED_DATA static uint8_t * ucHeap = NULL;
+    PRIVILEGED_DATA static size_t xHeapRegionSize = ( size_t ) 0;
+
+    /* A few bytes might be lost to byte aligning the heap start address. */
+    #define configADJUSTED_HEAP_SIZE    ( ( xHeapRegionSize > portBYTE_ALIGNMENT ) ? ( xHeapRegionSize - portBYTE_ALIGNMENT ) : ( size_t ) 0 )
+
+#elif ( configAPPLICATION_ALLOCATED_HEAP == 1 )
 
     /* The application writer has already defined the array used for the RTOS
      * heap - probably so it can be placed in a special segment or address. */
     extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
 
+    /* A few bytes might be lost to byte aligning the heap start address. */
+    #define configADJUSTED_HEAP_SIZE    ( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT )
+
 #else
 
     PRIVILEGED_DATA static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
 
-#endif /* configAPPLICATION_ALLOCATED_HEAP */
+    /* A few bytes might be lost to byte aligning the heap start address. */
+    #define configADJUSTED_HEAP_SIZE    ( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT )
+
+#endif /* configHEAP_FROM_LINKER_REGION */
 
 PRIVILEGED_DATA static size_t xNextFreeByte = ( size_t ) 0;
 
@@ -87,6 +101,13 @@ void * pvPortMalloc( size_t xWantedSize )
     {
         if( pucAlignedHeap == NULL )
         {
+            #if ( configHEAP_FROM_LINKER_REGION == 1 )
+            {
+                vApplicationGetHeapRegion( &ucHeap, &xHeapRegionSize );
+                configASSERT( ( ucHeap != NULL ) && ( xHeapRegionSize > portBYTE_ALIGNMENT ) );
+            }
+            #endif
+
             /* Ensure the heap starts on a correctly aligned boundary. */
             pucAlignedHeap = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) &ucHeap[ portBYTE_ALIGNMENT - 1 ] ) & ( ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) );
         }
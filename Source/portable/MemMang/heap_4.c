@@ -55,6 +55,25 @@
     #define configHEAP_CLEAR_MEMORY_ON_FREE    0
 #endif
 
+#if ( configUSE_HEAP_PROFILER == 1 )
+    #include "cache.h"
+
+    #if ( ( configHEAP_PROFILER_SITES & ( configHEAP_PROFILER_SITES - 1 ) ) != 0 )
+        #error configHEAP_PROFILER_SITES must be a power of two
+    #endif
+
+/* The caller recorded for an allocation.  pvPortMalloc() is kept out of line
+ * so that this is the code that called it, not its caller's caller. */
+    #define heapCALLER_ADDRESS()     __builtin_return_address( 0 )
+    #define heapPROFILED_FUNCTION    __attribute__( ( noinline ) )
+
+/* An allocated block's xSite when every site entry was taken. */
+    #define heapPROFILE_NO_SITE      ( ~( ( size_t ) 0 ) )
+#else
+    #define heapCALLER_ADDRESS()     NULL
+    #define heapPROFILED_FUNCTION
+#endif
+
 /* Block sizes must not get too small. */
 #define heapMINIMUM_BLOCK_SIZE    ( ( size_t ) ( xHeapStructSize << 1 ) )
 
@@ -86,21 +105,35 @@
 /*-----------------------------------------------------------*/
 
 /* Allocate the memory for the heap. */
-#if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
+#if ( configHEAP_FROM_LINKER_REGION == 1 )
+
+/* The application supplies the heap region, and its size, at run time through
+ * vApplicationGetHeapRegion() - typically so the heap can be a linker defined
+ * region sized to the RAM actually present. */
+    PRIVILEGED_DATA static uint8_t * ucHeap = NULL;
+    PRIVILEGED_DATA static size_t xHeapRegionSize = ( size_t ) 0;
+    #define heapREGION_SIZE    ( xHeapRegionSize )
+#elif ( configAPPLICATION_ALLOCATED_HEAP == 1 )
 
 /* The application writer has already defined the array used for the RTOS
  * heap - probably so it can be placed in a special segment or address. */
     extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+    #define heapREGION_SIZE    ( ( size_t ) configTOTAL_HEAP_SIZE )
 #else
     PRIVILEGED_DATA static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
-#endif /* configAPPLICATION_ALLOCATED_HEAP */
+    #define heapREGION_SIZE    ( ( size_t ) configTOTAL_HEAP_SIZE )
+#endif /* configHEAP_FROM_LINKER_REGION */
 
 /* Define the linked list structure.  This is used to link free blocks in order
  * of their memory address. */
 typedef struct A_BLOCK_LINK
 {
+    #if ( configUSE_HEAP_PROFILER == 1 )
+        void * pvCaller;                   /**< Allocated blocks: the code that called pvPortMalloc(). */
+        size_t xSite;                      /**< Allocated blocks: the xHeapProfile.xSites index of pvCaller. */
+    #endif
     struct A_BLOCK_LINK * pxNextFreeBlock; /**< The next free block in the list. */
-    size_t xBlockSize;                     /**< The size of the free block. */
+    size_t xBlockSize;                     /**< The size of the free block.  Last, so just below the returned pointer - see heap_pool.c. */
 } BlockLink_t;
 
 /* Setting configENABLE_HEAP_PROTECTOR to 1 enables heap block pointers
@@ -133,7 +166,7 @@ typedef struct A_BLOCK_LINK
 /* Assert that a heap block pointer is within the heap bounds. */
 #define heapVALIDATE_BLOCK_POINTER( pxBlock )                          \
     configASSERT( ( ( uint8_t * ) ( pxBlock ) >= &( ucHeap[ 0 ] ) ) && \
-                  ( ( uint8_t * ) ( pxBlock ) <= &( ucHeap[ configTOTAL_HEAP_SIZE - 1 ] ) ) )
+                  ( ( uint8_t * ) ( pxBlock ) <= &( ucHeap[ heapREGION_SIZE - 1 ] ) ) )
 
 /*-----------------------------------------------------------*/
 
@@ -151,6 +184,27 @@ static void prvInsertBlockIntoFreeList( BlockLink_t * pxBlockToInsert ) PRIVILEG
  */
 static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * pvPortMalloc(), with the caller to record for the allocation.
+ */
+static void * prvHeapMalloc( size_t xWantedSize,
+                             void * pvCaller ) PRIVILEGED_FUNCTION;
+
+#if ( configUSE_HEAP_PROFILER == 1 )
+
+/*
+ * Account for an allocation or a free in xHeapProfile.  Called with the
+ * scheduler suspended, pxBlock NULL for a failed allocation.
+ */
+    static void prvProfileMalloc( BlockLink_t * pxBlock,
+                                  void * pvCaller,
+                                  size_t xRequestedSize,
+                                  configRUN_TIME_COUNTER_TYPE xStartTime ) PRIVILEGED_FUNCTION;
+    static void prvProfileFree( const BlockLink_t * pxBlock,
+                                configRUN_TIME_COUNTER_TYPE xStartTime ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_HEAP_PROFILER */
+
 /*-----------------------------------------------------------*/
 
 /* The size of the structure placed at the beginning of each allocated memory
@@ -168,9 +222,25 @@ PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0U;
 PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = ( size_t ) 0U;
 PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = ( size_t ) 0U;
 
+#if ( configUSE_HEAP_PROFILER == 1 )
+
+/* At a fixed address, for the host - see portable.h.  Left out of the BSS
+ * clear and formatted by prvHeapInit(); 'used' keeps LTO from dropping the
+ * stores only the host reads. */
+    PRIVILEGED_DATA HeapProfile_t xHeapProfile __attribute__( ( section( ".heap_profile" ), used ) );
+
+#endif /* configUSE_HEAP_PROFILER */
+
 /*-----------------------------------------------------------*/
 
-void * pvPortMalloc( size_t xWantedSize )
+heapPROFILED_FUNCTION void * pvPortMalloc( size_t xWantedSize )
+{
+    return prvHeapMalloc( xWantedSize, heapCALLER_ADDRESS() );
+}
+/*-----------------------------------------------------------*/
+
+static void * prvHeapMalloc( size_t xWantedSize,
+                             void * pvCaller ) /* PRIVILEGED_FUNCTION */
 {
     BlockLink_t * pxBlock;
     BlockLink_t * pxPreviousBlock;
@@ -179,6 +249,14 @@ void * pvPortMalloc( size_t xWantedSize )
     size_t xAdditionalRequiredSize;
     size_t xAllocatedBlockSize = 0;
 
+    #if ( configUSE_HEAP_PROFILER == 1 )
+        const configRUN_TIME_COUNTER_TYPE xStartTime = portGET_RUN_TIME_COUNTER_VALUE();
+        const size_t xRequestedSize = xWantedSize;
+        BlockLink_t * pxAllocatedBlock = NULL;
+    #else
+        ( void ) pvCaller;
+    #endif
+
     if( xWantedSize > 0 )
     {
         /* The wanted size must be increased so it can contain a BlockLink_t
@@ -310,6 +388,12 @@ void * pvPortMalloc( size_t xWantedSize )
                     heapALLOCATE_BLOCK( pxBlock );
                     pxBlock->pxNextFreeBlock = heapPROTECT_BLOCK_POINTER( NULL );
                     xNumberOfSuccessfulAllocations++;
+
+                    #if ( configUSE_HEAP_PROFILER == 1 )
+                    {
+                        pxAllocatedBlock = pxBlock;
+                    }
+                    #endif
                 }
                 else
                 {
@@ -330,6 +414,12 @@ void * pvPortMalloc( size_t xWantedSize )
 
         /* Prevent compiler warnings when trace macros are not used. */
         ( void ) xAllocatedBlockSize;
+
+        #if ( configUSE_HEAP_PROFILER == 1 )
+        {
+            prvProfileMalloc( pxAllocatedBlock, pvCaller, xRequestedSize, xStartTime );
+        }
+        #endif
     }
     ( void ) xTaskResumeAll();
 
@@ -356,6 +446,10 @@ void vPortFree( void * pv )
     uint8_t * puc = ( uint8_t * ) pv;
     BlockLink_t * pxLink;
 
+    #if ( configUSE_HEAP_PROFILER == 1 )
+        const configRUN_TIME_COUNTER_TYPE xStartTime = portGET_RUN_TIME_COUNTER_VALUE();
+    #endif
+
     if( pv != NULL )
     {
         /* The memory being freed will have an BlockLink_t structure immediately
@@ -392,6 +486,12 @@ void vPortFree( void * pv )
                     /* Add this block to the list of free blocks. */
                     xFreeBytesRemaining += pxLink->xBlockSize;
                     traceFREE( pv, pxLink->xBlockSize );
+                    #if ( configUSE_HEAP_PROFILER == 1 )
+                    {
+                        /* Before the block can be merged into another. */
+                        prvProfileFree( pxLink, xStartTime );
+                    }
+                    #endif
                     prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
                     xNumberOfSuccessfulFrees++;
                 }
@@ -457,7 +557,16 @@ static void prvHeapInit( void ) /* PRIVILEGED_FUNCTION */
 {
     BlockLink_t * pxFirstFreeBlock;
     portPOINTER_SIZE_TYPE uxStartAddress, uxEndAddress;
-    size_t xTotalHeapSize = configTOTAL_HEAP_SIZE;
+    size_t xTotalHeapSize;
+
+    #if ( configHEAP_FROM_LINKER_REGION == 1 )
+    {
+        vApplicationGetHeapRegion( &ucHeap, &xHeapRegionSize );
+        configASSERT( ( ucHeap != NULL ) && ( xHeapRegionSize > ( portBYTE_ALIGNMENT + ( 2 * sizeof( BlockLink_t ) ) ) ) );
+    }
+    #endif
+
+    xTotalHeapSize = heapREGION_SIZE;
 
     /* Ensure the heap starts on a correctly aligned boundary. */
     uxStartAddress = ( portPOINTER_SIZE_TYPE ) ucHeap;
@@ -498,6 +607,20 @@ static void prvHeapInit( void ) /* PRIVILEGED_FUNCTION */
     /* Only one block exists - and it covers the entire usable heap space. */
     xMinimumEverFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
     xFreeBytesRemaining = pxFirstFreeBlock->xBlockSize;
+
+    #if ( configUSE_HEAP_PROFILER == 1 )
+    {
+        ( void ) memset( &xHeapProfile, 0x00, sizeof( xHeapProfile ) );
+        xHeapProfile.ulVersion = heapPROFILE_VERSION;
+        xHeapProfile.ulSiteCount = configHEAP_PROFILER_SITES;
+        xHeapProfile.ulBucketCount = heapPROFILE_SIZE_BUCKETS;
+        xHeapProfile.ulHeapStart = ( uint32_t ) uxStartAddress;
+        xHeapProfile.ulHeapSize = ( uint32_t ) ( uxEndAddress - uxStartAddress );
+        xHeapProfile.ulHeaderSize = ( uint32_t ) xHeapStructSize;
+        portMEMORY_BARRIER();
+        xHeapProfile.ulMagic = heapPROFILE_MAGIC;
+    }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -636,3 +759,188 @@ void vPortHeapResetState( void )
     xNumberOfSuccessfulFrees = ( size_t ) 0U;
 }
 /*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_PROFILER == 1 )
+
+    static uint32_t prvProfileBucket( size_t xSize )
+    {
+        uint32_t ulBucket;
+
+        /* Bucket 0 below 16 bytes, then one per power of two. */
+        if( xSize < ( size_t ) 16U )
+        {
+            ulBucket = 0U;
+        }
+        else
+        {
+            ulBucket = ( uint32_t ) ( 31 - __builtin_clz( ( uint32_t ) xSize ) ) - 3U;
+
+            if( ulBucket >= ( uint32_t ) heapPROFILE_SIZE_BUCKETS )
+            {
+                ulBucket = ( uint32_t ) heapPROFILE_SIZE_BUCKETS - 1U;
+            }
+        }
+
+        return ulBucket;
+    }
+/*-----------------------------------------------------------*/
+
+    static uint32_t prvProfileElapsed( configRUN_TIME_COUNTER_TYPE xStartTime )
+    {
+        configRUN_TIME_COUNTER_TYPE xElapsed = portGET_RUN_TIME_COUNTER_VALUE() - xStartTime;
+
+        return ( xElapsed > ( configRUN_TIME_COUNTER_TYPE ) UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) xElapsed;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvProfileMalloc( BlockLink_t * pxBlock,
+                                  void * pvCaller,
+                                  size_t xRequestedSize,
+                                  configRUN_TIME_COUNTER_TYPE xStartTime ) /* PRIVILEGED_FUNCTION */
+    {
+        HeapProfileSite_t * pxSite = NULL;
+        size_t xSite = heapPROFILE_NO_SITE;
+        size_t xProbe;
+        uint32_t ulElapsed;
+
+        xHeapProfile.ulMallocCalls++;
+        xHeapProfile.ulRequestHistogram[ prvProfileBucket( xRequestedSize ) ]++;
+
+        if( pxBlock == NULL )
+        {
+            xHeapProfile.ulMallocFailures++;
+        }
+        else
+        {
+            /* Open addressing on the caller; entries are never removed, so the
+             * first free entry ends the search. */
+            for( xProbe = 0; xProbe < ( size_t ) configHEAP_PROFILER_SITES; xProbe++ )
+            {
+                size_t xIndex = ( ( ( ( uint32_t ) pvCaller ) >> 2 ) * 2654435761UL + ( uint32_t ) xProbe ) & ( ( size_t ) configHEAP_PROFILER_SITES - 1U );
+
+                if( xHeapProfile.xSites[ xIndex ].ulCaller == ( uint32_t ) pvCaller )
+                {
+                    xSite = xIndex;
+                    break;
+                }
+
+                if( xHeapProfile.xSites[ xIndex ].ulCaller == 0U )
+                {
+                    xHeapProfile.xSites[ xIndex ].ulCaller = ( uint32_t ) pvCaller;
+                    xSite = xIndex;
+                    break;
+                }
+            }
+
+            pxBlock->pvCaller = pvCaller;
+            pxBlock->xSite = xSite;
+
+            if( xSite != heapPROFILE_NO_SITE )
+            {
+                pxSite = &( xHeapProfile.xSites[ xSite ] );
+                pxSite->ulAllocations++;
+                pxSite->ulBytesInUse += ( uint32_t ) ( pxBlock->xBlockSize & ~heapBLOCK_ALLOCATED_BITMASK );
+
+                if( pxSite->ulBytesInUse > pxSite->ulMaxBytesInUse )
+                {
+                    pxSite->ulMaxBytesInUse = pxSite->ulBytesInUse;
+                }
+            }
+            else
+            {
+                xHeapProfile.ulSitesFull++;
+            }
+        }
+
+        ulElapsed = prvProfileElapsed( xStartTime );
+        xHeapProfile.ullMallocTime += ulElapsed;
+
+        if( ulElapsed > xHeapProfile.ulMallocMaxTime )
+        {
+            xHeapProfile.ulMallocMaxTime = ulElapsed;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvProfileFree( const BlockLink_t * pxBlock,
+                                configRUN_TIME_COUNTER_TYPE xStartTime ) /* PRIVILEGED_FUNCTION */
+    {
+        uint32_t ulElapsed;
+
+        if( pxBlock->xSite < ( size_t ) configHEAP_PROFILER_SITES )
+        {
+            HeapProfileSite_t * pxSite = &( xHeapProfile.xSites[ pxBlock->xSite ] );
+
+            pxSite->ulFrees++;
+            pxSite->ulBytesInUse -= ( uint32_t ) pxBlock->xBlockSize;
+        }
+
+        xHeapProfile.ulFreeCalls++;
+        ulElapsed = prvProfileElapsed( xStartTime );
+        xHeapProfile.ullFreeTime += ulElapsed;
+
+        if( ulElapsed > xHeapProfile.ulFreeMaxTime )
+        {
+            xHeapProfile.ulFreeMaxTime = ulElapsed;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    void vPortHeapProfileSnapshot( void )
+    {
+        BlockLink_t * pxBlock;
+        uint32_t ulBucket;
+        size_t x;
+
+        vTaskSuspendAll();
+        {
+            if( pxEnd != NULL )
+            {
+                xHeapProfile.ulSnapshotSequence++;
+                portMEMORY_BARRIER();
+
+                xHeapProfile.ulSnapshotTick = ( uint32_t ) xTaskGetTickCount();
+                xHeapProfile.ulFreeBytes = ( uint32_t ) xFreeBytesRemaining;
+                xHeapProfile.ulFreeBlocks = 0U;
+                xHeapProfile.ulLargestFreeBlock = 0U;
+
+                #if ( configGENERATE_RUN_TIME_STATS == 1 )
+                {
+                    xHeapProfile.ulCounterFrequency = ulPortGetRunTimeCounterFrequency();
+                }
+                #endif
+
+                for( x = 0; x < ( size_t ) heapPROFILE_SIZE_BUCKETS; x++ )
+                {
+                    xHeapProfile.ulMapBlocks[ x ] = 0U;
+                    xHeapProfile.ulMapBytes[ x ] = 0U;
+                }
+
+                /* The free list is in address order, so this is also the
+                 * order the host would find the holes in. */
+                for( pxBlock = heapPROTECT_BLOCK_POINTER( xStart.pxNextFreeBlock ); pxBlock != pxEnd; pxBlock = heapPROTECT_BLOCK_POINTER( pxBlock->pxNextFreeBlock ) )
+                {
+                    heapVALIDATE_BLOCK_POINTER( pxBlock );
+                    ulBucket = prvProfileBucket( pxBlock->xBlockSize );
+                    xHeapProfile.ulMapBlocks[ ulBucket ]++;
+                    xHeapProfile.ulMapBytes[ ulBucket ] += ( uint32_t ) pxBlock->xBlockSize;
+                    xHeapProfile.ulFreeBlocks++;
+
+                    if( pxBlock->xBlockSize > xHeapProfile.ulLargestFreeBlock )
+                    {
+                        xHeapProfile.ulLargestFreeBlock = ( uint32_t ) pxBlock->xBlockSize;
+                    }
+                }
+
+                portMEMORY_BARRIER();
+                xHeapProfile.ulSnapshotSequence++;
+
+                /* The host reads RAM, not this core's data cache. */
+                cache_clean_range( &xHeapProfile, sizeof( xHeapProfile ) );
+            }
+        }
+        ( void ) xTaskResumeAll();
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_HEAP_PROFILER */
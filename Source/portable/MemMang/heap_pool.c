@@ -0,0 +1,346 @@
+/*
+ * Size-class pool allocator in front of heap_4.
+ *
+ * Kernel objects come in a handful of sizes - TCBs, queues, timers, and task
+ * stacks of a few common depths.  Requests up to the largest size class are
+ * served from a per-class free list of fixed-size blocks, which makes
+ * pvPortMalloc() and vPortFree() O(1) for them and keeps task churn from
+ * fragmenting the general heap.  Pools grow a slab at a time from heap_4 and
+ * never give memory back; anything larger than the largest class, or any
+ * request a pool cannot grow for, goes to heap_4 directly.
+ *
+ * The size classes are configHEAP_POOL_SIZES (bytes, ascending), and their
+ * number configHEAP_POOL_CLASS_COUNT.  Per-class statistics, including the
+ * high-water mark of blocks in use, are returned in HeapStats_t.xPoolStats by
+ * vPortGetHeapStats().
+ *
+ * Each pool block carries an 8 byte header, laid out like heap_4's BlockLink_t
+ * so that the word just below the returned pointer says where the block came
+ * from: heap_4 marks allocated blocks with heapBLOCK_ALLOCATED_BITMASK in that
+ * word, pool blocks hold a tag with that bit clear.
+ *
+ * Pool blocks are aligned to configHEAP_POOL_ALIGNMENT, portBYTE_ALIGNMENT by
+ * default.  Set to the cache line size, objects from different blocks never
+ * share a line - see configUSE_TCB_CACHE_LAYOUT.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configUSE_HEAP_POOLS != 1 )
+    #error heap_pool.c requires configUSE_HEAP_POOLS to be set to 1
+#endif
+
+#ifndef configHEAP_POOL_SIZES
+    #error configHEAP_POOL_SIZES must list the pool block sizes in bytes, in ascending order
+#endif
+
+#ifndef configHEAP_POOL_ALIGNMENT
+    #define configHEAP_POOL_ALIGNMENT    portBYTE_ALIGNMENT
+#endif
+
+#if ( ( configHEAP_POOL_ALIGNMENT < portBYTE_ALIGNMENT ) || ( ( configHEAP_POOL_ALIGNMENT & ( configHEAP_POOL_ALIGNMENT - 1 ) ) != 0 ) )
+    #error configHEAP_POOL_ALIGNMENT must be a power of two no less than portBYTE_ALIGNMENT
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* heap_4 is the general purpose back end.  It is compiled into this file with
+ * its public functions renamed, so that the names the kernel calls are the ones
+ * defined below. */
+#define pvPortMalloc             pvHeapGeneralMalloc
+#define vPortFree                vHeapGeneralFree
+#define pvPortCalloc             pvHeapGeneralCalloc
+#define vPortGetHeapStats        vHeapGeneralGetStats
+#define vPortHeapResetState      vHeapGeneralResetState
+
+void * pvPortMalloc( size_t xWantedSize );
+void vPortFree( void * pv );
+void * pvPortCalloc( size_t xNum,
+                     size_t xSize );
+void vPortGetHeapStats( HeapStats_t * pxHeapStats );
+void vPortHeapResetState( void );
+
+#include "heap_4.c"
+
+#undef pvPortMalloc
+#undef vPortFree
+#undef pvPortCalloc
+#undef vPortGetHeapStats
+#undef vPortHeapResetState
+
+/*-----------------------------------------------------------*/
+
+/* Pool block header, the same size as heap_4's and with the tag where heap_4
+ * keeps the block size. */
+typedef struct PoolBlockHeader
+{
+    struct PoolBlockHeader * pxNextFree; /* Free list link - only valid while the block is free. */
+    size_t xTag;                         /* poolTAG_MAGIC | class index. */
+} PoolBlockHeader_t;
+
+#define poolHEADER_SIZE        ( sizeof( PoolBlockHeader_t ) )
+#define poolTAG_MAGIC          ( ( size_t ) 0x504F0000UL )
+#define poolTAG_MAGIC_MASK     ( ( size_t ) 0xFFFF0000UL )
+#define poolTAG_CLASS_MASK     ( ( size_t ) 0x0000FFFFUL )
+#define poolALIGNMENT_MASK     ( ( size_t ) configHEAP_POOL_ALIGNMENT - 1U )
+
+/* Slabs are about this size, but always hold at least one block. */
+#define poolSLAB_TARGET_BYTES  ( ( size_t ) 1024U )
+
+typedef struct PoolClass
+{
+    size_t xBlockSize;               /* Usable bytes per block. */
+    size_t xStride;                  /* Header and block, rounded up to the alignment. */
+    size_t xBlocksPerSlab;
+    PoolBlockHeader_t * pxFreeList;
+    HeapPoolStats_t xStats;
+} PoolClass_t;
+
+static const size_t xPoolSizes[ configHEAP_POOL_CLASS_COUNT ] = configHEAP_POOL_SIZES;
+
+PRIVILEGED_DATA static PoolClass_t xPoolClasses[ configHEAP_POOL_CLASS_COUNT ];
+PRIVILEGED_DATA static BaseType_t xPoolsInitialised = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+static void prvPoolInit( void ) PRIVILEGED_FUNCTION;
+static BaseType_t prvPoolGrow( PoolClass_t * pxClass,
+                               size_t xClassIndex ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+static void prvPoolInit( void ) /* PRIVILEGED_FUNCTION */
+{
+    size_t x;
+
+    for( x = 0; x < ( size_t ) configHEAP_POOL_CLASS_COUNT; x++ )
+    {
+        /* Keep every block, and so every returned pointer, aligned.  Any
+         * space the alignment adds to a block is usable. */
+        size_t xStride = ( xPoolSizes[ x ] + poolHEADER_SIZE + poolALIGNMENT_MASK ) & ~poolALIGNMENT_MASK;
+        size_t xBlockSize = xStride - poolHEADER_SIZE;
+
+        configASSERT( ( x == 0 ) || ( xPoolSizes[ x ] > xPoolSizes[ x - 1 ] ) );
+
+        xPoolClasses[ x ].xBlockSize = xBlockSize;
+        xPoolClasses[ x ].xStride = xStride;
+        xPoolClasses[ x ].xBlocksPerSlab = ( xStride < poolSLAB_TARGET_BYTES ) ? ( poolSLAB_TARGET_BYTES / xStride ) : 1U;
+        xPoolClasses[ x ].pxFreeList = NULL;
+        memset( &( xPoolClasses[ x ].xStats ), 0x00, sizeof( HeapPoolStats_t ) );
+        xPoolClasses[ x ].xStats.xBlockSize = xBlockSize;
+    }
+
+    xPoolsInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPoolGrow( PoolClass_t * pxClass,
+                               size_t xClassIndex ) /* PRIVILEGED_FUNCTION */
+{
+    size_t xStride = pxClass->xStride;
+    uint8_t * pucSlab;
+    size_t x;
+
+    /* Called with the scheduler suspended, which heap_4 tolerates.  heap_4
+     * only aligns to portBYTE_ALIGNMENT, so the first block may have to start
+     * further in; slabs are never freed, so nothing needs the original
+     * pointer. */
+    pucSlab = ( uint8_t * ) pvHeapGeneralMalloc( ( xStride * pxClass->xBlocksPerSlab ) + ( configHEAP_POOL_ALIGNMENT - portBYTE_ALIGNMENT ) );
+
+    if( pucSlab == NULL )
+    {
+        return pdFALSE;
+    }
+
+    pucSlab += ( ( size_t ) configHEAP_POOL_ALIGNMENT - ( ( ( size_t ) pucSlab + poolHEADER_SIZE ) & poolALIGNMENT_MASK ) ) & poolALIGNMENT_MASK;
+
+    for( x = 0; x < pxClass->xBlocksPerSlab; x++ )
+    {
+        PoolBlockHeader_t * pxBlock = ( PoolBlockHeader_t * ) ( pucSlab + ( x * xStride ) );
+
+        pxBlock->xTag = poolTAG_MAGIC | xClassIndex;
+        pxBlock->pxNextFree = pxClass->pxFreeList;
+        pxClass->pxFreeList = pxBlock;
+    }
+
+    pxClass->xStats.xBlocksTotal += pxClass->xBlocksPerSlab;
+    pxClass->xStats.xSlabs++;
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+heapPROFILED_FUNCTION void * pvPortMalloc( size_t xWantedSize )
+{
+    PoolClass_t * pxClass = NULL;
+    PoolBlockHeader_t * pxBlock = NULL;
+    void * pvReturn = NULL;
+    size_t x;
+
+    if( ( xWantedSize == 0 ) || ( xWantedSize > xPoolSizes[ configHEAP_POOL_CLASS_COUNT - 1 ] ) )
+    {
+        /* The profiler records this function's caller, not this call. */
+        return prvHeapMalloc( xWantedSize, heapCALLER_ADDRESS() );
+    }
+
+    vTaskSuspendAll();
+    {
+        if( xPoolsInitialised == pdFALSE )
+        {
+            prvPoolInit();
+        }
+
+        /* A fixed, small number of classes - this is the O(1) part. */
+        for( x = 0; x < ( size_t ) configHEAP_POOL_CLASS_COUNT; x++ )
+        {
+            if( xWantedSize <= xPoolClasses[ x ].xBlockSize )
+            {
+                pxClass = &( xPoolClasses[ x ] );
+                break;
+            }
+        }
+
+        if( ( pxClass->pxFreeList != NULL ) || ( prvPoolGrow( pxClass, x ) != pdFALSE ) )
+        {
+            pxBlock = pxClass->pxFreeList;
+            pxClass->pxFreeList = pxBlock->pxNextFree;
+            pxBlock->pxNextFree = NULL;
+
+            pxClass->xStats.xBlocksInUse++;
+            pxClass->xStats.xNumberOfAllocations++;
+
+            if( pxClass->xStats.xBlocksInUse > pxClass->xStats.xMaxBlocksInUse )
+            {
+                pxClass->xStats.xMaxBlocksInUse = pxClass->xStats.xBlocksInUse;
+            }
+
+            pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + poolHEADER_SIZE );
+            traceMALLOC( pvReturn, xWantedSize );
+        }
+        else
+        {
+            /* The pool cannot grow by a whole slab; the request alone may
+             * still fit in the general heap. */
+            pxClass->xStats.xNumberOfFallbacks++;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    if( pvReturn == NULL )
+    {
+        pvReturn = prvHeapMalloc( xWantedSize, heapCALLER_ADDRESS() );
+    }
+
+    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void * pv )
+{
+    PoolBlockHeader_t * pxBlock;
+    PoolClass_t * pxClass;
+    size_t xClassIndex;
+
+    if( pv == NULL )
+    {
+        return;
+    }
+
+    pxBlock = ( PoolBlockHeader_t * ) ( ( ( uint8_t * ) pv ) - poolHEADER_SIZE );
+
+    if( ( pxBlock->xTag & heapBLOCK_ALLOCATED_BITMASK ) != 0 )
+    {
+        /* Allocated by heap_4. */
+        vHeapGeneralFree( pv );
+        return;
+    }
+
+    xClassIndex = pxBlock->xTag & poolTAG_CLASS_MASK;
+    configASSERT( ( pxBlock->xTag & poolTAG_MAGIC_MASK ) == poolTAG_MAGIC );
+    configASSERT( xClassIndex < ( size_t ) configHEAP_POOL_CLASS_COUNT );
+    configASSERT( pxBlock->pxNextFree == NULL );
+
+    pxClass = &( xPoolClasses[ xClassIndex ] );
+
+    #if ( configHEAP_CLEAR_MEMORY_ON_FREE == 1 )
+    {
+        ( void ) memset( pv, 0, pxClass->xBlockSize );
+    }
+    #endif
+
+    vTaskSuspendAll();
+    {
+        pxBlock->pxNextFree = pxClass->pxFreeList;
+        pxClass->pxFreeList = pxBlock;
+        pxClass->xStats.xBlocksInUse--;
+        traceFREE( pv, pxClass->xBlockSize );
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortCalloc( size_t xNum,
+                     size_t xSize )
+{
+    void * pv = NULL;
+
+    if( heapMULTIPLY_WILL_OVERFLOW( xNum, xSize ) == 0 )
+    {
+        pv = pvPortMalloc( xNum * xSize );
+
+        if( pv != NULL )
+        {
+            ( void ) memset( pv, 0, xNum * xSize );
+        }
+    }
+
+    return pv;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t * pxHeapStats )
+{
+    size_t x;
+
+    /* The general heap figures include the slabs, which are allocated from
+     * it, and count each slab as one allocation. */
+    vHeapGeneralGetStats( pxHeapStats );
+
+    vTaskSuspendAll();
+    {
+        if( xPoolsInitialised == pdFALSE )
+        {
+            prvPoolInit();
+        }
+
+        for( x = 0; x < ( size_t ) configHEAP_POOL_CLASS_COUNT; x++ )
+        {
+            pxHeapStats->xPoolStats[ x ] = xPoolClasses[ x ].xStats;
+        }
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Reset the state in this file. This state is normally initialized at start up.
+ * This function must be called by the application before restarting the
+ * scheduler.
+ */
+void vPortHeapResetState( void )
+{
+    vHeapGeneralResetState();
+    xPoolsInitialised = pdFALSE;
+}
+/*-----------------------------------------------------------*/
@@ -5,8 +5,24 @@
 
 #include "FreeRTOS.h"
 
-/* Simple heap - just a static buffer */
+/* Simple heap - just a static buffer, or the region the application hands
+ * out through vApplicationGetHeapRegion() */
+#if ( configHEAP_FROM_LINKER_REGION == 1 )
+static uint8_t *ucHeap = NULL;
+static size_t xHeapSize = 0;
+
+static void prvHeapInit( void )
+{
+    if (ucHeap == NULL) {
+        vApplicationGetHeapRegion(&ucHeap, &xHeapSize);
+    }
+}
+#else
 static uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+static const size_t xHeapSize = configTOTAL_HEAP_SIZE;
+
+#define prvHeapInit()
+#endif
 static size_t xNextFreeByte = 0;
 
 void * pvPortMalloc( size_t xWantedSize )
@@ -18,8 +34,10 @@ void * pvPortMalloc( size_t xWantedSize )
         xWantedSize = (xWantedSize + 4) & ~3;
     }
     
+    prvHeapInit();
+
     /* Check if we have enough space */
-    if (xNextFreeByte + xWantedSize <= configTOTAL_HEAP_SIZE) {
+    if (xNextFreeByte + xWantedSize <= xHeapSize) {
         pvReturn = &ucHeap[xNextFreeByte];
         xNextFreeByte += xWantedSize;
     }
@@ -40,10 +58,10 @@ void vPortInitialiseBlocks( void )
 
 size_t xPortGetFreeHeapSize( void )
 {
-    return (configTOTAL_HEAP_SIZE - xNextFreeByte);
+    return (xHeapSize - xNextFreeByte);
 }
 
 size_t xPortGetMinimumEverFreeHeapSize( void )
 {
-    return (configTOTAL_HEAP_SIZE - xNextFreeByte);
+    return (xHeapSize - xNextFreeByte);
 }
\ No newline at end of file
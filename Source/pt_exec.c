@@ -0,0 +1,433 @@
+/*
+ * Stackless worker executor - see pt_exec.h.
+ *
+ * A worker's 'link' and 'state' belong to the critical section: tasks and
+ * ISRs move workers from event wait lists to run queues.  Its 'timer' link
+ * belongs to the executor's task alone, so a worker woken by an event stays
+ * in its timer slot until the executor next runs it or reaches the slot.
+ * Nothing running has a timer: one is started only at a wait.
+ */
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "pt_exec.h"
+
+#define PT_WHEEL_MASK           ((TickType_t)PT_WHEEL_SLOTS - 1)
+
+// Tick comparisons across the counter wrap
+#define PT_TICK_REACHED(t, now) ((TickType_t)((now) - (t)) <= (portMAX_DELAY / 2))
+
+// Worker state
+#define PT_STATE_READY          0
+#define PT_STATE_RUNNING        1
+#define PT_STATE_WAITING        2
+#define PT_STATE_DONE           3
+
+static inline void list_init(pt_link_t *l) {
+    l->next = l;
+    l->prev = l;
+}
+
+static inline int list_empty(const pt_link_t *l) {
+    return l->next == l;
+}
+
+static inline void list_append(pt_link_t *l, pt_link_t *n) {
+    n->prev = l->prev;
+    n->next = l;
+    l->prev->next = n;
+    l->prev = n;
+}
+
+static inline void list_remove(pt_link_t *n) {
+    n->prev->next = n->next;
+    n->next->prev = n->prev;
+    list_init(n);
+}
+
+static inline pt_worker_t *worker_of_link(pt_link_t *l) {
+    return (pt_worker_t *)((char *)l - offsetof(pt_worker_t, link));
+}
+
+static inline pt_worker_t *worker_of_timer(pt_link_t *l) {
+    return (pt_worker_t *)((char *)l - offsetof(pt_worker_t, timer));
+}
+
+// Critical section held.  Returns the executor to notify.
+static pt_exec_t *ready_locked(pt_worker_t *w) {
+    w->state = PT_STATE_READY;
+    list_append(&w->exec->ready, &w->link);
+    w->exec->ready_count++;
+    return w->exec;
+}
+
+static void notify(pt_exec_t *e) {
+    TaskHandle_t task = e->task;
+
+    // A worker readying another in its own executor needs no wake up, and
+    // before the task starts its first pass finds the run queue anyway.
+    if (task != NULL && task != xTaskGetCurrentTaskHandle()) {
+        xTaskNotifyGive(task);
+    }
+}
+
+// Critical section held: pass a signal to the longest waiting worker, or keep
+// it.  Returns the executor to notify, or NULL.
+static pt_exec_t *event_give_locked(pt_event_t *ev) {
+    pt_worker_t *w;
+
+    if (list_empty(&ev->waiters)) {
+        if (ev->count < ev->max) {
+            ev->count++;
+        }
+        return NULL;
+    }
+    w = worker_of_link(ev->waiters.next);
+    list_remove(&w->link);
+    w->event = NULL;
+    w->result = PT_RESULT_OK;
+    return ready_locked(w);
+}
+
+// Executor task: start the timer of a worker that is parking.
+static void timer_start(pt_worker_t *w, TickType_t ticks) {
+    pt_exec_t *e = w->exec;
+    TickType_t slot;
+
+    if (ticks > portMAX_DELAY / 2) {
+        ticks = portMAX_DELAY / 2;
+    }
+    w->wake = xTaskGetTickCount() + ticks;
+
+    // Relative to the last tick the wheel reached, which may be behind
+    if ((TickType_t)(w->wake - e->now) < (TickType_t)PT_WHEEL_SLOTS) {
+        slot = w->wake & PT_WHEEL_MASK;
+        list_append(&e->wheel[slot], &w->timer);
+        e->wheel_map |= 1ULL << slot;
+    } else {
+        list_append(&e->far, &w->timer);
+    }
+}
+
+// Executor task: a worker's timer expired.
+static void timer_expire(pt_worker_t *w) {
+    list_remove(&w->timer);
+    taskENTER_CRITICAL();
+    if (w->state == PT_STATE_WAITING) {
+        if (w->event != NULL) {
+            list_remove(&w->link);
+            w->event = NULL;
+        }
+        w->result = PT_RESULT_TIMEOUT;
+        (void)ready_locked(w);
+    }
+    taskEXIT_CRITICAL();
+}
+
+static void wheel_expire_slot(pt_exec_t *e, TickType_t slot, TickType_t now) {
+    pt_link_t *head = &e->wheel[slot];
+    pt_link_t *l = head->next;
+
+    while (l != head) {
+        pt_worker_t *w = worker_of_timer(l);
+
+        l = l->next;
+        // Woken otherwise and not yet run, or due: either way off the wheel.
+        // Entries for a later revolution only exist while the wheel lags.
+        if (w->state != PT_STATE_WAITING) {
+            list_remove(&w->timer);
+        } else if (PT_TICK_REACHED(w->wake, now)) {
+            timer_expire(w);
+        }
+    }
+    if (list_empty(head)) {
+        e->wheel_map &= ~(1ULL << slot);
+    }
+}
+
+// Move long waits that are now within a revolution onto the wheel.
+static void far_cascade(pt_exec_t *e, TickType_t now) {
+    pt_link_t *l = e->far.next;
+
+    while (l != &e->far) {
+        pt_worker_t *w = worker_of_timer(l);
+        TickType_t slot = w->wake & PT_WHEEL_MASK;
+
+        l = l->next;
+        if (w->state != PT_STATE_WAITING) {
+            list_remove(&w->timer);
+        } else if (PT_TICK_REACHED(w->wake, now)) {
+            timer_expire(w);
+        } else if ((TickType_t)(w->wake - now) < (TickType_t)PT_WHEEL_SLOTS) {
+            list_remove(&w->timer);
+            list_append(&e->wheel[slot], &w->timer);
+            e->wheel_map |= 1ULL << slot;
+        }
+    }
+}
+
+// Advance the wheel from e->now to 'now', a slot per tick, or every slot once
+// if it fell a revolution or more behind.
+static void timers_advance(pt_exec_t *e, TickType_t now) {
+    TickType_t elapsed = now - e->now;
+    TickType_t n = (elapsed < (TickType_t)PT_WHEEL_SLOTS) ? elapsed : (TickType_t)PT_WHEEL_SLOTS;
+    int wrapped = (elapsed >= (TickType_t)PT_WHEEL_SLOTS) ||
+                  ((e->now & ~PT_WHEEL_MASK) != (now & ~PT_WHEEL_MASK));
+
+    for (TickType_t i = 1; i <= n; i++) {
+        TickType_t slot = (e->now + i) & PT_WHEEL_MASK;
+
+        if (e->wheel_map & (1ULL << slot)) {
+            wheel_expire_slot(e, slot, now);
+        }
+    }
+    e->now = now;
+    if (wrapped && !list_empty(&e->far)) {
+        far_cascade(e, now);
+    }
+}
+
+// Ticks from now to the next slot that may be occupied, or to the next
+// revolution while there are long waits.
+static TickType_t timers_next(pt_exec_t *e) {
+    uint32_t start = (uint32_t)((e->now + 1) & PT_WHEEL_MASK);
+    uint64_t map = e->wheel_map;
+    TickType_t target = 0;
+    int found = 0;
+    TickType_t now;
+
+    if (start != 0) {
+        map = (map >> start) | (map << (PT_WHEEL_SLOTS - start));
+    }
+    if (map != 0) {
+        target = e->now + 1 + (TickType_t)__builtin_ctzll(map);
+        found = 1;
+    }
+    if (!list_empty(&e->far)) {
+        TickType_t revolution = (e->now | PT_WHEEL_MASK) + 1;
+
+        if (!found || PT_TICK_REACHED(revolution, target)) {
+            target = revolution;
+        }
+        found = 1;
+    }
+    if (!found) {
+        return portMAX_DELAY;
+    }
+    now = xTaskGetTickCount();
+    return PT_TICK_REACHED(target, now) ? 0 : target - now;
+}
+
+// Run each worker that was ready at the start of the pass once.
+static void run_ready(pt_exec_t *e) {
+    uint32_t budget;
+
+    taskENTER_CRITICAL();
+    budget = e->ready_count;
+    taskEXIT_CRITICAL();
+
+    while (budget-- > 0) {
+        pt_worker_t *w;
+        int status;
+
+        taskENTER_CRITICAL();
+        if (list_empty(&e->ready)) {
+            taskEXIT_CRITICAL();
+            break;
+        }
+        w = worker_of_link(e->ready.next);
+        list_remove(&w->link);
+        e->ready_count--;
+        w->state = PT_STATE_RUNNING;
+        taskEXIT_CRITICAL();
+
+        if (w->timer.next != &w->timer) {
+            list_remove(&w->timer);
+        }
+
+        status = w->fn(w);
+        e->runs++;
+
+        taskENTER_CRITICAL();
+        if (status == PT_DONE) {
+            w->state = PT_STATE_DONE;
+            e->workers--;
+        } else if (w->state == PT_STATE_RUNNING) {
+            // Returned without a wait: run it again next pass.
+            (void)ready_locked(w);
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+void pt_exec_init(pt_exec_t *exec) {
+    list_init(&exec->ready);
+    exec->ready_count = 0;
+    exec->workers = 0;
+    exec->task = NULL;
+    exec->now = xTaskGetTickCount();
+    exec->wheel_map = 0;
+    list_init(&exec->far);
+    for (uint32_t i = 0; i < PT_WHEEL_SLOTS; i++) {
+        list_init(&exec->wheel[i]);
+    }
+    exec->passes = 0;
+    exec->runs = 0;
+}
+
+void pt_exec_run(void *exec) {
+    pt_exec_t *e = (pt_exec_t *)exec;
+    uint32_t idle;
+
+    configASSERT(e != NULL);
+    taskENTER_CRITICAL();
+    e->task = xTaskGetCurrentTaskHandle();
+    taskEXIT_CRITICAL();
+
+    for (;;) {
+        timers_advance(e, xTaskGetTickCount());
+        run_ready(e);
+        e->passes++;
+
+        taskENTER_CRITICAL();
+        idle = (e->ready_count == 0);
+        taskEXIT_CRITICAL();
+
+        // A wake up between the check and the take leaves the notification
+        // count set, so the take returns at once.
+        if (idle) {
+            (void)ulTaskNotifyTake(pdTRUE, timers_next(e));
+        } else {
+            taskYIELD();
+        }
+    }
+}
+
+void pt_spawn(pt_exec_t *exec, pt_worker_t *w, pt_worker_fn fn, void *arg) {
+    configASSERT(exec != NULL && w != NULL && fn != NULL);
+    list_init(&w->link);
+    list_init(&w->timer);
+    w->exec = exec;
+    w->fn = fn;
+    w->arg = arg;
+    w->event = NULL;
+    w->wake = 0;
+    w->pc = 0;
+    w->result = PT_RESULT_OK;
+
+    taskENTER_CRITICAL();
+    exec->workers++;
+    (void)ready_locked(w);
+    taskEXIT_CRITICAL();
+    notify(exec);
+}
+
+void pt_sleep(pt_worker_t *w, TickType_t ticks) {
+    taskENTER_CRITICAL();
+    if (ticks == 0) {
+        (void)ready_locked(w);
+    } else {
+        w->state = PT_STATE_WAITING;
+    }
+    taskEXIT_CRITICAL();
+    if (ticks != 0) {
+        timer_start(w, ticks);
+    }
+}
+
+void pt_event_init(pt_event_t *ev, uint32_t count, uint32_t max) {
+    configASSERT(max != 0 && count <= max);
+    list_init(&ev->waiters);
+    ev->count = count;
+    ev->max = max;
+}
+
+int pt_event_wait(pt_worker_t *w, pt_event_t *ev, TickType_t timeout) {
+    int parked = 0;
+
+    taskENTER_CRITICAL();
+    if (ev->count > 0) {
+        ev->count--;
+        w->result = PT_RESULT_OK;
+    } else if (timeout == 0) {
+        w->result = PT_RESULT_TIMEOUT;
+    } else {
+        w->state = PT_STATE_WAITING;
+        w->event = ev;
+        list_append(&ev->waiters, &w->link);
+        parked = 1;
+    }
+    taskEXIT_CRITICAL();
+
+    // A give in between readies the worker first; the timer is then stale
+    // and dropped when the worker next runs.
+    if (parked && timeout != portMAX_DELAY) {
+        timer_start(w, timeout);
+    }
+    return parked;
+}
+
+void pt_event_give(pt_event_t *ev) {
+    pt_exec_t *e;
+
+    taskENTER_CRITICAL();
+    e = event_give_locked(ev);
+    taskEXIT_CRITICAL();
+    if (e != NULL) {
+        notify(e);
+    }
+}
+
+void pt_event_give_from_isr(pt_event_t *ev, BaseType_t *woken) {
+    UBaseType_t saved;
+    pt_exec_t *e;
+
+    saved = taskENTER_CRITICAL_FROM_ISR();
+    e = event_give_locked(ev);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+    if (e != NULL && e->task != NULL) {
+        vTaskNotifyGiveFromISR(e->task, woken);
+    }
+}
+
+void pt_queue_init(pt_queue_t *q, QueueHandle_t queue) {
+    configASSERT(queue != NULL);
+    q->queue = queue;
+    pt_event_init(&q->items, 0, 1);
+    pt_event_init(&q->space, 0, 1);
+}
+
+int pt_queue_send(pt_queue_t *q, const void *item, TickType_t ticks) {
+    if (xQueueSend(q->queue, item, ticks) != pdPASS) {
+        return -1;
+    }
+    pt_event_give(&q->items);
+    return 0;
+}
+
+int pt_queue_send_from_isr(pt_queue_t *q, const void *item, BaseType_t *woken) {
+    if (xQueueSendFromISR(q->queue, item, woken) != pdPASS) {
+        return -1;
+    }
+    pt_event_give_from_isr(&q->items, woken);
+    return 0;
+}
+
+int pt_queue_receive(pt_queue_t *q, void *buf, TickType_t ticks) {
+    if (xQueueReceive(q->queue, buf, ticks) != pdPASS) {
+        return -1;
+    }
+    pt_event_give(&q->space);
+    return 0;
+}
+
+int pt_queue_try_send(pt_queue_t *q, const void *item) {
+    return pt_queue_send(q, item, 0);
+}
+
+int pt_queue_try_receive(pt_queue_t *q, void *buf) {
+    return pt_queue_receive(q, buf, 0);
+}
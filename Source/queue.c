@@ -53,6 +53,26 @@
 #define queueLOCKED_UNMODIFIED    ( ( int8_t ) 0 )
 #define queueINT8_MAX             ( ( int8_t ) 127 )
 
+/* Copy one item into or out of the queue storage area.  One word items -
+ * handles, pointers and msg_pool buffer descriptors - are the common case and
+ * are moved with a single load and store rather than a call to memcpy().  The
+ * item can be of any type, so the word is accessed through a may_alias type
+ * that the compiler does not assume to be distinct from it. */
+typedef uint32_t __attribute__( ( may_alias ) ) QueueItemWord_t;
+
+#define queueCOPY_ITEM( pvDest, pvSource, uxSize )                                                               \
+    do {                                                                                                         \
+        if( ( ( uxSize ) == sizeof( uint32_t ) ) &&                                                              \
+            ( ( ( ( portPOINTER_SIZE_TYPE ) ( pvDest ) | ( portPOINTER_SIZE_TYPE ) ( pvSource ) ) & 3U ) == 0U ) ) \
+        {                                                                                                        \
+            *( ( QueueItemWord_t * ) ( pvDest ) ) = *( ( const QueueItemWord_t * ) ( pvSource ) );               \
+        }                                                                                                        \
+        else                                                                                                     \
+        {                                                                                                        \
+            ( void ) memcpy( ( void * ) ( pvDest ), ( const void * ) ( pvSource ), ( size_t ) ( uxSize ) );      \
+        }                                                                                                        \
+    } while( 0 )
+
 /* When the Queue_t structure is used to represent a base queue its pcHead and
  * pcTail members are used as pointers into the queue storage area.  When the
  * Queue_t structure is used to represent a mutex pcHead and pcTail pointers are
@@ -82,6 +102,24 @@ typedef struct SemaphoreData
 #define queueSEMAPHORE_QUEUE_ITEM_LENGTH    ( ( UBaseType_t ) 0 )
 #define queueMUTEX_GIVE_BLOCK_TIME          ( ( TickType_t ) 0U )
 
+/* Values of the ulFastLock member used by configUSE_MUTEX_FAST_PATH.  A free
+ * mutex is claimed by swapping queueFAST_LOCK_FREE for the handle of the
+ * taking task, and given back by swapping the handle for queueFAST_LOCK_FREE,
+ * with neither touching the rest of the structure.  A task that finds the
+ * mutex held swaps in queueFAST_LOCK_SLOW, inside a critical section, copying
+ * the holder into the queue members the blocking and priority inheritance
+ * code use; the holder's swap back then fails and it takes the normal give
+ * path, which restores queueFAST_LOCK_FREE once the mutex is free with nothing
+ * waiting.  queueFAST_LOCK_NEVER marks queues, semaphores, recursive mutexes
+ * and mutexes in queue sets, which never use the fast path.  TCBs are word
+ * aligned, so no task handle equals one of these values. */
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+    #define queueFAST_LOCK_FREE                 ( ( uint32_t ) 0U )
+    #define queueFAST_LOCK_SLOW                 ( ( uint32_t ) 1U )
+    #define queueFAST_LOCK_NEVER                ( ( uint32_t ) 2U )
+    #define queueFAST_LOCK_IS_HELD( ulLock )    ( ( ulLock ) > queueFAST_LOCK_NEVER )
+#endif
+
 #if ( configUSE_PREEMPTION == 0 )
 
 /* If the cooperative scheduler is being used then a yield should not be
@@ -133,6 +171,10 @@ typedef struct QueueDefinition /* The old naming convention is used to prevent b
         UBaseType_t uxQueueNumber;
         uint8_t ucQueueType;
     #endif
+
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+        volatile uint32_t ulFastLock; /**< The mutex fast path's lock word - see queueFAST_LOCK_FREE. */
+    #endif
 } xQUEUE;
 
 /* The old xQUEUE name is maintained above then typedefed to the new Queue_t
@@ -210,6 +252,35 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
 static void prvCopyDataFromQueue( Queue_t * const pxQueue,
                                   void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Copy as many of uxCount items as there is space for into, or as many as are
+ * available out of, the queue, in at most two contiguous runs either side of
+ * the wrap point.  Both update uxMessagesWaiting and return the number of
+ * items moved.  Called from a critical section.
+ */
+static UBaseType_t prvCopyItemsToQueue( Queue_t * const pxQueue,
+                                        const uint8_t * pucItems,
+                                        UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+static UBaseType_t prvCopyItemsFromQueue( Queue_t * const pxQueue,
+                                          uint8_t * pucBuffer,
+                                          UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Unblock at most uxCount tasks from pxEventList, one per item added to or
+ * removed from the queue.  Returns pdTRUE if any of them has a priority above
+ * that of the calling task.  Called from a critical section with the queue
+ * unlocked.
+ */
+static BaseType_t prvUnblockEventListTasks( List_t * const pxEventList,
+                                            UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Tell the receivers that uxCount items were just posted to the queue - either
+ * the queue set the queue belongs to or the tasks blocked on the queue itself.
+ */
+static BaseType_t prvNotifyItemsSent( Queue_t * const pxQueue,
+                                      UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
 #if ( configUSE_QUEUE_SETS == 1 )
 
 /*
@@ -235,7 +306,28 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
  * as a mutex.
  */
 #if ( configUSE_MUTEXES == 1 )
-    static void prvInitialiseMutex( Queue_t * pxNewQueue ) PRIVILEGED_FUNCTION;
+    static void prvInitialiseMutex( Queue_t * pxNewQueue,
+                                    const uint8_t ucQueueType ) PRIVILEGED_FUNCTION;
+#endif
+
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+
+/*
+ * Take or give a mutex on the fast path with a single compare and swap of its
+ * lock word, and no critical section.  Return pdFALSE, having changed nothing,
+ * if the mutex is not free (take) or not held uncontended by the calling task
+ * (give), in which case the caller goes on to the normal path.
+ */
+    static BaseType_t prvFastMutexTake( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+    static BaseType_t prvFastMutexGive( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Move a mutex off the fast path, to queueFAST_LOCK_SLOW or
+ * queueFAST_LOCK_NEVER, making the holder and count queue members current.
+ * Must be called from within a critical section.
+ */
+    static void prvFastMutexToQueue( Queue_t * const pxQueue,
+                                     const uint32_t ulNewLock ) PRIVILEGED_FUNCTION;
 #endif
 
 #if ( configUSE_MUTEXES == 1 )
@@ -608,14 +700,26 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
     }
     #endif /* configUSE_QUEUE_SETS */
 
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+    {
+        /* prvInitialiseMutex() enables the fast path for plain mutexes. */
+        pxNewQueue->ulFastLock = queueFAST_LOCK_NEVER;
+    }
+    #endif
+
     traceQUEUE_CREATE( pxNewQueue );
 }
 /*-----------------------------------------------------------*/
 
 #if ( configUSE_MUTEXES == 1 )
 
-    static void prvInitialiseMutex( Queue_t * pxNewQueue )
+    static void prvInitialiseMutex( Queue_t * pxNewQueue,
+                                    const uint8_t ucQueueType )
     {
+        /* Remove compiler warnings about unused parameters should
+         * configUSE_MUTEX_FAST_PATH not be set to 1. */
+        ( void ) ucQueueType;
+
         if( pxNewQueue != NULL )
         {
             /* The queue create function will set all the queue structure members
@@ -632,6 +736,23 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
 
             /* Start with the semaphore in the expected state. */
             ( void ) xQueueGenericSend( pxNewQueue, NULL, ( TickType_t ) 0U, queueSEND_TO_BACK );
+
+            #if ( configUSE_MUTEX_FAST_PATH == 1 )
+            {
+                /* The mutex is now free, with the holder and count members
+                 * as queueFAST_LOCK_FREE expects them.  A recursive mutex
+                 * keeps its take count in the queue members, so stays off the
+                 * fast path. */
+                if( ucQueueType == queueQUEUE_TYPE_MUTEX )
+                {
+                    pxNewQueue->ulFastLock = queueFAST_LOCK_FREE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            #endif /* configUSE_MUTEX_FAST_PATH */
         }
         else
         {
@@ -652,7 +773,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
         traceENTER_xQueueCreateMutex( ucQueueType );
 
         xNewQueue = xQueueGenericCreate( uxMutexLength, uxMutexSize, ucQueueType );
-        prvInitialiseMutex( ( Queue_t * ) xNewQueue );
+        prvInitialiseMutex( ( Queue_t * ) xNewQueue, ucQueueType );
 
         traceRETURN_xQueueCreateMutex( xNewQueue );
 
@@ -677,7 +798,7 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
         ( void ) ucQueueType;
 
         xNewQueue = xQueueGenericCreateStatic( uxMutexLength, uxMutexSize, NULL, pxStaticQueue, ucQueueType );
-        prvInitialiseMutex( ( Queue_t * ) xNewQueue );
+        prvInitialiseMutex( ( Queue_t * ) xNewQueue, ucQueueType );
 
         traceRETURN_xQueueCreateMutexStatic( xNewQueue );
 
@@ -708,6 +829,19 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
             if( pxSemaphore->uxQueueType == queueQUEUE_IS_MUTEX )
             {
                 pxReturn = pxSemaphore->u.xSemaphore.xMutexHolder;
+
+                #if ( configUSE_MUTEX_FAST_PATH == 1 )
+                {
+                    /* A holder that took the mutex on the fast path is only
+                     * recorded in the lock word. */
+                    const uint32_t ulLock = pxSemaphore->ulFastLock;
+
+                    if( queueFAST_LOCK_IS_HELD( ulLock ) )
+                    {
+                        pxReturn = ( TaskHandle_t ) ( portPOINTER_SIZE_TYPE ) ulLock;
+                    }
+                }
+                #endif
             }
             else
             {
@@ -740,6 +874,17 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
         if( ( ( Queue_t * ) xSemaphore )->uxQueueType == queueQUEUE_IS_MUTEX )
         {
             pxReturn = ( ( Queue_t * ) xSemaphore )->u.xSemaphore.xMutexHolder;
+
+            #if ( configUSE_MUTEX_FAST_PATH == 1 )
+            {
+                const uint32_t ulLock = ( ( Queue_t * ) xSemaphore )->ulFastLock;
+
+                if( queueFAST_LOCK_IS_HELD( ulLock ) )
+                {
+                    pxReturn = ( TaskHandle_t ) ( portPOINTER_SIZE_TYPE ) ulLock;
+                }
+            }
+            #endif
         }
         else
         {
@@ -754,6 +899,122 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength,
 #endif /* if ( ( configUSE_MUTEXES == 1 ) && ( INCLUDE_xSemaphoreGetMutexHolder == 1 ) ) */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+
+    static BaseType_t prvFastMutexTake( Queue_t * const pxQueue )
+    {
+        TaskHandle_t xSelf;
+        BaseType_t xReturn = pdFALSE;
+
+        if( pxQueue->ulFastLock == queueFAST_LOCK_FREE )
+        {
+            /* Count the mutex as held before it can be seen to be, so that a
+             * task that finds it held and inherits into this task always finds
+             * the count that accounts for it. */
+            xSelf = pvTaskIncrementMutexHeldCount();
+
+            if( xSelf != NULL )
+            {
+                if( portCOMPARE_AND_SWAP( &( pxQueue->ulFastLock ), queueFAST_LOCK_FREE, ( uint32_t ) ( portPOINTER_SIZE_TYPE ) xSelf ) == queueFAST_LOCK_FREE )
+                {
+                    xReturn = pdTRUE;
+                }
+                else
+                {
+                    /* Another task got there first.  This task held one more
+                     * mutex a moment ago, so nothing is disinherited. */
+                    ( void ) xTaskDecrementMutexHeldCount();
+                }
+            }
+            else
+            {
+                /* No task is running yet, so there is no handle to store. */
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvFastMutexGive( Queue_t * const pxQueue )
+    {
+        const uint32_t ulLock = pxQueue->ulFastLock;
+        BaseType_t xReturn = pdFALSE;
+
+        /* Only the holder can swap its own handle out.  If a task has blocked
+         * on the mutex since it was taken the lock word is
+         * queueFAST_LOCK_SLOW, the swap fails, and the give goes through the
+         * queue code - which wakes that task and undoes any inheritance.  A
+         * priority inherited through a mutex given back earlier is undone here
+         * if this is the last mutex the task holds. */
+        if( queueFAST_LOCK_IS_HELD( ulLock ) &&
+            ( ulLock == ( uint32_t ) ( portPOINTER_SIZE_TYPE ) xTaskGetCurrentTaskHandle() ) &&
+            ( portCOMPARE_AND_SWAP( &( pxQueue->ulFastLock ), ulLock, queueFAST_LOCK_FREE ) == ulLock ) )
+        {
+            traceQUEUE_SEND( pxQueue );
+
+            if( xTaskDecrementMutexHeldCount() != pdFALSE )
+            {
+                /* Given back in a different order to the mutexes taken. */
+                queueYIELD_IF_USING_PREEMPTION();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            xReturn = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvFastMutexToQueue( Queue_t * const pxQueue,
+                                     const uint32_t ulNewLock )
+    {
+        uint32_t ulLock;
+
+        do
+        {
+            ulLock = pxQueue->ulFastLock;
+
+            if( ( ulLock == queueFAST_LOCK_NEVER ) || ( ulLock == ulNewLock ) )
+            {
+                /* Already where it is being moved to, or never on the fast
+                 * path. */
+                return;
+            }
+        } while( portCOMPARE_AND_SWAP( &( pxQueue->ulFastLock ), ulLock, ulNewLock ) != ulLock );
+
+        if( queueFAST_LOCK_IS_HELD( ulLock ) )
+        {
+            /* Taken on the fast path: record the holder where priority
+             * inheritance looks for it.  Its mutex held count already
+             * includes this mutex. */
+            pxQueue->u.xSemaphore.xMutexHolder = ( TaskHandle_t ) ( portPOINTER_SIZE_TYPE ) ulLock;
+            pxQueue->uxMessagesWaiting = ( UBaseType_t ) 0;
+        }
+        else
+        {
+            /* Free, or already in the queue code (queueFAST_LOCK_SLOW moving
+             * to queueFAST_LOCK_NEVER): the members are current. */
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_MUTEX_FAST_PATH */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_RECURSIVE_MUTEXES == 1 )
 
     BaseType_t xQueueGiveMutexRecursive( QueueHandle_t xMutex )
@@ -966,6 +1227,23 @@ BaseType_t xQueueGenericSend( QueueHandle_t xQueue,
     }
     #endif
 
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+    {
+        /* Giving back a mutex nothing has blocked on needs no critical
+         * section. */
+        if( prvFastMutexGive( pxQueue ) != pdFALSE )
+        {
+            traceRETURN_xQueueGenericSend( pdPASS );
+
+            return pdPASS;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif /* configUSE_MUTEX_FAST_PATH */
+
     for( ; ; )
     {
         taskENTER_CRITICAL();
@@ -1074,6 +1352,26 @@ BaseType_t xQueueGenericSend( QueueHandle_t xQueue,
                 }
                 #endif /* configUSE_QUEUE_SETS */
 
+                #if ( configUSE_MUTEX_FAST_PATH == 1 )
+                {
+                    /* A mutex moved off the fast path by contention goes back
+                     * to it once it is free with nothing waiting.  The holder
+                     * and count members are then as queueFAST_LOCK_FREE
+                     * expects them.  Nothing else swaps the lock word while it
+                     * is queueFAST_LOCK_SLOW outside a critical section. */
+                    if( ( pxQueue->ulFastLock == queueFAST_LOCK_SLOW ) &&
+                        ( pxQueue->uxMessagesWaiting == ( UBaseType_t ) 1 ) &&
+                        ( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE ) )
+                    {
+                        pxQueue->ulFastLock = queueFAST_LOCK_FREE;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                #endif /* configUSE_MUTEX_FAST_PATH */
+
                 taskEXIT_CRITICAL();
 
                 traceRETURN_xQueueGenericSend( pdPASS );
@@ -1683,13 +1981,43 @@ BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
     }
     #endif
 
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+    {
+        /* Taking a free mutex needs no critical section. */
+        if( prvFastMutexTake( pxQueue ) != pdFALSE )
+        {
+            traceQUEUE_RECEIVE( pxQueue );
+            traceRETURN_xQueueSemaphoreTake( pdPASS );
+
+            return pdPASS;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    #endif /* configUSE_MUTEX_FAST_PATH */
+
     for( ; ; )
     {
         taskENTER_CRITICAL();
         {
+            UBaseType_t uxSemaphoreCount;
+
+            #if ( configUSE_MUTEX_FAST_PATH == 1 )
+            {
+                /* The mutex is held, or this task lost a race for it: move it
+                 * to the queue code, so the holder is known for priority
+                 * inheritance and its give wakes this task.  Done on each pass
+                 * as the mutex may have gone back to the fast path while this
+                 * task was blocked. */
+                prvFastMutexToQueue( pxQueue, queueFAST_LOCK_SLOW );
+            }
+            #endif
+
             /* Semaphores are queues with an item size of 0, and where the
              * number of messages in the queue is the semaphore's count value. */
-            const UBaseType_t uxSemaphoreCount = pxQueue->uxMessagesWaiting;
+            uxSemaphoreCount = pxQueue->uxMessagesWaiting;
 
             /* Is there data in the queue now?  To be running the calling task
              * must be the highest priority task wanting to access the queue. */
@@ -2136,84 +2464,493 @@ BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue,
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,
-                              void * const pvBuffer )
+UBaseType_t xQueueSendMultiple( QueueHandle_t xQueue,
+                                const void * const pvItems,
+                                const UBaseType_t uxItemCount,
+                                TickType_t xTicksToWait )
 {
-    BaseType_t xReturn;
-    UBaseType_t uxSavedInterruptStatus;
-    int8_t * pcOriginalReadPosition;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
     Queue_t * const pxQueue = xQueue;
+    const uint8_t * pucNextItem = ( const uint8_t * ) pvItems;
+    UBaseType_t uxSent = 0, uxCopied;
 
-    traceENTER_xQueuePeekFromISR( xQueue, pvBuffer );
-
-    configASSERT( ( pxQueue != NULL ) && !( ( pvBuffer == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
-    configASSERT( ( pxQueue != NULL ) && ( pxQueue->uxItemSize != 0 ) ); /* Can't peek a semaphore. */
+    traceENTER_xQueueSendMultiple( xQueue, pvItems, uxItemCount, xTicksToWait );
 
-    /* RTOS ports that support interrupt nesting have the concept of a maximum
-     * system call (or maximum API call) interrupt priority.  Interrupts that are
-     * above the maximum system call priority are kept permanently enabled, even
-     * when the RTOS kernel is in a critical section, but cannot make any calls to
-     * FreeRTOS API functions.  If configASSERT() is defined in FreeRTOSConfig.h
-     * then portASSERT_IF_INTERRUPT_PRIORITY_INVALID() will result in an assertion
-     * failure if a FreeRTOS API function is called from an interrupt that has been
-     * assigned a priority above the configured maximum system call priority.
-     * Only FreeRTOS functions that end in FromISR can be called from interrupts
-     * that have been assigned a priority at or (logically) below the maximum
-     * system call interrupt priority.  FreeRTOS maintains a separate interrupt
-     * safe API to ensure interrupt entry is as fast and as simple as possible.
-     * More information (albeit Cortex-M specific) is provided on the following
-     * link: https://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html */
-    portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+    configASSERT( pxQueue );
+    configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+    configASSERT( !( ( pvItems == NULL ) && ( uxItemCount != ( UBaseType_t ) 0U ) ) );
+    #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+    {
+        configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+    }
+    #endif
 
-    /* MISRA Ref 4.7.1 [Return value shall be checked] */
-    /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#dir-47 */
-    /* coverity[misra_c_2012_directive_4_7_violation] */
-    uxSavedInterruptStatus = ( UBaseType_t ) taskENTER_CRITICAL_FROM_ISR();
+    for( ; ; )
     {
-        /* Cannot block in an ISR, so check there is data available. */
-        if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+        taskENTER_CRITICAL();
         {
-            traceQUEUE_PEEK_FROM_ISR( pxQueue );
+            /* Post as many items as there is room for, then tell the
+             * receivers once for the whole batch rather than once per item. */
+            uxCopied = prvCopyItemsToQueue( pxQueue, pucNextItem, uxItemCount - uxSent );
 
-            /* Remember the read position so it can be reset as nothing is
-             * actually being removed from the queue. */
-            pcOriginalReadPosition = pxQueue->u.xQueue.pcReadFrom;
-            prvCopyDataFromQueue( pxQueue, pvBuffer );
-            pxQueue->u.xQueue.pcReadFrom = pcOriginalReadPosition;
+            if( uxCopied > ( UBaseType_t ) 0 )
+            {
+                traceQUEUE_SEND( pxQueue );
 
-            xReturn = pdPASS;
-        }
-        else
-        {
-            xReturn = pdFAIL;
-            traceQUEUE_PEEK_FROM_ISR_FAILED( pxQueue );
-        }
-    }
-    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+                pucNextItem += uxCopied * pxQueue->uxItemSize;
+                uxSent += uxCopied;
 
-    traceRETURN_xQueuePeekFromISR( xReturn );
+                if( prvNotifyItemsSent( pxQueue, uxCopied ) != pdFALSE )
+                {
+                    /* As in xQueueGenericSend(), it is ok to yield from
+                     * within the critical section. */
+                    queueYIELD_IF_USING_PREEMPTION();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
 
-    return xReturn;
-}
-/*-----------------------------------------------------------*/
+            if( ( uxSent == uxItemCount ) || ( xTicksToWait == ( TickType_t ) 0 ) )
+            {
+                /* Everything was posted, or the queue filled and no block
+                 * time is specified (or the block time has expired). */
+                taskEXIT_CRITICAL();
 
-UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
-{
-    UBaseType_t uxReturn;
+                if( uxSent != uxItemCount )
+                {
+                    traceQUEUE_SEND_FAILED( pxQueue );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
 
-    traceENTER_uxQueueMessagesWaiting( xQueue );
+                traceRETURN_xQueueSendMultiple( uxSent );
 
-    configASSERT( xQueue );
+                return uxSent;
+            }
+            else if( xEntryTimeSet == pdFALSE )
+            {
+                vTaskInternalSetTimeOutState( &xTimeOut );
+                xEntryTimeSet = pdTRUE;
+            }
+            else
+            {
+                /* Entry time was already set. */
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
 
-    portBASE_TYPE_ENTER_CRITICAL();
-    {
-        uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
-    }
-    portBASE_TYPE_EXIT_CRITICAL();
+        /* The queue is full.  Wait for room exactly as xQueueGenericSend()
+         * does. */
 
-    traceRETURN_uxQueueMessagesWaiting( uxReturn );
+        vTaskSuspendAll();
+        prvLockQueue( pxQueue );
 
-    return uxReturn;
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+        {
+            if( prvIsQueueFull( pxQueue ) != pdFALSE )
+            {
+                traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+                vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+                prvUnlockQueue( pxQueue );
+
+                if( xTaskResumeAll() == pdFALSE )
+                {
+                    taskYIELD_WITHIN_API();
+                }
+            }
+            else
+            {
+                /* Try again. */
+                prvUnlockQueue( pxQueue );
+                ( void ) xTaskResumeAll();
+            }
+        }
+        else
+        {
+            /* The timeout has expired. */
+            prvUnlockQueue( pxQueue );
+            ( void ) xTaskResumeAll();
+
+            traceQUEUE_SEND_FAILED( pxQueue );
+            traceRETURN_xQueueSendMultiple( uxSent );
+
+            return uxSent;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue,
+                                       const void * const pvItems,
+                                       const UBaseType_t uxItemCount,
+                                       BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    UBaseType_t uxSent, uxSavedInterruptStatus;
+    Queue_t * const pxQueue = xQueue;
+
+    traceENTER_xQueueSendMultipleFromISR( xQueue, pvItems, uxItemCount, pxHigherPriorityTaskWoken );
+
+    configASSERT( pxQueue );
+    configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+    configASSERT( !( ( pvItems == NULL ) && ( uxItemCount != ( UBaseType_t ) 0U ) ) );
+
+    /* See the comment in xQueueGenericSendFromISR(). */
+    portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+    /* MISRA Ref 4.7.1 [Return value shall be checked] */
+    /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#dir-47 */
+    /* coverity[misra_c_2012_directive_4_7_violation] */
+    uxSavedInterruptStatus = ( UBaseType_t ) taskENTER_CRITICAL_FROM_ISR();
+    {
+        uxSent = prvCopyItemsToQueue( pxQueue, ( const uint8_t * ) pvItems, uxItemCount );
+
+        if( uxSent > ( UBaseType_t ) 0 )
+        {
+            UBaseType_t uxItem;
+
+            traceQUEUE_SEND_FROM_ISR( pxQueue );
+
+            /* The event list is not altered if the queue is locked.  This
+             * will be done when the queue is unlocked later. */
+            if( pxQueue->cTxLock == queueUNLOCKED )
+            {
+                if( ( prvNotifyItemsSent( pxQueue, uxSent ) != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+                {
+                    *pxHigherPriorityTaskWoken = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                /* Count every item, so the unlocking task can unblock a
+                 * receiver for each. */
+                for( uxItem = 0; uxItem < uxSent; uxItem++ )
+                {
+                    const int8_t cTxLock = pxQueue->cTxLock;
+
+                    prvIncrementQueueTxLock( pxQueue, cTxLock );
+                }
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( uxSent != uxItemCount )
+        {
+            traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    traceRETURN_xQueueSendMultipleFromISR( uxSent );
+
+    return uxSent;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue,
+                                   void * const pvBuffer,
+                                   const UBaseType_t uxMaxItems,
+                                   TickType_t xTicksToWait )
+{
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+    Queue_t * const pxQueue = xQueue;
+    UBaseType_t uxReceived;
+
+    traceENTER_xQueueReceiveMultiple( xQueue, pvBuffer, uxMaxItems, xTicksToWait );
+
+    configASSERT( pxQueue );
+    configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+    configASSERT( pvBuffer != NULL );
+    configASSERT( uxMaxItems != ( UBaseType_t ) 0U );
+    #if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+    {
+        configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+    }
+    #endif
+
+    for( ; ; )
+    {
+        taskENTER_CRITICAL();
+        {
+            /* Take everything that is there, up to uxMaxItems, and unblock a
+             * waiting sender for each slot freed. */
+            uxReceived = prvCopyItemsFromQueue( pxQueue, ( uint8_t * ) pvBuffer, uxMaxItems );
+
+            if( uxReceived > ( UBaseType_t ) 0 )
+            {
+                traceQUEUE_RECEIVE( pxQueue );
+
+                if( prvUnblockEventListTasks( &( pxQueue->xTasksWaitingToSend ), uxReceived ) != pdFALSE )
+                {
+                    queueYIELD_IF_USING_PREEMPTION();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                taskEXIT_CRITICAL();
+
+                traceRETURN_xQueueReceiveMultiple( uxReceived );
+
+                return uxReceived;
+            }
+            else
+            {
+                if( xTicksToWait == ( TickType_t ) 0 )
+                {
+                    taskEXIT_CRITICAL();
+
+                    traceQUEUE_RECEIVE_FAILED( pxQueue );
+                    traceRETURN_xQueueReceiveMultiple( 0 );
+
+                    return 0;
+                }
+                else if( xEntryTimeSet == pdFALSE )
+                {
+                    vTaskInternalSetTimeOutState( &xTimeOut );
+                    xEntryTimeSet = pdTRUE;
+                }
+                else
+                {
+                    /* Entry time was already set. */
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        /* The queue is empty.  Wait for data exactly as xQueueReceive()
+         * does. */
+
+        vTaskSuspendAll();
+        prvLockQueue( pxQueue );
+
+        if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+        {
+            if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+            {
+                traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+                vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+                prvUnlockQueue( pxQueue );
+
+                if( xTaskResumeAll() == pdFALSE )
+                {
+                    taskYIELD_WITHIN_API();
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                /* The queue contains data again.  Loop back to try and read
+                 * the data. */
+                prvUnlockQueue( pxQueue );
+                ( void ) xTaskResumeAll();
+            }
+        }
+        else
+        {
+            /* Timed out.  If there is no data in the queue exit, otherwise
+             * loop back and attempt to read the data. */
+            prvUnlockQueue( pxQueue );
+            ( void ) xTaskResumeAll();
+
+            if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+            {
+                traceQUEUE_RECEIVE_FAILED( pxQueue );
+                traceRETURN_xQueueReceiveMultiple( 0 );
+
+                return 0;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue,
+                                          void * const pvBuffer,
+                                          const UBaseType_t uxMaxItems,
+                                          BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    UBaseType_t uxReceived, uxSavedInterruptStatus;
+    Queue_t * const pxQueue = xQueue;
+
+    traceENTER_xQueueReceiveMultipleFromISR( xQueue, pvBuffer, uxMaxItems, pxHigherPriorityTaskWoken );
+
+    configASSERT( pxQueue );
+    configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+    configASSERT( !( ( pvBuffer == NULL ) && ( uxMaxItems != ( UBaseType_t ) 0U ) ) );
+
+    /* See the comment in xQueueReceiveFromISR(). */
+    portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+    /* MISRA Ref 4.7.1 [Return value shall be checked] */
+    /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#dir-47 */
+    /* coverity[misra_c_2012_directive_4_7_violation] */
+    uxSavedInterruptStatus = ( UBaseType_t ) taskENTER_CRITICAL_FROM_ISR();
+    {
+        uxReceived = prvCopyItemsFromQueue( pxQueue, ( uint8_t * ) pvBuffer, uxMaxItems );
+
+        if( uxReceived > ( UBaseType_t ) 0 )
+        {
+            UBaseType_t uxItem;
+
+            traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+
+            /* If the queue is locked the event list will not be modified.
+             * Instead count each item removed, so the task that unlocks the
+             * queue can unblock a sender for each. */
+            if( pxQueue->cRxLock == queueUNLOCKED )
+            {
+                if( ( prvUnblockEventListTasks( &( pxQueue->xTasksWaitingToSend ), uxReceived ) != pdFALSE ) &&
+                    ( pxHigherPriorityTaskWoken != NULL ) )
+                {
+                    *pxHigherPriorityTaskWoken = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                for( uxItem = 0; uxItem < uxReceived; uxItem++ )
+                {
+                    const int8_t cRxLock = pxQueue->cRxLock;
+
+                    prvIncrementQueueRxLock( pxQueue, cRxLock );
+                }
+            }
+        }
+        else
+        {
+            traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    traceRETURN_xQueueReceiveMultipleFromISR( uxReceived );
+
+    return uxReceived;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,
+                              void * const pvBuffer )
+{
+    BaseType_t xReturn;
+    UBaseType_t uxSavedInterruptStatus;
+    int8_t * pcOriginalReadPosition;
+    Queue_t * const pxQueue = xQueue;
+
+    traceENTER_xQueuePeekFromISR( xQueue, pvBuffer );
+
+    configASSERT( ( pxQueue != NULL ) && !( ( pvBuffer == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
+    configASSERT( ( pxQueue != NULL ) && ( pxQueue->uxItemSize != 0 ) ); /* Can't peek a semaphore. */
+
+    /* RTOS ports that support interrupt nesting have the concept of a maximum
+     * system call (or maximum API call) interrupt priority.  Interrupts that are
+     * above the maximum system call priority are kept permanently enabled, even
+     * when the RTOS kernel is in a critical section, but cannot make any calls to
+     * FreeRTOS API functions.  If configASSERT() is defined in FreeRTOSConfig.h
+     * then portASSERT_IF_INTERRUPT_PRIORITY_INVALID() will result in an assertion
+     * failure if a FreeRTOS API function is called from an interrupt that has been
+     * assigned a priority above the configured maximum system call priority.
+     * Only FreeRTOS functions that end in FromISR can be called from interrupts
+     * that have been assigned a priority at or (logically) below the maximum
+     * system call interrupt priority.  FreeRTOS maintains a separate interrupt
+     * safe API to ensure interrupt entry is as fast and as simple as possible.
+     * More information (albeit Cortex-M specific) is provided on the following
+     * link: https://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html */
+    portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+    /* MISRA Ref 4.7.1 [Return value shall be checked] */
+    /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#dir-47 */
+    /* coverity[misra_c_2012_directive_4_7_violation] */
+    uxSavedInterruptStatus = ( UBaseType_t ) taskENTER_CRITICAL_FROM_ISR();
+    {
+        /* Cannot block in an ISR, so check there is data available. */
+        if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+        {
+            traceQUEUE_PEEK_FROM_ISR( pxQueue );
+
+            /* Remember the read position so it can be reset as nothing is
+             * actually being removed from the queue. */
+            pcOriginalReadPosition = pxQueue->u.xQueue.pcReadFrom;
+            prvCopyDataFromQueue( pxQueue, pvBuffer );
+            pxQueue->u.xQueue.pcReadFrom = pcOriginalReadPosition;
+
+            xReturn = pdPASS;
+        }
+        else
+        {
+            xReturn = pdFAIL;
+            traceQUEUE_PEEK_FROM_ISR_FAILED( pxQueue );
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    traceRETURN_xQueuePeekFromISR( xReturn );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue )
+{
+    UBaseType_t uxReturn;
+
+    traceENTER_uxQueueMessagesWaiting( xQueue );
+
+    configASSERT( xQueue );
+
+    portBASE_TYPE_ENTER_CRITICAL();
+    {
+        uxReturn = ( ( Queue_t * ) xQueue )->uxMessagesWaiting;
+
+        #if ( configUSE_MUTEX_FAST_PATH == 1 )
+        {
+            /* A mutex held on the fast path still has its free count. */
+            if( queueFAST_LOCK_IS_HELD( ( ( Queue_t * ) xQueue )->ulFastLock ) )
+            {
+                uxReturn = ( UBaseType_t ) 0;
+            }
+        }
+        #endif
+    }
+    portBASE_TYPE_EXIT_CRITICAL();
+
+    traceRETURN_uxQueueMessagesWaiting( uxReturn );
+
+    return uxReturn;
 }
 /*-----------------------------------------------------------*/
 
@@ -2248,6 +2985,15 @@ UBaseType_t uxQueueMessagesWaitingFromISR( const QueueHandle_t xQueue )
     configASSERT( pxQueue );
     uxReturn = pxQueue->uxMessagesWaiting;
 
+    #if ( configUSE_MUTEX_FAST_PATH == 1 )
+    {
+        if( queueFAST_LOCK_IS_HELD( pxQueue->ulFastLock ) )
+        {
+            uxReturn = ( UBaseType_t ) 0;
+        }
+    }
+    #endif
+
     traceRETURN_uxQueueMessagesWaitingFromISR( uxReturn );
 
     return uxReturn;
@@ -2420,7 +3166,7 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
     }
     else if( xPosition == queueSEND_TO_BACK )
     {
-        ( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize );
+        queueCOPY_ITEM( pxQueue->pcWriteTo, pvItemToQueue, pxQueue->uxItemSize );
         pxQueue->pcWriteTo += pxQueue->uxItemSize;
 
         if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail )
@@ -2434,7 +3180,7 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue,
     }
     else
     {
-        ( void ) memcpy( ( void * ) pxQueue->u.xQueue.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize );
+        queueCOPY_ITEM( pxQueue->u.xQueue.pcReadFrom, pvItemToQueue, pxQueue->uxItemSize );
         pxQueue->u.xQueue.pcReadFrom -= pxQueue->uxItemSize;
 
         if( pxQueue->u.xQueue.pcReadFrom < pxQueue->pcHead )
@@ -2489,8 +3235,185 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue,
             mtCOVERAGE_TEST_MARKER();
         }
 
-        ( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( size_t ) pxQueue->uxItemSize );
+        queueCOPY_ITEM( pvBuffer, pxQueue->u.xQueue.pcReadFrom, pxQueue->uxItemSize );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvCopyItemsToQueue( Queue_t * const pxQueue,
+                                        const uint8_t * pucItems,
+                                        UBaseType_t uxCount )
+{
+    const UBaseType_t uxSpace = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+    UBaseType_t uxCopied, uxRun;
+
+    /* This function is called from a critical section. */
+
+    if( uxCount > uxSpace )
+    {
+        uxCount = uxSpace;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    uxCopied = uxCount;
+
+    while( uxCount > ( UBaseType_t ) 0 )
+    {
+        /* The items that fit before the write position wraps.  pcWriteTo is
+         * always below pcTail, so this is at least one. */
+        uxRun = ( UBaseType_t ) ( pxQueue->u.xQueue.pcTail - pxQueue->pcWriteTo ) / pxQueue->uxItemSize;
+
+        if( uxRun > uxCount )
+        {
+            uxRun = uxCount;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        ( void ) memcpy( ( void * ) pxQueue->pcWriteTo, ( const void * ) pucItems, ( size_t ) ( uxRun * pxQueue->uxItemSize ) );
+        pxQueue->pcWriteTo += uxRun * pxQueue->uxItemSize;
+        pucItems += uxRun * pxQueue->uxItemSize;
+        uxCount -= uxRun;
+
+        if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail )
+        {
+            pxQueue->pcWriteTo = pxQueue->pcHead;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+    pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( pxQueue->uxMessagesWaiting + uxCopied );
+
+    return uxCopied;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvCopyItemsFromQueue( Queue_t * const pxQueue,
+                                          uint8_t * pucBuffer,
+                                          UBaseType_t uxCount )
+{
+    int8_t * pcFirst;
+    UBaseType_t uxCopied, uxRun;
+
+    /* This function is called from a critical section. */
+
+    if( uxCount > pxQueue->uxMessagesWaiting )
+    {
+        uxCount = pxQueue->uxMessagesWaiting;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    uxCopied = uxCount;
+
+    while( uxCount > ( UBaseType_t ) 0 )
+    {
+        /* pcReadFrom points at the last item read, so the run starts one item
+         * on from it. */
+        pcFirst = pxQueue->u.xQueue.pcReadFrom + pxQueue->uxItemSize;
+
+        if( pcFirst >= pxQueue->u.xQueue.pcTail )
+        {
+            pcFirst = pxQueue->pcHead;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        uxRun = ( UBaseType_t ) ( pxQueue->u.xQueue.pcTail - pcFirst ) / pxQueue->uxItemSize;
+
+        if( uxRun > uxCount )
+        {
+            uxRun = uxCount;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        ( void ) memcpy( ( void * ) pucBuffer, ( const void * ) pcFirst, ( size_t ) ( uxRun * pxQueue->uxItemSize ) );
+        pxQueue->u.xQueue.pcReadFrom = pcFirst + ( ( uxRun - ( UBaseType_t ) 1 ) * pxQueue->uxItemSize );
+        pucBuffer += uxRun * pxQueue->uxItemSize;
+        uxCount -= uxRun;
+    }
+
+    pxQueue->uxMessagesWaiting = ( UBaseType_t ) ( pxQueue->uxMessagesWaiting - uxCopied );
+
+    return uxCopied;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUnblockEventListTasks( List_t * const pxEventList,
+                                            UBaseType_t uxCount )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    while( ( uxCount > ( UBaseType_t ) 0 ) && ( listLIST_IS_EMPTY( pxEventList ) == pdFALSE ) )
+    {
+        if( xTaskRemoveFromEventList( pxEventList ) != pdFALSE )
+        {
+            xHigherPriorityTaskWoken = pdTRUE;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        uxCount--;
+    }
+
+    return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvNotifyItemsSent( Queue_t * const pxQueue,
+                                      UBaseType_t uxCount )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    #if ( configUSE_QUEUE_SETS == 1 )
+    {
+        if( pxQueue->pxQueueSetContainer != NULL )
+        {
+            /* The queue set holds one handle per item in its member queues,
+             * so it is posted to once per item. */
+            while( uxCount > ( UBaseType_t ) 0 )
+            {
+                if( prvNotifyQueueSetContainer( pxQueue ) != pdFALSE )
+                {
+                    xHigherPriorityTaskWoken = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                uxCount--;
+            }
+        }
+        else
+        {
+            xHigherPriorityTaskWoken = prvUnblockEventListTasks( &( pxQueue->xTasksWaitingToReceive ), uxCount );
+        }
     }
+    #else /* configUSE_QUEUE_SETS */
+    {
+        xHigherPriorityTaskWoken = prvUnblockEventListTasks( &( pxQueue->xTasksWaitingToReceive ), uxCount );
+    }
+    #endif /* configUSE_QUEUE_SETS */
+
+    return xHigherPriorityTaskWoken;
 }
 /*-----------------------------------------------------------*/
 
@@ -2845,7 +3768,7 @@ BaseType_t xQueueIsQueueFullFromISR( const QueueHandle_t xQueue )
                 }
 
                 --( pxQueue->uxMessagesWaiting );
-                ( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
+                queueCOPY_ITEM( pvBuffer, pxQueue->u.xQueue.pcReadFrom, pxQueue->uxItemSize );
 
                 xReturn = pdPASS;
 
@@ -2967,7 +3890,7 @@ BaseType_t xQueueIsQueueFullFromISR( const QueueHandle_t xQueue )
             }
 
             --( pxQueue->uxMessagesWaiting );
-            ( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.xQueue.pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
+            queueCOPY_ITEM( pvBuffer, pxQueue->u.xQueue.pcReadFrom, pxQueue->uxItemSize );
 
             if( ( *pxCoRoutineWoken ) == pdFALSE )
             {
@@ -3223,6 +4146,14 @@ BaseType_t xQueueIsQueueFullFromISR( const QueueHandle_t xQueue )
 
         taskENTER_CRITICAL();
         {
+            #if ( configUSE_MUTEX_FAST_PATH == 1 )
+            {
+                /* The set is told of each give, which the fast path would
+                 * skip, so a mutex added to one stays in the queue code. */
+                prvFastMutexToQueue( ( Queue_t * ) xQueueOrSemaphore, queueFAST_LOCK_NEVER );
+            }
+            #endif
+
             if( ( ( Queue_t * ) xQueueOrSemaphore )->pxQueueSetContainer != NULL )
             {
                 /* Cannot add a queue/semaphore to more than one queue set. */
@@ -0,0 +1,167 @@
+/*
+ * Paravirtual seL4 VMM calls - see sel4_pv.h.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "irq_dispatch.h"
+#include "sel4_pv.h"
+
+#if ( configUSE_SEL4_PARAVIRT == 1 )
+
+typedef struct {
+    sel4_pv_notify_fn fn;
+    void *arg;
+} sel4_pv_channel_t;
+
+// Written by sel4_pv_init() before the scheduler starts, read-only after.
+static uint32_t pv_features;
+static uint32_t pv_priority_bits;
+static uint32_t pv_notify_irq;
+
+static sel4_pv_channel_t pv_channels[SEL4_PV_NOTIFY_CHANNELS];
+static uint32_t pv_notify_registered;
+
+// HVC #0, encoded so that the assembler need not be told about the
+// virtualization extensions.  The VMM may clobber r0-r3.
+static uint32_t pv_call(uint32_t fn, uint32_t a1, uint32_t a2, uint32_t a3,
+                        uint32_t *r1_out, uint32_t *r2_out) {
+    register uint32_t r0 __asm("r0") = fn;
+    register uint32_t r1 __asm("r1") = a1;
+    register uint32_t r2 __asm("r2") = a2;
+    register uint32_t r3 __asm("r3") = a3;
+
+    __asm volatile (".inst 0xe1400070"
+                    : "+r" (r0), "+r" (r1), "+r" (r2), "+r" (r3) :: "memory");
+    if (r1_out != NULL) {
+        *r1_out = r1;
+    }
+    if (r2_out != NULL) {
+        *r2_out = r2;
+    }
+    return r0;
+}
+
+uint32_t sel4_pv_init(void) {
+    uint32_t version;
+    uint32_t features;
+    uint32_t irq;
+
+    if (pv_features != 0) {
+        return pv_features;
+    }
+
+    version = pv_call(SEL4_PV_FN_VERSION, 0, 0, 0, &features, &irq);
+    if (version == SEL4_PV_NOT_SUPPORTED || version < SEL4_PV_VERSION) {
+        return 0;
+    }
+
+    if (features & SEL4_PV_FEAT_GIC_INFO) {
+        pv_priority_bits = pv_call(SEL4_PV_FN_GIC_INFO, 0, 0, 0, NULL, NULL);
+        if (pv_priority_bits == SEL4_PV_NOT_SUPPORTED || pv_priority_bits > 8) {
+            pv_priority_bits = 0;
+        }
+    }
+    if (irq >= IRQ_TABLE_SIZE) {
+        features &= ~SEL4_PV_FEAT_NOTIFY;
+    }
+    pv_notify_irq = irq;
+    pv_features = features;
+    return features;
+}
+
+uint32_t sel4_pv_features(void) {
+    return pv_features;
+}
+
+uint32_t sel4_pv_gic_priority_bits(void) {
+    return pv_priority_bits;
+}
+
+void sel4_pv_set_deadline(uint64_t deadline) {
+    if (pv_features & SEL4_PV_FEAT_DEADLINE) {
+        (void)pv_call(SEL4_PV_FN_SET_DEADLINE, (uint32_t)deadline, (uint32_t)(deadline >> 32), 0,
+                      NULL, NULL);
+    }
+}
+
+void sel4_pv_wait(uint64_t deadline) {
+    __asm volatile ("dsb" ::: "memory");
+    if (pv_features & SEL4_PV_FEAT_YIELD) {
+        // One exit, and the VMM need not decode a trapped WFI to know when
+        // the vCPU is next due.
+        (void)pv_call(SEL4_PV_FN_YIELD, (uint32_t)deadline, (uint32_t)(deadline >> 32), 0,
+                      NULL, NULL);
+    } else {
+        sel4_pv_set_deadline(deadline);
+        __asm volatile ("wfi" ::: "memory");
+    }
+    __asm volatile ("isb" ::: "memory");
+}
+
+int sel4_pv_notify(uint32_t channel) {
+    if (!(pv_features & SEL4_PV_FEAT_NOTIFY) || channel >= SEL4_PV_NOTIFY_CHANNELS) {
+        return -1;
+    }
+    // The producer's stores must be visible before the other VM is woken.
+    __asm volatile ("dmb ish" ::: "memory");
+    if (pv_call(SEL4_PV_FN_NOTIFY, channel, 0, 0, NULL, NULL) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+void sel4_pv_doorbell(void *arg) {
+    (void)sel4_pv_notify((uint32_t)arg);
+}
+
+static void pv_notify_irq_handler(uint32_t id, void *arg) {
+    uint32_t pending;
+
+    (void)id;
+    (void)arg;
+
+    // Every channel signalled since the last poll, in one exit.  The VMM
+    // lowers the interrupt when the poll leaves nothing pending.
+    pending = pv_call(SEL4_PV_FN_NOTIFY_POLL, 0, 0, 0, NULL, NULL);
+    if (pending == SEL4_PV_NOT_SUPPORTED) {
+        return;
+    }
+    while (pending != 0) {
+        uint32_t channel = 31 - __builtin_clz(pending);
+
+        pending &= ~(1UL << channel);
+        if (pv_channels[channel].fn != NULL) {
+            pv_channels[channel].fn(channel, pv_channels[channel].arg);
+        }
+    }
+}
+
+int sel4_pv_notify_bind(uint32_t channel, sel4_pv_notify_fn fn, void *arg) {
+    int ret = -1;
+    int first = 0;
+
+    configASSERT(fn != NULL);
+    if (!(pv_features & SEL4_PV_FEAT_NOTIFY) || channel >= SEL4_PV_NOTIFY_CHANNELS) {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    if (pv_channels[channel].fn == NULL) {
+        pv_channels[channel].arg = arg;
+        __asm volatile ("dmb ish" ::: "memory");
+        pv_channels[channel].fn = fn;
+        first = !pv_notify_registered;
+        pv_notify_registered = 1;
+        ret = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    if (first && irq_register(pv_notify_irq, pv_notify_irq_handler, NULL,
+                              portLOWEST_USABLE_INTERRUPT_PRIORITY - 1, IRQ_FLAG_NO_FPU) < 0) {
+        return -1;
+    }
+    return ret;
+}
+
+#endif // configUSE_SEL4_PARAVIRT
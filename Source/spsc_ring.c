@@ -0,0 +1,254 @@
+/*
+ * Shared-memory SPSC ring - see spsc_ring.h.
+ */
+
+#include <string.h>
+#include "spsc_ring.h"
+#include "gic.h"
+
+static spsc_ring_t *irq_rings[SPSC_RING_MAX_IRQS];
+static uint32_t irq_ids[SPSC_RING_MAX_IRQS];
+
+// Orders this side's slot copies and index updates against the other side's,
+// which may be another CPU in the inner shareable domain.
+static inline void ring_dmb(void) {
+    __asm volatile ("dmb ish" ::: "memory");
+}
+
+// Atomically clear *p and return its old value.
+static inline uint32_t ring_claim(volatile uint32_t *p) {
+    uint32_t old, failed;
+
+    do {
+        __asm volatile ("ldrex %0, [%2]\n"
+                        "strex %1, %3, [%2]"
+                        : "=&r" (old), "=&r" (failed)
+                        : "r" (p), "r" (0)
+                        : "memory");
+    } while (failed);
+    return old;
+}
+
+size_t spsc_ring_shm_size(uint32_t slot_size, uint32_t slot_count) {
+    return sizeof(spsc_ring_shared_t) + (size_t)slot_size * slot_count;
+}
+
+static void ring_init_local(spsc_ring_t *r, spsc_ring_shared_t *shm, uint32_t cached) {
+    r->shm = shm;
+    r->mask = shm->slot_count - 1;
+    r->slot_size = shm->slot_size;
+    r->cached = cached;
+    r->consumer = NULL;
+    r->doorbell = NULL;
+    r->doorbell_arg = NULL;
+}
+
+int spsc_ring_format(spsc_ring_t *r, void *shm, size_t size, uint32_t slot_size, uint32_t slot_count) {
+    spsc_ring_shared_t *s = shm;
+
+    if (slot_size == 0 || slot_count == 0 || (slot_count & (slot_count - 1)) != 0 ||
+        slot_count > 0x80000000UL || ((uintptr_t)shm & (CACHE_LINE_MAX - 1)) != 0 ||
+        (uint64_t)slot_size * slot_count > size || spsc_ring_shm_size(slot_size, slot_count) > size) {
+        return -1;
+    }
+
+    s->magic = 0;
+    ring_dmb();
+    s->head = 0;
+    s->tail = 0;
+    s->consumer_waiting = 0;
+    s->slot_size = slot_size;
+    s->slot_count = slot_count;
+    ring_dmb();
+    s->magic = SPSC_RING_MAGIC;
+
+    ring_init_local(r, s, 0);
+    return 0;
+}
+
+int spsc_ring_attach(spsc_ring_t *r, void *shm, size_t size) {
+    spsc_ring_shared_t *s = shm;
+
+    if (size < sizeof(spsc_ring_shared_t) || s->magic != SPSC_RING_MAGIC) {
+        return -1;
+    }
+    ring_dmb();  // Read the geometry only after seeing the magic
+    if (s->slot_size == 0 || s->slot_count == 0 || (s->slot_count & (s->slot_count - 1)) != 0 ||
+        (uint64_t)s->slot_size * s->slot_count > size ||
+        spsc_ring_shm_size(s->slot_size, s->slot_count) > size) {
+        return -1;
+    }
+
+    // The ring may already be in use.  The live tail is the right cached
+    // index for either side: the producer's view of the consumer, and for a
+    // consumer nothing known to be readable, so its first pop reads the head.
+    // 0 would let a producer overwrite unread slots, or a consumer pop
+    // head - 0 slots it was never given.
+    ring_init_local(r, s, s->tail);
+    return 0;
+}
+
+void spsc_ring_set_doorbell(spsc_ring_t *r, spsc_doorbell_fn fn, void *arg) {
+    r->doorbell = fn;
+    r->doorbell_arg = arg;
+}
+
+// Copy 'n' slots between 'buf' and the ring starting at slot index 'pos',
+// in at most two pieces around the wrap.
+static void ring_copy_in(spsc_ring_t *r, uint32_t pos, const uint8_t *buf, uint32_t n) {
+    uint32_t first = pos & r->mask;
+    uint32_t run = r->mask + 1 - first;
+
+    if (run > n) {
+        run = n;
+    }
+    memcpy(&r->shm->data[(size_t)first * r->slot_size], buf, (size_t)run * r->slot_size);
+    if (n > run) {
+        memcpy(&r->shm->data[0], buf + (size_t)run * r->slot_size, (size_t)(n - run) * r->slot_size);
+    }
+}
+
+static void ring_copy_out(spsc_ring_t *r, uint32_t pos, uint8_t *buf, uint32_t n) {
+    uint32_t first = pos & r->mask;
+    uint32_t run = r->mask + 1 - first;
+
+    if (run > n) {
+        run = n;
+    }
+    memcpy(buf, &r->shm->data[(size_t)first * r->slot_size], (size_t)run * r->slot_size);
+    if (n > run) {
+        memcpy(buf + (size_t)run * r->slot_size, &r->shm->data[0], (size_t)(n - run) * r->slot_size);
+    }
+}
+
+uint32_t spsc_ring_push(spsc_ring_t *r, const void *items, uint32_t count) {
+    spsc_ring_shared_t *s = r->shm;
+    uint32_t head = s->head;
+    uint32_t size = r->mask + 1;
+
+    // Only re-read the consumer's line when the cached tail says full.
+    if (size - (head - r->cached) < count) {
+        r->cached = s->tail;
+        ring_dmb();  // The consumer's reads of those slots are done
+    }
+    uint32_t space = size - (head - r->cached);
+    if (count > space) {
+        count = space;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    ring_copy_in(r, head, items, count);
+    ring_dmb();  // Slots before index
+    s->head = head + count;
+
+    // Publishing the head and checking the flag must not be reordered, or a
+    // consumer going to sleep right now could miss this batch.
+    ring_dmb();
+    if (s->consumer_waiting && ring_claim(&s->consumer_waiting) && r->doorbell != NULL) {
+        r->doorbell(r->doorbell_arg);
+    }
+    return count;
+}
+
+uint32_t spsc_ring_pop(spsc_ring_t *r, void *items, uint32_t max) {
+    spsc_ring_shared_t *s = r->shm;
+    uint32_t tail = s->tail;
+
+    if (r->cached - tail < max) {
+        r->cached = s->head;
+        ring_dmb();  // Index before slots
+    }
+    uint32_t avail = r->cached - tail;
+    if (max > avail) {
+        max = avail;
+    }
+    if (max == 0) {
+        return 0;
+    }
+
+    ring_copy_out(r, tail, items, max);
+    ring_dmb();  // Done reading the slots before handing them back
+    s->tail = tail + max;
+    return max;
+}
+
+uint32_t spsc_ring_pop_wait(spsc_ring_t *r, void *items, uint32_t max, TickType_t timeout) {
+    spsc_ring_shared_t *s = r->shm;
+    TimeOut_t time_out;
+    uint32_t n;
+
+    n = spsc_ring_pop(r, items, max);
+    if (n != 0 || timeout == 0) {
+        return n;
+    }
+
+    r->consumer = xTaskGetCurrentTaskHandle();
+    vTaskSetTimeOutState(&time_out);
+    for (;;) {
+        s->consumer_waiting = 1;
+        ring_dmb();  // Flag before the re-check, pairs with the producer's
+        n = spsc_ring_pop(r, items, max);
+        if (n != 0 || xTaskCheckForTimeOut(&time_out, &timeout) != pdFALSE) {
+            break;
+        }
+        // Woken by the doorbell, a stale doorbell or the timeout; the loop
+        // sorts out which.
+        (void)ulTaskNotifyTake(pdTRUE, timeout);
+    }
+    s->consumer_waiting = 0;
+    r->consumer = NULL;
+
+    if (n == 0) {
+        n = spsc_ring_pop(r, items, max);
+    }
+    return n;
+}
+
+uint32_t spsc_ring_count(const spsc_ring_t *r) {
+    uint32_t head = r->shm->head;
+    return head - r->shm->tail;
+}
+
+int spsc_ring_bind_irq(spsc_ring_t *r, uint32_t irq_id) {
+    int slot = -1;
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < SPSC_RING_MAX_IRQS; i++) {
+        if (irq_rings[i] == NULL) {
+            irq_ids[i] = irq_id;
+            irq_rings[i] = r;
+            slot = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    if (slot < 0) {
+        return -1;
+    }
+
+    gic_set_priority(irq_id, portLOWEST_USABLE_INTERRUPT_PRIORITY - 1);
+    if (irq_id >= GIC_SPI_BASE) {
+        gic_set_target(irq_id, 1);
+    }
+    gic_enable_irq(irq_id);
+    return 0;
+}
+
+int spsc_ring_irq_handler(uint32_t id) {
+    BaseType_t woken = pdFALSE;
+    int handled = 0;
+
+    for (int i = 0; i < SPSC_RING_MAX_IRQS; i++) {
+        if (irq_rings[i] != NULL && irq_ids[i] == id) {
+            TaskHandle_t consumer = irq_rings[i]->consumer;
+            if (consumer != NULL) {
+                vTaskNotifyGiveFromISR(consumer, &woken);
+            }
+            handled = 1;
+        }
+    }
+    portYIELD_FROM_ISR(woken);
+    return handled;
+}
@@ -0,0 +1,177 @@
+/*
+ * Stack guard pages, overflow reports and incremental high-water tracking -
+ * see stack_guard.h.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "uart.h"
+#include "log.h"
+#include "mmu.h"
+#include "stack_guard.h"
+
+// The kernel's fill pattern (tskSTACK_FILL_BYTE) as a word
+#define STACK_FILL_WORD     0xA5A5A5A5UL
+
+// DFSR fault status: FS[4] is bit 10
+#define DFSR_FS(dfsr)       ((((dfsr) >> 6) & 0x10UL) | ((dfsr) & 0xFUL))
+#define DFSR_WNR            (1UL << 11)
+
+typedef struct {
+    TaskHandle_t task;
+    const StackType_t *base;    // Lowest word
+    uint32_t depth;             // Words
+    uint32_t free;              // Lowest free words seen
+    uint32_t next;              // Next word of the current pass
+} stack_watch_t;
+
+static uint32_t guard_pages[STACK_GUARD_MAX];
+static volatile uint32_t guard_count;
+
+static stack_watch_t watches[STACK_WATCH_MAX];
+static volatile uint32_t watch_count;
+static uint32_t watch_current;
+static volatile uint32_t watch_pass_count;
+
+static void guard_print(const char *fmt, const uint32_t *args, uint32_t nargs) {
+    char line[96];
+    size_t len = log_format(line, sizeof(line), fmt, args, nargs);
+
+    uart_write(line, len);
+}
+
+// Stop everything else writing to the UART and the trace.
+static void guard_fatal_enter(void) {
+#if ( configUSE_TRACE_RING == 1 )
+    trace_ring_freeze();
+#endif
+    uart_enter_polled_mode();
+    log_flush();
+}
+
+static __attribute__((noreturn)) void guard_halt(void) {
+    guard_print("System will halt here for debugging.\r\n", NULL, 0);
+    for (;;);
+}
+
+int stack_guard_protect(StackType_t *buffer) {
+    uint32_t page = (uint32_t)buffer;
+    int ret = -1;
+
+    if (page & (MMU_PAGE_SIZE - 1)) {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    if (guard_count < STACK_GUARD_MAX && mmu_unmap_pages(page, MMU_PAGE_SIZE) == 0) {
+        guard_pages[guard_count++] = page;
+        ret = 0;
+    }
+    taskEXIT_CRITICAL();
+    return ret;
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    (void)xTask;
+
+    guard_fatal_enter();
+    guard_print("\r\n=== STACK OVERFLOW ===\r\nTask: %s (canary overwritten)\r\n",
+                (const uint32_t[]){ (uint32_t)pcTaskName }, 1);
+    guard_halt();
+}
+
+void stack_guard_data_abort(uint32_t dfar, uint32_t dfsr, uint32_t pc) {
+    const char *name = "none";
+    TaskHandle_t task;
+
+    guard_fatal_enter();
+
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED && (task = xTaskGetCurrentTaskHandle()) != NULL) {
+        name = pcTaskGetName(task);
+    }
+    for (uint32_t i = 0; i < guard_count; i++) {
+        if (dfar - guard_pages[i] < MMU_PAGE_SIZE) {
+            guard_print("\r\n=== STACK OVERFLOW ===\r\nTask: %s, %u bytes past the end, at pc %p\r\n",
+                        (const uint32_t[]){ (uint32_t)name, guard_pages[i] + MMU_PAGE_SIZE - dfar, pc }, 3);
+            guard_halt();
+        }
+    }
+    guard_print("\r\n=== DATA ABORT ===\r\nTask: %s, %s %p at pc %p, DFSR %x (FS %x)\r\n",
+                (const uint32_t[]){ (uint32_t)name, (uint32_t)((dfsr & DFSR_WNR) ? "write" : "read"),
+                                    dfar, pc, dfsr, DFSR_FS(dfsr) }, 6);
+    guard_halt();
+}
+
+/*-----------------------------------------------------------*/
+/* High-water tracking */
+
+int stack_watch_add(TaskHandle_t task) {
+    TaskStatus_t status;
+    stack_watch_t *w;
+    int ret = -1;
+
+    // No stack scan, no state lookup
+    vTaskGetInfo(task, &status, pdFALSE, eInvalid);
+
+    taskENTER_CRITICAL();
+    if (watch_count < STACK_WATCH_MAX) {
+        w = &watches[watch_count];
+        w->task = task;
+        w->base = status.pxStackBase;
+        w->depth = (uint32_t)(status.pxEndOfStack - status.pxStackBase) + 1;
+        w->free = w->depth;
+        w->next = 0;
+        watch_count++;
+        ret = 0;
+    }
+    taskEXIT_CRITICAL();
+    return ret;
+}
+
+void stack_watch_step(void) {
+    stack_watch_t *w;
+    uint32_t end;
+
+    // One idle task does the stepping; the others' would only race it
+    if (portGET_CORE_ID() != 0 || watch_count == 0) {
+        return;
+    }
+
+    // A pass over one stack goes up from its lowest word, and stops at the
+    // first that is not the fill: the free figure can only shrink, so only
+    // the words below it need looking at.
+    w = &watches[watch_current];
+    end = w->next + STACK_WATCH_SLICE;
+    if (end > w->free) {
+        end = w->free;
+    }
+    while (w->next < end) {
+        if (w->base[w->next] != STACK_FILL_WORD) {
+            w->free = w->next;
+            break;
+        }
+        w->next++;
+    }
+    if (w->next < w->free) {
+        return;
+    }
+
+    w->next = 0;
+    if (++watch_current >= watch_count) {
+        watch_current = 0;
+        watch_pass_count++;
+    }
+}
+
+uint32_t stack_watch_get(TaskHandle_t task) {
+    for (uint32_t i = 0; i < watch_count; i++) {
+        if (watches[i].task == task) {
+            return watches[i].free;
+        }
+    }
+    return 0;
+}
+
+uint32_t stack_watch_passes(void) {
+    return watch_pass_count;
+}
@@ -0,0 +1,51 @@
+/*
+ * Memory for the tasks the kernel creates itself - see static_alloc.h.
+ *
+ * Needed by every profile since configSUPPORT_STATIC_ALLOCATION is always on;
+ * the static profile additionally turns off configSUPPORT_DYNAMIC_ALLOCATION
+ * and links without a heap.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "static_alloc.h"
+
+static StaticTask_t idle_tcb KERNEL_OBJECT_SECTION;
+static StackType_t idle_stack[configMINIMAL_STACK_SIZE] TASK_STACK_SECTION;
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   configSTACK_DEPTH_TYPE *puxIdleTaskStackSize) {
+    *ppxIdleTaskTCBBuffer = &idle_tcb;
+    *ppxIdleTaskStackBuffer = idle_stack;
+    *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+#if ( configNUMBER_OF_CORES > 1 )
+// One passive idle task for each core but the first.
+static StaticTask_t passive_idle_tcb[configNUMBER_OF_CORES - 1] KERNEL_OBJECT_SECTION;
+static StackType_t passive_idle_stack[configNUMBER_OF_CORES - 1][configMINIMAL_STACK_SIZE] TASK_STACK_SECTION;
+
+void vApplicationGetPassiveIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                          StackType_t **ppxIdleTaskStackBuffer,
+                                          configSTACK_DEPTH_TYPE *puxIdleTaskStackSize,
+                                          BaseType_t xPassiveIdleTaskIndex) {
+    *ppxIdleTaskTCBBuffer = &passive_idle_tcb[xPassiveIdleTaskIndex];
+    *ppxIdleTaskStackBuffer = passive_idle_stack[xPassiveIdleTaskIndex];
+    *puxIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+#endif
+
+#if configUSE_TIMERS
+static StaticTask_t timer_tcb KERNEL_OBJECT_SECTION;
+static StackType_t timer_stack[configTIMER_TASK_STACK_DEPTH] TASK_STACK_SECTION;
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    configSTACK_DEPTH_TYPE *puxTimerTaskStackSize) {
+    *ppxTimerTaskTCBBuffer = &timer_tcb;
+    *ppxTimerTaskStackBuffer = timer_stack;
+    *puxTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
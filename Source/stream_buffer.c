@@ -297,6 +297,39 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
                                        size_t xSpace,
                                        size_t xRequiredSpace ) PRIVILEGED_FUNCTION;
 
+/*
+ * Returns the total length of xFragmentCount fragments.
+ */
+static size_t prvFragmentsLength( const StreamBufferFragment_t * const pxFragments,
+                                  size_t xFragmentCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * As prvWriteMessageToBuffer(), but the data is gathered from xFragmentCount
+ * fragments of xDataLengthBytes in total.  A message buffer gets a single
+ * message, with one length header, holding all the fragments back to back.
+ */
+static size_t prvWriteFragmentsToBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                         const StreamBufferFragment_t * const pxFragments,
+                                         size_t xFragmentCount,
+                                         size_t xDataLengthBytes,
+                                         size_t xSpace,
+                                         size_t xRequiredSpace ) PRIVILEGED_FUNCTION;
+
+/*
+ * Reads as many whole messages out of a message buffer as fit in
+ * xBufferLengthBytes, up to xMaxMessages, packing them back to back into
+ * pucRxData and their lengths into pxMessageLengths.  The tail is moved once,
+ * after the last message is copied.  Returns the number of messages read and
+ * sets *pxBytesReceived to the number of bytes copied.
+ */
+static size_t prvReadMessagesFromBuffer( StreamBuffer_t * pxStreamBuffer,
+                                         uint8_t * pucRxData,
+                                         size_t xBufferLengthBytes,
+                                         size_t * const pxMessageLengths,
+                                         size_t xMaxMessages,
+                                         size_t xBytesAvailable,
+                                         size_t * const pxBytesReceived ) PRIVILEGED_FUNCTION;
+
 /*
  * Copies xCount bytes from the pxStreamBuffer's data storage area to pucData.
  * This function does not update the buffer's xTail pointer, so multiple reads
@@ -997,6 +1030,191 @@ size_t xStreamBufferSendFromISR( StreamBufferHandle_t xStreamBuffer,
 }
 /*-----------------------------------------------------------*/
 
+size_t xStreamBufferSendFragments( StreamBufferHandle_t xStreamBuffer,
+                                   const StreamBufferFragment_t * const pxFragments,
+                                   size_t xFragmentCount,
+                                   TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn, xSpace = 0;
+    size_t xDataLengthBytes, xRequiredSpace;
+    TimeOut_t xTimeOut;
+    size_t xMaxReportedSpace;
+
+    traceENTER_xStreamBufferSendFragments( xStreamBuffer, pxFragments, xFragmentCount, xTicksToWait );
+
+    configASSERT( pxFragments );
+    configASSERT( pxStreamBuffer );
+
+    xDataLengthBytes = prvFragmentsLength( pxFragments, xFragmentCount );
+    xRequiredSpace = xDataLengthBytes;
+
+    /* The maximum amount of space a stream buffer will ever report is its length
+     * minus 1. */
+    xMaxReportedSpace = pxStreamBuffer->xLength - ( size_t ) 1;
+
+    /* As xStreamBufferSend(): a message buffer needs room for the whole
+     * message and its length, a stream buffer takes as much as fits. */
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+
+        /* Overflow? */
+        configASSERT( xRequiredSpace > xDataLengthBytes );
+
+        if( xRequiredSpace > xMaxReportedSpace )
+        {
+            /* The message would not fit even if the entire buffer was empty,
+             * so don't wait for space. */
+            xTicksToWait = ( TickType_t ) 0;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        if( xRequiredSpace > xMaxReportedSpace )
+        {
+            xRequiredSpace = xMaxReportedSpace;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+    if( xTicksToWait != ( TickType_t ) 0 )
+    {
+        vTaskSetTimeOutState( &xTimeOut );
+
+        do
+        {
+            /* Wait until the required number of bytes are free in the
+             * buffer. */
+            taskENTER_CRITICAL();
+            {
+                xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+                if( xSpace < xRequiredSpace )
+                {
+                    /* Clear notification state as going to wait for space. */
+                    ( void ) xTaskNotifyStateClearIndexed( NULL, pxStreamBuffer->uxNotificationIndex );
+
+                    /* Should only be one writer. */
+                    configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+                    pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+                }
+                else
+                {
+                    taskEXIT_CRITICAL();
+                    break;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
+            ( void ) xTaskNotifyWaitIndexed( pxStreamBuffer->uxNotificationIndex, ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+            pxStreamBuffer->xTaskWaitingToSend = NULL;
+        } while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( xSpace == ( size_t ) 0 )
+    {
+        xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    xReturn = prvWriteFragmentsToBuffer( pxStreamBuffer, pxFragments, xFragmentCount, xDataLengthBytes, xSpace, xRequiredSpace );
+
+    if( xReturn > ( size_t ) 0 )
+    {
+        traceSTREAM_BUFFER_SEND( xStreamBuffer, xReturn );
+
+        /* Was a task waiting for the data?  The fragments went in as one
+         * write, so the receiver is told at most once for all of them. */
+        if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+        {
+            prvSEND_COMPLETED( pxStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+        traceSTREAM_BUFFER_SEND_FAILED( xStreamBuffer );
+    }
+
+    traceRETURN_xStreamBufferSendFragments( xReturn );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendFragmentsFromISR( StreamBufferHandle_t xStreamBuffer,
+                                          const StreamBufferFragment_t * const pxFragments,
+                                          size_t xFragmentCount,
+                                          BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn, xSpace;
+    size_t xDataLengthBytes, xRequiredSpace;
+
+    traceENTER_xStreamBufferSendFragmentsFromISR( xStreamBuffer, pxFragments, xFragmentCount, pxHigherPriorityTaskWoken );
+
+    configASSERT( pxFragments );
+    configASSERT( pxStreamBuffer );
+
+    xDataLengthBytes = prvFragmentsLength( pxFragments, xFragmentCount );
+    xRequiredSpace = xDataLengthBytes;
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+    xReturn = prvWriteFragmentsToBuffer( pxStreamBuffer, pxFragments, xFragmentCount, xDataLengthBytes, xSpace, xRequiredSpace );
+
+    if( xReturn > ( size_t ) 0 )
+    {
+        /* Was a task waiting for the data? */
+        if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+        {
+            prvSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xReturn );
+    traceRETURN_xStreamBufferSendFragmentsFromISR( xReturn );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
 static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
                                        const void * pvTxData,
                                        size_t xDataLengthBytes,
@@ -1050,6 +1268,92 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
 }
 /*-----------------------------------------------------------*/
 
+static size_t prvFragmentsLength( const StreamBufferFragment_t * const pxFragments,
+                                  size_t xFragmentCount )
+{
+    size_t xFragment, xLength = 0;
+
+    for( xFragment = 0; xFragment < xFragmentCount; xFragment++ )
+    {
+        configASSERT( ( pxFragments[ xFragment ].pvData != NULL ) || ( pxFragments[ xFragment ].xLength == ( size_t ) 0 ) );
+
+        /* Overflow? */
+        configASSERT( ( xLength + pxFragments[ xFragment ].xLength ) >= xLength );
+
+        xLength += pxFragments[ xFragment ].xLength;
+    }
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWriteFragmentsToBuffer( StreamBuffer_t * const pxStreamBuffer,
+                                         const StreamBufferFragment_t * const pxFragments,
+                                         size_t xFragmentCount,
+                                         size_t xDataLengthBytes,
+                                         size_t xSpace,
+                                         size_t xRequiredSpace )
+{
+    size_t xNextHead = pxStreamBuffer->xHead;
+    size_t xFragment, xRemaining, xCount;
+    configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        /* Convert xDataLengthBytes to the message length type. */
+        xMessageLength = ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes;
+
+        /* Ensure the data length given fits within configMESSAGE_BUFFER_LENGTH_TYPE. */
+        configASSERT( ( size_t ) xMessageLength == xDataLengthBytes );
+
+        if( xSpace >= xRequiredSpace )
+        {
+            /* One length for the whole message, however many fragments it
+             * is gathered from. */
+            xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xMessageLength ), sbBYTES_TO_STORE_MESSAGE_LENGTH, xNextHead );
+        }
+        else
+        {
+            /* Not enough space, so do not write data to the buffer. */
+            xDataLengthBytes = 0;
+        }
+    }
+    else
+    {
+        /* A stream buffer takes as many of the bytes as there is space for. */
+        xDataLengthBytes = configMIN( xDataLengthBytes, xSpace );
+    }
+
+    xRemaining = xDataLengthBytes;
+
+    for( xFragment = 0; ( xFragment < xFragmentCount ) && ( xRemaining != ( size_t ) 0 ); xFragment++ )
+    {
+        xCount = configMIN( pxFragments[ xFragment ].xLength, xRemaining );
+
+        if( xCount != ( size_t ) 0 )
+        {
+            /* MISRA Ref 11.5.5 [Void pointer assignment] */
+            /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+            /* coverity[misra_c_2012_rule_11_5_violation] */
+            xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) pxFragments[ xFragment ].pvData, xCount, xNextHead );
+            xRemaining -= xCount;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+    if( xDataLengthBytes != ( size_t ) 0 )
+    {
+        /* Publish the length and every fragment in one update of the head. */
+        pxStreamBuffer->xHead = xNextHead;
+    }
+
+    return xDataLengthBytes;
+}
+/*-----------------------------------------------------------*/
+
 size_t xStreamBufferReceive( StreamBufferHandle_t xStreamBuffer,
                              void * pvRxData,
                              size_t xBufferLengthBytes,
@@ -1273,6 +1577,106 @@ size_t xStreamBufferReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
 }
 /*-----------------------------------------------------------*/
 
+size_t xStreamBufferReceiveMessages( StreamBufferHandle_t xStreamBuffer,
+                                     void * pvRxData,
+                                     size_t xBufferLengthBytes,
+                                     size_t * const pxMessageLengths,
+                                     size_t xMaxMessages,
+                                     TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xMessages = 0, xReceivedLength = 0, xBytesAvailable;
+
+    traceENTER_xStreamBufferReceiveMessages( xStreamBuffer, pvRxData, xBufferLengthBytes, pxMessageLengths, xMaxMessages, xTicksToWait );
+
+    configASSERT( pvRxData );
+    configASSERT( pxMessageLengths );
+    configASSERT( pxStreamBuffer );
+    configASSERT( xMaxMessages > ( size_t ) 0 );
+
+    /* Only a message buffer holds discrete messages to count. */
+    configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 );
+
+    if( xTicksToWait != ( TickType_t ) 0 )
+    {
+        /* Checking if there is data and clearing the notification state must be
+         * performed atomically. */
+        taskENTER_CRITICAL();
+        {
+            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+            /* Wait for a whole batch - the trigger level, which senders test
+             * before they notify - rather than for a single message, so that
+             * the task is woken once per batch.  The trigger level is at least
+             * 1, so this also waits while the buffer is empty. */
+            if( xBytesAvailable < pxStreamBuffer->xTriggerLevelBytes )
+            {
+                /* Clear notification state as going to wait for data. */
+                ( void ) xTaskNotifyStateClearIndexed( NULL, pxStreamBuffer->uxNotificationIndex );
+
+                /* Should only be one reader. */
+                configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+                pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xBytesAvailable < pxStreamBuffer->xTriggerLevelBytes )
+        {
+            /* Wait for the batch, then take whatever is there - on a timeout
+             * that may be less than the trigger level. */
+            traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
+            ( void ) xTaskNotifyWaitIndexed( pxStreamBuffer->uxNotificationIndex, ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+            pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+            /* Recheck the data available after blocking. */
+            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+    }
+
+    if( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+    {
+        /* MISRA Ref 11.5.5 [Void pointer assignment] */
+        /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+        /* coverity[misra_c_2012_rule_11_5_violation] */
+        xMessages = prvReadMessagesFromBuffer( pxStreamBuffer, ( uint8_t * ) pvRxData, xBufferLengthBytes, pxMessageLengths, xMaxMessages, xBytesAvailable, &xReceivedLength );
+
+        /* Was a task waiting for space in the buffer?  It is told once for
+         * all the messages read. */
+        if( xMessages != ( size_t ) 0 )
+        {
+            traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xReceivedLength );
+            prvRECEIVE_COMPLETED( xStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer );
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceRETURN_xStreamBufferReceiveMessages( xMessages );
+
+    return xMessages;
+}
+/*-----------------------------------------------------------*/
+
 static size_t prvReadMessageFromBuffer( StreamBuffer_t * pxStreamBuffer,
                                         void * pvRxData,
                                         size_t xBufferLengthBytes,
@@ -1328,6 +1732,55 @@ static size_t prvReadMessageFromBuffer( StreamBuffer_t * pxStreamBuffer,
 }
 /*-----------------------------------------------------------*/
 
+static size_t prvReadMessagesFromBuffer( StreamBuffer_t * pxStreamBuffer,
+                                         uint8_t * pucRxData,
+                                         size_t xBufferLengthBytes,
+                                         size_t * const pxMessageLengths,
+                                         size_t xMaxMessages,
+                                         size_t xBytesAvailable,
+                                         size_t * const pxBytesReceived )
+{
+    size_t xMessages = 0, xCopied = 0, xNextMessageLength;
+    size_t xTail = pxStreamBuffer->xTail, xNextTail;
+    configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
+
+    while( ( xMessages < xMaxMessages ) && ( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH ) )
+    {
+        xNextTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xTail );
+        xNextMessageLength = ( size_t ) xTempNextMessageLength;
+
+        /* A message that does not fit in what is left of the caller's buffer
+         * ends the batch, and stays in the message buffer. */
+        if( xNextMessageLength > ( xBufferLengthBytes - xCopied ) )
+        {
+            break;
+        }
+
+        configASSERT( xNextMessageLength <= ( xBytesAvailable - sbBYTES_TO_STORE_MESSAGE_LENGTH ) );
+
+        xTail = prvReadBytesFromBuffer( pxStreamBuffer, &( pucRxData[ xCopied ] ), xNextMessageLength, xNextTail );
+        pxMessageLengths[ xMessages ] = xNextMessageLength;
+        xMessages++;
+        xCopied += xNextMessageLength;
+        xBytesAvailable -= sbBYTES_TO_STORE_MESSAGE_LENGTH + xNextMessageLength;
+    }
+
+    if( xMessages != ( size_t ) 0 )
+    {
+        /* Free the space of every message read in one update of the tail. */
+        pxStreamBuffer->xTail = xTail;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    *pxBytesReceived = xCopied;
+
+    return xMessages;
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xStreamBufferIsEmpty( StreamBufferHandle_t xStreamBuffer )
 {
     const StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
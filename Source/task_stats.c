@@ -0,0 +1,221 @@
+/*
+ * Per-task CPU usage report - see task_stats.h.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "uart.h"
+#include "irq_dispatch.h"
+#include "idle.h"
+#include "tick_timer.h"
+#include "task_stats.h"
+
+static TaskStatus_t task_status[TASK_STATS_MAX_TASKS];
+
+static void stats_puts(const char *s) {
+    size_t len = 0;
+    while (s[len]) {
+        len++;
+    }
+    uart_write(s, len);
+}
+
+static void stats_dec(uint64_t val, int width) {
+    char buf[20];
+    int i = 0;
+
+    do {
+        buf[i++] = '0' + (char)(val % 10);
+        val /= 10;
+    } while (val > 0);
+    while (width-- > i) {
+        uart_putc(' ');
+    }
+    while (i > 0) {
+        uart_putc(buf[--i]);
+    }
+}
+
+static void stats_name(const char *name) {
+    int len = 0;
+
+    while (name[len] && len < configMAX_TASK_NAME_LEN) {
+        uart_putc(name[len++]);
+    }
+    while (len++ < configMAX_TASK_NAME_LEN) {
+        uart_putc(' ');
+    }
+}
+
+static char state_char(eTaskState state) {
+    switch (state) {
+        case eRunning:   return 'X';
+        case eReady:     return 'R';
+        case eBlocked:   return 'B';
+        case eSuspended: return 'S';
+        case eDeleted:   return 'D';
+        default:         return '?';
+    }
+}
+
+void task_stats_print(void) {
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count;
+
+    count = uxTaskGetSystemState(task_status, TASK_STATS_MAX_TASKS, &total);
+
+    stats_puts("=== TASK RUN TIME STATS ===\r\n");
+    if (count == 0) {
+        stats_puts("More than ");
+        stats_dec(TASK_STATS_MAX_TASKS, 0);
+        stats_puts(" tasks, nothing reported\r\n");
+        return;
+    }
+    stats_puts("name       s pri stack         run time     cpu\r\n");
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *t = &task_status[i];
+        // CPU share in tenths of a percent
+        uint64_t permille = total ? (t->ulRunTimeCounter * 1000) / total : 0;
+
+        stats_name(t->pcTaskName);
+        uart_putc(' ');
+        uart_putc(state_char(t->eCurrentState));
+        stats_dec(t->uxCurrentPriority, 4);
+        stats_dec(t->usStackHighWaterMark, 6);
+        stats_dec(t->ulRunTimeCounter, 17);
+        stats_dec(permille / 10, 5);
+        uart_putc('.');
+        uart_putc('0' + (char)(permille % 10));
+        stats_puts("%\r\n");
+    }
+}
+
+void heap_stats_print(void) {
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    HeapStats_t heap;
+
+    vPortGetHeapStats(&heap);
+
+    stats_puts("=== HEAP STATS ===\r\n");
+    stats_puts("free ");
+    stats_dec(heap.xAvailableHeapSpaceInBytes, 0);
+    stats_puts("  min ever ");
+    stats_dec(heap.xMinimumEverFreeBytesRemaining, 0);
+    stats_puts("  largest ");
+    stats_dec(heap.xSizeOfLargestFreeBlockInBytes, 0);
+    stats_puts("  blocks ");
+    stats_dec(heap.xNumberOfFreeBlocks, 0);
+    stats_puts("\r\n");
+
+#if configUSE_HEAP_POOLS == 1
+    stats_puts(" size  slabs  total  used  peak   allocs  fallback\r\n");
+    for (int i = 0; i < configHEAP_POOL_CLASS_COUNT; i++) {
+        const HeapPoolStats_t *p = &heap.xPoolStats[i];
+
+        stats_dec(p->xBlockSize, 5);
+        stats_dec(p->xSlabs, 7);
+        stats_dec(p->xBlocksTotal, 7);
+        stats_dec(p->xBlocksInUse, 6);
+        stats_dec(p->xMaxBlocksInUse, 6);
+        stats_dec(p->xNumberOfAllocations, 9);
+        stats_dec(p->xNumberOfFallbacks, 10);
+        stats_puts("\r\n");
+    }
+#endif
+#if configUSE_HEAP_PROFILER == 1
+    // Refresh the fragmentation map the host reads with the figures above.
+    vPortHeapProfileSnapshot();
+#endif
+#endif // configSUPPORT_DYNAMIC_ALLOCATION
+}
+
+void critical_stats_print(void) {
+#if configUSE_CPSR_CRITICAL_SECTIONS == 1
+    static uint32_t last_count;
+    static TickType_t last_tick;
+    uint32_t count = ulPortGetMaskWritesAvoided();
+    TickType_t now = xTaskGetTickCount();
+    TickType_t elapsed = now - last_tick;
+
+    stats_puts("GIC mask writes avoided: ");
+    stats_dec(count, 0);
+    if (elapsed > 0) {
+        // Rate since the previous call
+        stats_puts(", ");
+        stats_dec(((uint64_t)(count - last_count) * configTICK_RATE_HZ) / elapsed, 0);
+        stats_puts("/s");
+    }
+    stats_puts("\r\n");
+
+    last_count = count;
+    last_tick = now;
+#endif
+}
+
+#if configUSE_IRQ_STATS == 1
+static uint64_t stats_counts_to_ns(uint32_t counts, uint32_t hz) {
+    return ((uint64_t)counts * 1000000000ULL) / hz;
+}
+#endif
+
+void irq_stats_print(void) {
+#if configUSE_IRQ_STATS == 1
+    uint32_t hz = ulPortGetRunTimeCounterFrequency();
+
+    if (hz == 0) {
+        hz = configCPU_CLOCK_HZ;    // CNTFRQ not set up; the figures are rough
+    }
+
+    stats_puts("IRQ     count nest  handler ns   ack-eoi ns\r\n");
+    for (uint32_t id = 0; id < IRQ_TABLE_SIZE; id++) {
+        irq_stats_t st;
+
+        if (irq_stats_get(id, &st) < 0 || st.count == 0) {
+            continue;
+        }
+        stats_dec(id, 4);
+        stats_dec(st.count, 10);
+        stats_dec(st.max_nesting, 5);
+        stats_dec(stats_counts_to_ns(st.max_handler, hz), 11);
+        stats_dec(stats_counts_to_ns(st.max_ack_to_eoi, hz), 13);
+        stats_puts("\r\n");
+    }
+    for (uint32_t core = 0; core < configNUMBER_OF_CORES; core++) {
+        stats_puts("Core ");
+        stats_dec(core, 0);
+        stats_puts(" SVC stack unused: ");
+        stats_dec(irq_stack_unused(core), 0);
+        stats_puts(" of ");
+        stats_dec(1UL << configISR_STACK_SHIFT, 0);
+        stats_puts(" bytes\r\n");
+    }
+#endif
+}
+
+void idle_stats_print(void) {
+    static idle_stats_t last[configNUMBER_OF_CORES];
+    static uint64_t last_now;
+    uint64_t now = tick_timer_read_counter();
+    uint64_t elapsed = now - last_now;
+
+    last_now = now;
+    if (elapsed == 0) {
+        return;
+    }
+    for (uint32_t core = 0; core < configNUMBER_OF_CORES; core++) {
+        idle_stats_t st;
+
+        if (idle_stats_get(core, &st) < 0) {
+            continue;
+        }
+        stats_puts("Core ");
+        stats_dec(core, 0);
+        stats_puts(" asleep: ");
+        stats_dec(((st.asleep - last[core].asleep) * 100) / elapsed, 0);
+        stats_puts("%, ");
+        stats_dec(st.wakeups - last[core].wakeups, 0);
+        stats_puts(" wakeups\r\n");
+        last[core] = st;
+    }
+}
@@ -275,19 +275,51 @@
         prvResetNextTaskUnblockTime();                                            \
     } while( 0 )
 
+#if ( configUSE_DELAY_WHEEL == 1 )
+
+    #if ( ( configDELAY_WHEEL_SLOTS < 32 ) || ( ( configDELAY_WHEEL_SLOTS & ( configDELAY_WHEEL_SLOTS - 1 ) ) != 0 ) )
+        #error configDELAY_WHEEL_SLOTS must be a power of two of 32 or more
+    #endif
+
+    #define tskDELAY_WHEEL_MASK     ( ( UBaseType_t ) configDELAY_WHEEL_SLOTS - 1U )
+    #define tskDELAY_WHEEL_WORDS    ( ( UBaseType_t ) configDELAY_WHEEL_SLOTS / 32U )
+
+/* Delays of 1 to configDELAY_WHEEL_SLOTS - 1 ticks go in the wheel, longer (and
+ * zero) ones in the sorted delayed lists. */
+    #define tskDELAY_IN_WHEEL( xTicksToWait )    ( ( TickType_t ) ( ( xTicksToWait ) - 1U ) < ( TickType_t ) tskDELAY_WHEEL_MASK )
+
+    #define tskIS_DELAY_WHEEL_LIST( pxList )     ( ( ( pxList ) >= &( xDelayWheel[ 0 ] ) ) && ( ( pxList ) <= &( xDelayWheel[ tskDELAY_WHEEL_MASK ] ) ) )
+
+#endif /* configUSE_DELAY_WHEEL */
+
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_PARTITIONED_SCHEDULING == 0 )
+
+/* The ready list a task of priority uxPriority is held in. */
+    #define taskREADY_LIST( pxTCB, uxPriority )    ( &( pxReadyTasksLists[ ( uxPriority ) ] ) )
+
 /*
  * Place the task represented by pxTCB into the appropriate ready list for
  * the task.  It is inserted at the end of the list.
  */
-#define prvAddTaskToReadyList( pxTCB )                                                                     \
+    #define prvAddTaskToReadyList( pxTCB )                                                                 \
     do {                                                                                                   \
         traceMOVED_TASK_TO_READY_STATE( pxTCB );                                                           \
         taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );                                                \
         listINSERT_END( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
         tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB );                                                      \
     } while( 0 )
+
+#else /* if ( configUSE_PARTITIONED_SCHEDULING == 0 ) */
+
+/* Each core has its own set of ready lists, holding only the tasks pinned to
+ * it.  A task readied by another core goes to the owning core's inbox, which
+ * only the owning core moves into its ready lists. */
+    #define taskREADY_LIST( pxTCB, uxPriority )    ( &( pxReadyTasksLists[ ( pxTCB )->xPartition ][ ( uxPriority ) ] ) )
+    #define prvAddTaskToReadyList( pxTCB )         prvAddTaskToPartition( pxTCB )
+
+#endif /* if ( configUSE_PARTITIONED_SCHEDULING == 0 ) */
 /*-----------------------------------------------------------*/
 
 /*
@@ -332,6 +364,13 @@
 /* Indicates that the task is an Idle task. */
 #define taskATTRIBUTE_IS_IDLE    ( UBaseType_t ) ( 1U << 0U )
 
+/* Idle tasks sharing each tskIDLE_PRIORITY ready list. */
+#if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+    #define taskIDLE_TASKS_PER_READY_LIST    1
+#else
+    #define taskIDLE_TASKS_PER_READY_LIST    configNUMBER_OF_CORES
+#endif
+
 #if ( ( configNUMBER_OF_CORES > 1 ) && ( portCRITICAL_NESTING_IN_TCB == 1 ) )
     #define portGET_CRITICAL_NESTING_COUNT( xCoreID )          ( pxCurrentTCBs[ ( xCoreID ) ]->uxCriticalNesting )
     #define portSET_CRITICAL_NESTING_COUNT( xCoreID, x )       ( pxCurrentTCBs[ ( xCoreID ) ]->uxCriticalNesting = ( x ) )
@@ -371,6 +410,106 @@
  * and stores task state information, including a pointer to the task's context
  * (the task's run time environment, including register values)
  */
+#if ( configUSE_TCB_CACHE_LAYOUT == 1 )
+
+/* The same fields, ordered by how hot they are, and the whole TCB aligned to a
+ * cache line.  The first line holds everything vTaskSwitchContext() and
+ * xTaskIncrementTick() read of a task they switch to, wake or pass over in a
+ * ready list on a single core (with list data integrity checks off): the saved
+ * stack pointer, the state list item, the priority and the stack start for the
+ * overflow check.  The second holds the event list item, the SMP scheduling
+ * state and the run time counter.  Names, trace numbers and the like, only
+ * used by the query functions, come last.  StaticTask_t in FreeRTOS.h follows
+ * this order too. */
+typedef struct tskTaskControlBlock       /* The old naming convention is used to prevent breaking kernel aware debuggers. */
+{
+    volatile StackType_t * pxTopOfStack; /**< Points to the location of the last item placed on the tasks stack.  THIS MUST BE THE FIRST MEMBER OF THE TCB STRUCT. */
+
+    #if ( portUSING_MPU_WRAPPERS == 1 )
+        xMPU_SETTINGS xMPUSettings; /**< The MPU settings are defined as part of the port layer.  THIS MUST BE THE SECOND MEMBER OF THE TCB STRUCT. */
+    #endif
+
+    ListItem_t xStateListItem; /**< The list that the state list item of a task is reference from denotes the state of that task (Ready, Blocked, Suspended ). */
+    UBaseType_t uxPriority;    /**< The priority of the task.  0 is the lowest priority. */
+    StackType_t * pxStack;     /**< Points to the start of the stack. */
+
+    ListItem_t xEventListItem; /**< Used to reference a task from an event list. */
+
+    #if ( configNUMBER_OF_CORES > 1 )
+        volatile BaseType_t xTaskRunState; /**< Used to identify the core the task is running on, if the task is running. Otherwise, identifies the task's state - not running or yielding. */
+        UBaseType_t uxTaskAttributes;      /**< Task's attributes - currently used to identify the idle tasks. */
+    #endif
+
+    #if ( configUSE_CORE_AFFINITY == 1 ) && ( configNUMBER_OF_CORES > 1 )
+        UBaseType_t uxCoreAffinityMask; /**< Used to link the task to certain cores.  UBaseType_t must have greater than or equal to the number of bits as configNUMBER_OF_CORES. */
+    #endif
+
+    #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+        BaseType_t xPartition; /**< The core whose ready lists hold the task - the single core in uxCoreAffinityMask. */
+    #endif
+
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        configRUN_TIME_COUNTER_TYPE ulRunTimeCounter; /**< Stores the amount of time the task has spent in the Running state. */
+    #endif
+
+    #if ( configUSE_TASK_PREEMPTION_DISABLE == 1 )
+        BaseType_t xPreemptionDisable; /**< Used to prevent the task from being preempted. */
+    #endif
+
+    #if ( portCRITICAL_NESTING_IN_TCB == 1 )
+        UBaseType_t uxCriticalNesting; /**< Holds the critical section nesting depth for ports that do not maintain their own count in the port layer. */
+    #endif
+
+    #if ( configUSE_MUTEXES == 1 )
+        UBaseType_t uxBasePriority; /**< The priority last assigned to the task - used by the priority inheritance mechanism. */
+        UBaseType_t uxMutexesHeld;
+    #endif
+
+    #if ( configUSE_TASK_NOTIFICATIONS == 1 )
+        volatile uint32_t ulNotifiedValue[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+        volatile uint8_t ucNotifyState[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+    #endif
+
+    #if ( INCLUDE_xTaskAbortDelay == 1 )
+        uint8_t ucDelayAborted;
+    #endif
+
+    /* See the comments in FreeRTOS.h with the definition of
+     * tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE. */
+    #if ( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 )
+        uint8_t ucStaticallyAllocated; /**< Set to pdTRUE if the task is a statically allocated to ensure no attempt is made to free the memory. */
+    #endif
+
+    char pcTaskName[ configMAX_TASK_NAME_LEN ]; /**< Descriptive name given to the task when created.  Facilitates debugging only. */
+
+    #if ( ( portSTACK_GROWTH > 0 ) || ( configRECORD_STACK_HIGH_ADDRESS == 1 ) )
+        StackType_t * pxEndOfStack; /**< Points to the highest valid address for the stack. */
+    #endif
+
+    #if ( configUSE_TRACE_FACILITY == 1 )
+        UBaseType_t uxTCBNumber;  /**< Stores a number that increments each time a TCB is created.  It allows debuggers to determine when a task has been deleted and then recreated. */
+        UBaseType_t uxTaskNumber; /**< Stores a number specifically for use by third party trace code. */
+    #endif
+
+    #if ( configUSE_APPLICATION_TASK_TAG == 1 )
+        TaskHookFunction_t pxTaskTag;
+    #endif
+
+    #if ( configNUM_THREAD_LOCAL_STORAGE_POINTERS > 0 )
+        void * pvThreadLocalStoragePointers[ configNUM_THREAD_LOCAL_STORAGE_POINTERS ];
+    #endif
+
+    #if ( configUSE_C_RUNTIME_TLS_SUPPORT == 1 )
+        configTLS_BLOCK_TYPE xTLSBlock; /**< Memory block used as Thread Local Storage (TLS) Block for the task. */
+    #endif
+
+    #if ( configUSE_POSIX_ERRNO == 1 )
+        int iTaskErrno;
+    #endif
+} __attribute__( ( aligned( configTCB_CACHE_LINE_SIZE ) ) ) tskTCB;
+
+#else /* configUSE_TCB_CACHE_LAYOUT */
+
 typedef struct tskTaskControlBlock       /* The old naming convention is used to prevent breaking kernel aware debuggers. */
 {
     volatile StackType_t * pxTopOfStack; /**< Points to the location of the last item placed on the tasks stack.  THIS MUST BE THE FIRST MEMBER OF THE TCB STRUCT. */
@@ -383,6 +522,10 @@ typedef struct tskTaskControlBlock       /* The old naming convention is used to
         UBaseType_t uxCoreAffinityMask; /**< Used to link the task to certain cores.  UBaseType_t must have greater than or equal to the number of bits as configNUMBER_OF_CORES. */
     #endif
 
+    #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+        BaseType_t xPartition; /**< The core whose ready lists hold the task - the single core in uxCoreAffinityMask. */
+    #endif
+
     ListItem_t xStateListItem;                  /**< The list that the state list item of a task is reference from denotes the state of that task (Ready, Blocked, Suspended ). */
     ListItem_t xEventListItem;                  /**< Used to reference a task from an event list. */
     UBaseType_t uxPriority;                     /**< The priority of the task.  0 is the lowest priority. */
@@ -451,6 +594,8 @@ typedef struct tskTaskControlBlock       /* The old naming convention is used to
     #endif
 } tskTCB;
 
+#endif /* configUSE_TCB_CACHE_LAYOUT */
+
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
  * below to enable the use of older kernel aware debuggers. */
 typedef tskTCB TCB_t;
@@ -472,13 +617,33 @@ typedef tskTCB TCB_t;
  * xDelayedTaskList1 and xDelayedTaskList2 could be moved to function scope but
  * doing so breaks some kernel aware debuggers and debuggers that rely on removing
  * the static qualifier. */
-PRIVILEGED_DATA static List_t pxReadyTasksLists[ configMAX_PRIORITIES ]; /**< Prioritised ready tasks. */
+#if ( configUSE_PARTITIONED_SCHEDULING == 0 )
+    PRIVILEGED_DATA static List_t pxReadyTasksLists[ configMAX_PRIORITIES ] portNOINIT; /**< Prioritised ready tasks.  Initialised with the first task, like the other lists. */
+#else
+    PRIVILEGED_DATA static List_t pxReadyTasksLists[ configNUMBER_OF_CORES ][ configMAX_PRIORITIES ] portNOINIT; /**< Prioritised ready tasks of each core. */
+    PRIVILEGED_DATA static List_t xCoreInboxes[ configNUMBER_OF_CORES ];                              /**< Tasks readied by another core, not yet moved to the owning core's ready lists. */
+#endif
 PRIVILEGED_DATA static List_t xDelayedTaskList1;                         /**< Delayed tasks. */
 PRIVILEGED_DATA static List_t xDelayedTaskList2;                         /**< Delayed tasks (two lists are used - one for delays that have overflowed the current tick count. */
 PRIVILEGED_DATA static List_t * volatile pxDelayedTaskList;              /**< Points to the delayed task list currently being used. */
 PRIVILEGED_DATA static List_t * volatile pxOverflowDelayedTaskList;      /**< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
 PRIVILEGED_DATA static List_t xPendingReadyList;                         /**< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready list when the scheduler is resumed. */
 
+#if ( configUSE_DELAY_WHEEL == 1 )
+
+/* Tasks delayed by less than configDELAY_WHEEL_SLOTS ticks, in the slot given
+ * by their wake time modulo the wheel size.  A slot therefore only ever holds
+ * tasks that wake at the same tick, unsorted, so adding a task is a
+ * listINSERT_END() and the tick interrupt empties one slot, whatever the
+ * number of delayed tasks.  Tick count overflows need no special handling.  A
+ * set bit in ulDelayWheelMap marks a slot that may be occupied: tasks leaving
+ * a slot early (events, xTaskAbortDelay(), deletion) do not clear it, the
+ * search for the next wake time does. */
+    PRIVILEGED_DATA static List_t xDelayWheel[ configDELAY_WHEEL_SLOTS ] portNOINIT;
+    PRIVILEGED_DATA static uint32_t ulDelayWheelMap[ tskDELAY_WHEEL_WORDS ] portNOINIT;
+
+#endif /* configUSE_DELAY_WHEEL */
+
 #if ( INCLUDE_vTaskDelete == 1 )
 
     PRIVILEGED_DATA static List_t xTasksWaitingTermination; /**< Tasks that have been deleted - but their memory not yet freed. */
@@ -501,7 +666,11 @@ PRIVILEGED_DATA static List_t xPendingReadyList;                         /**< Ta
 /* Other file private variables. --------------------------------*/
 PRIVILEGED_DATA static volatile UBaseType_t uxCurrentNumberOfTasks = ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xTickCount = ( TickType_t ) configINITIAL_TICK_COUNT;
-PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority = tskIDLE_PRIORITY;
+#if ( configUSE_PARTITIONED_SCHEDULING == 0 )
+    PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority = tskIDLE_PRIORITY;
+#else
+    PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriorities[ configNUMBER_OF_CORES ] = { tskIDLE_PRIORITY };
+#endif
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning = pdFALSE;
 PRIVILEGED_DATA static volatile TickType_t xPendedTicks = ( TickType_t ) 0U;
 PRIVILEGED_DATA static volatile BaseType_t xYieldPendings[ configNUMBER_OF_CORES ] = { pdFALSE };
@@ -573,6 +742,27 @@ static BaseType_t prvCreateIdleTasks( void );
     static void prvSelectHighestPriorityTask( BaseType_t xCoreID );
 #endif /* #if ( configNUMBER_OF_CORES > 1 ) */
 
+#if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+
+/*
+ * Places pxTCB in its core's ready list, or in that core's inbox if the
+ * calling core is another one.
+ */
+    static void prvAddTaskToPartition( TCB_t * pxTCB );
+
+/*
+ * Moves the tasks other cores have readied for xCoreID into its ready lists.
+ * Only called by core xCoreID itself.
+ */
+    static void prvDrainCoreInbox( BaseType_t xCoreID );
+
+/*
+ * Pins pxTCB to the lowest numbered core in uxCoreAffinityMask.
+ */
+    static void prvSetTaskPartition( TCB_t * pxTCB,
+                                     UBaseType_t uxCoreAffinityMask );
+#endif /* #if ( configUSE_PARTITIONED_SCHEDULING == 1 ) */
+
 /**
  * Utility task that simply returns pdTRUE if the task referenced by xTask is
  * currently in the Suspended state, or pdFALSE if the task referenced by xTask
@@ -698,6 +888,22 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
  */
 static void prvResetNextTaskUnblockTime( void ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_DELAY_WHEEL == 1 )
+
+/*
+ * The earliest wake time in the delay wheel that has not overflowed the tick
+ * count, or portMAX_DELAY if there is none.
+ */
+    static TickType_t prvDelayWheelNextUnblockTime( TickType_t xConstTickCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Place the current task in the delay wheel slot of xTimeToWake.
+ */
+    static void prvAddCurrentTaskToDelayWheel( TickType_t xTimeToWake,
+                                               TickType_t xConstTickCount ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_DELAY_WHEEL */
+
 #if ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
 
 /*
@@ -886,7 +1092,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB ) PRIVILEGED_FUNCTION;
 
 /*-----------------------------------------------------------*/
 
-#if ( configNUMBER_OF_CORES > 1 )
+#if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_PARTITIONED_SCHEDULING == 0 ) )
     static void prvYieldForTask( const TCB_t * pxTCB )
     {
         BaseType_t xLowestPriorityToPreempt;
@@ -998,10 +1204,10 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB ) PRIVILEGED_FUNCTION;
             #endif
         }
     }
-#endif /* #if ( configNUMBER_OF_CORES > 1 ) */
+#endif /* #if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_PARTITIONED_SCHEDULING == 0 ) ) */
 /*-----------------------------------------------------------*/
 
-#if ( configNUMBER_OF_CORES > 1 )
+#if ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_PARTITIONED_SCHEDULING == 0 ) )
     static void prvSelectHighestPriorityTask( BaseType_t xCoreID )
     {
         UBaseType_t uxCurrentPriority = uxTopReadyPriority;
@@ -1267,7 +1473,201 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB ) PRIVILEGED_FUNCTION;
         #endif /* #if ( configUSE_CORE_AFFINITY == 1 ) */
     }
 
-#endif /* ( configNUMBER_OF_CORES > 1 ) */
+#endif /* ( ( configNUMBER_OF_CORES > 1 ) && ( configUSE_PARTITIONED_SCHEDULING == 0 ) ) */
+
+#if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+    static void prvYieldForTask( const TCB_t * pxTCB )
+    {
+        /* A partitioned task can only preempt the task running on its own
+         * core, so no other core is looked at. */
+        const BaseType_t xCoreID = pxTCB->xPartition;
+        BaseType_t xCurrentCoreTaskPriority = ( BaseType_t ) pxCurrentTCBs[ xCoreID ]->uxPriority;
+
+        /* This must be called from a critical section. */
+        configASSERT( portGET_CRITICAL_NESTING_COUNT( ( BaseType_t ) portGET_CORE_ID() ) > 0U );
+
+        /* The idle task is preempted by tasks of its own priority as well. */
+        if( ( pxCurrentTCBs[ xCoreID ]->uxTaskAttributes & taskATTRIBUTE_IS_IDLE ) != 0U )
+        {
+            xCurrentCoreTaskPriority = ( BaseType_t ) ( xCurrentCoreTaskPriority - 1 );
+        }
+
+        if( ( taskTASK_IS_RUNNING( pxTCB ) == pdFALSE ) &&
+            ( taskTASK_IS_RUNNING( pxCurrentTCBs[ xCoreID ] ) != pdFALSE ) &&
+            ( xYieldPendings[ xCoreID ] == pdFALSE ) &&
+            ( ( BaseType_t ) pxTCB->uxPriority > xCurrentCoreTaskPriority ) )
+        {
+            #if ( configUSE_TASK_PREEMPTION_DISABLE == 1 )
+                if( pxCurrentTCBs[ xCoreID ]->xPreemptionDisable == pdFALSE )
+            #endif
+            {
+                prvYieldCore( xCoreID );
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvSelectHighestPriorityTask( BaseType_t xCoreID )
+    {
+        List_t * const pxCoreReadyLists = pxReadyTasksLists[ xCoreID ];
+        UBaseType_t uxCurrentPriority;
+        BaseType_t xTaskScheduled = pdFALSE;
+        BaseType_t xDecrementTopPriority = pdTRUE;
+        TCB_t * pxTCB;
+
+        /* This function should be called when scheduler is running. */
+        configASSERT( xSchedulerRunning == pdTRUE );
+
+        prvDrainCoreInbox( xCoreID );
+
+        /* As in the global scheduler, a running task that yields goes to the
+         * end of its ready list so that tasks of equal priority take turns. */
+        if( listIS_CONTAINED_WITHIN( &( pxCoreReadyLists[ pxCurrentTCBs[ xCoreID ]->uxPriority ] ),
+                                     &pxCurrentTCBs[ xCoreID ]->xStateListItem ) == pdTRUE )
+        {
+            ( void ) uxListRemove( &pxCurrentTCBs[ xCoreID ]->xStateListItem );
+            vListInsertEnd( &( pxCoreReadyLists[ pxCurrentTCBs[ xCoreID ]->uxPriority ] ),
+                            &pxCurrentTCBs[ xCoreID ]->xStateListItem );
+        }
+
+        uxCurrentPriority = uxTopReadyPriorities[ xCoreID ];
+
+        for( ; ; )
+        {
+            const List_t * const pxReadyList = &( pxCoreReadyLists[ uxCurrentPriority ] );
+
+            if( listLIST_IS_EMPTY( pxReadyList ) == pdFALSE )
+            {
+                const ListItem_t * pxEndMarker = listGET_END_MARKER( pxReadyList );
+                ListItem_t * pxIterator;
+
+                xDecrementTopPriority = pdFALSE;
+
+                for( pxIterator = listGET_HEAD_ENTRY( pxReadyList ); pxIterator != pxEndMarker; pxIterator = listGET_NEXT( pxIterator ) )
+                {
+                    /* MISRA Ref 11.5.3 [Void pointer assignment] */
+                    /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+                    /* coverity[misra_c_2012_rule_11_5_violation] */
+                    pxTCB = ( TCB_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+                    if( pxTCB->xTaskRunState == taskTASK_NOT_RUNNING )
+                    {
+                        pxCurrentTCBs[ xCoreID ]->xTaskRunState = taskTASK_NOT_RUNNING;
+                        pxTCB->xTaskRunState = xCoreID;
+                        pxCurrentTCBs[ xCoreID ] = pxTCB;
+                        xTaskScheduled = pdTRUE;
+                    }
+                    else if( pxTCB == pxCurrentTCBs[ xCoreID ] )
+                    {
+                        configASSERT( ( pxTCB->xTaskRunState == xCoreID ) || ( pxTCB->xTaskRunState == taskTASK_SCHEDULED_TO_YIELD ) );
+                        pxTCB->xTaskRunState = xCoreID;
+                        xTaskScheduled = pdTRUE;
+                    }
+                    else
+                    {
+                        /* Just moved here by vTaskCoreAffinitySet() and still
+                         * running on its old core. */
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+
+                    if( xTaskScheduled != pdFALSE )
+                    {
+                        break;
+                    }
+                }
+            }
+            else if( xDecrementTopPriority != pdFALSE )
+            {
+                uxTopReadyPriorities[ xCoreID ]--;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Each core's idle task is always in its tskIDLE_PRIORITY list. */
+            if( ( xTaskScheduled != pdFALSE ) || ( uxCurrentPriority == tskIDLE_PRIORITY ) )
+            {
+                break;
+            }
+
+            uxCurrentPriority--;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvAddTaskToPartition( TCB_t * pxTCB )
+    {
+        const BaseType_t xCoreID = pxTCB->xPartition;
+
+        traceMOVED_TASK_TO_READY_STATE( pxTCB );
+
+        if( ( xSchedulerRunning == pdFALSE ) || ( xCoreID == ( BaseType_t ) portGET_CORE_ID() ) )
+        {
+            if( pxTCB->uxPriority > uxTopReadyPriorities[ xCoreID ] )
+            {
+                uxTopReadyPriorities[ xCoreID ] = pxTCB->uxPriority;
+            }
+
+            listINSERT_END( &( pxReadyTasksLists[ xCoreID ][ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) );
+        }
+        else
+        {
+            /* The owning core files it at its next context switch: at once
+             * if prvYieldForTask() finds the task should preempt, otherwise
+             * when it blocks or at the next tick. */
+            listINSERT_END( &( xCoreInboxes[ xCoreID ] ), &( pxTCB->xStateListItem ) );
+        }
+
+        tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB );
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvDrainCoreInbox( BaseType_t xCoreID )
+    {
+        List_t * const pxInbox = &( xCoreInboxes[ xCoreID ] );
+        TCB_t * pxTCB;
+
+        while( listLIST_IS_EMPTY( pxInbox ) == pdFALSE )
+        {
+            /* MISRA Ref 11.5.3 [Void pointer assignment] */
+            /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+            /* coverity[misra_c_2012_rule_11_5_violation] */
+            pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxInbox );
+            listREMOVE_ITEM( &( pxTCB->xStateListItem ) );
+
+            if( pxTCB->uxPriority > uxTopReadyPriorities[ xCoreID ] )
+            {
+                uxTopReadyPriorities[ xCoreID ] = pxTCB->uxPriority;
+            }
+
+            listINSERT_END( &( pxReadyTasksLists[ xCoreID ][ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvSetTaskPartition( TCB_t * pxTCB,
+                                     UBaseType_t uxCoreAffinityMask )
+    {
+        BaseType_t xCoreID = 0;
+
+        /* Strict partitioning: the task runs on exactly one core. */
+        configASSERT( ( uxCoreAffinityMask & ( ( ( UBaseType_t ) 1U << ( UBaseType_t ) configNUMBER_OF_CORES ) - 1U ) ) != 0U );
+
+        while( ( uxCoreAffinityMask & ( ( UBaseType_t ) 1U << ( UBaseType_t ) xCoreID ) ) == 0U )
+        {
+            xCoreID++;
+        }
+
+        pxTCB->xPartition = xCoreID;
+        pxTCB->uxCoreAffinityMask = ( UBaseType_t ) 1U << ( UBaseType_t ) xCoreID;
+    }
+
+#endif /* #if ( configUSE_PARTITIONED_SCHEDULING == 1 ) */
 
 /*-----------------------------------------------------------*/
 
@@ -2153,6 +2553,13 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
             #endif /* configUSE_TRACE_FACILITY */
             traceTASK_CREATE( pxNewTCB );
 
+            #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+            {
+                /* Pin the task to the first core its affinity allows. */
+                prvSetTaskPartition( pxNewTCB, pxNewTCB->uxCoreAffinityMask );
+            }
+            #endif
+
             prvAddTaskToReadyList( pxNewTCB );
 
             portSETUP_TCB( pxNewTCB );
@@ -2550,6 +2957,13 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
                 eReturn = eBlocked;
             }
 
+            #if ( configUSE_DELAY_WHEEL == 1 )
+                else if( tskIS_DELAY_WHEEL_LIST( pxStateList ) )
+                {
+                    eReturn = eBlocked;
+                }
+            #endif
+
             #if ( INCLUDE_vTaskSuspend == 1 )
                 else if( pxStateList == &xSuspendedTaskList )
                 {
@@ -2936,7 +3350,7 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
                  * nothing more than change its priority variable. However, if
                  * the task is in a ready list it needs to be removed and placed
                  * in the list appropriate to its new priority. */
-                if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ uxPriorityUsedOnEntry ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+                if( listIS_CONTAINED_WITHIN( taskREADY_LIST( pxTCB, uxPriorityUsedOnEntry ), &( pxTCB->xStateListItem ) ) != pdFALSE )
                 {
                     /* The task is currently in its ready list - remove before
                      * adding it to its new ready list.  As we are in a critical
@@ -3020,7 +3434,32 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
             pxTCB = prvGetTCBFromHandle( xTask );
             configASSERT( pxTCB != NULL );
 
-            pxTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+            #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+            {
+                const BaseType_t xOldPartition = pxTCB->xPartition;
+                BaseType_t xQueued;
+
+                /* A partitioned task is pinned to a single core. */
+                configASSERT( ( uxCoreAffinityMask & ( uxCoreAffinityMask - 1U ) ) == 0U );
+
+                xQueued = ( listIS_CONTAINED_WITHIN( taskREADY_LIST( pxTCB, pxTCB->uxPriority ), &( pxTCB->xStateListItem ) ) != pdFALSE ) ||
+                          ( listIS_CONTAINED_WITHIN( &( xCoreInboxes[ xOldPartition ] ), &( pxTCB->xStateListItem ) ) != pdFALSE );
+
+                prvSetTaskPartition( pxTCB, uxCoreAffinityMask );
+                uxCoreAffinityMask = pxTCB->uxCoreAffinityMask;
+
+                /* A ready task moves to its new core's lists now. */
+                if( ( xQueued != pdFALSE ) && ( pxTCB->xPartition != xOldPartition ) )
+                {
+                    ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+                    prvAddTaskToReadyList( pxTCB );
+                }
+            }
+            #else
+            {
+                pxTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+            }
+            #endif
 
             if( xSchedulerRunning != pdFALSE )
             {
@@ -3676,6 +4115,16 @@ static BaseType_t prvCreateIdleTasks( void )
                 /* Assign idle task to each core before SMP scheduler is running. */
                 xIdleTaskHandles[ xCoreID ]->xTaskRunState = xCoreID;
                 pxCurrentTCBs[ xCoreID ] = xIdleTaskHandles[ xCoreID ];
+
+                #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+                {
+                    /* Created with the default affinity - move it into its
+                     * own core's partition. */
+                    ( void ) uxListRemove( &( xIdleTaskHandles[ xCoreID ]->xStateListItem ) );
+                    prvSetTaskPartition( xIdleTaskHandles[ xCoreID ], ( UBaseType_t ) 1U << ( UBaseType_t ) xCoreID );
+                    prvAddTaskToReadyList( xIdleTaskHandles[ xCoreID ] );
+                }
+                #endif
             }
             #endif
         }
@@ -4327,17 +4776,40 @@ char * pcTaskGetName( TaskHandle_t xTaskToQuery )
         vTaskSuspendAll();
         {
             /* Search the ready lists. */
-            do
+            #if ( configUSE_PARTITIONED_SCHEDULING == 0 )
             {
-                uxQueue--;
-                pxTCB = prvSearchForNameWithinSingleList( ( List_t * ) &( pxReadyTasksLists[ uxQueue ] ), pcNameToQuery );
+                do
+                {
+                    uxQueue--;
+                    pxTCB = prvSearchForNameWithinSingleList( ( List_t * ) &( pxReadyTasksLists[ uxQueue ] ), pcNameToQuery );
 
-                if( pxTCB != NULL )
+                    if( pxTCB != NULL )
+                    {
+                        /* Found the handle. */
+                        break;
+                    }
+                } while( uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY );
+            }
+            #else
+            {
+                BaseType_t xCoreID;
+
+                /* Each core's lists, and the tasks readied for it not yet
+                 * moved into them. */
+                pxTCB = NULL;
+
+                for( xCoreID = 0; ( xCoreID < ( BaseType_t ) configNUMBER_OF_CORES ) && ( pxTCB == NULL ); xCoreID++ )
                 {
-                    /* Found the handle. */
-                    break;
+                    pxTCB = prvSearchForNameWithinSingleList( &( xCoreInboxes[ xCoreID ] ), pcNameToQuery );
+
+                    for( uxQueue = configMAX_PRIORITIES; ( uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY ) && ( pxTCB == NULL ); )
+                    {
+                        uxQueue--;
+                        pxTCB = prvSearchForNameWithinSingleList( &( pxReadyTasksLists[ xCoreID ][ uxQueue ] ), pcNameToQuery );
+                    }
                 }
-            } while( uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY );
+            }
+            #endif /* if ( configUSE_PARTITIONED_SCHEDULING == 0 ) */
 
             /* Search the delayed lists. */
             if( pxTCB == NULL )
@@ -4350,6 +4822,17 @@ char * pcTaskGetName( TaskHandle_t xTaskToQuery )
                 pxTCB = prvSearchForNameWithinSingleList( ( List_t * ) pxOverflowDelayedTaskList, pcNameToQuery );
             }
 
+            #if ( configUSE_DELAY_WHEEL == 1 )
+            {
+                UBaseType_t uxSlot;
+
+                for( uxSlot = 0; ( uxSlot <= tskDELAY_WHEEL_MASK ) && ( pxTCB == NULL ); uxSlot++ )
+                {
+                    pxTCB = prvSearchForNameWithinSingleList( &( xDelayWheel[ uxSlot ] ), pcNameToQuery );
+                }
+            }
+            #endif
+
             #if ( INCLUDE_vTaskSuspend == 1 )
             {
                 if( pxTCB == NULL )
@@ -4452,17 +4935,47 @@ char * pcTaskGetName( TaskHandle_t xTaskToQuery )
             {
                 /* Fill in an TaskStatus_t structure with information on each
                  * task in the Ready state. */
-                do
+                #if ( configUSE_PARTITIONED_SCHEDULING == 0 )
                 {
-                    uxQueue--;
-                    uxTask = ( UBaseType_t ) ( uxTask + prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( pxReadyTasksLists[ uxQueue ] ), eReady ) );
-                } while( uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY );
+                    do
+                    {
+                        uxQueue--;
+                        uxTask = ( UBaseType_t ) ( uxTask + prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( pxReadyTasksLists[ uxQueue ] ), eReady ) );
+                    } while( uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY );
+                }
+                #else
+                {
+                    BaseType_t xCoreID;
+
+                    for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+                    {
+                        for( uxQueue = configMAX_PRIORITIES; uxQueue > ( UBaseType_t ) tskIDLE_PRIORITY; )
+                        {
+                            uxQueue--;
+                            uxTask = ( UBaseType_t ) ( uxTask + prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( pxReadyTasksLists[ xCoreID ][ uxQueue ] ), eReady ) );
+                        }
+
+                        uxTask = ( UBaseType_t ) ( uxTask + prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( xCoreInboxes[ xCoreID ] ), eReady ) );
+                    }
+                }
+                #endif /* if ( configUSE_PARTITIONED_SCHEDULING == 0 ) */
 
                 /* Fill in an TaskStatus_t structure with information on each
                  * task in the Blocked state. */
                 uxTask = ( UBaseType_t ) ( uxTask + prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxDelayedTaskList, eBlocked ) );
                 uxTask = ( UBaseType_t ) ( uxTask + prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxOverflowDelayedTaskList, eBlocked ) );
 
+                #if ( configUSE_DELAY_WHEEL == 1 )
+                {
+                    UBaseType_t uxSlot;
+
+                    for( uxSlot = 0; uxSlot <= tskDELAY_WHEEL_MASK; uxSlot++ )
+                    {
+                        uxTask = ( UBaseType_t ) ( uxTask + prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( xDelayWheel[ uxSlot ] ), eBlocked ) );
+                    }
+                }
+                #endif
+
                 #if ( INCLUDE_vTaskDelete == 1 )
                 {
                     /* Fill in an TaskStatus_t structure with information on
@@ -4764,6 +5277,50 @@ BaseType_t xTaskIncrementTick( void )
          * look any further down the list. */
         if( xConstTickCount >= xNextTaskUnblockTime )
         {
+            #if ( configUSE_DELAY_WHEEL == 1 )
+            {
+                /* Every task in this tick's slot wakes now.  They are placed
+                 * in the ready lists the same way as those from the delayed
+                 * list below. */
+                List_t * const pxSlot = &( xDelayWheel[ ( UBaseType_t ) xConstTickCount & tskDELAY_WHEEL_MASK ] );
+
+                while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+                {
+                    /* MISRA Ref 11.5.3 [Void pointer assignment] */
+                    /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+                    /* coverity[misra_c_2012_rule_11_5_violation] */
+                    pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+                    configASSERT( listGET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ) ) == xConstTickCount );
+
+                    listREMOVE_ITEM( &( pxTCB->xStateListItem ) );
+
+                    if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
+                    {
+                        listREMOVE_ITEM( &( pxTCB->xEventListItem ) );
+                    }
+
+                    prvAddTaskToReadyList( pxTCB );
+
+                    #if ( configUSE_PREEMPTION == 1 )
+                    {
+                        #if ( configNUMBER_OF_CORES == 1 )
+                        {
+                            if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+                            {
+                                xSwitchRequired = pdTRUE;
+                            }
+                        }
+                        #else
+                        {
+                            prvYieldForTask( pxTCB );
+                        }
+                        #endif
+                    }
+                    #endif /* #if ( configUSE_PREEMPTION == 1 ) */
+                }
+            }
+            #endif /* configUSE_DELAY_WHEEL */
+
             for( ; ; )
             {
                 if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
@@ -4853,6 +5410,17 @@ BaseType_t xTaskIncrementTick( void )
                     #endif /* #if ( configUSE_PREEMPTION == 1 ) */
                 }
             }
+
+            #if ( configUSE_DELAY_WHEEL == 1 )
+            {
+                const TickType_t xWheelUnblockTime = prvDelayWheelNextUnblockTime( xConstTickCount );
+
+                if( xWheelUnblockTime < xNextTaskUnblockTime )
+                {
+                    xNextTaskUnblockTime = xWheelUnblockTime;
+                }
+            }
+            #endif
         }
 
         /* Tasks of equal priority to the currently running task will share
@@ -4877,7 +5445,7 @@ BaseType_t xTaskIncrementTick( void )
 
                 for( xCoreID = 0; xCoreID < ( ( BaseType_t ) configNUMBER_OF_CORES ); xCoreID++ )
                 {
-                    if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCBs[ xCoreID ]->uxPriority ] ) ) > 1U )
+                    if( listCURRENT_LIST_LENGTH( taskREADY_LIST( pxCurrentTCBs[ xCoreID ], pxCurrentTCBs[ xCoreID ]->uxPriority ) ) > 1U )
                     {
                         xYieldPendings[ xCoreID ] = pdTRUE;
                     }
@@ -4885,6 +5453,17 @@ BaseType_t xTaskIncrementTick( void )
                     {
                         mtCOVERAGE_TEST_MARKER();
                     }
+
+                    #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+                    {
+                        /* Tasks another core readied, that did not preempt
+                         * this core's task, are filed at the next switch. */
+                        if( listLIST_IS_EMPTY( &( xCoreInboxes[ xCoreID ] ) ) == pdFALSE )
+                        {
+                            xYieldPendings[ xCoreID ] = pdTRUE;
+                        }
+                    }
+                    #endif
                 }
             }
             #endif /* #if ( configNUMBER_OF_CORES == 1 ) */
@@ -5556,6 +6135,166 @@ void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem,
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_EVENT_GROUP_WAITER_INDEX == 1 )
+
+    BaseType_t xTaskRemoveAllFromUnorderedEventList( List_t * const pxEventList,
+                                                     const TickType_t xItemValue )
+    {
+        TCB_t * pxUnblockedTCB;
+        BaseType_t xReturn = pdFALSE;
+        BaseType_t xMovedToReady = pdFALSE;
+
+        #if ( configNUMBER_OF_CORES == 1 )
+            UBaseType_t uxTopPriority = tskIDLE_PRIORITY;
+        #endif
+
+        /* THIS FUNCTION MUST BE CALLED FROM A CRITICAL SECTION.  It can also be
+         * called from a critical section within an ISR.  The event group makes
+         * sure nothing else is accessing pxEventList.
+         *
+         * Every task on the list is unblocked with the same item value, so the
+         * per task cost is just the list moves: the next unblock time is reset
+         * and the yield decided once for the whole batch. */
+        while( listLIST_IS_EMPTY( pxEventList ) == pdFALSE )
+        {
+            /* MISRA Ref 11.5.3 [Void pointer assignment] */
+            /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+            /* coverity[misra_c_2012_rule_11_5_violation] */
+            pxUnblockedTCB = listGET_OWNER_OF_HEAD_ENTRY( pxEventList );
+            configASSERT( pxUnblockedTCB );
+            listSET_LIST_ITEM_VALUE( &( pxUnblockedTCB->xEventListItem ), xItemValue | taskEVENT_LIST_ITEM_VALUE_IN_USE );
+            listREMOVE_ITEM( &( pxUnblockedTCB->xEventListItem ) );
+
+            if( uxSchedulerSuspended == ( UBaseType_t ) 0U )
+            {
+                listREMOVE_ITEM( &( pxUnblockedTCB->xStateListItem ) );
+                prvAddTaskToReadyList( pxUnblockedTCB );
+                xMovedToReady = pdTRUE;
+            }
+            else
+            {
+                /* The delayed and ready lists cannot be accessed, so hold this
+                 * task pending until the scheduler is resumed. */
+                listINSERT_END( &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
+            }
+
+            #if ( configNUMBER_OF_CORES == 1 )
+            {
+                if( pxUnblockedTCB->uxPriority > uxTopPriority )
+                {
+                    uxTopPriority = pxUnblockedTCB->uxPriority;
+                }
+            }
+            #elif ( configUSE_PREEMPTION == 1 )
+            {
+                prvYieldForTask( pxUnblockedTCB );
+            }
+            #endif
+        }
+
+        #if ( configUSE_TICKLESS_IDLE != 0 )
+        {
+            /* See xTaskRemoveFromEventList(). */
+            if( xMovedToReady != pdFALSE )
+            {
+                prvResetNextTaskUnblockTime();
+            }
+        }
+        #endif
+        ( void ) xMovedToReady;
+
+        #if ( configNUMBER_OF_CORES == 1 )
+        {
+            if( uxTopPriority > pxCurrentTCB->uxPriority )
+            {
+                xReturn = pdTRUE;
+                xYieldPendings[ 0 ] = pdTRUE;
+            }
+        }
+        #else
+        {
+            if( xYieldPendings[ portGET_CORE_ID() ] != pdFALSE )
+            {
+                xReturn = pdTRUE;
+            }
+        }
+        #endif
+
+        return xReturn;
+    }
+/*-----------------------------------------------------------*/
+
+    void vTaskRemoveAllFromUnorderedEventList( List_t * const pxEventList,
+                                               const TickType_t xItemValue )
+    {
+        TCB_t * pxUnblockedTCB = NULL;
+
+        #if ( configNUMBER_OF_CORES == 1 )
+            UBaseType_t uxTopPriority = tskIDLE_PRIORITY;
+        #endif
+
+        /* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED.  As in
+         * vTaskRemoveFromUnorderedEventList(), interrupts then do not access
+         * the delayed or ready lists, so the tasks go straight to the ready
+         * lists without a critical section.  The event group keeps interrupts
+         * off pxEventList. */
+        configASSERT( uxSchedulerSuspended != ( UBaseType_t ) 0U );
+
+        while( listLIST_IS_EMPTY( pxEventList ) == pdFALSE )
+        {
+            /* MISRA Ref 11.5.3 [Void pointer assignment] */
+            /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+            /* coverity[misra_c_2012_rule_11_5_violation] */
+            pxUnblockedTCB = listGET_OWNER_OF_HEAD_ENTRY( pxEventList );
+            configASSERT( pxUnblockedTCB );
+            listSET_LIST_ITEM_VALUE( &( pxUnblockedTCB->xEventListItem ), xItemValue | taskEVENT_LIST_ITEM_VALUE_IN_USE );
+            listREMOVE_ITEM( &( pxUnblockedTCB->xEventListItem ) );
+
+            listREMOVE_ITEM( &( pxUnblockedTCB->xStateListItem ) );
+            prvAddTaskToReadyList( pxUnblockedTCB );
+
+            #if ( configNUMBER_OF_CORES == 1 )
+            {
+                if( pxUnblockedTCB->uxPriority > uxTopPriority )
+                {
+                    uxTopPriority = pxUnblockedTCB->uxPriority;
+                }
+            }
+            #elif ( configUSE_PREEMPTION == 1 )
+            {
+                taskENTER_CRITICAL();
+                {
+                    prvYieldForTask( pxUnblockedTCB );
+                }
+                taskEXIT_CRITICAL();
+            }
+            #endif
+        }
+
+        #if ( configUSE_TICKLESS_IDLE != 0 )
+        {
+            /* See vTaskRemoveFromUnorderedEventList(). */
+            if( pxUnblockedTCB != NULL )
+            {
+                prvResetNextTaskUnblockTime();
+            }
+        }
+        #endif
+
+        #if ( configNUMBER_OF_CORES == 1 )
+        {
+            /* The switch occurs when the scheduler is resumed. */
+            if( uxTopPriority > pxCurrentTCB->uxPriority )
+            {
+                xYieldPendings[ 0 ] = pdTRUE;
+            }
+        }
+        #endif
+    }
+
+#endif /* configUSE_EVENT_GROUP_WAITER_INDEX */
+/*-----------------------------------------------------------*/
+
 void vTaskSetTimeOutState( TimeOut_t * const pxTimeOut )
 {
     traceENTER_vTaskSetTimeOutState( pxTimeOut );
@@ -5758,7 +6497,7 @@ void vTaskMissedYield( void )
                  * the ready list at the idle priority contains one more task than the
                  * number of idle tasks, which is equal to the configured numbers of cores
                  * then a task other than the idle task is ready to execute. */
-                if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) configNUMBER_OF_CORES )
+                if( listCURRENT_LIST_LENGTH( taskREADY_LIST( pxCurrentTCB, tskIDLE_PRIORITY ) ) > ( UBaseType_t ) taskIDLE_TASKS_PER_READY_LIST )
                 {
                     taskYIELD();
                 }
@@ -5847,7 +6586,7 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
              * the ready list at the idle priority contains one more task than the
              * number of idle tasks, which is equal to the configured numbers of cores
              * then a task other than the idle task is ready to execute. */
-            if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) configNUMBER_OF_CORES )
+            if( listCURRENT_LIST_LENGTH( taskREADY_LIST( pxCurrentTCB, tskIDLE_PRIORITY ) ) > ( UBaseType_t ) taskIDLE_TASKS_PER_READY_LIST )
             {
                 taskYIELD();
             }
@@ -6068,15 +6807,49 @@ static void prvInitialiseTaskLists( void )
 {
     UBaseType_t uxPriority;
 
-    for( uxPriority = ( UBaseType_t ) 0U; uxPriority < ( UBaseType_t ) configMAX_PRIORITIES; uxPriority++ )
+    #if ( configUSE_PARTITIONED_SCHEDULING == 0 )
+    {
+        for( uxPriority = ( UBaseType_t ) 0U; uxPriority < ( UBaseType_t ) configMAX_PRIORITIES; uxPriority++ )
+        {
+            vListInitialise( &( pxReadyTasksLists[ uxPriority ] ) );
+        }
+    }
+    #else
     {
-        vListInitialise( &( pxReadyTasksLists[ uxPriority ] ) );
+        BaseType_t xCoreID;
+
+        for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+        {
+            for( uxPriority = ( UBaseType_t ) 0U; uxPriority < ( UBaseType_t ) configMAX_PRIORITIES; uxPriority++ )
+            {
+                vListInitialise( &( pxReadyTasksLists[ xCoreID ][ uxPriority ] ) );
+            }
+
+            vListInitialise( &( xCoreInboxes[ xCoreID ] ) );
+        }
     }
+    #endif /* if ( configUSE_PARTITIONED_SCHEDULING == 0 ) */
 
     vListInitialise( &xDelayedTaskList1 );
     vListInitialise( &xDelayedTaskList2 );
     vListInitialise( &xPendingReadyList );
 
+    #if ( configUSE_DELAY_WHEEL == 1 )
+    {
+        UBaseType_t uxSlot;
+
+        for( uxSlot = 0; uxSlot <= tskDELAY_WHEEL_MASK; uxSlot++ )
+        {
+            vListInitialise( &( xDelayWheel[ uxSlot ] ) );
+        }
+
+        for( uxSlot = 0; uxSlot < tskDELAY_WHEEL_WORDS; uxSlot++ )
+        {
+            ulDelayWheelMap[ uxSlot ] = 0U;
+        }
+    }
+    #endif /* configUSE_DELAY_WHEEL */
+
     #if ( INCLUDE_vTaskDelete == 1 )
     {
         vListInitialise( &xTasksWaitingTermination );
@@ -6530,9 +7303,99 @@ static void prvResetNextTaskUnblockTime( void )
          * from the Blocked state. */
         xNextTaskUnblockTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxDelayedTaskList );
     }
+
+    #if ( configUSE_DELAY_WHEEL == 1 )
+    {
+        const TickType_t xWheelUnblockTime = prvDelayWheelNextUnblockTime( xTickCount );
+
+        if( xWheelUnblockTime < xNextTaskUnblockTime )
+        {
+            xNextTaskUnblockTime = xWheelUnblockTime;
+        }
+    }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_DELAY_WHEEL == 1 )
+
+    static TickType_t prvDelayWheelNextUnblockTime( TickType_t xConstTickCount )
+    {
+        const UBaseType_t uxStart = ( UBaseType_t ) xConstTickCount & tskDELAY_WHEEL_MASK;
+        UBaseType_t x;
+
+        /* Look through the slots from the current tick's onwards, around the
+         * wheel and back to the current word's lower bits.  An unprocessed
+         * task in the current tick's slot (just after an overflow) wakes now. */
+        for( x = 0; x <= tskDELAY_WHEEL_WORDS; x++ )
+        {
+            const UBaseType_t uxWord = ( ( uxStart / 32U ) + x ) % tskDELAY_WHEEL_WORDS;
+            uint32_t ulBits = ulDelayWheelMap[ uxWord ];
+
+            if( x == 0U )
+            {
+                ulBits &= ~0UL << ( uxStart % 32U );
+            }
+            else if( x == tskDELAY_WHEEL_WORDS )
+            {
+                ulBits &= ( 1UL << ( uxStart % 32U ) ) - 1UL;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            while( ulBits != 0U )
+            {
+                const UBaseType_t uxBit = ( UBaseType_t ) __builtin_ctz( ulBits );
+                const UBaseType_t uxSlot = ( uxWord * 32U ) + uxBit;
+                TickType_t xTimeToWake;
+
+                if( listLIST_IS_EMPTY( &( xDelayWheel[ uxSlot ] ) ) != pdFALSE )
+                {
+                    /* Emptied by something other than the tick. */
+                    ulDelayWheelMap[ uxWord ] &= ~( 1UL << uxBit );
+                    ulBits &= ulBits - 1U;
+                    continue;
+                }
+
+                xTimeToWake = xConstTickCount + ( TickType_t ) ( ( uxSlot - uxStart ) & tskDELAY_WHEEL_MASK );
+
+                /* Later slots only hold later wake times, so if this one is
+                 * past the overflow they all are.  They are found again when
+                 * the delayed lists are switched. */
+                return ( xTimeToWake < xConstTickCount ) ? portMAX_DELAY : xTimeToWake;
+            }
+        }
+
+        return portMAX_DELAY;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvAddCurrentTaskToDelayWheel( TickType_t xTimeToWake,
+                                               TickType_t xConstTickCount )
+    {
+        const UBaseType_t uxSlot = ( UBaseType_t ) xTimeToWake & tskDELAY_WHEEL_MASK;
+
+        traceMOVED_TASK_TO_DELAYED_LIST();
+        listINSERT_END( &( xDelayWheel[ uxSlot ] ), &( pxCurrentTCB->xStateListItem ) );
+        ulDelayWheelMap[ uxSlot / 32U ] |= 1UL << ( uxSlot % 32U );
+
+        /* As for the delayed lists, a wake time past the tick count overflow
+         * is picked up when the lists are switched. */
+        if( ( xTimeToWake >= xConstTickCount ) && ( xTimeToWake < xNextTaskUnblockTime ) )
+        {
+            xNextTaskUnblockTime = xTimeToWake;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_DELAY_WHEEL */
+/*-----------------------------------------------------------*/
+
 #if ( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_RECURSIVE_MUTEXES == 1 ) ) || ( configNUMBER_OF_CORES > 1 )
 
     #if ( configNUMBER_OF_CORES == 1 )
@@ -6666,7 +7529,7 @@ static void prvResetNextTaskUnblockTime( void )
 
                 /* If the task being modified is in the ready state it will need
                  * to be moved into a new list. */
-                if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxMutexHolderTCB->uxPriority ] ), &( pxMutexHolderTCB->xStateListItem ) ) != pdFALSE )
+                if( listIS_CONTAINED_WITHIN( taskREADY_LIST( pxMutexHolderTCB, pxMutexHolderTCB->uxPriority ), &( pxMutexHolderTCB->xStateListItem ) ) != pdFALSE )
                 {
                     if( uxListRemove( &( pxMutexHolderTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
                     {
@@ -6899,7 +7762,7 @@ static void prvResetNextTaskUnblockTime( void )
                      * from its current state list if it is in the Ready state as
                      * the task's priority is going to change and there is one
                      * Ready list per priority. */
-                    if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ uxPriorityUsedOnEntry ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+                    if( listIS_CONTAINED_WITHIN( taskREADY_LIST( pxTCB, uxPriorityUsedOnEntry ), &( pxTCB->xStateListItem ) ) != pdFALSE )
                     {
                         if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
                         {
@@ -7686,6 +8549,46 @@ TickType_t uxTaskResetEventItemValue( void )
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_MUTEX_FAST_PATH == 1 )
+
+    BaseType_t xTaskDecrementMutexHeldCount( void )
+    {
+        TCB_t * pxTCB;
+        BaseType_t xReturn = pdFALSE;
+
+        traceENTER_xTaskDecrementMutexHeldCount();
+
+        pxTCB = pxCurrentTCB;
+
+        /* Only the task itself changes its count outside a critical section,
+         * and only for a mutex it took on the fast path.  Nothing has blocked
+         * on that mutex, but another one given back earlier might have been
+         * contended - its priority is only disinherited once the last mutex
+         * is given back, which may be this one. */
+        configASSERT( pxTCB->uxMutexesHeld );
+
+        if( ( pxTCB->uxMutexesHeld == ( UBaseType_t ) 1 ) &&
+            ( pxTCB->uxPriority != pxTCB->uxBasePriority ) )
+        {
+            taskENTER_CRITICAL();
+            {
+                xReturn = xTaskPriorityDisinherit( pxTCB );
+            }
+            taskEXIT_CRITICAL();
+        }
+        else
+        {
+            ( pxTCB->uxMutexesHeld )--;
+        }
+
+        traceRETURN_xTaskDecrementMutexHeldCount( xReturn );
+
+        return xReturn;
+    }
+
+#endif /* configUSE_MUTEX_FAST_PATH */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_TASK_NOTIFICATIONS == 1 )
 
     uint32_t ulTaskGenericNotifyTake( UBaseType_t uxIndexToWaitOn,
@@ -8625,6 +9528,13 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
             /* The list item will be inserted in wake time order. */
             listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ), xTimeToWake );
 
+            #if ( configUSE_DELAY_WHEEL == 1 )
+                if( tskDELAY_IN_WHEEL( xTicksToWait ) )
+                {
+                    prvAddCurrentTaskToDelayWheel( xTimeToWake, xConstTickCount );
+                }
+                else
+            #endif
             if( xTimeToWake < xConstTickCount )
             {
                 /* Wake time has overflowed.  Place this item in the overflow
@@ -8663,6 +9573,13 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
         /* The list item will be inserted in wake time order. */
         listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ), xTimeToWake );
 
+        #if ( configUSE_DELAY_WHEEL == 1 )
+            if( tskDELAY_IN_WHEEL( xTicksToWait ) )
+            {
+                prvAddCurrentTaskToDelayWheel( xTimeToWake, xConstTickCount );
+            }
+            else
+        #endif
         if( xTimeToWake < xConstTickCount )
         {
             traceMOVED_TASK_TO_OVERFLOW_DELAYED_LIST();
@@ -8833,13 +9750,18 @@ void vTaskResetState( void )
     /* Other file private variables. */
     uxCurrentNumberOfTasks = ( UBaseType_t ) 0U;
     xTickCount = ( TickType_t ) configINITIAL_TICK_COUNT;
-    uxTopReadyPriority = tskIDLE_PRIORITY;
+    #if ( configUSE_PARTITIONED_SCHEDULING == 0 )
+        uxTopReadyPriority = tskIDLE_PRIORITY;
+    #endif
     xSchedulerRunning = pdFALSE;
     xPendedTicks = ( TickType_t ) 0U;
 
     for( xCoreID = 0; xCoreID < configNUMBER_OF_CORES; xCoreID++ )
     {
         xYieldPendings[ xCoreID ] = pdFALSE;
+        #if ( configUSE_PARTITIONED_SCHEDULING == 1 )
+            uxTopReadyPriorities[ xCoreID ] = tskIDLE_PRIORITY;
+        #endif
     }
 
     xNumOfOverflows = ( BaseType_t ) 0;
@@ -0,0 +1,127 @@
+/*
+ * RTOS tick driver on the ARMv7 virtual generic timer - see tick_timer.h.
+ *
+ * The compare value is advanced by exactly one period on every tick rather
+ * than re-armed relative to "now", so interrupt latency does not accumulate
+ * into tick drift.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "gic.h"
+#include "tick_timer.h"
+#if ( configUSE_SEL4_PARAVIRT == 1 )
+#include "sel4_pv.h"
+#endif
+
+static uint32_t counts_per_tick;
+static uint64_t next_tick_compare;
+
+uint32_t tick_timer_counts_per_tick(void) {
+    return counts_per_tick;
+}
+
+void vSetupTickInterrupt(void) {
+    uint32_t freq = tick_timer_read_cntfrq();
+
+    if (freq == 0) {
+        freq = TICK_TIMER_FALLBACK_HZ;
+    }
+    counts_per_tick = freq / configTICK_RATE_HZ;
+    configASSERT(counts_per_tick != 0);
+
+    gic_init();
+
+    // The tick must run at the lowest usable priority - FreeRTOS_Tick_Handler
+    // relies on interrupts not already being masked when it is entered.
+    gic_set_priority(TICK_TIMER_IRQ_ID, portLOWEST_USABLE_INTERRUPT_PRIORITY);
+
+    next_tick_compare = tick_timer_read_counter() + counts_per_tick;
+    tick_timer_write_compare(next_tick_compare);
+    tick_timer_write_ctl(CNTV_CTL_ENABLE);
+
+    gic_enable_irq(TICK_TIMER_IRQ_ID);
+}
+
+// configCLEAR_TICK_INTERRUPT(): the virtual timer output is level sensitive and
+// stays asserted until the compare value moves past the counter.
+void vClearTickInterrupt(void) {
+    next_tick_compare += counts_per_tick;
+    tick_timer_write_compare(next_tick_compare);
+}
+
+#if (configUSE_TICKLESS_IDLE != 0)
+
+// Called by the idle task with the scheduler suspended.  Instead of taking
+// every tick while nothing is ready, move the compare value out to the next
+// unblock time, WFI, and tell the kernel how many ticks went by.
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+    uint64_t sleep_compare;
+    uint64_t now;
+    TickType_t idle_ticks;
+    TickType_t complete_ticks;
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+    // The run-time counter must not sleep through a cycle counter wrap.
+    if (xExpectedIdleTime > portMAX_RUN_TIME_STATS_IDLE_TICKS) {
+        xExpectedIdleTime = portMAX_RUN_TIME_STATS_IDLE_TICKS;
+    }
+#endif
+    idle_ticks = xExpectedIdleTime;
+
+    __asm volatile ("cpsid i\n"
+                    "dsb\n"
+                    "isb" ::: "memory");
+
+    // A task may have been readied, or a context switch pended, between the
+    // idle task deciding to sleep and interrupts being masked.
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        __asm volatile ("cpsie i" ::: "memory");
+        return;
+    }
+
+    // next_tick_compare is the boundary of the tick currently in progress, so
+    // it already accounts for the first of the expected idle ticks.
+    sleep_compare = next_tick_compare + (uint64_t)(idle_ticks - 1) * counts_per_tick;
+    tick_timer_write_compare(sleep_compare);
+
+    // The pre-sleep hook may set xExpectedIdleTime to 0 to skip the WFI.
+    configPRE_SLEEP_PROCESSING(xExpectedIdleTime);
+    if (xExpectedIdleTime > 0) {
+#if ( configUSE_SEL4_PARAVIRT == 1 )
+        // The VMM is told when to run the vCPU again.
+        sel4_pv_wait(sleep_compare);
+#else
+        // WFI wakes on a pending interrupt even with the I bit set.
+        __asm volatile ("dsb\n"
+                        "wfi\n"
+                        "isb" ::: "memory");
+#endif
+    }
+    configPOST_SLEEP_PROCESSING(xExpectedIdleTime);
+
+    now = tick_timer_read_counter();
+
+    if (now >= sleep_compare) {
+        // The timer expired.  Its interrupt is pending and will account for
+        // the final tick through FreeRTOS_Tick_Handler once IRQs are unmasked.
+        complete_ticks = idle_ticks - 1;
+        next_tick_compare = sleep_compare;
+    } else {
+        // Woken early by another interrupt: count the whole tick periods
+        // that elapsed and re-arm on the next period boundary.
+        if (now < next_tick_compare) {
+            complete_ticks = 0;
+        } else {
+            complete_ticks = (TickType_t)((now - next_tick_compare) / counts_per_tick) + 1;
+        }
+        next_tick_compare += (uint64_t)complete_ticks * counts_per_tick;
+        tick_timer_write_compare(next_tick_compare);
+    }
+
+    vTaskStepTick(complete_ticks);
+
+    __asm volatile ("cpsie i" ::: "memory");
+}
+
+#endif // configUSE_TICKLESS_IDLE
@@ -79,6 +79,25 @@
     #define tmrSTATUS_IS_STATICALLY_ALLOCATED    ( 0x02U )
     #define tmrSTATUS_IS_AUTORELOAD              ( 0x04U )
 
+/* Timer wheel geometry - see xTimerWheel below.  Each level has up to
+ * tmrWHEEL_SLOTS slots; the top one only covers the remaining bits of the tick
+ * count, so it may have fewer. */
+    #if ( configUSE_TIMER_WHEEL == 1 )
+        #define tmrWHEEL_SLOT_BITS    ( 5U )
+        #define tmrWHEEL_SLOTS        ( 1U << tmrWHEEL_SLOT_BITS )
+        #define tmrWHEEL_TICK_BITS    ( sizeof( TickType_t ) * 8U )
+        #define tmrWHEEL_LEVELS       ( ( tmrWHEEL_TICK_BITS + tmrWHEEL_SLOT_BITS - 1U ) / tmrWHEEL_SLOT_BITS )
+        #define tmrWHEEL_SLOTS_AT_LEVEL( uxLevel )                                                           \
+    ( ( ( tmrWHEEL_TICK_BITS - ( ( uxLevel ) * tmrWHEEL_SLOT_BITS ) ) >= tmrWHEEL_SLOT_BITS ) ? tmrWHEEL_SLOTS : \
+      ( 1U << ( tmrWHEEL_TICK_BITS - ( ( uxLevel ) * tmrWHEEL_SLOT_BITS ) ) ) )
+
+/* The longest timer period, and the longest the timer service task sleeps for.
+ * Between them they keep every expiry time less than the tick range ahead of
+ * xWheelTime. */
+        #define tmrWHEEL_MAX_PERIOD    ( tmrMAX_TIME_BEFORE_OVERFLOW >> 1 )
+        #define tmrWHEEL_MAX_SLEEP     ( tmrMAX_TIME_BEFORE_OVERFLOW >> 2 )
+    #endif /* configUSE_TIMER_WHEEL */
+
 /* The definition of the timers themselves. */
     typedef struct tmrTimerControl                                               /* The old naming convention is used to prevent breaking kernel aware debuggers. */
     {
@@ -134,16 +153,37 @@
         } u;
     } DaemonTaskMessage_t;
 
+    #if ( configUSE_TIMER_WHEEL == 0 )
+
 /* The list in which active timers are stored.  Timers are referenced in expire
  * time order, with the nearest expiry time at the front of the list.  Only the
  * timer service task is allowed to access these lists.
  * xActiveTimerList1 and xActiveTimerList2 could be at function scope but that
  * breaks some kernel aware debuggers, and debuggers that reply on removing the
  * static qualifier. */
-    PRIVILEGED_DATA static List_t xActiveTimerList1;
-    PRIVILEGED_DATA static List_t xActiveTimerList2;
-    PRIVILEGED_DATA static List_t * pxCurrentTimerList;
-    PRIVILEGED_DATA static List_t * pxOverflowTimerList;
+        PRIVILEGED_DATA static List_t xActiveTimerList1;
+        PRIVILEGED_DATA static List_t xActiveTimerList2;
+        PRIVILEGED_DATA static List_t * pxCurrentTimerList;
+        PRIVILEGED_DATA static List_t * pxOverflowTimerList;
+    #else /* if ( configUSE_TIMER_WHEEL == 0 ) */
+
+/* Active timers are kept in a hierarchical timer wheel.  A level n slot spans
+ * 2^(5n) ticks.  A timer goes in the lowest level that reaches its expiry time
+ * from xWheelTime, in the slot picked by the expiry time's bits for that level,
+ * so starting or stopping a timer is a single vListInsertEnd() or uxListRemove()
+ * however many timers are active.  When xWheelTime reaches the start of an
+ * occupied slot above level 0 the slot's timers move down the wheel, and when it
+ * reaches an occupied level 0 slot all the timers in it have expired.  Times are
+ * only compared relative to xWheelTime, so tick count overflows need no special
+ * handling.  Tasks apply timer commands to the wheel directly, so, unlike the
+ * lists, it is only accessed from critical sections. */
+        PRIVILEGED_DATA static List_t xTimerWheel[ tmrWHEEL_LEVELS ][ tmrWHEEL_SLOTS ] portNOINIT;     /* Initialised with the timer queue. */
+        PRIVILEGED_DATA static uint32_t ulWheelOccupied[ tmrWHEEL_LEVELS ] portNOINIT;                 /* Bit n is set while slot n of the level is not empty. */
+        PRIVILEGED_DATA static TickType_t xWheelTime = ( TickType_t ) 0U;     /* The wheel has been processed up to and including this time. */
+        PRIVILEGED_DATA static TickType_t xWheelWakeTime = ( TickType_t ) 0U; /* When the timer service task, if waiting, is due to wake. */
+        PRIVILEGED_DATA static BaseType_t xWheelTaskWaiting = pdFALSE;
+        PRIVILEGED_DATA static BaseType_t xWheelReceiving = pdFALSE;          /* The timer service task may hold a command it has received but not yet applied. */
+    #endif /* if ( configUSE_TIMER_WHEEL == 0 ) */
 
 /* A queue that is used to send commands to the timer service task. */
     PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
@@ -170,42 +210,44 @@
  */
     static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
+    #if ( configUSE_TIMER_WHEEL == 0 )
+
 /*
  * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
  * depending on if the expire time causes a timer counter overflow.
  */
-    static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer,
-                                                  const TickType_t xNextExpiryTime,
-                                                  const TickType_t xTimeNow,
-                                                  const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
+        static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer,
+                                                      const TickType_t xNextExpiryTime,
+                                                      const TickType_t xTimeNow,
+                                                      const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
 
 /*
  * Reload the specified auto-reload timer.  If the reloading is backlogged,
  * clear the backlog, calling the callback for each additional reload.  When
  * this function returns, the next expiry time is after xTimeNow.
  */
-    static void prvReloadTimer( Timer_t * const pxTimer,
-                                TickType_t xExpiredTime,
-                                const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+        static void prvReloadTimer( Timer_t * const pxTimer,
+                                    TickType_t xExpiredTime,
+                                    const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
 
 /*
  * An active timer has reached its expire time.  Reload the timer if it is an
  * auto-reload timer, then call its callback.
  */
-    static void prvProcessExpiredTimer( const TickType_t xNextExpireTime,
-                                        const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+        static void prvProcessExpiredTimer( const TickType_t xNextExpireTime,
+                                            const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
 
 /*
  * The tick count has overflowed.  Switch the timer lists after ensuring the
  * current timer list does not still reference some timers.
  */
-    static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+        static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
  * if a tick count overflow occurred since prvSampleTimeNow() was last called.
  */
-    static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
+        static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
 
 /*
  * If the timer list contains any active timers then return the expire time of
@@ -213,14 +255,87 @@
  * timer list does not contain any timers then return 0 and set *pxListWasEmpty
  * to pdTRUE.
  */
-    static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty ) PRIVILEGED_FUNCTION;
+        static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty ) PRIVILEGED_FUNCTION;
 
 /*
  * If a timer has expired, process it.  Otherwise, block the timer service task
  * until either a timer does expire or a command is received.
  */
-    static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime,
-                                            BaseType_t xListWasEmpty ) PRIVILEGED_FUNCTION;
+        static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime,
+                                                BaseType_t xListWasEmpty ) PRIVILEGED_FUNCTION;
+    #else /* if ( configUSE_TIMER_WHEEL == 0 ) */
+
+/*
+ * Put the timer in the wheel slot for xNextExpiryTime, or take it out of
+ * whichever slot it is in.  Called from a critical section.
+ */
+        static void prvWheelInsert( Timer_t * const pxTimer,
+                                    const TickType_t xNextExpiryTime ) PRIVILEGED_FUNCTION;
+        static void prvWheelRemove( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+/*
+ * If the wheel holds any timers, set *pxTicksAhead to the number of ticks from
+ * xWheelTime to the next slot that needs processing and return pdTRUE,
+ * otherwise return pdFALSE.  Called from a critical section.
+ */
+        static BaseType_t prvWheelNextEvent( TickType_t * const pxTicksAhead ) PRIVILEGED_FUNCTION;
+
+/*
+ * Move the timers out of every slot above level 0 that starts at xWheelTime
+ * into lower levels.  Called from a critical section.
+ */
+        static void prvWheelCascade( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * The timer, which is not in the wheel, expired at xExpiredTime.  Reload it if
+ * it is an auto-reload timer, clearing any backlog, and return the number of
+ * times its callback must be called.  Called from a critical section.
+ */
+        static UBaseType_t prvWheelExpireTimer( Timer_t * const pxTimer,
+                                                TickType_t xExpiredTime,
+                                                const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Advance the wheel to xTimeNow, calling the callback of every timer that
+ * expires on the way.
+ */
+        static void prvWheelProcessExpiredTimers( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Block the timer service task until the wheel's next slot is due, a command is
+ * received, or a task starts a timer that expires before then.
+ */
+        static void prvWheelWaitForWork( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Apply a start, reset, stop or change period command to the timer.  Returns
+ * pdTRUE, leaving the timer untouched, if the expiry time of a start or reset
+ * command has already passed.  Called from a critical section.
+ */
+        static BaseType_t prvWheelApplyCommand( Timer_t * const pxTimer,
+                                                const BaseType_t xCommandID,
+                                                const TickType_t xOptionalValue,
+                                                const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called by the timer service task to process a timer command it received on
+ * the timer queue.
+ */
+        static void prvWheelProcessCommand( Timer_t * const pxTimer,
+                                            const BaseType_t xCommandID,
+                                            const TickType_t xMessageValue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Apply a command from a task without going through the timer queue, waking
+ * the timer service task if the timer now expires before the task is due to
+ * wake.  Returns pdFAIL if the command must be sent to the queue instead,
+ * which includes whenever earlier commands are still queued or being applied,
+ * so that commands take effect in the order they were issued.
+ */
+        static BaseType_t prvWheelCommandFromTask( Timer_t * const pxTimer,
+                                                   const BaseType_t xCommandID,
+                                                   const TickType_t xOptionalValue ) PRIVILEGED_FUNCTION;
+    #endif /* if ( configUSE_TIMER_WHEEL == 0 ) */
 
 /*
  * Called after a Timer_t structure has been allocated either statically or
@@ -424,6 +539,14 @@
         /* 0 is not a valid value for xTimerPeriodInTicks. */
         configASSERT( ( xTimerPeriodInTicks > 0 ) );
 
+        #if ( configUSE_TIMER_WHEEL == 1 )
+        {
+            /* Here rather than when the timer is first started, so the call
+             * that sets the period is the one that fails. */
+            configASSERT( ( xTimerPeriodInTicks <= tmrWHEEL_MAX_PERIOD ) );
+        }
+        #endif
+
         /* Ensure the infrastructure used by the timer service task has been
          * created/initialised. */
         prvCheckForValidListAndQueue();
@@ -469,7 +592,25 @@
 
             configASSERT( xCommandID < tmrFIRST_FROM_ISR_COMMAND );
 
-            if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+            #if ( configUSE_TIMER_WHEEL == 1 )
+            {
+                configASSERT( ( xCommandID != tmrCOMMAND_CHANGE_PERIOD ) || ( xOptionalValue <= tmrWHEEL_MAX_PERIOD ) );
+
+                /* Apply the command to the wheel directly.  Only deletion has to
+                 * wait for the timer service task, which may be running the
+                 * timer's callback. */
+                if( ( xCommandID != tmrCOMMAND_DELETE ) && ( xCommandID < tmrFIRST_FROM_ISR_COMMAND ) )
+                {
+                    xReturn = prvWheelCommandFromTask( xTimer, xCommandID, xOptionalValue );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            #endif /* configUSE_TIMER_WHEEL */
+
+            if( ( xReturn == pdFAIL ) && ( xCommandID < tmrFIRST_FROM_ISR_COMMAND ) )
             {
                 if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
                 {
@@ -518,6 +659,12 @@
 
             configASSERT( xCommandID >= tmrFIRST_FROM_ISR_COMMAND );
 
+            #if ( configUSE_TIMER_WHEEL == 1 )
+            {
+                configASSERT( ( xCommandID != tmrCOMMAND_CHANGE_PERIOD_FROM_ISR ) || ( xOptionalValue <= tmrWHEEL_MAX_PERIOD ) );
+            }
+            #endif
+
             if( xCommandID >= tmrFIRST_FROM_ISR_COMMAND )
             {
                 xReturn = xQueueSendToBackFromISR( xTimerQueue, &xMessage, pxHigherPriorityTaskWoken );
@@ -692,59 +839,65 @@
     }
 /*-----------------------------------------------------------*/
 
-    static void prvReloadTimer( Timer_t * const pxTimer,
-                                TickType_t xExpiredTime,
-                                const TickType_t xTimeNow )
-    {
-        /* Insert the timer into the appropriate list for the next expiry time.
-         * If the next expiry time has already passed, advance the expiry time,
-         * call the callback function, and try again. */
-        while( prvInsertTimerInActiveList( pxTimer, ( xExpiredTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xExpiredTime ) != pdFALSE )
+    #if ( configUSE_TIMER_WHEEL == 0 )
+
+        static void prvReloadTimer( Timer_t * const pxTimer,
+                                    TickType_t xExpiredTime,
+                                    const TickType_t xTimeNow )
         {
-            /* Advance the expiry time. */
-            xExpiredTime += pxTimer->xTimerPeriodInTicks;
+            /* Insert the timer into the appropriate list for the next expiry time.
+             * If the next expiry time has already passed, advance the expiry time,
+             * call the callback function, and try again. */
+            while( prvInsertTimerInActiveList( pxTimer, ( xExpiredTime + pxTimer->xTimerPeriodInTicks ), xTimeNow, xExpiredTime ) != pdFALSE )
+            {
+                /* Advance the expiry time. */
+                xExpiredTime += pxTimer->xTimerPeriodInTicks;
 
-            /* Call the timer callback. */
-            traceTIMER_EXPIRED( pxTimer );
-            pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+                /* Call the timer callback. */
+                traceTIMER_EXPIRED( pxTimer );
+                pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+            }
         }
-    }
 /*-----------------------------------------------------------*/
 
-    static void prvProcessExpiredTimer( const TickType_t xNextExpireTime,
-                                        const TickType_t xTimeNow )
-    {
-        /* MISRA Ref 11.5.3 [Void pointer assignment] */
-        /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
-        /* coverity[misra_c_2012_rule_11_5_violation] */
-        Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList );
+        static void prvProcessExpiredTimer( const TickType_t xNextExpireTime,
+                                            const TickType_t xTimeNow )
+        {
+            /* MISRA Ref 11.5.3 [Void pointer assignment] */
+            /* More details at: https://github.com/FreeRTOS/FreeRTOS-Kernel/blob/main/MISRA.md#rule-115 */
+            /* coverity[misra_c_2012_rule_11_5_violation] */
+            Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList );
 
-        /* Remove the timer from the list of active timers.  A check has already
-         * been performed to ensure the list is not empty. */
+            /* Remove the timer from the list of active timers.  A check has already
+             * been performed to ensure the list is not empty. */
 
-        ( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+            ( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
 
-        /* If the timer is an auto-reload timer then calculate the next
-         * expiry time and re-insert the timer in the list of active timers. */
-        if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0U )
-        {
-            prvReloadTimer( pxTimer, xNextExpireTime, xTimeNow );
-        }
-        else
-        {
-            pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
+            /* If the timer is an auto-reload timer then calculate the next
+             * expiry time and re-insert the timer in the list of active timers. */
+            if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0U )
+            {
+                prvReloadTimer( pxTimer, xNextExpireTime, xTimeNow );
+            }
+            else
+            {
+                pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
+            }
+
+            /* Call the timer callback. */
+            traceTIMER_EXPIRED( pxTimer );
+            pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
         }
 
-        /* Call the timer callback. */
-        traceTIMER_EXPIRED( pxTimer );
-        pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
-    }
+    #endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
     static portTASK_FUNCTION( prvTimerTask, pvParameters )
     {
-        TickType_t xNextExpireTime;
-        BaseType_t xListWasEmpty;
+        #if ( configUSE_TIMER_WHEEL == 0 )
+            TickType_t xNextExpireTime;
+            BaseType_t xListWasEmpty;
+        #endif
 
         /* Just to avoid compiler warnings. */
         ( void ) pvParameters;
@@ -761,13 +914,24 @@
 
         for( ; configCONTROL_INFINITE_LOOP(); )
         {
-            /* Query the timers list to see if it contains any timers, and if so,
-             * obtain the time at which the next timer will expire. */
-            xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
+            #if ( configUSE_TIMER_WHEEL == 1 )
+            {
+                /* Process every timer that has expired, then block this task until
+                 * the wheel next needs processing, or a command is received. */
+                prvWheelProcessExpiredTimers( xTaskGetTickCount() );
+                prvWheelWaitForWork();
+            }
+            #else
+            {
+                /* Query the timers list to see if it contains any timers, and if so,
+                 * obtain the time at which the next timer will expire. */
+                xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
 
-            /* If a timer has expired, process it.  Otherwise, block this task
-             * until either a timer does expire, or a command is received. */
-            prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+                /* If a timer has expired, process it.  Otherwise, block this task
+                 * until either a timer does expire, or a command is received. */
+                prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+            }
+            #endif /* configUSE_TIMER_WHEEL */
 
             /* Empty the command queue. */
             prvProcessReceivedCommands();
@@ -775,168 +939,666 @@
     }
 /*-----------------------------------------------------------*/
 
-    static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime,
-                                            BaseType_t xListWasEmpty )
-    {
-        TickType_t xTimeNow;
-        BaseType_t xTimerListsWereSwitched;
+    #if ( configUSE_TIMER_WHEEL == 0 )
 
-        vTaskSuspendAll();
+        static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime,
+                                                BaseType_t xListWasEmpty )
         {
-            /* Obtain the time now to make an assessment as to whether the timer
-             * has expired or not.  If obtaining the time causes the lists to switch
-             * then don't process this timer as any timers that remained in the list
-             * when the lists were switched will have been processed within the
-             * prvSampleTimeNow() function. */
-            xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
-
-            if( xTimerListsWereSwitched == pdFALSE )
+            TickType_t xTimeNow;
+            BaseType_t xTimerListsWereSwitched;
+
+            vTaskSuspendAll();
             {
-                /* The tick count has not overflowed, has the timer expired? */
-                if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
+                /* Obtain the time now to make an assessment as to whether the timer
+                 * has expired or not.  If obtaining the time causes the lists to switch
+                 * then don't process this timer as any timers that remained in the list
+                 * when the lists were switched will have been processed within the
+                 * prvSampleTimeNow() function. */
+                xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+
+                if( xTimerListsWereSwitched == pdFALSE )
+                {
+                    /* The tick count has not overflowed, has the timer expired? */
+                    if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
+                    {
+                        ( void ) xTaskResumeAll();
+                        prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+                    }
+                    else
+                    {
+                        /* The tick count has not overflowed, and the next expire
+                         * time has not been reached yet.  This task should therefore
+                         * block to wait for the next expire time or a command to be
+                         * received - whichever comes first.  The following line cannot
+                         * be reached unless xNextExpireTime > xTimeNow, except in the
+                         * case when the current timer list is empty. */
+                        if( xListWasEmpty != pdFALSE )
+                        {
+                            /* The current timer list is empty - is the overflow list
+                             * also empty? */
+                            xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+                        }
+
+                        vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+
+                        if( xTaskResumeAll() == pdFALSE )
+                        {
+                            /* Yield to wait for either a command to arrive, or the
+                             * block time to expire.  If a command arrived between the
+                             * critical section being exited and this yield then the yield
+                             * will not cause the task to block. */
+                            taskYIELD_WITHIN_API();
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                }
+                else
                 {
                     ( void ) xTaskResumeAll();
-                    prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
+        {
+            TickType_t xNextExpireTime;
+
+            /* Timers are listed in expiry time order, with the head of the list
+             * referencing the task that will expire first.  Obtain the time at which
+             * the timer with the nearest expiry time will expire.  If there are no
+             * active timers then just set the next expire time to 0.  That will cause
+             * this task to unblock when the tick count overflows, at which point the
+             * timer lists will be switched and the next expiry time can be
+             * re-assessed.  */
+            *pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
+
+            if( *pxListWasEmpty == pdFALSE )
+            {
+                xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+            }
+            else
+            {
+                /* Ensure the task unblocks when the tick count rolls over. */
+                xNextExpireTime = ( TickType_t ) 0U;
+            }
+
+            return xNextExpireTime;
+        }
+/*-----------------------------------------------------------*/
+
+        static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
+        {
+            TickType_t xTimeNow;
+            PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U;
+
+            xTimeNow = xTaskGetTickCount();
+
+            if( xTimeNow < xLastTime )
+            {
+                prvSwitchTimerLists();
+                *pxTimerListsWereSwitched = pdTRUE;
+            }
+            else
+            {
+                *pxTimerListsWereSwitched = pdFALSE;
+            }
+
+            xLastTime = xTimeNow;
+
+            return xTimeNow;
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer,
+                                                      const TickType_t xNextExpiryTime,
+                                                      const TickType_t xTimeNow,
+                                                      const TickType_t xCommandTime )
+        {
+            BaseType_t xProcessTimerNow = pdFALSE;
+
+            listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+            listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+            if( xNextExpiryTime <= xTimeNow )
+            {
+                /* Has the expiry time elapsed between the command to start/reset a
+                 * timer was issued, and the time the command was processed? */
+                if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks )
+                {
+                    /* The time between a command being issued and the command being
+                     * processed actually exceeds the timers period.  */
+                    xProcessTimerNow = pdTRUE;
+                }
+                else
+                {
+                    vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+                }
+            }
+            else
+            {
+                if( ( xTimeNow < xCommandTime ) && ( xNextExpiryTime >= xCommandTime ) )
+                {
+                    /* If, since the command was issued, the tick count has overflowed
+                     * but the expiry time has not, then the timer must have already passed
+                     * its expiry time and should be processed immediately. */
+                    xProcessTimerNow = pdTRUE;
                 }
                 else
                 {
-                    /* The tick count has not overflowed, and the next expire
-                     * time has not been reached yet.  This task should therefore
-                     * block to wait for the next expire time or a command to be
-                     * received - whichever comes first.  The following line cannot
-                     * be reached unless xNextExpireTime > xTimeNow, except in the
-                     * case when the current timer list is empty. */
-                    if( xListWasEmpty != pdFALSE )
+                    vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+                }
+            }
+
+            return xProcessTimerNow;
+        }
+/*-----------------------------------------------------------*/
+
+    #else /* if ( configUSE_TIMER_WHEEL == 0 ) */
+
+        static void prvWheelInsert( Timer_t * const pxTimer,
+                                    const TickType_t xNextExpiryTime )
+        {
+            const TickType_t xTicksAhead = xNextExpiryTime - xWheelTime;
+            UBaseType_t uxLevel = 0U;
+            UBaseType_t uxSlot;
+
+            configASSERT( pxTimer->xTimerPeriodInTicks <= tmrWHEEL_MAX_PERIOD );
+
+            /* Find the lowest level that reaches the expiry time. */
+            while( ( uxLevel < ( tmrWHEEL_LEVELS - 1U ) ) && ( ( xTicksAhead >> ( ( uxLevel + 1U ) * tmrWHEEL_SLOT_BITS ) ) != ( TickType_t ) 0U ) )
+            {
+                uxLevel++;
+            }
+
+            uxSlot = ( UBaseType_t ) ( xNextExpiryTime >> ( uxLevel * tmrWHEEL_SLOT_BITS ) ) & ( tmrWHEEL_SLOTS - 1U );
+
+            listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+            listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+            vListInsertEnd( &( xTimerWheel[ uxLevel ][ uxSlot ] ), &( pxTimer->xTimerListItem ) );
+            ulWheelOccupied[ uxLevel ] |= ( 1UL << uxSlot );
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvWheelRemove( Timer_t * const pxTimer )
+        {
+            List_t * const pxSlot = listLIST_ITEM_CONTAINER( &( pxTimer->xTimerListItem ) );
+            size_t uxIndex;
+
+            if( pxSlot != NULL )
+            {
+                if( uxListRemove( &( pxTimer->xTimerListItem ) ) == ( UBaseType_t ) 0U )
+                {
+                    uxIndex = ( size_t ) ( pxSlot - &( xTimerWheel[ 0 ][ 0 ] ) );
+                    ulWheelOccupied[ uxIndex / tmrWHEEL_SLOTS ] &= ~( 1UL << ( uxIndex % tmrWHEEL_SLOTS ) );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvWheelNextEvent( TickType_t * const pxTicksAhead )
+        {
+            BaseType_t xFound = pdFALSE;
+            UBaseType_t uxLevel;
+            UBaseType_t uxShift;
+            UBaseType_t uxMask;
+            UBaseType_t uxCurrent;
+            UBaseType_t uxAhead;
+            TickType_t xTicksAhead;
+
+            for( uxLevel = 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+            {
+                if( ulWheelOccupied[ uxLevel ] != 0U )
+                {
+                    uxShift = uxLevel * tmrWHEEL_SLOT_BITS;
+                    uxMask = tmrWHEEL_SLOTS_AT_LEVEL( uxLevel ) - 1U;
+                    uxCurrent = ( UBaseType_t ) ( xWheelTime >> uxShift ) & uxMask;
+
+                    /* Find the nearest occupied slot after the current one.  The
+                     * current slot itself is a whole turn of the level away: it
+                     * was processed, or was empty, when xWheelTime entered it. */
+                    uxAhead = 1U;
+
+                    while( ( ulWheelOccupied[ uxLevel ] & ( 1UL << ( ( uxCurrent + uxAhead ) & uxMask ) ) ) == 0U )
                     {
-                        /* The current timer list is empty - is the overflow list
-                         * also empty? */
-                        xListWasEmpty = listLIST_IS_EMPTY( pxOverflowTimerList );
+                        uxAhead++;
                     }
 
-                    vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+                    /* Ticks from xWheelTime to the start of that slot. */
+                    xTicksAhead = ( ( TickType_t ) uxAhead << uxShift ) - ( xWheelTime & ( ( ( TickType_t ) 1U << uxShift ) - 1U ) );
 
-                    if( xTaskResumeAll() == pdFALSE )
+                    if( ( xFound == pdFALSE ) || ( xTicksAhead < *pxTicksAhead ) )
                     {
-                        /* Yield to wait for either a command to arrive, or the
-                         * block time to expire.  If a command arrived between the
-                         * critical section being exited and this yield then the yield
-                         * will not cause the task to block. */
-                        taskYIELD_WITHIN_API();
+                        *pxTicksAhead = xTicksAhead;
+                        xFound = pdTRUE;
                     }
-                    else
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+
+            return xFound;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvWheelCascade( void )
+        {
+            UBaseType_t uxLevel;
+            UBaseType_t uxShift;
+            List_t * pxSlot;
+            Timer_t * pxTimer;
+
+            /* A slot that starts at xWheelTime only holds timers that expire less
+             * than one slot length after it, so they all land in the current
+             * level 0 slot or in slots still ahead - never in another slot that
+             * is cascaded here. */
+            for( uxLevel = 1U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+            {
+                uxShift = uxLevel * tmrWHEEL_SLOT_BITS;
+
+                if( ( xWheelTime & ( ( ( TickType_t ) 1U << uxShift ) - 1U ) ) == ( TickType_t ) 0U )
+                {
+                    pxSlot = &( xTimerWheel[ uxLevel ][ ( UBaseType_t ) ( xWheelTime >> uxShift ) & ( tmrWHEEL_SLOTS_AT_LEVEL( uxLevel ) - 1U ) ] );
+
+                    while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
                     {
-                        mtCOVERAGE_TEST_MARKER();
+                        pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+
+                        prvWheelRemove( pxTimer );
+                        prvWheelInsert( pxTimer, listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) );
                     }
                 }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        }
+/*-----------------------------------------------------------*/
+
+        static UBaseType_t prvWheelExpireTimer( Timer_t * const pxTimer,
+                                                TickType_t xExpiredTime,
+                                                const TickType_t xTimeNow )
+        {
+            UBaseType_t uxCallbacks = 1U;
+
+            if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0U )
+            {
+                /* As prvReloadTimer() - one more callback for each reload that is
+                 * already due. */
+                while( ( ( TickType_t ) ( xTimeNow - xExpiredTime ) ) >= pxTimer->xTimerPeriodInTicks )
+                {
+                    xExpiredTime += pxTimer->xTimerPeriodInTicks;
+                    uxCallbacks++;
+                }
+
+                pxTimer->ucStatus |= ( uint8_t ) tmrSTATUS_IS_ACTIVE;
+                prvWheelInsert( pxTimer, xExpiredTime + pxTimer->xTimerPeriodInTicks );
             }
             else
             {
-                ( void ) xTaskResumeAll();
+                pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
             }
+
+            return uxCallbacks;
         }
-    }
 /*-----------------------------------------------------------*/
 
-    static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
-    {
-        TickType_t xNextExpireTime;
-
-        /* Timers are listed in expiry time order, with the head of the list
-         * referencing the task that will expire first.  Obtain the time at which
-         * the timer with the nearest expiry time will expire.  If there are no
-         * active timers then just set the next expire time to 0.  That will cause
-         * this task to unblock when the tick count overflows, at which point the
-         * timer lists will be switched and the next expiry time can be
-         * re-assessed.  */
-        *pxListWasEmpty = listLIST_IS_EMPTY( pxCurrentTimerList );
-
-        if( *pxListWasEmpty == pdFALSE )
+        static void prvWheelProcessExpiredTimers( const TickType_t xTimeNow )
         {
-            xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+            TickType_t xTicksAhead;
+            TickType_t xEventTime;
+            BaseType_t xEventDue;
+            List_t * pxSlot;
+            Timer_t * pxTimer;
+            UBaseType_t uxCallbacks = 0U;
+
+            do
+            {
+                /* Step xWheelTime to the next slot that needs processing, if it is
+                 * due, otherwise straight to xTimeNow. */
+                taskENTER_CRITICAL();
+                {
+                    xEventDue = prvWheelNextEvent( &xTicksAhead );
+
+                    if( ( xEventDue != pdFALSE ) && ( xTicksAhead <= ( TickType_t ) ( xTimeNow - xWheelTime ) ) )
+                    {
+                        xWheelTime += xTicksAhead;
+                        prvWheelCascade();
+                    }
+                    else
+                    {
+                        xEventDue = pdFALSE;
+                        xWheelTime = xTimeNow;
+                    }
+
+                    xEventTime = xWheelTime;
+                }
+                taskEXIT_CRITICAL();
+
+                if( xEventDue != pdFALSE )
+                {
+                    /* Every timer in the level 0 slot expires now.  They are taken
+                     * out one at a time so that the callbacks run outside the
+                     * critical section.  Timers started meanwhile expire at least
+                     * one tick after xWheelTime, so never land in this slot. */
+                    pxSlot = &( xTimerWheel[ 0 ][ ( UBaseType_t ) xEventTime & ( tmrWHEEL_SLOTS - 1U ) ] );
+
+                    do
+                    {
+                        pxTimer = NULL;
+
+                        taskENTER_CRITICAL();
+                        {
+                            if( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+                            {
+                                pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+                                configASSERT( listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) == xEventTime );
+
+                                prvWheelRemove( pxTimer );
+                                uxCallbacks = prvWheelExpireTimer( pxTimer, xEventTime, xTimeNow );
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
+                        taskEXIT_CRITICAL();
+
+                        if( pxTimer != NULL )
+                        {
+                            for( ; uxCallbacks > 0U; uxCallbacks-- )
+                            {
+                                traceTIMER_EXPIRED( pxTimer );
+                                pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+                            }
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    } while( pxTimer != NULL );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            } while( xEventDue != pdFALSE );
         }
-        else
+/*-----------------------------------------------------------*/
+
+        static void prvWheelWaitForWork( void )
         {
-            /* Ensure the task unblocks when the tick count rolls over. */
-            xNextExpireTime = ( TickType_t ) 0U;
-        }
+            TickType_t xTimeNow;
+            TickType_t xTicksAhead;
+            TickType_t xTicksToWait;
 
-        return xNextExpireTime;
-    }
-/*-----------------------------------------------------------*/
+            vTaskSuspendAll();
+            {
+                taskENTER_CRITICAL();
+                {
+                    xTimeNow = xTaskGetTickCount();
 
-    static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
-    {
-        TickType_t xTimeNow;
-        PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U;
+                    /* Wake at least every tmrWHEEL_MAX_SLEEP ticks, even with no
+                     * timers active, so that xWheelTime never falls too far behind
+                     * the tick count. */
+                    xTicksToWait = tmrWHEEL_MAX_SLEEP;
 
-        xTimeNow = xTaskGetTickCount();
+                    if( prvWheelNextEvent( &xTicksAhead ) != pdFALSE )
+                    {
+                        if( xTicksAhead <= ( TickType_t ) ( xTimeNow - xWheelTime ) )
+                        {
+                            /* Became due since the wheel was last processed. */
+                            xTicksToWait = tmrNO_DELAY;
+                        }
+                        else if( ( xTicksAhead - ( TickType_t ) ( xTimeNow - xWheelTime ) ) < tmrWHEEL_MAX_SLEEP )
+                        {
+                            xTicksToWait = xTicksAhead - ( TickType_t ) ( xTimeNow - xWheelTime );
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
 
-        if( xTimeNow < xLastTime )
-        {
-            prvSwitchTimerLists();
-            *pxTimerListsWereSwitched = pdTRUE;
+                    /* From here until the task is blocked, a task that starts a
+                     * timer expiring before xWheelWakeTime aborts the wait.  On a
+                     * multi-core system it cannot do so before the task is blocked,
+                     * as xTaskAbortDelay() waits for the scheduler to be resumed. */
+                    xWheelWakeTime = xTimeNow + xTicksToWait;
+                    xWheelTaskWaiting = ( xTicksToWait != tmrNO_DELAY ) ? pdTRUE : pdFALSE;
+                }
+                taskEXIT_CRITICAL();
+
+                if( xTicksToWait != tmrNO_DELAY )
+                {
+                    vQueueWaitForMessageRestricted( xTimerQueue, xTicksToWait, pdFALSE );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+
+            if( ( xTaskResumeAll() == pdFALSE ) && ( xTicksToWait != tmrNO_DELAY ) )
+            {
+                /* Yield to wait for a command, the block time to expire, or the
+                 * wait to be aborted. */
+                taskYIELD_WITHIN_API();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            taskENTER_CRITICAL();
+            {
+                xWheelTaskWaiting = pdFALSE;
+            }
+            taskEXIT_CRITICAL();
         }
-        else
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvWheelApplyCommand( Timer_t * const pxTimer,
+                                                const BaseType_t xCommandID,
+                                                const TickType_t xOptionalValue,
+                                                const TickType_t xTimeNow )
         {
-            *pxTimerListsWereSwitched = pdFALSE;
-        }
+            BaseType_t xExpired = pdFALSE;
+
+            switch( xCommandID )
+            {
+                case tmrCOMMAND_START:
+                case tmrCOMMAND_START_FROM_ISR:
+                case tmrCOMMAND_RESET:
+                case tmrCOMMAND_RESET_FROM_ISR:
+
+                    /* Has the expiry time already passed since the command was
+                     * issued? */
+                    if( ( ( TickType_t ) ( xTimeNow - xOptionalValue ) ) >= pxTimer->xTimerPeriodInTicks )
+                    {
+                        xExpired = pdTRUE;
+                    }
+                    else
+                    {
+                        prvWheelRemove( pxTimer );
+                        pxTimer->ucStatus |= ( uint8_t ) tmrSTATUS_IS_ACTIVE;
+                        prvWheelInsert( pxTimer, xOptionalValue + pxTimer->xTimerPeriodInTicks );
+                    }
 
-        xLastTime = xTimeNow;
+                    break;
 
-        return xTimeNow;
-    }
-/*-----------------------------------------------------------*/
+                case tmrCOMMAND_STOP:
+                case tmrCOMMAND_STOP_FROM_ISR:
+                    prvWheelRemove( pxTimer );
+                    pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
+                    break;
 
-    static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer,
-                                                  const TickType_t xNextExpiryTime,
-                                                  const TickType_t xTimeNow,
-                                                  const TickType_t xCommandTime )
-    {
-        BaseType_t xProcessTimerNow = pdFALSE;
+                case tmrCOMMAND_CHANGE_PERIOD:
+                case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR:
+                    prvWheelRemove( pxTimer );
+                    pxTimer->ucStatus |= ( uint8_t ) tmrSTATUS_IS_ACTIVE;
+                    pxTimer->xTimerPeriodInTicks = xOptionalValue;
+                    configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
 
-        listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
-        listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+                    /* As for the lists, the new period is measured from now. */
+                    prvWheelInsert( pxTimer, xTimeNow + pxTimer->xTimerPeriodInTicks );
+                    break;
 
-        if( xNextExpiryTime <= xTimeNow )
+                default:
+                    /* Don't expect to get here. */
+                    break;
+            }
+
+            return xExpired;
+        }
+/*-----------------------------------------------------------*/
+
+        static void prvWheelProcessCommand( Timer_t * const pxTimer,
+                                            const BaseType_t xCommandID,
+                                            const TickType_t xMessageValue )
         {
-            /* Has the expiry time elapsed between the command to start/reset a
-             * timer was issued, and the time the command was processed? */
-            if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks )
+            /* Sampled after the message was received, as in the list version. */
+            const TickType_t xTimeNow = xTaskGetTickCount();
+            UBaseType_t uxCallbacks = 0U;
+
+            taskENTER_CRITICAL();
             {
-                /* The time between a command being issued and the command being
-                 * processed actually exceeds the timers period.  */
-                xProcessTimerNow = pdTRUE;
+                if( xCommandID == tmrCOMMAND_DELETE )
+                {
+                    prvWheelRemove( pxTimer );
+                    pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
+                }
+                else if( prvWheelApplyCommand( pxTimer, xCommandID, xMessageValue, xTimeNow ) != pdFALSE )
+                {
+                    /* The timer expired before the command was processed.  Process
+                     * it now. */
+                    prvWheelRemove( pxTimer );
+                    uxCallbacks = prvWheelExpireTimer( pxTimer, xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
             }
-            else
+            taskEXIT_CRITICAL();
+
+            for( ; uxCallbacks > 0U; uxCallbacks-- )
             {
-                vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+                traceTIMER_EXPIRED( pxTimer );
+                pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
             }
+
+            #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+            {
+                if( ( xCommandID == tmrCOMMAND_DELETE ) && ( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 ) )
+                {
+                    vPortFree( pxTimer );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
         }
-        else
+/*-----------------------------------------------------------*/
+
+        static BaseType_t prvWheelCommandFromTask( Timer_t * const pxTimer,
+                                                   const BaseType_t xCommandID,
+                                                   const TickType_t xOptionalValue )
         {
-            if( ( xTimeNow < xCommandTime ) && ( xNextExpiryTime >= xCommandTime ) )
+            BaseType_t xReturn = pdFAIL;
+            BaseType_t xWakeTimerTask = pdFALSE;
+
+            taskENTER_CRITICAL();
             {
-                /* If, since the command was issued, the tick count has overflowed
-                 * but the expiry time has not, then the timer must have already passed
-                 * its expiry time and should be processed immediately. */
-                xProcessTimerNow = pdTRUE;
+                /* Commands from ISRs, and task commands that could not be
+                 * applied directly, go through the queue.  While any are queued
+                 * or held by the timer service task this one must queue behind
+                 * them, or it would take effect first - a stop overtaken by an
+                 * earlier start would leave the timer running.  A start or reset
+                 * that has already expired is left to the timer service task,
+                 * which has to call the callback. */
+                if( ( xWheelReceiving != pdFALSE ) || ( uxQueueMessagesWaiting( xTimerQueue ) != ( UBaseType_t ) 0U ) )
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+                else if( prvWheelApplyCommand( pxTimer, xCommandID, xOptionalValue, xTaskGetTickCount() ) == pdFALSE )
+                {
+                    xReturn = pdPASS;
+
+                    if( ( xWheelTaskWaiting != pdFALSE ) &&
+                        ( ( pxTimer->ucStatus & tmrSTATUS_IS_ACTIVE ) != 0U ) &&
+                        ( ( ( TickType_t ) ( listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) - xWheelTime ) ) < ( ( TickType_t ) ( xWheelWakeTime - xWheelTime ) ) ) )
+                    {
+                        xWakeTimerTask = pdTRUE;
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( xWakeTimerTask != pdFALSE )
+            {
+                ( void ) xTaskAbortDelay( xTimerTaskHandle );
             }
             else
             {
-                vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+                mtCOVERAGE_TEST_MARKER();
             }
+
+            return xReturn;
         }
 
-        return xProcessTimerNow;
-    }
+    #endif /* if ( configUSE_TIMER_WHEEL == 0 ) */
 /*-----------------------------------------------------------*/
 
     static void prvProcessReceivedCommands( void )
     {
         DaemonTaskMessage_t xMessage = { 0 };
         Timer_t * pxTimer;
-        BaseType_t xTimerListsWereSwitched;
-        TickType_t xTimeNow;
+
+        #if ( configUSE_TIMER_WHEEL == 0 )
+            BaseType_t xTimerListsWereSwitched;
+            TickType_t xTimeNow;
+        #endif
+
+        #if ( configUSE_TIMER_WHEEL == 1 )
+        {
+            /* A message received below is applied after it has left the queue;
+             * until then tasks must not apply theirs directly. */
+            taskENTER_CRITICAL();
+            {
+                xWheelReceiving = pdTRUE;
+            }
+            taskEXIT_CRITICAL();
+        }
+        #endif
 
         while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL )
         {
@@ -972,110 +1634,120 @@
 
                 if( pxTimer != NULL )
                 {
-                    if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE )
+                    #if ( configUSE_TIMER_WHEEL == 1 )
                     {
-                        /* The timer is in a list, remove it. */
-                        ( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
-
-                    traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
-
-                    /* In this case the xTimerListsWereSwitched parameter is not used, but
-                     *  it must be present in the function call.  prvSampleTimeNow() must be
-                     *  called after the message is received from xTimerQueue so there is no
-                     *  possibility of a higher priority task adding a message to the message
-                     *  queue with a time that is ahead of the timer daemon task (because it
-                     *  pre-empted the timer daemon task after the xTimeNow value was set). */
-                    xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+                        traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
 
-                    switch( xMessage.xMessageID )
+                        prvWheelProcessCommand( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
+                    }
+                    #else
                     {
-                        case tmrCOMMAND_START:
-                        case tmrCOMMAND_START_FROM_ISR:
-                        case tmrCOMMAND_RESET:
-                        case tmrCOMMAND_RESET_FROM_ISR:
-                            /* Start or restart a timer. */
-                            pxTimer->ucStatus |= ( uint8_t ) tmrSTATUS_IS_ACTIVE;
-
-                            if( prvInsertTimerInActiveList( pxTimer, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) != pdFALSE )
-                            {
-                                /* The timer expired before it was added to the active
-                                 * timer list.  Process it now. */
-                                if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0U )
+                        if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE )
+                        {
+                            /* The timer is in a list, remove it. */
+                            ( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+
+                        traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
+
+                        /* In this case the xTimerListsWereSwitched parameter is not used, but
+                         *  it must be present in the function call.  prvSampleTimeNow() must be
+                         *  called after the message is received from xTimerQueue so there is no
+                         *  possibility of a higher priority task adding a message to the message
+                         *  queue with a time that is ahead of the timer daemon task (because it
+                         *  pre-empted the timer daemon task after the xTimeNow value was set). */
+                        xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+
+                        switch( xMessage.xMessageID )
+                        {
+                            case tmrCOMMAND_START:
+                            case tmrCOMMAND_START_FROM_ISR:
+                            case tmrCOMMAND_RESET:
+                            case tmrCOMMAND_RESET_FROM_ISR:
+                                /* Start or restart a timer. */
+                                pxTimer->ucStatus |= ( uint8_t ) tmrSTATUS_IS_ACTIVE;
+
+                                if( prvInsertTimerInActiveList( pxTimer, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) != pdFALSE )
                                 {
-                                    prvReloadTimer( pxTimer, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow );
+                                    /* The timer expired before it was added to the active
+                                     * timer list.  Process it now. */
+                                    if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0U )
+                                    {
+                                        prvReloadTimer( pxTimer, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow );
+                                    }
+                                    else
+                                    {
+                                        pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
+                                    }
+
+                                    /* Call the timer callback. */
+                                    traceTIMER_EXPIRED( pxTimer );
+                                    pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
                                 }
                                 else
                                 {
-                                    pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
+                                    mtCOVERAGE_TEST_MARKER();
                                 }
 
-                                /* Call the timer callback. */
-                                traceTIMER_EXPIRED( pxTimer );
-                                pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
-                            }
-                            else
-                            {
-                                mtCOVERAGE_TEST_MARKER();
-                            }
+                                break;
 
-                            break;
-
-                        case tmrCOMMAND_STOP:
-                        case tmrCOMMAND_STOP_FROM_ISR:
-                            /* The timer has already been removed from the active list. */
-                            pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
-                            break;
-
-                        case tmrCOMMAND_CHANGE_PERIOD:
-                        case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR:
-                            pxTimer->ucStatus |= ( uint8_t ) tmrSTATUS_IS_ACTIVE;
-                            pxTimer->xTimerPeriodInTicks = xMessage.u.xTimerParameters.xMessageValue;
-                            configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
-
-                            /* The new period does not really have a reference, and can
-                             * be longer or shorter than the old one.  The command time is
-                             * therefore set to the current time, and as the period cannot
-                             * be zero the next expiry time can only be in the future,
-                             * meaning (unlike for the xTimerStart() case above) there is
-                             * no fail case that needs to be handled here. */
-                            ( void ) prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
-                            break;
-
-                        case tmrCOMMAND_DELETE:
-                            #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
-                            {
-                                /* The timer has already been removed from the active list,
-                                 * just free up the memory if the memory was dynamically
-                                 * allocated. */
-                                if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
+                            case tmrCOMMAND_STOP:
+                            case tmrCOMMAND_STOP_FROM_ISR:
+                                /* The timer has already been removed from the active list. */
+                                pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
+                                break;
+
+                            case tmrCOMMAND_CHANGE_PERIOD:
+                            case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR:
+                                pxTimer->ucStatus |= ( uint8_t ) tmrSTATUS_IS_ACTIVE;
+                                pxTimer->xTimerPeriodInTicks = xMessage.u.xTimerParameters.xMessageValue;
+                                configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
+
+                                /* The new period does not really have a reference, and can
+                                 * be longer or shorter than the old one.  The command time is
+                                 * therefore set to the current time, and as the period cannot
+                                 * be zero the next expiry time can only be in the future,
+                                 * meaning (unlike for the xTimerStart() case above) there is
+                                 * no fail case that needs to be handled here. */
+                                ( void ) prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
+                                break;
+
+                            case tmrCOMMAND_DELETE:
+                                #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
                                 {
-                                    vPortFree( pxTimer );
+                                    /* The timer has already been removed from the active list,
+                                     * just free up the memory if the memory was dynamically
+                                     * allocated. */
+                                    if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
+                                    {
+                                        vPortFree( pxTimer );
+                                    }
+                                    else
+                                    {
+                                        pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
+                                    }
                                 }
-                                else
+                                #else /* if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
                                 {
+                                    /* If dynamic allocation is not enabled, the memory
+                                     * could not have been dynamically allocated. So there is
+                                     * no need to free the memory - just mark the timer as
+                                     * "not active". */
                                     pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
                                 }
-                            }
-                            #else /* if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) */
-                            {
-                                /* If dynamic allocation is not enabled, the memory
-                                 * could not have been dynamically allocated. So there is
-                                 * no need to free the memory - just mark the timer as
-                                 * "not active". */
-                                pxTimer->ucStatus &= ( ( uint8_t ) ~tmrSTATUS_IS_ACTIVE );
-                            }
-                            #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
-                            break;
+                                #endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+                                break;
 
-                        default:
-                            /* Don't expect to get here. */
-                            break;
+                            default:
+                                /* Don't expect to get here. */
+                                break;
+                        }
                     }
+                    #endif /* configUSE_TIMER_WHEEL */
                 }
                 else
                 {
@@ -1083,32 +1755,48 @@
                 }
             }
         }
+
+        #if ( configUSE_TIMER_WHEEL == 1 )
+        {
+            /* Every received message has been applied.  Anything queued since
+             * the last receive failed still keeps tasks off the direct path. */
+            taskENTER_CRITICAL();
+            {
+                xWheelReceiving = pdFALSE;
+            }
+            taskEXIT_CRITICAL();
+        }
+        #endif
     }
 /*-----------------------------------------------------------*/
 
-    static void prvSwitchTimerLists( void )
-    {
-        TickType_t xNextExpireTime;
-        List_t * pxTemp;
-
-        /* The tick count has overflowed.  The timer lists must be switched.
-         * If there are any timers still referenced from the current timer list
-         * then they must have expired and should be processed before the lists
-         * are switched. */
-        while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
+    #if ( configUSE_TIMER_WHEEL == 0 )
+
+        static void prvSwitchTimerLists( void )
         {
-            xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+            TickType_t xNextExpireTime;
+            List_t * pxTemp;
+
+            /* The tick count has overflowed.  The timer lists must be switched.
+             * If there are any timers still referenced from the current timer list
+             * then they must have expired and should be processed before the lists
+             * are switched. */
+            while( listLIST_IS_EMPTY( pxCurrentTimerList ) == pdFALSE )
+            {
+                xNextExpireTime = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxCurrentTimerList );
+
+                /* Process the expired timer.  For auto-reload timers, be careful to
+                 * process only expirations that occur on the current list.  Further
+                 * expirations must wait until after the lists are switched. */
+                prvProcessExpiredTimer( xNextExpireTime, tmrMAX_TIME_BEFORE_OVERFLOW );
+            }
 
-            /* Process the expired timer.  For auto-reload timers, be careful to
-             * process only expirations that occur on the current list.  Further
-             * expirations must wait until after the lists are switched. */
-            prvProcessExpiredTimer( xNextExpireTime, tmrMAX_TIME_BEFORE_OVERFLOW );
+            pxTemp = pxCurrentTimerList;
+            pxCurrentTimerList = pxOverflowTimerList;
+            pxOverflowTimerList = pxTemp;
         }
 
-        pxTemp = pxCurrentTimerList;
-        pxCurrentTimerList = pxOverflowTimerList;
-        pxOverflowTimerList = pxTemp;
-    }
+    #endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
     static void prvCheckForValidListAndQueue( void )
@@ -1120,10 +1808,31 @@
         {
             if( xTimerQueue == NULL )
             {
-                vListInitialise( &xActiveTimerList1 );
-                vListInitialise( &xActiveTimerList2 );
-                pxCurrentTimerList = &xActiveTimerList1;
-                pxOverflowTimerList = &xActiveTimerList2;
+                #if ( configUSE_TIMER_WHEEL == 1 )
+                {
+                    UBaseType_t uxLevel;
+                    UBaseType_t uxSlot;
+
+                    for( uxLevel = 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+                    {
+                        for( uxSlot = 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+                        {
+                            vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+                        }
+
+                        ulWheelOccupied[ uxLevel ] = 0U;
+                    }
+
+                    xWheelTime = xTaskGetTickCount();
+                }
+                #else
+                {
+                    vListInitialise( &xActiveTimerList1 );
+                    vListInitialise( &xActiveTimerList2 );
+                    pxCurrentTimerList = &xActiveTimerList1;
+                    pxOverflowTimerList = &xActiveTimerList2;
+                }
+                #endif /* configUSE_TIMER_WHEEL */
 
                 #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
                 {
@@ -1334,6 +2043,14 @@
     {
         xTimerQueue = NULL;
         xTimerTaskHandle = NULL;
+
+        #if ( configUSE_TIMER_WHEEL == 1 )
+        {
+            xWheelTime = ( TickType_t ) 0U;
+            xWheelWakeTime = ( TickType_t ) 0U;
+            xWheelTaskWaiting = pdFALSE;
+        }
+        #endif /* configUSE_TIMER_WHEEL */
     }
 /*-----------------------------------------------------------*/
 
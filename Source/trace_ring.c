@@ -0,0 +1,129 @@
+/*
+ * Binary kernel event trace - see trace_ring.h.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cache.h"
+#include "pmu.h"
+#include "tick_timer.h"
+
+#if ( configUSE_TRACE_RING == 1 )
+
+// Defines the kernel's trace macros, so only with the ring on
+#include "trace_ring.h"
+
+// Linked at TRACE_RING_BASE (link.ld), outside the BSS clear.  Only the host
+// reads it, so 'used' keeps LTO from dropping the stores.
+trace_ring_area_t trace_ring_area __attribute__((section(".trace_ring"), aligned(64), used));
+
+// In the BSS, so that nothing is recorded into the unformatted rings before
+// trace_ring_init().
+static volatile uint32_t trace_enabled;
+static uint32_t trace_use_pmu;
+
+static inline uint32_t trace_timestamp(void) {
+    uint32_t val;
+
+    if (trace_use_pmu) {
+        __asm volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (val));
+    } else {
+        uint32_t hi;
+        __asm volatile ("mrrc p15, 1, %0, %1, c14" : "=r" (val), "=r" (hi));
+    }
+    return val;
+}
+
+void trace_ring_init(void) {
+    trace_ring_header_t *h = &trace_ring_area.header;
+
+    configASSERT((uintptr_t)&trace_ring_area == TRACE_RING_BASE);
+
+    h->magic = 0;
+    for (uint32_t c = 0; c < configNUMBER_OF_CORES; c++) {
+        trace_ring_area.core[c].head = 0;
+    }
+
+    // Enable the cycle counter without resetting it; the port resets it
+    // itself when it sets up the run time stats.  A hypervisor that does not
+    // expose the PMU leaves it stuck.
+    trace_use_pmu = 0;
+#if ( configNUMBER_OF_CORES == 1 )
+    {
+        uint32_t pmcr, start;
+
+        __asm volatile ("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+        pmcr = (pmcr | PMCR_E) & ~PMCR_D;
+        __asm volatile ("mcr p15, 0, %0, c9, c12, 0\n"
+                        "mcr p15, 0, %1, c9, c12, 1\n"
+                        "isb" :: "r" (pmcr), "r" (PMCNTEN_C) : "memory");
+        start = pmu_read_cycles();
+        for (volatile uint32_t i = 0; i < 1000; i++) {
+        }
+        trace_use_pmu = (pmu_read_cycles() != start);
+    }
+#endif
+
+    h->version = TRACE_RING_VERSION;
+    h->core_count = configNUMBER_OF_CORES;
+    h->record_count = TRACE_RING_RECORDS;
+    h->record_size = sizeof(trace_record_t);
+    if (trace_use_pmu) {
+        h->clock_source = TRACE_CLOCK_PMU;
+        h->clock_hz = configCPU_CLOCK_HZ;
+    } else {
+        h->clock_source = TRACE_CLOCK_VIRTUAL;
+        h->clock_hz = tick_timer_read_cntfrq();
+        if (h->clock_hz == 0) {
+            h->clock_hz = TICK_TIMER_FALLBACK_HZ;
+        }
+    }
+    h->frozen = 0;
+    __asm volatile ("dmb ish" ::: "memory");
+    h->magic = TRACE_RING_MAGIC;
+
+    trace_enabled = 1;
+}
+
+void trace_ring_record(uint32_t event, uint32_t object, uint32_t value) {
+    uint32_t cpsr;
+
+    if (!trace_enabled) {
+        return;
+    }
+
+    // Tasks and ISRs on a core share its ring; each core has its own, so the
+    // I bit is all the exclusion a record needs.
+    __asm volatile ("mrs %0, cpsr\n"
+                    "cpsid i" : "=r" (cpsr) :: "memory");
+    {
+#if ( configNUMBER_OF_CORES > 1 )
+        trace_ring_core_t *c = &trace_ring_area.core[portGET_CORE_ID()];
+#else
+        trace_ring_core_t *c = &trace_ring_area.core[0];
+#endif
+        uint32_t head = c->head;
+        trace_record_t *r = &c->records[head & (TRACE_RING_RECORDS - 1)];
+
+        r->timestamp = trace_timestamp();
+        r->event = event;
+        r->object = object;
+        r->value = value;
+        c->head = head + 1;
+    }
+    __asm volatile ("msr cpsr_c, %0" :: "r" (cpsr) : "memory");
+}
+
+void trace_ring_freeze(void) {
+    if (!trace_enabled) {
+        return;
+    }
+    trace_enabled = 0;
+    trace_ring_area.header.frozen = 1;
+
+    // QEMU keeps no caches, but a debugger reading RAM on hardware would see
+    // stale lines.
+    cache_clean_range(&trace_ring_area, sizeof(trace_ring_area));
+}
+
+#endif // configUSE_TRACE_RING
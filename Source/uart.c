@@ -0,0 +1,190 @@
+/*
+ * Buffered, interrupt-driven PL011 UART driver - see uart.h.
+ *
+ * All access to the TX stream buffer, from tasks and from ISRs, happens inside
+ * a critical section, so the buffer only ever sees one writer and one reader
+ * at a time even though both the task side and the TX interrupt move bytes
+ * from the ring into the FIFO.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "gic.h"
+#include "static_alloc.h"
+#include "uart.h"
+
+#define UART_REG(off)   (*(volatile uint32_t *)(UART0_BASE + (off)))
+
+#define UART_DR         UART_REG(0x00)
+#define UART_FR         UART_REG(0x18)
+#define UART_LCR_H      UART_REG(0x2C)
+#define UART_CR         UART_REG(0x30)
+#define UART_IFLS       UART_REG(0x34)
+#define UART_IMSC       UART_REG(0x38)
+#define UART_MIS        UART_REG(0x40)
+#define UART_ICR        UART_REG(0x44)
+
+#define FR_BUSY         (1 << 3)
+#define FR_TXFF         (1 << 5)
+#define FR_TXFE         (1 << 7)
+#define LCR_H_FEN       (1 << 4)
+#define CR_UARTEN       (1 << 0)
+#define INT_TX          (1 << 5)
+#define IFLS_TX_1_8     0x0
+
+// The PL011 TX FIFO is at least 16 entries deep.
+#define UART_FIFO_DEPTH 16
+
+static StreamBufferHandle_t tx_stream;
+static StaticStreamBuffer_t tx_stream_struct KERNEL_OBJECT_SECTION;
+static uint8_t tx_storage[UART_TX_BUFFER_SIZE];
+static volatile int polled_mode = 1;
+static volatile uint32_t tx_dropped;
+
+static void polled_putc(char c) {
+    while (UART_FR & FR_TXFF) {}
+    UART_DR = c;
+}
+
+static int uart_buffered(void) {
+    return !polled_mode && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+// Move bytes from the ring into the TX FIFO until one of them runs out, then
+// leave the TX interrupt enabled only if there is more to send.  Must be
+// called inside a critical section.
+static void tx_fill_fifo(void) {
+    char chunk[UART_FIFO_DEPTH];
+    size_t n;
+
+    for (;;) {
+        if (UART_FR & FR_TXFE) {
+            // Empty FIFO: a full chunk is guaranteed to fit.
+            n = xStreamBufferReceiveFromISR(tx_stream, chunk, sizeof(chunk), NULL);
+            for (size_t i = 0; i < n; i++) {
+                UART_DR = chunk[i];
+            }
+        } else if (!(UART_FR & FR_TXFF)) {
+            n = xStreamBufferReceiveFromISR(tx_stream, chunk, 1, NULL);
+            if (n) {
+                UART_DR = chunk[0];
+            }
+        } else {
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+    }
+
+    if (xStreamBufferIsEmpty(tx_stream)) {
+        UART_IMSC &= ~INT_TX;
+    } else {
+        UART_IMSC |= INT_TX;
+    }
+}
+
+void uart_init(void) {
+    // The FIFO has to be enabled with the UART disabled and idle.
+    if (!(UART_LCR_H & LCR_H_FEN)) {
+        uint32_t cr = UART_CR;
+        UART_CR = cr & ~CR_UARTEN;
+        while (UART_FR & FR_BUSY) {}
+        UART_LCR_H |= LCR_H_FEN;
+        UART_CR = cr;
+    }
+
+    UART_IMSC = 0;
+    UART_ICR = 0x7FF;
+    UART_IFLS = (UART_IFLS & ~0x7) | IFLS_TX_1_8;
+
+    tx_stream = xStreamBufferCreateStatic(sizeof(tx_storage), 1, tx_storage, &tx_stream_struct);
+
+    gic_set_priority(UART0_IRQ_ID, portLOWEST_USABLE_INTERRUPT_PRIORITY - 1);
+    gic_set_target(UART0_IRQ_ID, 1);
+    gic_enable_irq(UART0_IRQ_ID);
+
+    polled_mode = 0;
+}
+
+size_t uart_write(const char *buf, size_t len) {
+    size_t done = 0;
+
+    if (!uart_buffered()) {
+        for (size_t i = 0; i < len; i++) {
+            polled_putc(buf[i]);
+        }
+        return len;
+    }
+
+    while (done < len) {
+        taskENTER_CRITICAL();
+        done += xStreamBufferSendFromISR(tx_stream, buf + done, len - done, NULL);
+        tx_fill_fifo();
+        taskEXIT_CRITICAL();
+
+        if (done < len) {
+            // Ring full: wait for the FIFO to accept more rather than drop.
+            while (UART_FR & FR_TXFF) {}
+        }
+    }
+    return len;
+}
+
+void uart_putc(char c) {
+    uart_write(&c, 1);
+}
+
+size_t uart_write_from_isr(const char *buf, size_t len) {
+    UBaseType_t saved;
+    size_t n;
+
+    if (polled_mode) {
+        for (size_t i = 0; i < len; i++) {
+            polled_putc(buf[i]);
+        }
+        return len;
+    }
+
+    saved = taskENTER_CRITICAL_FROM_ISR();
+    n = xStreamBufferSendFromISR(tx_stream, buf, len, NULL);
+    tx_fill_fifo();
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    if (n < len) {
+        tx_dropped += len - n;
+    }
+    return n;
+}
+
+void uart_enter_polled_mode(void) {
+    char c;
+
+    if (polled_mode) {
+        return;
+    }
+    polled_mode = 1;
+    UART_IMSC &= ~INT_TX;
+
+    while (xStreamBufferReceiveFromISR(tx_stream, &c, 1, NULL) == 1) {
+        polled_putc(c);
+    }
+}
+
+void uart_irq_handler(void) {
+    UBaseType_t saved;
+
+    if (UART_MIS & INT_TX) {
+        UART_ICR = INT_TX;
+        saved = taskENTER_CRITICAL_FROM_ISR();
+        if (!polled_mode) {
+            tx_fill_fifo();
+        }
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+    }
+}
+
+uint32_t uart_tx_dropped(void) {
+    return tx_dropped;
+}